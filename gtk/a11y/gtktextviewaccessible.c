@@ -36,6 +36,11 @@ struct _GtkTextViewAccessiblePrivate
 {
   gint insert_offset;
   gint selection_bound;
+
+  /* Contiguous insertions are merged and announced once per frame */
+  gint pending_insert_offset;
+  gint pending_insert_length;
+  guint pending_tick_id;
 };
 
 static void       insert_text_cb       (GtkTextBuffer    *buffer,
@@ -114,6 +119,9 @@ gtk_text_view_accessible_ref_state_set (AtkObject *accessible)
   return state_set;
 }
 
+static void       gtk_text_view_accessible_flush_insert (GtkTextViewAccessible *accessible,
+                                                         GtkTextBuffer         *buffer);
+
 static void
 gtk_text_view_accessible_change_buffer (GtkTextViewAccessible *accessible,
                                         GtkTextBuffer         *old_buffer,
@@ -121,6 +129,7 @@ gtk_text_view_accessible_change_buffer (GtkTextViewAccessible *accessible,
 {
   if (old_buffer)
     {
+      gtk_text_view_accessible_flush_insert (accessible, old_buffer);
       g_signal_handlers_disconnect_matched (old_buffer, G_SIGNAL_MATCH_DATA, 0, 0, NULL, NULL, accessible);
 
       g_signal_emit_by_name (accessible,
@@ -142,17 +151,37 @@ gtk_text_view_accessible_change_buffer (GtkTextViewAccessible *accessible,
     }
 }
 
+/* An unmapped widget gets no frames, so the pending insertion would
+ * only be announced once it is shown again
+ */
+static void
+gtk_text_view_accessible_unmap (GtkWidget             *widget,
+                                GtkTextViewAccessible *accessible)
+{
+  gtk_text_view_accessible_flush_insert (accessible,
+                                         gtk_text_view_get_buffer (GTK_TEXT_VIEW (widget)));
+}
+
 static void
 gtk_text_view_accessible_widget_set (GtkAccessible *accessible)
 {
+  GtkWidget *widget = gtk_accessible_get_widget (accessible);
+
+  g_signal_connect (widget, "unmap",
+                    G_CALLBACK (gtk_text_view_accessible_unmap), accessible);
+
   gtk_text_view_accessible_change_buffer (GTK_TEXT_VIEW_ACCESSIBLE (accessible),
                                           NULL,
-                                          gtk_text_view_get_buffer (GTK_TEXT_VIEW (gtk_accessible_get_widget (accessible))));
+                                          gtk_text_view_get_buffer (GTK_TEXT_VIEW (widget)));
 }
 
 static void
 gtk_text_view_accessible_widget_unset (GtkAccessible *accessible)
 {
+  g_signal_handlers_disconnect_by_func (gtk_accessible_get_widget (accessible),
+                                        gtk_text_view_accessible_unmap,
+                                        accessible);
+
   gtk_text_view_accessible_change_buffer (GTK_TEXT_VIEW_ACCESSIBLE (accessible),
                                           gtk_text_view_get_buffer (GTK_TEXT_VIEW (gtk_accessible_get_widget (accessible))),
                                           NULL);
@@ -1764,6 +1793,42 @@ gtk_text_view_accessible_update_cursor (GtkTextViewAccessible *accessible,
     g_signal_emit_by_name (accessible, "text-selection-changed");
 }
 
+static void
+gtk_text_view_accessible_flush_insert (GtkTextViewAccessible *accessible,
+                                       GtkTextBuffer         *buffer)
+{
+  GtkTextViewAccessiblePrivate *priv = accessible->priv;
+  GtkWidget *widget;
+
+  if (priv->pending_tick_id == 0)
+    return;
+
+  widget = gtk_accessible_get_widget (GTK_ACCESSIBLE (accessible));
+  if (widget)
+    gtk_widget_remove_tick_callback (widget, priv->pending_tick_id);
+  priv->pending_tick_id = 0;
+
+  g_signal_emit_by_name (accessible,
+                         "text-changed::insert",
+                         priv->pending_insert_offset,
+                         priv->pending_insert_length);
+
+  gtk_text_view_accessible_update_cursor (accessible, buffer);
+}
+
+static gboolean
+flush_insert_tick (GtkWidget     *widget,
+                   GdkFrameClock *frame_clock,
+                   gpointer       data)
+{
+  GtkTextViewAccessible *accessible = data;
+
+  gtk_text_view_accessible_flush_insert (accessible,
+                                         gtk_text_view_get_buffer (GTK_TEXT_VIEW (widget)));
+
+  return G_SOURCE_REMOVE;
+}
+
 static void
 insert_text_cb (GtkTextBuffer *buffer,
                 GtkTextIter   *iter,
@@ -1772,15 +1837,38 @@ insert_text_cb (GtkTextBuffer *buffer,
                 gpointer       data)
 {
   GtkTextViewAccessible *accessible = data;
+  GtkTextViewAccessiblePrivate *priv = accessible->priv;
+  GtkWidget *widget;
   gint position;
   gint length;
 
   position = gtk_text_iter_get_offset (iter);
   length = g_utf8_strlen (text, len);
- 
-  g_signal_emit_by_name (accessible, "text-changed::insert", position - length, length);
 
-  gtk_text_view_accessible_update_cursor (accessible, buffer);
+  if (priv->pending_tick_id != 0 &&
+      position - length == priv->pending_insert_offset + priv->pending_insert_length)
+    {
+      priv->pending_insert_length += length;
+      return;
+    }
+
+  gtk_text_view_accessible_flush_insert (accessible, buffer);
+
+  widget = gtk_accessible_get_widget (GTK_ACCESSIBLE (accessible));
+  if (widget == NULL || !gtk_widget_get_mapped (widget))
+    {
+      g_signal_emit_by_name (accessible, "text-changed::insert", position - length, length);
+
+      gtk_text_view_accessible_update_cursor (accessible, buffer);
+      return;
+    }
+
+  priv->pending_insert_offset = position - length;
+  priv->pending_insert_length = length;
+  priv->pending_tick_id = gtk_widget_add_tick_callback (widget,
+                                                        flush_insert_tick,
+                                                        accessible,
+                                                        NULL);
 }
 
 static void
@@ -1792,6 +1880,9 @@ delete_range_cb (GtkTextBuffer *buffer,
   GtkTextViewAccessible *accessible = data;
   gint offset, length;
 
+  /* Deletions are announced right away, while the text still exists */
+  gtk_text_view_accessible_flush_insert (accessible, buffer);
+
   offset = gtk_text_iter_get_offset (start);
   length = gtk_text_iter_get_offset (end) - offset;
 
@@ -1817,10 +1908,12 @@ mark_set_cb (GtkTextBuffer *buffer,
    */
   if (mark == gtk_text_buffer_get_insert (buffer))
     {
+      gtk_text_view_accessible_flush_insert (accessible, buffer);
       gtk_text_view_accessible_update_cursor (accessible, buffer);
     }
   else if (mark == gtk_text_buffer_get_selection_bound (buffer))
     {
+      gtk_text_view_accessible_flush_insert (accessible, buffer);
       gtk_text_view_accessible_update_cursor (accessible, buffer);
     }
 }
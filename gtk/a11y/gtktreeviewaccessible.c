@@ -35,9 +35,30 @@
 #include "gtkcellaccessibleparent.h"
 #include "gtkcellaccessibleprivate.h"
 
+/* Row insertions and deletions are not announced right away. Adjacent
+ * ones are merged into a single range and emitted on the next frame,
+ * so that filling or clearing a model does not send one event per row
+ * to assistive technologies.
+ */
+typedef enum {
+  PENDING_NONE,
+  PENDING_INSERT,
+  PENDING_DELETE
+} PendingChange;
+
+/* Above this many cells, a range is announced as a model change
+ * instead of emitting children-changed for every cell.
+ */
+#define MAX_CHILDREN_CHANGED 256
+
 struct _GtkTreeViewAccessiblePrivate
 {
   GHashTable *cell_infos;
+
+  PendingChange pending;
+  guint pending_row;
+  guint pending_n_rows;
+  guint pending_tick_id;
 };
 
 typedef struct _GtkTreeViewAccessibleCellInfo  GtkTreeViewAccessibleCellInfo;
@@ -74,6 +95,7 @@ static gboolean         get_rbtree_column_from_index    (GtkTreeView
 static GtkTreeViewAccessibleCellInfo* find_cell_info    (GtkTreeViewAccessible           *view,
                                                          GtkCellAccessible               *cell);
 static AtkObject *       get_header_from_column         (GtkTreeViewColumn      *tv_col);
+static void             gtk_tree_view_accessible_flush_rows (GtkTreeViewAccessible *accessible);
 
 
 static void atk_table_interface_init                  (AtkTableIface                *iface);
@@ -195,6 +217,7 @@ gtk_tree_view_accessible_notify_gtk (GObject    *obj,
       AtkRole role;
 
       tree_model = gtk_tree_view_get_model (tree_view);
+      gtk_tree_view_accessible_flush_rows (accessible);
       g_hash_table_remove_all (accessible->priv->cell_infos);
 
       if (tree_model)
@@ -218,11 +241,34 @@ gtk_tree_view_accessible_notify_gtk (GObject    *obj,
     GTK_WIDGET_ACCESSIBLE_CLASS (gtk_tree_view_accessible_parent_class)->notify_gtk (obj, pspec);
 }
 
+/* An unmapped widget gets no frames, so the pending rows would only be
+ * announced once it is shown again
+ */
+static void
+gtk_tree_view_accessible_unmap (GtkWidget             *widget,
+                                GtkTreeViewAccessible *accessible)
+{
+  gtk_tree_view_accessible_flush_rows (accessible);
+}
+
+static void
+gtk_tree_view_accessible_widget_set (GtkAccessible *gtkaccessible)
+{
+  GTK_ACCESSIBLE_CLASS (gtk_tree_view_accessible_parent_class)->widget_set (gtkaccessible);
+
+  g_signal_connect (gtk_accessible_get_widget (gtkaccessible), "unmap",
+                    G_CALLBACK (gtk_tree_view_accessible_unmap), gtkaccessible);
+}
+
 static void
 gtk_tree_view_accessible_widget_unset (GtkAccessible *gtkaccessible)
 {
   GtkTreeViewAccessible *accessible = GTK_TREE_VIEW_ACCESSIBLE (gtkaccessible);
 
+  g_signal_handlers_disconnect_by_func (gtk_accessible_get_widget (gtkaccessible),
+                                        gtk_tree_view_accessible_unmap,
+                                        accessible);
+  gtk_tree_view_accessible_flush_rows (accessible);
   g_hash_table_remove_all (accessible->priv->cell_infos);
 
   GTK_ACCESSIBLE_CLASS (gtk_tree_view_accessible_parent_class)->widget_unset (gtkaccessible);
@@ -503,6 +549,7 @@ gtk_tree_view_accessible_class_init (GtkTreeViewAccessibleClass *klass)
 
   widget_class->notify_gtk = gtk_tree_view_accessible_notify_gtk;
 
+  accessible_class->widget_set = gtk_tree_view_accessible_widget_set;
   accessible_class->widget_unset = gtk_tree_view_accessible_widget_unset;
 
   /* The children of a GtkTreeView are the buttons at the top of the columns
@@ -1414,6 +1461,7 @@ _gtk_tree_view_accessible_reorder (GtkTreeView *treeview)
   if (accessible == NULL)
     return;
 
+  gtk_tree_view_accessible_flush_rows (accessible);
   g_signal_emit_by_name (accessible, "row-reordered");
 }
 
@@ -1598,13 +1646,145 @@ get_header_from_column (GtkTreeViewColumn *tv_col)
   return rc;
 }
 
+static void
+emit_rows_changed (GtkTreeViewAccessible *accessible,
+                   PendingChange          change,
+                   guint                  row,
+                   guint                  n_rows)
+{
+  GtkWidget *widget;
+  guint n_cols, i;
+
+  widget = gtk_accessible_get_widget (GTK_ACCESSIBLE (accessible));
+  n_cols = widget ? get_n_columns (GTK_TREE_VIEW (widget)) : 0;
+
+  if (change == PENDING_INSERT)
+    g_signal_emit_by_name (accessible, "row-inserted", row, n_rows);
+  else
+    g_signal_emit_by_name (accessible, "row-deleted", row, n_rows);
+
+  if (n_cols == 0)
+    return;
+
+  if (n_rows * n_cols > MAX_CHILDREN_CHANGED)
+    {
+      g_signal_emit_by_name (accessible, "model-changed");
+      return;
+    }
+
+  if (change == PENDING_INSERT)
+    {
+      for (i = (row + 1) * n_cols; i < (row + n_rows + 1) * n_cols; i++)
+        {
+         /* Pass NULL as the child object, i.e. 4th argument */
+          g_signal_emit_by_name (accessible, "children-changed::add", i, NULL, NULL);
+        }
+    }
+  else
+    {
+      for (i = (n_rows + row + 1) * n_cols - 1; i >= (row + 1) * n_cols; i--)
+        {
+         /* Pass NULL as the child object, i.e. 4th argument */
+          g_signal_emit_by_name (accessible, "children-changed::remove", i, NULL, NULL);
+        }
+    }
+}
+
+static void
+gtk_tree_view_accessible_flush_rows (GtkTreeViewAccessible *accessible)
+{
+  GtkTreeViewAccessiblePrivate *priv = accessible->priv;
+  GtkWidget *widget;
+  PendingChange change;
+
+  if (priv->pending_tick_id != 0)
+    {
+      widget = gtk_accessible_get_widget (GTK_ACCESSIBLE (accessible));
+      if (widget)
+        gtk_widget_remove_tick_callback (widget, priv->pending_tick_id);
+      priv->pending_tick_id = 0;
+    }
+
+  if (priv->pending == PENDING_NONE)
+    return;
+
+  change = priv->pending;
+  priv->pending = PENDING_NONE;
+
+  emit_rows_changed (accessible, change, priv->pending_row, priv->pending_n_rows);
+}
+
+static gboolean
+flush_rows_tick (GtkWidget     *widget,
+                 GdkFrameClock *frame_clock,
+                 gpointer       data)
+{
+  GtkTreeViewAccessible *accessible = data;
+
+  accessible->priv->pending_tick_id = 0;
+  gtk_tree_view_accessible_flush_rows (accessible);
+
+  return G_SOURCE_REMOVE;
+}
+
+static void
+queue_rows_changed (GtkTreeViewAccessible *accessible,
+                    GtkTreeView           *treeview,
+                    PendingChange          change,
+                    guint                  row,
+                    guint                  n_rows)
+{
+  GtkTreeViewAccessiblePrivate *priv = accessible->priv;
+
+  if (priv->pending == change)
+    {
+      if (change == PENDING_INSERT &&
+          row >= priv->pending_row &&
+          row <= priv->pending_row + priv->pending_n_rows)
+        {
+          priv->pending_n_rows += n_rows;
+          return;
+        }
+      else if (change == PENDING_DELETE &&
+               row == priv->pending_row)
+        {
+          priv->pending_n_rows += n_rows;
+          return;
+        }
+      else if (change == PENDING_DELETE &&
+               row + n_rows == priv->pending_row)
+        {
+          priv->pending_row = row;
+          priv->pending_n_rows += n_rows;
+          return;
+        }
+    }
+
+  gtk_tree_view_accessible_flush_rows (accessible);
+
+  /* Without a frame clock there is no frame to wait for */
+  if (!gtk_widget_get_mapped (GTK_WIDGET (treeview)))
+    {
+      emit_rows_changed (accessible, change, row, n_rows);
+      return;
+    }
+
+  priv->pending = change;
+  priv->pending_row = row;
+  priv->pending_n_rows = n_rows;
+  priv->pending_tick_id = gtk_widget_add_tick_callback (GTK_WIDGET (treeview),
+                                                        flush_rows_tick,
+                                                        accessible,
+                                                        NULL);
+}
+
 void
 _gtk_tree_view_accessible_add (GtkTreeView *treeview,
                                GtkRBTree   *tree,
                                GtkRBNode   *node)
 {
   GtkTreeViewAccessible *accessible;
-  guint row, n_rows, n_cols, i;
+  guint row, n_rows;
 
   accessible = GTK_TREE_VIEW_ACCESSIBLE (_gtk_widget_peek_accessible (GTK_WIDGET (treeview)));
   if (accessible == NULL)
@@ -1621,17 +1801,7 @@ _gtk_tree_view_accessible_add (GtkTreeView *treeview,
       n_rows = 1 + (node->children ? node->children->root->total_count : 0);
     }
 
-  g_signal_emit_by_name (accessible, "row-inserted", row, n_rows);
-
-  n_cols = get_n_columns (treeview);
-  if (n_cols)
-    {
-      for (i = (row + 1) * n_cols; i < (row + n_rows + 1) * n_cols; i++)
-        {
-         /* Pass NULL as the child object, i.e. 4th argument */
-          g_signal_emit_by_name (accessible, "children-changed::add", i, NULL, NULL);
-        }
-    }
+  queue_rows_changed (accessible, treeview, PENDING_INSERT, row, n_rows);
 }
 
 void
@@ -1642,7 +1812,7 @@ _gtk_tree_view_accessible_remove (GtkTreeView *treeview,
   GtkTreeViewAccessibleCellInfo *cell_info;
   GHashTableIter iter;
   GtkTreeViewAccessible *accessible;
-  guint row, n_rows, n_cols, i;
+  guint row, n_rows;
 
   accessible = GTK_TREE_VIEW_ACCESSIBLE (_gtk_widget_peek_accessible (GTK_WIDGET (treeview)));
   if (accessible == NULL)
@@ -1663,17 +1833,11 @@ _gtk_tree_view_accessible_remove (GtkTreeView *treeview,
       tree = node->children;
     }
 
-  g_signal_emit_by_name (accessible, "row-deleted", row, n_rows);
+  queue_rows_changed (accessible, treeview, PENDING_DELETE, row, n_rows);
 
-  n_cols = get_n_columns (treeview);
-  if (n_cols)
+  /* The cells must go now, their nodes are about to be freed */
+  if (get_n_columns (treeview))
     {
-      for (i = (n_rows + row + 1) * n_cols - 1; i >= (row + 1) * n_cols; i--)
-        {
-         /* Pass NULL as the child object, i.e. 4th argument */
-          g_signal_emit_by_name (accessible, "children-changed::remove", i, NULL, NULL);
-        }
-
       g_hash_table_iter_init (&iter, accessible->priv->cell_infos);
       while (g_hash_table_iter_next (&iter, NULL, (gpointer *)&cell_info))
         {
@@ -1695,6 +1859,8 @@ _gtk_tree_view_accessible_changed (GtkTreeView *treeview,
 
   accessible = GTK_TREE_VIEW_ACCESSIBLE (gtk_widget_get_accessible (GTK_WIDGET (treeview)));
 
+  gtk_tree_view_accessible_flush_rows (accessible);
+
   for (i = 0; i < gtk_tree_view_get_n_columns (treeview); i++)
     {
       GtkCellAccessible *cell = peek_cell (accessible,
@@ -1741,6 +1907,8 @@ gtk_tree_view_accessible_do_add_column (GtkTreeViewAccessible *accessible,
 {
   guint row, n_rows, n_cols;
 
+  gtk_tree_view_accessible_flush_rows (accessible);
+
   /* Generate column-inserted signal */
   g_signal_emit_by_name (accessible, "column-inserted", id, 1);
 
@@ -1787,6 +1955,8 @@ gtk_tree_view_accessible_do_remove_column (GtkTreeViewAccessible *accessible,
   gpointer value;
   guint row, n_rows, n_cols;
 
+  gtk_tree_view_accessible_flush_rows (accessible);
+
   /* Clean column from cache */
   g_hash_table_iter_init (&iter, accessible->priv->cell_infos);
   while (g_hash_table_iter_next (&iter, NULL, &value))
@@ -1841,6 +2011,7 @@ _gtk_tree_view_accessible_reorder_column (GtkTreeView       *treeview,
   if (obj == NULL)
     return;
 
+  gtk_tree_view_accessible_flush_rows (GTK_TREE_VIEW_ACCESSIBLE (obj));
   g_signal_emit_by_name (obj, "column-reordered");
 }
 
@@ -1917,6 +2088,7 @@ _gtk_tree_view_accessible_update_focus_column (GtkTreeView       *treeview,
     return;
 
   accessible = GTK_TREE_VIEW_ACCESSIBLE (obj);
+  gtk_tree_view_accessible_flush_rows (accessible);
 
   if (!_gtk_tree_view_get_cursor_node (treeview, &cursor_tree, &cursor_node))
     return;
@@ -1956,6 +2128,7 @@ _gtk_tree_view_accessible_add_state (GtkTreeView          *treeview,
     return;
 
   accessible = GTK_TREE_VIEW_ACCESSIBLE (obj);
+  gtk_tree_view_accessible_flush_rows (accessible);
 
   if (state == GTK_CELL_RENDERER_FOCUSED)
     {
@@ -2021,6 +2194,7 @@ _gtk_tree_view_accessible_remove_state (GtkTreeView          *treeview,
     return;
 
   accessible = GTK_TREE_VIEW_ACCESSIBLE (obj);
+  gtk_tree_view_accessible_flush_rows (accessible);
 
   if (state == GTK_CELL_RENDERER_FOCUSED)
     {
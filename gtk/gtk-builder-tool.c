@@ -17,6 +17,7 @@
  * Author: Matthias Clasen
  */
 
+#include <stdio.h>
 #include <stdlib.h>
 #include <string.h>
 
@@ -614,6 +615,40 @@ do_simplify (const gchar *filename)
     }
 }
 
+static void
+do_precompile (const gchar *filename)
+{
+  GError *error = NULL;
+  gchar *buffer;
+  gsize length;
+  GBytes *bytes;
+  gconstpointer data;
+  gsize size;
+
+  if (!g_file_get_contents (filename, &buffer, &length, &error))
+    {
+      g_printerr (_("Can't load file: %s\n"), error->message);
+      exit (1);
+    }
+
+  bytes = _gtk_builder_precompile (buffer, length, &error);
+  if (bytes == NULL)
+    {
+      g_printerr (_("Can't parse file: %s\n"), error->message);
+      exit (1);
+    }
+
+  data = g_bytes_get_data (bytes, &size);
+  if (fwrite (data, 1, size, stdout) != size)
+    {
+      g_printerr (_("Can't write precompiled data\n"));
+      exit (1);
+    }
+
+  g_bytes_unref (bytes);
+  g_free (buffer);
+}
+
 static GType
 make_fake_type (const gchar *type_name,
                 const gchar *parent_name)
@@ -958,6 +993,7 @@ usage (void)
              "Commands:\n"
              "  validate           Validate the file\n"
              "  simplify           Simplify the file\n"
+             "  precompile         Write the file in precompiled form\n"
              "  enumerate          List all named objects\n"
              "  preview [OPTIONS]  Preview the file\n"
              "\n"
@@ -991,6 +1027,8 @@ main (int argc, const char *argv[])
     do_validate (argv[1]);
   else if (strcmp (argv[0], "simplify") == 0)
     do_simplify (argv[1]);
+  else if (strcmp (argv[0], "precompile") == 0)
+    do_precompile (argv[1]);
   else if (strcmp (argv[0], "enumerate") == 0)
     do_enumerate (argv[1]);
   else if (strcmp (argv[0], "preview") == 0)
@@ -1386,31 +1386,30 @@ gtk_binding_entry_add_signal_from_string (GtkBindingSet *binding_set,
   return ret;
 }
 
-static gint
-find_entry_with_binding (GtkBindingEntry *entry,
-                         GtkBindingSet   *binding_set)
-{
-  return (entry->binding_set == binding_set) ? 0 : 1;
-}
-
 static gboolean
 binding_activate (GtkBindingSet *binding_set,
-                  GSList        *entries,
+                  gpointer      *entries,
+                  guint          n_entries,
                   GObject       *object,
                   gboolean       is_release,
                   gboolean      *unbound)
 {
   GtkBindingEntry *entry;
-  GSList *elem;
+  guint i;
 
-  elem = g_slist_find_custom (entries, binding_set,
-                              (GCompareFunc) find_entry_with_binding);
+  entry = NULL;
+  for (i = 0; i < n_entries; i++)
+    {
+      if (((GtkBindingEntry *) entries[i])->binding_set == binding_set)
+        {
+          entry = entries[i];
+          break;
+        }
+    }
 
-  if (!elem)
+  if (!entry)
     return FALSE;
 
-  entry = elem->data;
-
   if (is_release != ((entry->modifiers & GDK_RELEASE_MASK) != 0))
     return FALSE;
 
@@ -1428,7 +1427,8 @@ binding_activate (GtkBindingSet *binding_set,
 
 static gboolean
 gtk_bindings_activate_list (GObject  *object,
-                            GSList   *entries,
+                            gpointer *entries,
+                            guint     n_entries,
                             gboolean  is_release)
 {
   GtkStyleContext *context;
@@ -1437,7 +1437,7 @@ gtk_bindings_activate_list (GObject  *object,
   gboolean unbound = FALSE;
   GPtrArray *array;
 
-  if (!entries)
+  if (n_entries == 0)
     return FALSE;
 
   context = gtk_widget_get_style_context (GTK_WIDGET (object));
@@ -1452,7 +1452,7 @@ gtk_bindings_activate_list (GObject  *object,
       for (i = 0; i < array->len; i++)
         {
           binding_set = g_ptr_array_index (array, i);
-          handled = binding_activate (binding_set, entries,
+          handled = binding_activate (binding_set, entries, n_entries,
                                       object, is_release,
                                       &unbound);
           if (handled || unbound)
@@ -1479,7 +1479,7 @@ gtk_bindings_activate_list (GObject  *object,
           if (!binding_set)
             continue;
 
-          handled = binding_activate (binding_set, entries,
+          handled = binding_activate (binding_set, entries, n_entries,
                                       object, is_release,
                                       &unbound);
           if (unbound)
@@ -1509,7 +1509,9 @@ gtk_bindings_activate (GObject         *object,
                        guint            keyval,
                        GdkModifierType  modifiers)
 {
-  GSList *entries = NULL;
+  GSList *list, *l;
+  gpointer *entries;
+  guint n_entries, i;
   GdkDisplay *display;
   GtkKeyHash *key_hash;
   gboolean handled = FALSE;
@@ -1524,11 +1526,17 @@ gtk_bindings_activate (GObject         *object,
   display = gtk_widget_get_display (GTK_WIDGET (object));
   key_hash = binding_key_hash_for_keymap (gdk_keymap_get_for_display (display));
 
-  entries = _gtk_key_hash_lookup_keyval (key_hash, keyval, modifiers);
+  list = _gtk_key_hash_lookup_keyval (key_hash, keyval, modifiers);
 
-  handled = gtk_bindings_activate_list (object, entries, is_release);
+  n_entries = g_slist_length (list);
+  entries = g_new (gpointer, n_entries);
+  for (l = list, i = 0; l; l = l->next, i++)
+    entries[i] = l->data;
 
-  g_slist_free (entries);
+  handled = gtk_bindings_activate_list (object, entries, n_entries, is_release);
+
+  g_free (entries);
+  g_slist_free (list);
 
   return handled;
 }
@@ -1549,7 +1557,9 @@ gboolean
 gtk_bindings_activate_event (GObject     *object,
                              GdkEventKey *event)
 {
-  GSList *entries = NULL;
+  gpointer stack_entries[16];
+  gpointer *entries = stack_entries;
+  guint n_entries;
   GdkDisplay *display;
   GtkKeyHash *key_hash;
   gboolean handled = FALSE;
@@ -1560,16 +1570,28 @@ gtk_bindings_activate_event (GObject     *object,
   display = gtk_widget_get_display (GTK_WIDGET (object));
   key_hash = binding_key_hash_for_keymap (gdk_keymap_get_for_display (display));
 
-  entries = _gtk_key_hash_lookup (key_hash,
-                                  event->hardware_keycode,
-                                  event->state,
-                                  BINDING_MOD_MASK () & ~GDK_RELEASE_MASK,
-                                  event->group);
+  n_entries = _gtk_key_hash_lookup (key_hash,
+                                    event->hardware_keycode,
+                                    event->state,
+                                    BINDING_MOD_MASK () & ~GDK_RELEASE_MASK,
+                                    event->group,
+                                    entries, G_N_ELEMENTS (stack_entries));
+  if (n_entries > G_N_ELEMENTS (stack_entries))
+    {
+      entries = g_new (gpointer, n_entries);
+      _gtk_key_hash_lookup (key_hash,
+                            event->hardware_keycode,
+                            event->state,
+                            BINDING_MOD_MASK () & ~GDK_RELEASE_MASK,
+                            event->group,
+                            entries, n_entries);
+    }
 
-  handled = gtk_bindings_activate_list (object, entries,
+  handled = gtk_bindings_activate_list (object, entries, n_entries,
                                         event->type == GDK_KEY_RELEASE);
 
-  g_slist_free (entries);
+  if (entries != stack_entries)
+    g_free (entries);
 
   return handled;
 }
@@ -98,6 +98,18 @@
  *
  * Objects may be given a name with the “id” attribute, which allows the
  * application to retrieve them from the builder with gtk_builder_get_object().
+ *
+ * Toplevel objects with an “id” can be marked with deferred="yes". Such
+ * objects, e.g. dialogs that are rarely shown, are not built when the UI
+ * definition is loaded, but when gtk_builder_get_object() is first called
+ * for them or for one of the objects inside them. Until then they are not
+ * returned by gtk_builder_get_objects(), and objects inside them can not be
+ * referred to from other parts of the UI definition. Signal handlers of
+ * deferred objects are connected when they are built if
+ * gtk_builder_connect_signals() has been called before; when using
+ * gtk_builder_connect_signals_full(), call it again afterwards.
+ * Deferred objects are built right away in templates and by
+ * gtk_builder_add_objects_from_file() and similar functions.
  * An id is also necessary to use the object as property value in other
  * parts of the UI definition. GTK+ reserves ids starting and ending
  * with ___ (3 underscores) for its own purposes.
@@ -259,8 +271,20 @@ struct _GtkBuilderPrivate
   gchar *resource_prefix;
   GType template_type;
   GtkApplication *application;
+  GHashTable *deferred_objects;
+  gboolean signals_connected;
+  gpointer connect_data;
 };
 
+typedef struct {
+  gint ref_count;
+  gchar *filename;
+  gchar *resource_prefix;
+  gchar *domain;
+  gchar *buffer;
+  GPtrArray *ids;
+} DeferredObject;
+
 G_DEFINE_TYPE_WITH_PRIVATE (GtkBuilder, gtk_builder, G_TYPE_OBJECT)
 
 static void
@@ -322,6 +346,8 @@ gtk_builder_finalize (GObject *object)
   g_hash_table_destroy (priv->objects);
   if (priv->callbacks)
     g_hash_table_destroy (priv->callbacks);
+  if (priv->deferred_objects)
+    g_hash_table_destroy (priv->deferred_objects);
 
   g_slist_free_full (priv->signals, (GDestroyNotify)_free_signal_info);
 
@@ -957,6 +983,112 @@ _gtk_builder_finish (GtkBuilder *builder)
   gtk_builder_create_bindings (builder);
 }
 
+static DeferredObject *
+deferred_object_ref (DeferredObject *deferred)
+{
+  deferred->ref_count++;
+
+  return deferred;
+}
+
+static void
+deferred_object_unref (DeferredObject *deferred)
+{
+  if (--deferred->ref_count > 0)
+    return;
+
+  g_free (deferred->filename);
+  g_free (deferred->resource_prefix);
+  g_free (deferred->domain);
+  g_free (deferred->buffer);
+  g_ptr_array_unref (deferred->ids);
+  g_slice_free (DeferredObject, deferred);
+}
+
+/*< private >
+ * @builder: a #GtkBuilder
+ * @ids: the ids of all objects in the deferred object, including itself
+ * @buffer: the XML of the deferred object
+ *
+ * Remembers a toplevel object with the “deferred” attribute, to be
+ * built when one of @ids is looked up with gtk_builder_get_object().
+ */
+void
+_gtk_builder_add_deferred (GtkBuilder  *builder,
+                           GPtrArray   *ids,
+                           const gchar *buffer)
+{
+  GtkBuilderPrivate *priv = builder->priv;
+  DeferredObject *deferred;
+  guint i;
+
+  if (priv->deferred_objects == NULL)
+    priv->deferred_objects = g_hash_table_new_full (g_str_hash, g_str_equal,
+                                                    g_free,
+                                                    (GDestroyNotify) deferred_object_unref);
+
+  deferred = g_slice_new0 (DeferredObject);
+  deferred->filename = g_strdup (priv->filename);
+  deferred->resource_prefix = g_strdup (priv->resource_prefix);
+  deferred->domain = g_strdup (priv->domain);
+  deferred->buffer = g_strdup_printf ("<interface>%s</interface>", buffer);
+  deferred->ids = g_ptr_array_ref (ids);
+
+  for (i = 0; i < ids->len; i++)
+    g_hash_table_insert (priv->deferred_objects,
+                         g_strdup (g_ptr_array_index (ids, i)),
+                         deferred_object_ref (deferred));
+}
+
+static void
+gtk_builder_build_deferred (GtkBuilder  *builder,
+                            const gchar *name)
+{
+  GtkBuilderPrivate *priv = builder->priv;
+  DeferredObject *deferred;
+  gchar *filename, *resource_prefix, *domain;
+  GError *error = NULL;
+  guint i;
+
+  deferred = g_hash_table_lookup (priv->deferred_objects, name);
+  if (deferred == NULL)
+    return;
+
+  deferred_object_ref (deferred);
+  for (i = 0; i < deferred->ids->len; i++)
+    g_hash_table_remove (priv->deferred_objects, g_ptr_array_index (deferred->ids, i));
+
+  filename = priv->filename;
+  resource_prefix = priv->resource_prefix;
+  domain = priv->domain;
+
+  priv->filename = g_strdup (deferred->filename);
+  priv->resource_prefix = g_strdup (deferred->resource_prefix);
+  priv->domain = g_strdup (deferred->domain);
+
+  _gtk_builder_parser_parse_buffer (builder, deferred->filename,
+                                    deferred->buffer, strlen (deferred->buffer),
+                                    NULL,
+                                    &error);
+
+  g_free (priv->filename);
+  g_free (priv->resource_prefix);
+  g_free (priv->domain);
+  priv->filename = filename;
+  priv->resource_prefix = resource_prefix;
+  priv->domain = domain;
+
+  if (error)
+    {
+      g_warning ("Failed to build deferred object '%s': %s", name, error->message);
+      g_error_free (error);
+    }
+  else if (priv->signals_connected)
+    gtk_builder_connect_signals (builder, priv->connect_data);
+
+  deferred_object_unref (deferred);
+}
+
 /**
  * gtk_builder_new:
  *
@@ -1147,7 +1279,7 @@ gtk_builder_extend_with_template (GtkBuilder   *builder,
   g_return_val_if_fail (GTK_IS_WIDGET (widget), 0);
   g_return_val_if_fail (g_type_name (template_type) != NULL, 0);
   g_return_val_if_fail (g_type_is_a (G_OBJECT_TYPE (widget), template_type), 0);
-  g_return_val_if_fail (buffer && buffer[0], 0);
+  g_return_val_if_fail (buffer && (buffer[0] || _gtk_builder_is_precompiled (buffer, length)), 0);
 
   tmp_error = NULL;
 
@@ -1458,10 +1590,19 @@ GObject *
 gtk_builder_get_object (GtkBuilder  *builder,
                         const gchar *name)
 {
+  GObject *object;
+
   g_return_val_if_fail (GTK_IS_BUILDER (builder), NULL);
   g_return_val_if_fail (name != NULL, NULL);
 
-  return g_hash_table_lookup (builder->priv->objects, name);
+  object = g_hash_table_lookup (builder->priv->objects, name);
+  if (object == NULL && builder->priv->deferred_objects != NULL)
+    {
+      gtk_builder_build_deferred (builder, name);
+      object = g_hash_table_lookup (builder->priv->objects, name);
+    }
+
+  return object;
 }
 
 /**
@@ -1643,6 +1784,10 @@ gtk_builder_connect_signals (GtkBuilder *builder,
 
   g_return_if_fail (GTK_IS_BUILDER (builder));
 
+  /* Remember the user data for deferred objects built later on */
+  builder->priv->signals_connected = TRUE;
+  builder->priv->connect_data = user_data;
+
   args.data = user_data;
 
   if (g_module_supported ())
@@ -232,6 +232,88 @@ is_requested_object (const gchar *object,
   return FALSE;
 }
 
+/* The ids of deferred objects are reserved like those of the objects
+ * that are built right away, so duplicates are caught while parsing.
+ */
+static gboolean
+add_deferred_id (GMarkupParseContext  *context,
+                 ParserData           *data,
+                 const gchar          *id,
+                 GError              **error)
+{
+  gint line;
+
+  line = GPOINTER_TO_INT (g_hash_table_lookup (data->object_ids, id));
+  if (line != 0)
+    {
+      g_set_error (error,
+                   GTK_BUILDER_ERROR,
+                   GTK_BUILDER_ERROR_DUPLICATE_ID,
+                   "Duplicate object ID '%s' (previously on line %d)",
+                   id, line);
+      _gtk_builder_prefix_error (data->builder, context, error);
+      return FALSE;
+    }
+
+  g_markup_parse_context_get_position (context, &line, NULL);
+  g_hash_table_insert (data->object_ids, g_strdup (id), GINT_TO_POINTER (line));
+  g_ptr_array_add (data->deferred_ids, g_strdup (id));
+
+  return TRUE;
+}
+
+static void
+collect_deferred_start (GMarkupParseContext  *context,
+                        ParserData           *data,
+                        const gchar          *element_name,
+                        const gchar         **names,
+                        const gchar         **values,
+                        GError              **error)
+{
+  gint i;
+
+  data->deferred_level++;
+
+  g_string_append_c (data->deferred, '<');
+  g_string_append (data->deferred, element_name);
+  for (i = 0; names[i]; i++)
+    {
+      gchar *escaped;
+
+      /* Don't defer the object again when it gets instantiated */
+      if (data->deferred_level == 1 && strcmp (names[i], "deferred") == 0)
+        continue;
+
+      if (strcmp (names[i], "id") == 0 &&
+          (strcmp (element_name, "object") == 0 ||
+           strcmp (element_name, "menu") == 0) &&
+          !add_deferred_id (context, data, values[i], error))
+        return;
+
+      escaped = g_markup_escape_text (values[i], -1);
+      g_string_append_printf (data->deferred, " %s=\"%s\"", names[i], escaped);
+      g_free (escaped);
+    }
+  g_string_append_c (data->deferred, '>');
+}
+
+static void
+collect_deferred_end (ParserData  *data,
+                      const gchar *element_name)
+{
+  g_string_append_printf (data->deferred, "</%s>", element_name);
+
+  if (--data->deferred_level > 0)
+    return;
+
+  _gtk_builder_add_deferred (data->builder, data->deferred_ids, data->deferred->str);
+
+  g_string_free (data->deferred, TRUE);
+  g_ptr_array_unref (data->deferred_ids);
+  data->deferred = NULL;
+  data->deferred_ids = NULL;
+}
+
 static void
 parse_object (GMarkupParseContext  *context,
               ParserData           *data,
@@ -247,6 +329,7 @@ parse_object (GMarkupParseContext  *context,
   const gchar *constructor = NULL;
   const gchar *type_func = NULL;
   const gchar *object_id = NULL;
+  gboolean deferred = FALSE;
   gchar *internal_id = NULL;
   gint line;
 
@@ -262,12 +345,28 @@ parse_object (GMarkupParseContext  *context,
                                     G_MARKUP_COLLECT_STRING|G_MARKUP_COLLECT_OPTIONAL, "constructor", &constructor,
                                     G_MARKUP_COLLECT_STRING|G_MARKUP_COLLECT_OPTIONAL, "type-func", &type_func,
                                     G_MARKUP_COLLECT_STRING|G_MARKUP_COLLECT_OPTIONAL, "id", &object_id,
+                                    G_MARKUP_COLLECT_BOOLEAN|G_MARKUP_COLLECT_OPTIONAL, "deferred", &deferred,
                                     G_MARKUP_COLLECT_INVALID))
     {
       _gtk_builder_prefix_error (data->builder, data->ctx, error);
       return;
     }
 
+  /* Deferred toplevel objects are kept as XML and only built
+   * when gtk_builder_get_object() asks for them. Objects that
+   * are explicitly requested or part of a template are built
+   * right away.
+   */
+  if (deferred && object_id && child_info == NULL &&
+      data->requested_objects == NULL &&
+      _gtk_builder_get_template_type (data->builder) == 0)
+    {
+      data->deferred = g_string_new (NULL);
+      data->deferred_ids = g_ptr_array_new_with_free_func (g_free);
+      collect_deferred_start (context, data, element_name, names, values, error);
+      return;
+    }
+
   if (object_class)
     {
       object_type = gtk_builder_get_type_from_name (data->builder, object_class);
@@ -943,6 +1042,12 @@ start_element (GMarkupParseContext  *context,
     }
 #endif
 
+  if (data->deferred)
+    {
+      collect_deferred_start (context, data, element_name, names, values, error);
+      return;
+    }
+
   if (!data->last_element && strcmp (element_name, "interface") != 0)
     {
       error_unhandled_tag (data, element_name, error);
@@ -1011,6 +1116,12 @@ end_element (GMarkupParseContext  *context,
 
   GTK_NOTE (BUILDER, g_message ("</%s>", element_name));
 
+  if (data->deferred)
+    {
+      collect_deferred_end (data, element_name);
+      return;
+    }
+
   if (data->subparser && data->subparser->start)
     {
       subparser_end (context, element_name, data, error);
@@ -1157,6 +1268,16 @@ text (GMarkupParseContext  *context,
   ParserData *data = (ParserData*)user_data;
   CommonInfo *info;
 
+  if (data->deferred)
+    {
+      gchar *escaped;
+
+      escaped = g_markup_escape_text (text, text_len);
+      g_string_append (data->deferred, escaped);
+      g_free (escaped);
+      return;
+    }
+
   if (data->subparser && data->subparser->start)
     {
       GError *tmp_error = NULL;
@@ -1175,7 +1296,11 @@ text (GMarkupParseContext  *context,
   info = state_peek_info (data, CommonInfo);
   g_assert (info != NULL);
 
-  if (strcmp (g_markup_parse_context_get_element (context), "property") == 0)
+  /* <property> has no child elements, so if it is on top of the
+   * stack, it is the current element. Precompiled data is replayed
+   * without a context that knows the current element.
+   */
+  if (strcmp (info->tag.name, "property") == 0)
     {
       PropertyInfo *prop_info = (PropertyInfo*)info;
 
@@ -1258,7 +1383,13 @@ _gtk_builder_parser_parse_buffer (GtkBuilder   *builder,
                                           G_MARKUP_TREAT_CDATA_AS_TEXT,
                                           data, NULL);
 
-  if (!g_markup_parse_context_parse (data->ctx, buffer, length, error))
+  if (_gtk_builder_is_precompiled (buffer, length))
+    {
+      if (!_gtk_builder_replay_precompiled (&parser, buffer, length,
+                                            data, &data->ctx, error))
+        goto out;
+    }
+  else if (!g_markup_parse_context_parse (data->ctx, buffer, length, error))
     goto out;
 
   _gtk_builder_finish (builder);
@@ -1297,6 +1428,11 @@ _gtk_builder_parser_parse_buffer (GtkBuilder   *builder,
   g_slist_free_full (data->custom_finalizers, (GDestroyNotify)free_subparser);
   g_slist_free (data->finalizers);
   g_slist_free_full (data->requested_objects, g_free);
+  if (data->deferred)
+    {
+      g_string_free (data->deferred, TRUE);
+      g_ptr_array_unref (data->deferred_ids);
+    }
   g_free (data->domain);
   g_hash_table_destroy (data->object_ids);
   g_markup_parse_context_free (data->ctx);
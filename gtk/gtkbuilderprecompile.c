@@ -0,0 +1,636 @@
+/* gtkbuilderprecompile.c
+ * Copyright (C) 2016 Red Hat, Inc.
+ *
+ * This library is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Library General Public
+ * License as published by the Free Software Foundation; either
+ * version 2 of the License, or (at your option) any later version.
+ *
+ * This library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Library General Public License for more details.
+ *
+ * You should have received a copy of the GNU Library General Public
+ * License along with this library. If not, see <http://www.gnu.org/licenses/>.
+ */
+
+/* This file is compiled into both libgtk and gtk-builder-tool,
+ * so it must only depend on GLib.
+ */
+
+#include "config.h"
+
+#include <string.h>
+
+#include "gtkbuilderprivate.h"
+
+/* Precompiled GtkBuilder data
+ *
+ * The precompiled format is a pre-tokenized version of the .ui XML.
+ * All strings (element names, attribute names and values, property
+ * text) are stored once, nul-terminated, in a string table and are
+ * used in place when the data is loaded, so loading does neither
+ * tokenize XML nor unescape or copy strings.
+ *
+ * The elements that the builder parser handles itself (<interface>,
+ * <object>, <child>, <property>, ...) are stored as records. Custom
+ * tags (<packing>, <style>, <items>, <menu>, ...) are handled by
+ * subparsers that expect a real GMarkupParseContext, so they are
+ * stored as (minimized) XML fragments and parsed as such on load.
+ *
+ * All integers are 32 bit little endian.
+ *
+ *   header:   "\0GBP" version n_strings
+ *   strings:  n_strings × (length, bytes, '\0')
+ *   records:  a sequence of
+ *             RECORD_START_ELEMENT name n_attributes n_attributes × (name, value)
+ *             RECORD_END_ELEMENT
+ *             RECORD_TEXT text
+ *             RECORD_FRAGMENT parent_name xml
+ *
+ * Strings are referred to by their index in the string table. Since
+ * XML can not start with a nul byte, precompiled data can be told
+ * apart from XML by its first byte.
+ */
+
+#define PRECOMPILED_MAGIC "\0GBP"
+#define PRECOMPILED_MAGIC_LEN 4
+#define PRECOMPILED_VERSION 1
+
+enum {
+  RECORD_START_ELEMENT = 1,
+  RECORD_END_ELEMENT,
+  RECORD_TEXT,
+  RECORD_FRAGMENT
+};
+
+static const gchar *builtin_elements[] = {
+  "interface",
+  "requires",
+  "object",
+  "template",
+  "child",
+  "property",
+  "signal",
+  "placeholder"
+};
+
+static gboolean
+is_builtin_element (const gchar *element_name)
+{
+  gint i;
+
+  for (i = 0; i < G_N_ELEMENTS (builtin_elements); i++)
+    if (strcmp (element_name, builtin_elements[i]) == 0)
+      return TRUE;
+
+  return FALSE;
+}
+
+/* Writing */
+
+typedef struct {
+  GHashTable *string_ids;
+  GPtrArray *strings;
+  GString *records;
+
+  GString *fragment;
+  const gchar *fragment_parent;
+  gint fragment_depth;
+} PrecompileData;
+
+static void
+append_uint32 (GString *string,
+               guint32  value)
+{
+  value = GUINT32_TO_LE (value);
+  g_string_append_len (string, (const gchar *) &value, sizeof (value));
+}
+
+static guint32
+intern_string (PrecompileData *data,
+               const gchar    *string,
+               gsize           length)
+{
+  gchar *key;
+  gpointer id;
+
+  key = g_strndup (string, length);
+
+  if (g_hash_table_lookup_extended (data->string_ids, key, NULL, &id))
+    {
+      g_free (key);
+      return GPOINTER_TO_UINT (id);
+    }
+
+  id = GUINT_TO_POINTER (data->strings->len);
+  g_ptr_array_add (data->strings, key);
+  g_hash_table_insert (data->string_ids, key, id);
+
+  return GPOINTER_TO_UINT (id);
+}
+
+static void
+append_fragment_start (GString      *fragment,
+                       const gchar  *element_name,
+                       const gchar **names,
+                       const gchar **values)
+{
+  gint i;
+
+  g_string_append_c (fragment, '<');
+  g_string_append (fragment, element_name);
+  for (i = 0; names[i]; i++)
+    {
+      gchar *escaped;
+
+      escaped = g_markup_escape_text (values[i], -1);
+      g_string_append_printf (fragment, " %s=\"%s\"", names[i], escaped);
+      g_free (escaped);
+    }
+  g_string_append_c (fragment, '>');
+}
+
+static void
+precompile_start_element (GMarkupParseContext  *context,
+                          const gchar          *element_name,
+                          const gchar         **names,
+                          const gchar         **values,
+                          gpointer              user_data,
+                          GError              **error)
+{
+  PrecompileData *data = user_data;
+  gint i;
+
+  if (data->fragment_depth == 0 && !is_builtin_element (element_name))
+    {
+      const GSList *stack;
+
+      stack = g_markup_parse_context_get_element_stack (context);
+      data->fragment_parent = stack->next ? stack->next->data : "";
+    }
+
+  if (data->fragment_parent != NULL)
+    {
+      data->fragment_depth++;
+      append_fragment_start (data->fragment, element_name, names, values);
+      return;
+    }
+
+  g_string_append_c (data->records, RECORD_START_ELEMENT);
+  append_uint32 (data->records, intern_string (data, element_name, strlen (element_name)));
+  append_uint32 (data->records, g_strv_length ((gchar **) names));
+  for (i = 0; names[i]; i++)
+    {
+      append_uint32 (data->records, intern_string (data, names[i], strlen (names[i])));
+      append_uint32 (data->records, intern_string (data, values[i], strlen (values[i])));
+    }
+}
+
+static void
+precompile_end_element (GMarkupParseContext  *context,
+                        const gchar          *element_name,
+                        gpointer              user_data,
+                        GError              **error)
+{
+  PrecompileData *data = user_data;
+
+  if (data->fragment_parent != NULL)
+    {
+      g_string_append_printf (data->fragment, "</%s>", element_name);
+
+      if (--data->fragment_depth == 0)
+        {
+          g_string_append_c (data->records, RECORD_FRAGMENT);
+          append_uint32 (data->records,
+                         intern_string (data, data->fragment_parent, strlen (data->fragment_parent)));
+          append_uint32 (data->records,
+                         intern_string (data, data->fragment->str, data->fragment->len));
+          g_string_truncate (data->fragment, 0);
+          data->fragment_parent = NULL;
+        }
+      return;
+    }
+
+  g_string_append_c (data->records, RECORD_END_ELEMENT);
+}
+
+static void
+precompile_text (GMarkupParseContext  *context,
+                 const gchar          *text,
+                 gsize                 text_len,
+                 gpointer              user_data,
+                 GError              **error)
+{
+  PrecompileData *data = user_data;
+  const gchar *element_name;
+
+  if (data->fragment_parent != NULL)
+    {
+      gchar *escaped;
+
+      escaped = g_markup_escape_text (text, text_len);
+      g_string_append (data->fragment, escaped);
+      g_free (escaped);
+      return;
+    }
+
+  /* The builder ignores text outside of <property> */
+  element_name = g_markup_parse_context_get_element (context);
+  if (element_name == NULL || strcmp (element_name, "property") != 0)
+    return;
+
+  g_string_append_c (data->records, RECORD_TEXT);
+  append_uint32 (data->records, intern_string (data, text, text_len));
+}
+
+static const GMarkupParser precompile_parser = {
+  precompile_start_element,
+  precompile_end_element,
+  precompile_text,
+  NULL,
+  NULL
+};
+
+/*< private >
+ * _gtk_builder_precompile:
+ * @buffer: the .ui XML to precompile
+ * @length: the length of @buffer
+ * @error: return location for an error
+ *
+ * Converts a GtkBuilder UI definition into the precompiled format
+ * that _gtk_builder_parser_parse_buffer() can load without parsing
+ * XML.
+ *
+ * Returns: the precompiled data, or %NULL if @buffer could not be parsed
+ */
+GBytes *
+_gtk_builder_precompile (const gchar  *buffer,
+                         gsize         length,
+                         GError      **error)
+{
+  GMarkupParseContext *context;
+  PrecompileData data = { 0, };
+  GString *result = NULL;
+  guint i;
+
+  data.string_ids = g_hash_table_new (g_str_hash, g_str_equal);
+  data.strings = g_ptr_array_new_with_free_func (g_free);
+  data.records = g_string_new (NULL);
+  data.fragment = g_string_new (NULL);
+
+  context = g_markup_parse_context_new (&precompile_parser,
+                                        G_MARKUP_TREAT_CDATA_AS_TEXT,
+                                        &data, NULL);
+
+  if (!g_markup_parse_context_parse (context, buffer, length, error) ||
+      !g_markup_parse_context_end_parse (context, error))
+    goto out;
+
+  result = g_string_sized_new (data.records->len + 1024);
+  g_string_append_len (result, PRECOMPILED_MAGIC, PRECOMPILED_MAGIC_LEN);
+  append_uint32 (result, PRECOMPILED_VERSION);
+  append_uint32 (result, data.strings->len);
+  for (i = 0; i < data.strings->len; i++)
+    {
+      const gchar *string = g_ptr_array_index (data.strings, i);
+      gsize string_len = strlen (string);
+
+      append_uint32 (result, string_len);
+      g_string_append_len (result, string, string_len + 1);
+    }
+  g_string_append_len (result, data.records->str, data.records->len);
+
+ out:
+  g_markup_parse_context_free (context);
+  g_hash_table_destroy (data.string_ids);
+  g_ptr_array_unref (data.strings);
+  g_string_free (data.records, TRUE);
+  g_string_free (data.fragment, TRUE);
+
+  if (result == NULL)
+    return NULL;
+
+  return g_string_free_to_bytes (result);
+}
+
+/* Reading */
+
+typedef struct {
+  const guchar *data;
+  gsize length;
+  gsize pos;
+  const gchar **strings;
+  guint32 n_strings;
+} PrecompiledReader;
+
+static gboolean
+read_uint32 (PrecompiledReader *reader,
+             guint32           *value)
+{
+  if (reader->length - reader->pos < sizeof (guint32))
+    return FALSE;
+
+  memcpy (value, reader->data + reader->pos, sizeof (guint32));
+  *value = GUINT32_FROM_LE (*value);
+  reader->pos += sizeof (guint32);
+
+  return TRUE;
+}
+
+static gboolean
+read_string (PrecompiledReader  *reader,
+             const gchar       **string)
+{
+  guint32 id;
+
+  if (!read_uint32 (reader, &id) || id >= reader->n_strings)
+    return FALSE;
+
+  *string = reader->strings[id];
+
+  return TRUE;
+}
+
+static gboolean
+read_string_table (PrecompiledReader *reader)
+{
+  guint32 version, i;
+
+  reader->pos = PRECOMPILED_MAGIC_LEN;
+
+  if (!read_uint32 (reader, &version) || version != PRECOMPILED_VERSION)
+    return FALSE;
+
+  if (!read_uint32 (reader, &reader->n_strings) ||
+      reader->n_strings > (reader->length - reader->pos) / (sizeof (guint32) + 1))
+    return FALSE;
+
+  reader->strings = g_new (const gchar *, reader->n_strings);
+  for (i = 0; i < reader->n_strings; i++)
+    {
+      guint32 string_len;
+
+      if (!read_uint32 (reader, &string_len) ||
+          reader->length - reader->pos <= string_len ||
+          reader->data[reader->pos + string_len] != '\0')
+        return FALSE;
+
+      reader->strings[i] = (const gchar *) reader->data + reader->pos;
+      reader->pos += string_len + 1;
+    }
+
+  return TRUE;
+}
+
+typedef struct {
+  const GMarkupParser *parser;
+  gpointer user_data;
+  gint depth;
+} FragmentData;
+
+/* Fragments are wrapped in their parent element, so that subparsers
+ * checking their parent with _gtk_builder_check_parent() see the
+ * same element stack as when parsing the original XML. The wrapper
+ * itself is not passed on.
+ */
+static void
+fragment_start_element (GMarkupParseContext  *context,
+                        const gchar          *element_name,
+                        const gchar         **names,
+                        const gchar         **values,
+                        gpointer              user_data,
+                        GError              **error)
+{
+  FragmentData *fragment = user_data;
+
+  if (fragment->depth++ > 0)
+    fragment->parser->start_element (context, element_name, names, values,
+                                     fragment->user_data, error);
+}
+
+static void
+fragment_end_element (GMarkupParseContext  *context,
+                      const gchar          *element_name,
+                      gpointer              user_data,
+                      GError              **error)
+{
+  FragmentData *fragment = user_data;
+
+  if (--fragment->depth > 0)
+    fragment->parser->end_element (context, element_name,
+                                   fragment->user_data, error);
+}
+
+static void
+fragment_text (GMarkupParseContext  *context,
+               const gchar          *text,
+               gsize                 text_len,
+               gpointer              user_data,
+               GError              **error)
+{
+  FragmentData *fragment = user_data;
+
+  if (fragment->depth > 1)
+    fragment->parser->text (context, text, text_len,
+                            fragment->user_data, error);
+}
+
+static const GMarkupParser fragment_parser = {
+  fragment_start_element,
+  fragment_end_element,
+  fragment_text,
+  NULL,
+  NULL
+};
+
+static gboolean
+replay_fragment (const GMarkupParser  *parser,
+                 const gchar          *parent_name,
+                 const gchar          *xml,
+                 gpointer              user_data,
+                 GMarkupParseContext **context,
+                 GError              **error)
+{
+  GMarkupParseContext *outer_context;
+  FragmentData fragment = { parser, user_data, 0 };
+  gchar *wrapped;
+  gboolean ret;
+
+  /* The fragment can not be empty, so the wrapper always has a name */
+  if (*parent_name == '\0')
+    parent_name = "interface";
+
+  wrapped = g_strdup_printf ("<%s>%s</%s>", parent_name, xml, parent_name);
+
+  outer_context = *context;
+  *context = g_markup_parse_context_new (&fragment_parser,
+                                         G_MARKUP_TREAT_CDATA_AS_TEXT,
+                                         &fragment, NULL);
+
+  ret = g_markup_parse_context_parse (*context, wrapped, -1, error) &&
+        g_markup_parse_context_end_parse (*context, error);
+
+  g_markup_parse_context_free (*context);
+  *context = outer_context;
+  g_free (wrapped);
+
+  return ret;
+}
+
+gboolean
+_gtk_builder_is_precompiled (const gchar *buffer,
+                             gsize        length)
+{
+  /* A length of -1 means nul-terminated XML */
+  return length != (gsize) -1 &&
+         length >= PRECOMPILED_MAGIC_LEN &&
+         memcmp (buffer, PRECOMPILED_MAGIC, PRECOMPILED_MAGIC_LEN) == 0;
+}
+
+/*< private >
+ * _gtk_builder_replay_precompiled:
+ * @parser: the parser to pass the elements to
+ * @buffer: precompiled data, as returned by _gtk_builder_precompile()
+ * @length: the length of @buffer
+ * @user_data: user data for @parser
+ * @context: (inout): the context to pass to @parser. It is replaced by
+ *     the context parsing a fragment while the fragment is parsed
+ * @error: return location for an error
+ *
+ * Passes the contents of precompiled data to @parser, as if the
+ * original XML had been parsed.
+ *
+ * Returns: %TRUE if the data was replayed successfully
+ */
+gboolean
+_gtk_builder_replay_precompiled (const GMarkupParser  *parser,
+                                 const gchar          *buffer,
+                                 gsize                 length,
+                                 gpointer              user_data,
+                                 GMarkupParseContext **context,
+                                 GError              **error)
+{
+  PrecompiledReader reader = { (const guchar *) buffer, length, 0, NULL, 0 };
+  GPtrArray *element_stack;
+  GPtrArray *names, *values;
+  GError *tmp_error = NULL;
+  gboolean valid;
+
+  element_stack = g_ptr_array_new ();
+  names = g_ptr_array_new ();
+  values = g_ptr_array_new ();
+
+  valid = read_string_table (&reader);
+
+  while (valid && tmp_error == NULL && reader.pos < reader.length)
+    {
+      const gchar *name, *value;
+      guint32 n_attributes, i;
+
+      switch (reader.data[reader.pos++])
+        {
+        case RECORD_START_ELEMENT:
+          if (!read_string (&reader, &name) ||
+              !read_uint32 (&reader, &n_attributes))
+            {
+              valid = FALSE;
+              break;
+            }
+
+          g_ptr_array_set_size (names, 0);
+          g_ptr_array_set_size (values, 0);
+          for (i = 0; i < n_attributes; i++)
+            {
+              const gchar *attribute_name;
+
+              if (!read_string (&reader, &attribute_name) ||
+                  !read_string (&reader, &value))
+                {
+                  valid = FALSE;
+                  break;
+                }
+
+              g_ptr_array_add (names, (gpointer) attribute_name);
+              g_ptr_array_add (values, (gpointer) value);
+            }
+
+          if (!valid)
+            break;
+
+          g_ptr_array_add (names, NULL);
+          g_ptr_array_add (values, NULL);
+          g_ptr_array_add (element_stack, (gpointer) name);
+
+          parser->start_element (*context, name,
+                                 (const gchar **) names->pdata,
+                                 (const gchar **) values->pdata,
+                                 user_data, &tmp_error);
+          break;
+
+        case RECORD_END_ELEMENT:
+          if (element_stack->len == 0)
+            {
+              valid = FALSE;
+              break;
+            }
+
+          name = g_ptr_array_index (element_stack, element_stack->len - 1);
+          g_ptr_array_set_size (element_stack, element_stack->len - 1);
+
+          parser->end_element (*context, name, user_data, &tmp_error);
+          break;
+
+        case RECORD_TEXT:
+          if (!read_string (&reader, &value))
+            {
+              valid = FALSE;
+              break;
+            }
+
+          parser->text (*context, value, strlen (value), user_data, &tmp_error);
+          break;
+
+        case RECORD_FRAGMENT:
+          if (!read_string (&reader, &name) ||
+              !read_string (&reader, &value))
+            {
+              valid = FALSE;
+              break;
+            }
+
+          replay_fragment (parser, name, value, user_data, context, &tmp_error);
+          break;
+
+        default:
+          valid = FALSE;
+          break;
+        }
+    }
+
+  if (valid && tmp_error == NULL && element_stack->len != 0)
+    valid = FALSE;
+
+  g_ptr_array_unref (element_stack);
+  g_ptr_array_unref (names);
+  g_ptr_array_unref (values);
+  g_free (reader.strings);
+
+  if (tmp_error)
+    {
+      g_propagate_error (error, tmp_error);
+      return FALSE;
+    }
+
+  if (!valid)
+    {
+      g_set_error_literal (error,
+                           G_MARKUP_ERROR,
+                           G_MARKUP_ERROR_INVALID_CONTENT,
+                           "Invalid precompiled data");
+      return FALSE;
+    }
+
+  return TRUE;
+}
@@ -126,6 +126,11 @@ typedef struct {
   gint object_counter;
 
   GHashTable *object_ids;
+
+  /* The XML of a deferred toplevel object while it is being collected */
+  GString *deferred;
+  GPtrArray *deferred_ids;
+  gint deferred_level;
 } ParserData;
 
 typedef GType (*GTypeGetFunc) (void);
@@ -137,6 +142,17 @@ void _gtk_builder_parser_parse_buffer (GtkBuilder *builder,
                                        gsize length,
                                        gchar **requested_objs,
                                        GError **error);
+gboolean  _gtk_builder_is_precompiled (const gchar *buffer,
+                                       gsize        length);
+gboolean  _gtk_builder_replay_precompiled (const GMarkupParser  *parser,
+                                           const gchar          *buffer,
+                                           gsize                 length,
+                                           gpointer              user_data,
+                                           GMarkupParseContext **context,
+                                           GError              **error);
+GBytes *  _gtk_builder_precompile (const gchar *buffer,
+                                   gsize        length,
+                                   GError     **error);
 GObject * _gtk_builder_construct (GtkBuilder *builder,
                                   ObjectInfo *info,
 				  GError    **error);
@@ -151,6 +167,9 @@ void      _gtk_builder_add (GtkBuilder *builder,
 void      _gtk_builder_add_signals (GtkBuilder *builder,
 				    GSList     *signals);
 void      _gtk_builder_finish (GtkBuilder *builder);
+void      _gtk_builder_add_deferred (GtkBuilder  *builder,
+                                     GPtrArray   *ids,
+                                     const gchar *buffer);
 void _free_signal_info (SignalInfo *info,
                         gpointer user_data);
 
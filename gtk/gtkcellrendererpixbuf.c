@@ -82,7 +82,8 @@ enum {
   PROP_STOCK_DETAIL,
   PROP_FOLLOW_STATE,
   PROP_ICON_NAME,
-  PROP_GICON
+  PROP_GICON,
+  PROP_LOAD_ASYNC
 };
 
 
@@ -95,6 +96,7 @@ struct _GtkCellRendererPixbufPrivate
   GdkPixbuf *pixbuf_expander_closed;
 
   gboolean follow_state;
+  gboolean load_async;
 
   gchar *stock_detail;
 };
@@ -267,6 +269,25 @@ gtk_cell_renderer_pixbuf_class_init (GtkCellRendererPixbufClass *class)
                                                         G_TYPE_ICON,
                                                         GTK_PARAM_READWRITE));
 
+  /**
+   * GtkCellRendererPixbuf:load-async:
+   *
+   * Whether icons from the icon theme that have not been loaded yet
+   * should be loaded in a separate thread. Until an icon is available,
+   * nothing is drawn and the widget is redrawn once it has been loaded.
+   *
+   * This avoids blocking while scrolling through views showing
+   * many different icons. Symbolic icons are always loaded immediately.
+   *
+   * Since: 3.22
+   */
+  g_object_class_install_property (object_class,
+                                   PROP_LOAD_ASYNC,
+                                   g_param_spec_boolean ("load-async",
+                                                         P_("Load asynchronously"),
+                                                         P_("Whether to load icons in a thread"),
+                                                         FALSE,
+                                                         GTK_PARAM_READWRITE|G_PARAM_EXPLICIT_NOTIFY));
 
 
   gtk_cell_renderer_class_set_accessible_type (cell_class, GTK_TYPE_IMAGE_CELL_ACCESSIBLE);
@@ -307,6 +328,9 @@ gtk_cell_renderer_pixbuf_get_property (GObject        *object,
     case PROP_FOLLOW_STATE:
       g_value_set_boolean (value, priv->follow_state);
       break;
+    case PROP_LOAD_ASYNC:
+      g_value_set_boolean (value, priv->load_async);
+      break;
     case PROP_ICON_NAME:
       g_value_set_string (value, gtk_image_definition_get_icon_name (priv->image_def));
       break;
@@ -412,6 +436,13 @@ gtk_cell_renderer_pixbuf_set_property (GObject      *object,
     case PROP_FOLLOW_STATE:
       priv->follow_state = g_value_get_boolean (value);
       break;
+    case PROP_LOAD_ASYNC:
+      if (priv->load_async != g_value_get_boolean (value))
+        {
+          priv->load_async = g_value_get_boolean (value);
+          g_object_notify_by_pspec (object, pspec);
+        }
+      break;
     case PROP_GICON:
       take_image_definition (cellpixbuf, gtk_image_definition_new_gicon (g_value_get_object (value)));
       break;
@@ -449,6 +480,7 @@ create_icon_helper (GtkCellRendererPixbuf *cellpixbuf,
 
   helper = gtk_icon_helper_new (gtk_style_context_get_node (gtk_widget_get_style_context (widget)), widget);
   _gtk_icon_helper_set_force_scale_pixbuf (helper, TRUE);
+  _gtk_icon_helper_set_load_async (helper, priv->load_async);
   _gtk_icon_helper_set_definition (helper, priv->image_def);
   if (gtk_image_definition_get_storage_type (priv->image_def) != GTK_IMAGE_PIXBUF)
     _gtk_icon_helper_set_icon_size (helper, priv->icon_size);
@@ -117,6 +117,7 @@ static GtkClipboard *clipboard_peek       (GdkDisplay       *display,
       clipboard->get_func (clipboard, &selection_data,
                            info,
                            clipboard->user_data);
+      _gtk_selection_data_flush_stream (&selection_data);
 
       if (selection_data.length >= 0)
         _gtk_quartz_set_selection_data_for_pasteboard (clipboard->pasteboard,
@@ -768,6 +769,74 @@ gtk_clipboard_request_targets (GtkClipboard                *clipboard,
   callback (clipboard, targets, n_targets, user_data);
 }
 
+/**
+ * gtk_clipboard_read_stream_async:
+ * @clipboard:
+ * @target:
+ * @cancellable: (allow-none):
+ * @callback: (scope async):
+ * @user_data:
+ */
+void
+gtk_clipboard_read_stream_async (GtkClipboard        *clipboard,
+                                 GdkAtom              target,
+                                 GCancellable        *cancellable,
+                                 GAsyncReadyCallback  callback,
+                                 gpointer             user_data)
+{
+  GtkSelectionData *data;
+  GInputStream *stream;
+  GBytes *bytes;
+  GTask *task;
+
+  task = g_task_new (clipboard, cancellable, callback, user_data);
+  g_task_set_source_tag (task, gtk_clipboard_read_stream_async);
+
+  /* The pasteboard has the complete data anyway */
+  data = gtk_clipboard_wait_for_contents (clipboard, target);
+  if (data == NULL || data->length < 0)
+    {
+      g_task_return_new_error (task, G_IO_ERROR, G_IO_ERROR_FAILED,
+                               _("Could not read the clipboard contents"));
+    }
+  else
+    {
+      bytes = g_bytes_new (data->data, data->length);
+      stream = g_memory_input_stream_new_from_bytes (bytes);
+      g_bytes_unref (bytes);
+
+      g_task_set_task_data (task, data->type, NULL);
+      g_task_return_pointer (task, stream, g_object_unref);
+    }
+
+  if (data)
+    gtk_selection_data_free (data);
+  g_object_unref (task);
+}
+
+/**
+ * gtk_clipboard_read_stream_finish:
+ * @clipboard:
+ * @result:
+ * @out_type: (out) (allow-none):
+ * @error:
+ *
+ * Returns: (transfer full) (nullable):
+ */
+GInputStream *
+gtk_clipboard_read_stream_finish (GtkClipboard  *clipboard,
+                                  GAsyncResult  *result,
+                                  GdkAtom       *out_type,
+                                  GError       **error)
+{
+  g_return_val_if_fail (g_task_is_valid (result, clipboard), NULL);
+
+  if (out_type)
+    *out_type = g_task_get_task_data (G_TASK (result));
+
+  return g_task_propagate_pointer (G_TASK (result), error);
+}
+
 /**
  * gtk_clipboard_wait_for_contents:
  * @clipboard:
@@ -1206,6 +1275,7 @@ gtk_clipboard_store (GtkClipboard *clipboard)
 
       clipboard->get_func (clipboard, &selection_data,
                            targets[i].info, clipboard->user_data);
+      _gtk_selection_data_flush_stream (&selection_data);
 
       if (selection_data.length >= 0)
         _gtk_quartz_set_selection_data_for_pasteboard (clipboard->pasteboard,
@@ -26,6 +26,7 @@
 #include "gtkinvisible.h"
 #include "gtkmain.h"
 #include "gtkmarshalers.h"
+#include "gtkselectionprivate.h"
 #include "gtktextbufferrichtext.h"
 #include "gtkintl.h"
 
@@ -1371,6 +1372,150 @@ gtk_clipboard_request_targets (GtkClipboard                *clipboard,
 				  info);
 }
 
+typedef struct
+{
+  GtkWidget *widget;
+  GTask *task;
+  GSource *cancel_source;
+} ReadStreamInfo;
+
+static void
+read_stream_received (GtkWidget    *widget,
+                      GdkAtom       type,
+                      gint          format,
+                      GInputStream *stream,
+                      gpointer      data)
+{
+  ReadStreamInfo *info = data;
+
+  if (stream == NULL)
+    {
+      g_task_return_new_error (info->task, G_IO_ERROR, G_IO_ERROR_FAILED,
+                               _("Could not read the clipboard contents"));
+      return;
+    }
+
+  g_task_set_task_data (info->task, type, NULL);
+  g_task_return_pointer (info->task, g_object_ref (stream), g_object_unref);
+}
+
+static gboolean
+read_stream_cancelled (GCancellable *cancellable,
+                       gpointer      data)
+{
+  ReadStreamInfo *info = data;
+
+  /* This ends up in read_stream_done() */
+  _gtk_selection_cancel_stream (info->widget);
+
+  return G_SOURCE_REMOVE;
+}
+
+static void
+read_stream_done (gpointer data)
+{
+  ReadStreamInfo *info = data;
+
+  if (info->cancel_source)
+    {
+      g_source_destroy (info->cancel_source);
+      g_source_unref (info->cancel_source);
+    }
+
+  gtk_widget_destroy (info->widget);
+  g_object_unref (info->task);
+  g_slice_free (ReadStreamInfo, info);
+}
+
+/**
+ * gtk_clipboard_read_stream_async:
+ * @clipboard: a #GtkClipboard
+ * @target: an atom representing the form into which the clipboard
+ *     owner should convert the selection.
+ * @cancellable: (allow-none): a #GCancellable, or %NULL
+ * @callback: (scope async): a function to call when the stream is ready
+ * @user_data: user data to pass to @callback
+ *
+ * Requests the contents of the clipboard as the given target, like
+ * gtk_clipboard_request_contents(), but provides them as a #GInputStream
+ * instead of a buffer. The stream is handed out as soon as the first data
+ * arrives, and large contents that the owner sends incrementally (e.g.
+ * with the INCR protocol on X11) are passed on piece by piece, without
+ * ever being held in memory as a whole.
+ *
+ * The stream is fed from the main loop, so it should be read
+ * asynchronously in the main thread.
+ *
+ * Since: 3.22
+ **/
+void
+gtk_clipboard_read_stream_async (GtkClipboard        *clipboard,
+                                 GdkAtom              target,
+                                 GCancellable        *cancellable,
+                                 GAsyncReadyCallback  callback,
+                                 gpointer             user_data)
+{
+  ReadStreamInfo *info;
+
+  g_return_if_fail (clipboard != NULL);
+  g_return_if_fail (target != GDK_NONE);
+
+  info = g_slice_new0 (ReadStreamInfo);
+  info->task = g_task_new (clipboard, cancellable, callback, user_data);
+  g_task_set_source_tag (info->task, gtk_clipboard_read_stream_async);
+
+  /* The requestor stays busy until all data has arrived, long after
+   * @callback ran, so every transfer gets its own.
+   */
+  info->widget = make_clipboard_widget (clipboard->display, FALSE);
+
+  /* Cancelling stops the transfer, also after the stream was handed
+   * out; it is watched from the main loop, which feeds the stream
+   */
+  if (cancellable)
+    {
+      info->cancel_source = g_cancellable_source_new (cancellable);
+      g_source_set_callback (info->cancel_source,
+                             (GSourceFunc) read_stream_cancelled, info, NULL);
+      g_source_attach (info->cancel_source, NULL);
+    }
+
+  _gtk_selection_convert_stream (info->widget, clipboard->selection, target,
+                                 clipboard_get_timestamp (clipboard),
+                                 read_stream_received, info,
+                                 read_stream_done);
+}
+
+/**
+ * gtk_clipboard_read_stream_finish:
+ * @clipboard: a #GtkClipboard
+ * @result: a #GAsyncResult
+ * @out_type: (out) (allow-none): return location for the type of the
+ *     data, or %NULL
+ * @error: return location for a #GError, or %NULL
+ *
+ * Finishes an operation started with gtk_clipboard_read_stream_async().
+ *
+ * Returns: (transfer full) (nullable): a #GInputStream delivering the
+ *     clipboard contents, or %NULL if they could not be retrieved.
+ *
+ * Since: 3.22
+ **/
+GInputStream *
+gtk_clipboard_read_stream_finish (GtkClipboard  *clipboard,
+                                  GAsyncResult  *result,
+                                  GdkAtom       *out_type,
+                                  GError       **error)
+{
+  g_return_val_if_fail (g_task_is_valid (result, clipboard), NULL);
+  g_return_val_if_fail (g_task_get_source_tag (G_TASK (result)) == gtk_clipboard_read_stream_async, NULL);
+
+  if (out_type)
+    *out_type = g_task_get_task_data (G_TASK (result));
+
+  return g_task_propagate_pointer (G_TASK (result), error);
+}
+
 typedef struct
 {
   GMainLoop *loop;
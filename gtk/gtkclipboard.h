@@ -248,6 +248,17 @@ GDK_AVAILABLE_IN_ALL
 void gtk_clipboard_request_targets   (GtkClipboard                     *clipboard,
                                       GtkClipboardTargetsReceivedFunc   callback,
                                       gpointer                          user_data);
+GDK_AVAILABLE_IN_3_22
+void gtk_clipboard_read_stream_async (GtkClipboard                     *clipboard,
+                                      GdkAtom                           target,
+                                      GCancellable                     *cancellable,
+                                      GAsyncReadyCallback               callback,
+                                      gpointer                          user_data);
+GDK_AVAILABLE_IN_3_22
+GInputStream *gtk_clipboard_read_stream_finish (GtkClipboard       *clipboard,
+                                                GAsyncResult       *result,
+                                                GdkAtom            *out_type,
+                                                GError            **error);
 
 GDK_AVAILABLE_IN_ALL
 GtkSelectionData *gtk_clipboard_wait_for_contents  (GtkClipboard  *clipboard,
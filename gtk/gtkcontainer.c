@@ -289,6 +289,10 @@ struct _GtkContainerPrivate
   guint resize_mode        : 2;
   guint resize_mode_set    : 1;
   guint request_mode       : 2;
+  guint draw_index_valid   : 1;
+
+  GArray *draw_index;
+  gint draw_index_max_height;
 };
 
 enum {
@@ -318,6 +322,7 @@ static void     gtk_container_base_class_init      (GtkContainerClass *klass);
 static void     gtk_container_base_class_finalize  (GtkContainerClass *klass);
 static void     gtk_container_class_init           (GtkContainerClass *klass);
 static void     gtk_container_init                 (GtkContainer      *container);
+static void     gtk_container_finalize             (GObject           *object);
 static void     gtk_container_destroy              (GtkWidget         *widget);
 static void     gtk_container_set_property         (GObject         *object,
                                                     guint            prop_id,
@@ -502,6 +507,7 @@ gtk_container_class_init (GtkContainerClass *class)
 
   gobject_class->set_property = gtk_container_set_property;
   gobject_class->get_property = gtk_container_get_property;
+  gobject_class->finalize = gtk_container_finalize;
 
   widget_class->destroy = gtk_container_destroy;
   widget_class->compute_expand = gtk_container_compute_expand;
@@ -1680,6 +1686,16 @@ gtk_container_init (GtkContainer *container)
   priv->border_width_set = FALSE;
 }
 
+static void
+gtk_container_finalize (GObject *object)
+{
+  GtkContainer *container = GTK_CONTAINER (object);
+
+  g_clear_pointer (&container->priv->draw_index, g_array_unref);
+
+  G_OBJECT_CLASS (parent_class)->finalize (object);
+}
+
 static void
 gtk_container_destroy (GtkWidget *widget)
 {
@@ -3588,17 +3604,21 @@ gtk_container_show_all (GtkWidget *widget)
 typedef struct {
   GtkWidget *child;
   int window_depth;
+  guint order;
 } ChildOrderInfo;
 
+typedef struct {
+  GtkContainer *container;
+  GArray *child_infos;
+  cairo_t *cr;
+  guint order;
+} ContainerDrawData;
+
 static void
-gtk_container_draw_forall (GtkWidget *widget,
-                           gpointer   client_data)
+gtk_container_draw_add_child (ContainerDrawData *data,
+                              GtkWidget         *widget,
+                              guint              order)
 {
-  struct {
-    GtkContainer *container;
-    GArray *child_infos;
-    cairo_t *cr;
-  } *data = client_data;
   ChildOrderInfo info;
   GList *siblings;
   GdkWindow *window;
@@ -3607,6 +3627,7 @@ gtk_container_draw_forall (GtkWidget *widget,
     {
       info.child = widget;
       info.window_depth = G_MAXINT;
+      info.order = order;
       window = _gtk_widget_get_window (widget);
       if (window != gtk_widget_get_window (GTK_WIDGET (data->container)))
         {
@@ -3617,6 +3638,15 @@ gtk_container_draw_forall (GtkWidget *widget,
     }
 }
 
+static void
+gtk_container_draw_forall (GtkWidget *widget,
+                           gpointer   client_data)
+{
+  ContainerDrawData *data = client_data;
+
+  gtk_container_draw_add_child (data, widget, data->order++);
+}
+
 static gint
 compare_children_for_draw (gconstpointer  _a,
                            gconstpointer  _b)
@@ -3624,7 +3654,160 @@ compare_children_for_draw (gconstpointer  _a,
   const ChildOrderInfo *a = _a;
   const ChildOrderInfo *b = _b;
 
-  return b->window_depth - a->window_depth;
+  if (a->window_depth != b->window_depth)
+    return b->window_depth - a->window_depth;
+
+  return a->order < b->order ? -1 : a->order > b->order;
+}
+
+/* Containers with many children keep their drawable children sorted
+ * by the top of their clip, so that a draw only looks at the children
+ * whose clip intersects the area being drawn, instead of at all of
+ * them. The index is dropped when a child is added, removed, mapped,
+ * unmapped or gets a new clip, and when the container is allocated,
+ * which is what follows reordering its children.
+ */
+#define DRAW_INDEX_MIN_CHILDREN 64
+
+typedef struct {
+  GtkWidget *child;
+  GdkRectangle clip;
+  guint order;
+} DrawIndexChild;
+
+typedef struct {
+  GdkWindow *window;
+  GArray *children;
+  guint n_children;
+  gint max_height;
+  gboolean indexable;
+} DrawIndexData;
+
+static void
+gtk_container_draw_index_add (GtkWidget *child,
+                              gpointer   client_data)
+{
+  DrawIndexData *data = client_data;
+  DrawIndexChild entry;
+  GdkWindow *child_in_window;
+
+  entry.order = data->n_children++;
+
+  if (!data->indexable || !_gtk_widget_is_drawable (child))
+    return;
+
+  /* The clips of children in other windows aren't comparable */
+  if (_gtk_widget_get_has_window (child))
+    child_in_window = gdk_window_get_parent (_gtk_widget_get_window (child));
+  else
+    child_in_window = _gtk_widget_get_window (child);
+
+  if (child_in_window != data->window)
+    {
+      data->indexable = FALSE;
+      return;
+    }
+
+  entry.child = child;
+  gtk_widget_get_clip (child, &entry.clip);
+  data->max_height = MAX (data->max_height, entry.clip.height);
+
+  g_array_append_val (data->children, entry);
+}
+
+static gint
+compare_draw_index_children (gconstpointer  _a,
+                             gconstpointer  _b)
+{
+  const DrawIndexChild *a = _a;
+  const DrawIndexChild *b = _b;
+
+  return a->clip.y < b->clip.y ? -1 : a->clip.y > b->clip.y;
+}
+
+static void
+gtk_container_ensure_draw_index (GtkContainer *container)
+{
+  GtkContainerPrivate *priv = container->priv;
+  DrawIndexData data;
+
+  if (priv->draw_index_valid)
+    return;
+
+  priv->draw_index_valid = TRUE;
+
+  data.window = _gtk_widget_get_window (GTK_WIDGET (container));
+  data.children = g_array_new (FALSE, FALSE, sizeof (DrawIndexChild));
+  data.n_children = 0;
+  data.max_height = 0;
+  data.indexable = TRUE;
+
+  gtk_container_forall (container, gtk_container_draw_index_add, &data);
+
+  if (!data.indexable || data.n_children < DRAW_INDEX_MIN_CHILDREN)
+    {
+      g_array_unref (data.children);
+      return;
+    }
+
+  g_array_sort (data.children, compare_draw_index_children);
+
+  priv->draw_index = data.children;
+  priv->draw_index_max_height = data.max_height;
+}
+
+void
+_gtk_container_invalidate_draw_index (GtkContainer *container)
+{
+  GtkContainerPrivate *priv = container->priv;
+
+  priv->draw_index_valid = FALSE;
+  g_clear_pointer (&priv->draw_index, g_array_unref);
+}
+
+static void
+gtk_container_draw_index_lookup (ContainerDrawData *data)
+{
+  GtkContainer *container = data->container;
+  GtkContainerPrivate *priv = container->priv;
+  GtkAllocation allocation;
+  DrawIndexChild *entry;
+  GdkRectangle area;
+  guint lo, hi, mid, i;
+
+  if (!gdk_cairo_get_clip_rectangle (data->cr, &area))
+    return;
+
+  /* Child clips are relative to the window, not to the container */
+  if (!_gtk_widget_get_has_window (GTK_WIDGET (container)))
+    {
+      _gtk_widget_get_allocation (GTK_WIDGET (container), &allocation);
+      area.x += allocation.x;
+      area.y += allocation.y;
+    }
+
+  /* Find the first child that could reach down into the area */
+  lo = 0;
+  hi = priv->draw_index->len;
+  while (lo < hi)
+    {
+      mid = (lo + hi) / 2;
+      entry = &g_array_index (priv->draw_index, DrawIndexChild, mid);
+      if (entry->clip.y + priv->draw_index_max_height <= area.y)
+        lo = mid + 1;
+      else
+        hi = mid;
+    }
+
+  for (i = lo; i < priv->draw_index->len; i++)
+    {
+      entry = &g_array_index (priv->draw_index, DrawIndexChild, i);
+      if (entry->clip.y >= area.y + area.height)
+        break;
+
+      if (gdk_rectangle_intersect (&entry->clip, &area, NULL))
+        gtk_container_draw_add_child (data, entry->child, entry->order);
+    }
 }
 
 static gint
@@ -3635,20 +3818,23 @@ gtk_container_draw (GtkWidget *widget,
   GArray *child_infos;
   int i;
   ChildOrderInfo *child_info;
-  struct {
-    GtkContainer *container;
-    GArray *child_infos;
-    cairo_t *cr;
-  } data;
+  ContainerDrawData data;
 
   child_infos = g_array_new (FALSE, TRUE, sizeof (ChildOrderInfo));
 
   data.container = container;
   data.cr = cr;
   data.child_infos = child_infos;
-  gtk_container_forall (container,
-                        gtk_container_draw_forall,
-                        &data);
+  data.order = 0;
+
+  gtk_container_ensure_draw_index (container);
+
+  if (container->priv->draw_index)
+    gtk_container_draw_index_lookup (&data);
+  else
+    gtk_container_forall (container,
+                          gtk_container_draw_forall,
+                          &data);
 
   g_array_sort (child_infos, compare_children_for_draw);
 
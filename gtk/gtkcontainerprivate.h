@@ -46,6 +46,7 @@ void      gtk_container_get_children_clip       (GtkContainer  *container,
                                                  GtkAllocation *out_clip);
 void      gtk_container_set_default_resize_mode (GtkContainer *container,
                                                  GtkResizeMode resize_mode);
+void      _gtk_container_invalidate_draw_index  (GtkContainer *container);
 
 G_END_DECLS
 
@@ -410,6 +410,37 @@ _gtk_css_image_get_surface (GtkCssImage     *image,
   return result;
 }
 
+/* Computed images are shared by all widgets with the same style, so
+ * images that build a pattern from their size, like gradients, can
+ * usually keep using it from one frame to the next.
+ */
+cairo_pattern_t *
+_gtk_css_image_pattern_cache_get (GtkCssImagePatternCache *cache,
+                                  GtkCssImage             *image,
+                                  double                   width,
+                                  double                   height,
+                                  GtkCssImagePatternFunc   create_func)
+{
+  if (cache->pattern == NULL ||
+      cache->width != width ||
+      cache->height != height)
+    {
+      _gtk_css_image_pattern_cache_clear (cache);
+
+      cache->pattern = create_func (image, width, height);
+      cache->width = width;
+      cache->height = height;
+    }
+
+  return cache->pattern;
+}
+
+void
+_gtk_css_image_pattern_cache_clear (GtkCssImagePatternCache *cache)
+{
+  g_clear_pointer (&cache->pattern, cairo_pattern_destroy);
+}
+
 static GType
 gtk_css_image_get_parser_type (GtkCssParser *parser)
 {
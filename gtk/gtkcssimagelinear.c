@@ -127,11 +127,10 @@ gtk_css_image_linear_compute_start_point (double angle_in_degrees,
   *y = perpendicular * *x + c;
 }
                                          
-static void
-gtk_css_image_linear_draw (GtkCssImage        *image,
-                           cairo_t            *cr,
-                           double              width,
-                           double              height)
+static cairo_pattern_t *
+gtk_css_image_linear_create_pattern (GtkCssImage *image,
+                                     double       width,
+                                     double       height)
 {
   GtkCssImageLinear *linear = GTK_CSS_IMAGE_LINEAR (image);
   cairo_pattern_t *pattern;
@@ -228,12 +227,26 @@ gtk_css_image_linear_draw (GtkCssImage        *image,
       last = i;
     }
 
+  return pattern;
+}
+
+static void
+gtk_css_image_linear_draw (GtkCssImage        *image,
+                           cairo_t            *cr,
+                           double              width,
+                           double              height)
+{
+  GtkCssImageLinear *linear = GTK_CSS_IMAGE_LINEAR (image);
+  cairo_pattern_t *pattern;
+
+  pattern = _gtk_css_image_pattern_cache_get (&linear->pattern, image,
+                                              width, height,
+                                              gtk_css_image_linear_create_pattern);
+
   cairo_rectangle (cr, 0, 0, width, height);
   cairo_translate (cr, width / 2, height / 2);
   cairo_set_source (cr, pattern);
   cairo_fill (cr);
-
-  cairo_pattern_destroy (pattern);
 }
 
 
@@ -587,6 +600,8 @@ gtk_css_image_linear_dispose (GObject *object)
       linear->angle = NULL;
     }
 
+  _gtk_css_image_pattern_cache_clear (&linear->pattern);
+
   G_OBJECT_CLASS (_gtk_css_image_linear_parent_class)->dispose (object);
 }
 
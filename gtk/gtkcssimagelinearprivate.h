@@ -49,6 +49,8 @@ struct _GtkCssImageLinear
   GtkCssValue *angle;
   GArray *stops;
   guint repeating :1;
+
+  GtkCssImagePatternCache pattern;
 };
 
 struct _GtkCssImageLinearClass
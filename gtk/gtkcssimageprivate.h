@@ -37,12 +37,25 @@ G_BEGIN_DECLS
 
 typedef struct _GtkCssImage           GtkCssImage;
 typedef struct _GtkCssImageClass      GtkCssImageClass;
+typedef struct _GtkCssImagePatternCache GtkCssImagePatternCache;
+
+typedef cairo_pattern_t * (* GtkCssImagePatternFunc) (GtkCssImage *image,
+                                                      double       width,
+                                                      double       height);
 
 struct _GtkCssImage
 {
   GObject parent;
 };
 
+/* The pattern an image last drew with, and the size it was made for */
+struct _GtkCssImagePatternCache
+{
+  cairo_pattern_t *pattern;
+  double width;
+  double height;
+};
+
 struct _GtkCssImageClass
 {
   GObjectClass parent_class;
@@ -123,6 +136,14 @@ cairo_surface_t *
                                                     int                         surface_width,
                                                     int                         surface_height);
 
+cairo_pattern_t *
+               _gtk_css_image_pattern_cache_get    (GtkCssImagePatternCache    *cache,
+                                                    GtkCssImage                *image,
+                                                    double                      width,
+                                                    double                      height,
+                                                    GtkCssImagePatternFunc      create_func);
+void           _gtk_css_image_pattern_cache_clear  (GtkCssImagePatternCache    *cache);
+
 G_END_DECLS
 
 #endif /* __GTK_CSS_IMAGE_PRIVATE_H__ */
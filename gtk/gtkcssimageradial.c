@@ -73,11 +73,10 @@ gtk_css_image_radial_get_start_end (GtkCssImageRadial *radial,
     }
 }
 
-static void
-gtk_css_image_radial_draw (GtkCssImage *image,
-                           cairo_t     *cr,
-                           double       width,
-                           double       height)
+static cairo_pattern_t *
+gtk_css_image_radial_create_pattern (GtkCssImage *image,
+                                     double       width,
+                                     double       height)
 {
   GtkCssImageRadial *radial = GTK_CSS_IMAGE_RADIAL (image);
   cairo_pattern_t *pattern;
@@ -163,12 +162,11 @@ gtk_css_image_radial_draw (GtkCssImage *image,
 
   gtk_css_image_radial_get_start_end (radial, radius, &start, &end);
 
+  /* Centered on the position, so drawing needs no translation */
   pattern = cairo_pattern_create_radial (0, 0, 0, 0, 0, radius);
-  if (yscale != 1.0)
-    {
-      cairo_matrix_init_scale (&matrix, 1.0, 1.0 / yscale);
-      cairo_pattern_set_matrix (pattern, &matrix);
-    }
+  cairo_matrix_init_scale (&matrix, 1.0, 1.0 / yscale);
+  cairo_matrix_translate (&matrix, -x, -y);
+  cairo_pattern_set_matrix (pattern, &matrix);
 
  if (radial->repeating)
     cairo_pattern_set_extend (pattern, CAIRO_EXTEND_REPEAT);
@@ -219,12 +217,25 @@ gtk_css_image_radial_draw (GtkCssImage *image,
       last = i;
     }
 
+  return pattern;
+}
+
+static void
+gtk_css_image_radial_draw (GtkCssImage *image,
+                           cairo_t     *cr,
+                           double       width,
+                           double       height)
+{
+  GtkCssImageRadial *radial = GTK_CSS_IMAGE_RADIAL (image);
+  cairo_pattern_t *pattern;
+
+  pattern = _gtk_css_image_pattern_cache_get (&radial->pattern, image,
+                                              width, height,
+                                              gtk_css_image_radial_create_pattern);
+
   cairo_rectangle (cr, 0, 0, width, height);
-  cairo_translate (cr, x, y);
   cairo_set_source (cr, pattern);
   cairo_fill (cr);
-
-  cairo_pattern_destroy (pattern);
 }
 
 static gboolean
@@ -651,6 +662,8 @@ gtk_css_image_radial_dispose (GObject *object)
         radial->sizes[i] = NULL;
       }
 
+  _gtk_css_image_pattern_cache_clear (&radial->pattern);
+
   G_OBJECT_CLASS (_gtk_css_image_radial_parent_class)->dispose (object);
 }
 
@@ -59,6 +59,8 @@ struct _GtkCssImageRadial
   GtkCssRadialSize size;
   guint circle : 1;
   guint repeating :1;
+
+  GtkCssImagePatternCache pattern;
 };
 
 struct _GtkCssImageRadialClass
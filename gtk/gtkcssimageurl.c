@@ -23,39 +23,158 @@
 
 #include "gtkcssimageurlprivate.h"
 #include "gtkcssimagesurfaceprivate.h"
+#include "gtkprivate.h"
 #include "gtkstyleproviderprivate.h"
 
 G_DEFINE_TYPE (GtkCssImageUrl, _gtk_css_image_url, GTK_TYPE_CSS_IMAGE)
 
-static GtkCssImage *
-gtk_css_image_url_load_image (GtkCssImageUrl  *url,
-                              GError         **error)
+/* Decoded images are shared by URI between all url() images that refer
+ * to them, no matter which provider they were parsed from. An entry lives
+ * as long as one of those images does. Entries remember the entity tag of
+ * the file, and one whose file has changed since is replaced, so that
+ * reloading a style sheet picks up the new image.
+ *
+ * If GTK_CSS_ASYNC_IMAGES is set in the environment, computing a style
+ * no longer decodes the image. It starts decoding in a thread and uses an
+ * empty placeholder until it is done. Then the providers that asked for the
+ * image are marked as changed, which makes the style contexts recompute
+ * their styles and redraw with the real image.
+ */
+struct _GtkCssImageUrlLoad
+{
+  int ref_count;
+  char *uri;
+  char *etag;           /* of the file when the entry was made, or NULL */
+  GFile *file;
+
+  GtkCssImage *image;   /* NULL until loaded */
+  GError *error;        /* set if loading failed */
+
+  guint loading : 1;
+  GSList *waiting;      /* GWeakRef to providers to notify when loaded */
+};
+
+static GHashTable *url_loads = NULL;
+
+static gboolean
+gtk_css_image_url_load_async (void)
+{
+  static int async = -1;
+
+  if (async < 0)
+    async = gtk_get_env_flag ("GTK_CSS_ASYNC_IMAGES");
+
+  return async;
+}
+
+static char *
+gtk_css_image_url_get_etag (GFile *file)
+{
+  GFileInfo *info;
+  char *etag;
+
+  /* Resources don't change */
+  if (g_file_has_uri_scheme (file, "resource"))
+    return NULL;
+
+  info = g_file_query_info (file,
+                            G_FILE_ATTRIBUTE_ETAG_VALUE,
+                            G_FILE_QUERY_INFO_NONE,
+                            NULL, NULL);
+  if (info == NULL)
+    return NULL;
+
+  etag = g_strdup (g_file_info_get_etag (info));
+  g_object_unref (info);
+
+  return etag;
+}
+
+static GtkCssImageUrlLoad *
+gtk_css_image_url_load_lookup (GFile *file)
+{
+  GtkCssImageUrlLoad *load;
+  char *uri, *etag;
+
+  if (url_loads == NULL)
+    url_loads = g_hash_table_new (g_str_hash, g_str_equal);
+
+  uri = g_file_get_uri (file);
+  etag = gtk_css_image_url_get_etag (file);
+  load = g_hash_table_lookup (url_loads, uri);
+  if (load && g_strcmp0 (load->etag, etag) == 0)
+    {
+      g_free (uri);
+      g_free (etag);
+      load->ref_count++;
+      return load;
+    }
+
+  /* A stale entry stays around for the images already using it */
+  if (load)
+    g_hash_table_remove (url_loads, uri);
+
+  load = g_slice_new0 (GtkCssImageUrlLoad);
+  load->ref_count = 1;
+  load->uri = uri;
+  load->etag = etag;
+  load->file = g_object_ref (file);
+  g_hash_table_insert (url_loads, load->uri, load);
+
+  return load;
+}
+
+static void
+weak_ref_free (GWeakRef *ref)
 {
+  g_weak_ref_clear (ref);
+  g_slice_free (GWeakRef, ref);
+}
+
+static void
+gtk_css_image_url_load_unref (GtkCssImageUrlLoad *load)
+{
+  if (--load->ref_count > 0)
+    return;
+
+  if (g_hash_table_lookup (url_loads, load->uri) == load)
+    g_hash_table_remove (url_loads, load->uri);
+  g_slist_free_full (load->waiting, (GDestroyNotify) weak_ref_free);
+  g_clear_object (&load->image);
+  g_clear_error (&load->error);
+  g_object_unref (load->file);
+  g_free (load->etag);
+  g_free (load->uri);
+  g_slice_free (GtkCssImageUrlLoad, load);
+}
+
+/* Called from the loader threads, too */
+static cairo_surface_t *
+gtk_css_image_url_load_surface (GFile   *file,
+                                GError **error)
+{
+  cairo_surface_t *surface;
   GdkPixbuf *pixbuf;
-  GError *local_error = NULL;
   GFileInputStream *input;
 
-  if (url->loaded_image)
-    return url->loaded_image;
-
   /* We special case resources here so we can use
      gdk_pixbuf_new_from_resource, which in turn has some special casing
      for GdkPixdata files to avoid duplicating the memory for the pixbufs */
-  if (g_file_has_uri_scheme (url->file, "resource"))
+  if (g_file_has_uri_scheme (file, "resource"))
     {
-      char *uri = g_file_get_uri (url->file);
+      char *uri = g_file_get_uri (file);
       char *resource_path = g_uri_unescape_string (uri + strlen ("resource://"), NULL);
 
-      pixbuf = gdk_pixbuf_new_from_resource (resource_path, &local_error);
+      pixbuf = gdk_pixbuf_new_from_resource (resource_path, error);
       g_free (resource_path);
       g_free (uri);
     }
   else
     {
-      input = g_file_read (url->file, NULL, &local_error);
+      input = g_file_read (file, NULL, error);
       if (input != NULL)
 	{
-          pixbuf = gdk_pixbuf_new_from_stream (G_INPUT_STREAM (input), NULL, &local_error);
+          pixbuf = gdk_pixbuf_new_from_stream (G_INPUT_STREAM (input), NULL, error);
           g_object_unref (input);
 	}
       else
@@ -65,30 +184,153 @@ gtk_css_image_url_load_image (GtkCssImageUrl  *url,
     }
 
   if (pixbuf == NULL)
+    return NULL;
+
+  surface = gdk_cairo_surface_create_from_pixbuf (pixbuf, 1, NULL);
+  g_object_unref (pixbuf);
+
+  return surface;
+}
+
+static void
+gtk_css_image_url_load_set_surface (GtkCssImageUrlLoad *load,
+                                    cairo_surface_t    *surface,
+                                    GError             *error)
+{
+  cairo_surface_t *empty;
+
+  if (surface)
     {
-      cairo_surface_t *empty;
+      load->image = _gtk_css_image_surface_new (surface);
+      return;
+    }
+
+  load->error = g_error_new (GTK_CSS_PROVIDER_ERROR,
+                             GTK_CSS_PROVIDER_ERROR_FAILED,
+                             "Error loading image '%s': %s", load->uri, error->message);
+
+  empty = cairo_image_surface_create (CAIRO_FORMAT_ARGB32, 0, 0);
+  load->image = _gtk_css_image_surface_new (empty);
+  cairo_surface_destroy (empty);
+}
 
-      if (error)
+static void
+gtk_css_image_url_load_thread (GTask        *task,
+                               gpointer      source_object,
+                               gpointer      task_data,
+                               GCancellable *cancellable)
+{
+  GFile *file = task_data;
+  cairo_surface_t *surface;
+  GError *error = NULL;
+
+  surface = gtk_css_image_url_load_surface (file, &error);
+  if (surface)
+    g_task_return_pointer (task, surface, (GDestroyNotify) cairo_surface_destroy);
+  else
+    g_task_return_error (task, error);
+}
+
+static void
+gtk_css_image_url_load_done (GObject      *source,
+                             GAsyncResult *result,
+                             gpointer      data)
+{
+  GtkCssImageUrlLoad *load = data;
+  cairo_surface_t *surface;
+  GError *error = NULL;
+  GSList *l;
+
+  surface = g_task_propagate_pointer (G_TASK (result), &error);
+
+  /* A synchronous load may have beaten us to it */
+  if (load->image == NULL)
+    gtk_css_image_url_load_set_surface (load, surface, error);
+
+  g_clear_pointer (&surface, cairo_surface_destroy);
+  g_clear_error (&error);
+  load->loading = FALSE;
+
+  for (l = load->waiting; l; l = l->next)
+    {
+      GtkStyleProviderPrivate *provider = g_weak_ref_get (l->data);
+
+      if (provider)
         {
-          char *uri;
-
-          uri = g_file_get_uri (url->file);
-          g_set_error (error,
-                       GTK_CSS_PROVIDER_ERROR,
-                       GTK_CSS_PROVIDER_ERROR_FAILED,
-                       "Error loading image '%s': %s", uri, local_error->message);
-          g_error_free (local_error);
-          g_free (uri);
-       }
-
-      empty = cairo_image_surface_create (CAIRO_FORMAT_ARGB32, 0, 0);
-      url->loaded_image = _gtk_css_image_surface_new (empty);
-      cairo_surface_destroy (empty);
-      return url->loaded_image;
+          _gtk_style_provider_private_changed (provider);
+          g_object_unref (provider);
+        }
     }
+  g_slist_free_full (load->waiting, (GDestroyNotify) weak_ref_free);
+  load->waiting = NULL;
 
-  url->loaded_image = _gtk_css_image_surface_new_for_pixbuf (pixbuf);
-  g_object_unref (pixbuf);
+  gtk_css_image_url_load_unref (load);
+}
+
+static void
+gtk_css_image_url_load_start (GtkCssImageUrlLoad      *load,
+                              GtkStyleProviderPrivate *provider)
+{
+  GTask *task;
+  GWeakRef *ref;
+  GObject *waiting;
+  GSList *l;
+
+  for (l = load->waiting; l; l = l->next)
+    {
+      waiting = g_weak_ref_get (l->data);
+      if (waiting)
+        g_object_unref (waiting);
+      if (waiting == G_OBJECT (provider))
+        break;
+    }
+
+  if (l == NULL)
+    {
+      ref = g_slice_new (GWeakRef);
+      g_weak_ref_init (ref, provider);
+      load->waiting = g_slist_prepend (load->waiting, ref);
+    }
+
+  if (load->loading)
+    return;
+
+  load->loading = TRUE;
+  load->ref_count++;
+
+  task = g_task_new (NULL, NULL, gtk_css_image_url_load_done, load);
+  g_task_set_task_data (task, g_object_ref (load->file), g_object_unref);
+  g_task_run_in_thread (task, gtk_css_image_url_load_thread);
+  g_object_unref (task);
+}
+
+static GtkCssImage *
+gtk_css_image_url_load_image (GtkCssImageUrl  *url,
+                              GError         **error)
+{
+  GtkCssImageUrlLoad *load;
+  cairo_surface_t *surface;
+  GError *local_error = NULL;
+
+  if (url->loaded_image)
+    return url->loaded_image;
+
+  if (url->load == NULL)
+    url->load = gtk_css_image_url_load_lookup (url->file);
+  load = url->load;
+
+  if (load->image == NULL)
+    {
+      surface = gtk_css_image_url_load_surface (load->file, &local_error);
+      gtk_css_image_url_load_set_surface (load, surface, local_error);
+      g_clear_pointer (&surface, cairo_surface_destroy);
+      g_clear_error (&local_error);
+    }
+
+  if (load->error && error)
+    *error = g_error_copy (load->error);
+
+  url->loaded_image = g_object_ref (load->image);
 
   return url->loaded_image;
 }
@@ -139,6 +381,30 @@ gtk_css_image_url_compute (GtkCssImage             *image,
   GtkCssImage *copy;
   GError *error = NULL;
 
+  if (url->loaded_image == NULL && provider != NULL && gtk_css_image_url_load_async ())
+    {
+      if (url->load == NULL)
+        url->load = gtk_css_image_url_load_lookup (url->file);
+
+      if (url->load->image == NULL)
+        {
+          static GtkCssImage *placeholder = NULL;
+
+          gtk_css_image_url_load_start (url->load, provider);
+
+          if (placeholder == NULL)
+            {
+              cairo_surface_t *empty;
+
+              empty = cairo_image_surface_create (CAIRO_FORMAT_ARGB32, 0, 0);
+              placeholder = _gtk_css_image_surface_new (empty);
+              cairo_surface_destroy (empty);
+            }
+
+          return g_object_ref (placeholder);
+        }
+    }
+
   copy = gtk_css_image_url_load_image (url, &error);
   if (error)
     {
@@ -179,6 +445,7 @@ gtk_css_image_url_dispose (GObject *object)
 
   g_clear_object (&url->file);
   g_clear_object (&url->loaded_image);
+  g_clear_pointer (&url->load, gtk_css_image_url_load_unref);
 
   G_OBJECT_CLASS (_gtk_css_image_url_parent_class)->dispose (object);
 }
@@ -33,6 +33,7 @@ G_BEGIN_DECLS
 
 typedef struct _GtkCssImageUrl           GtkCssImageUrl;
 typedef struct _GtkCssImageUrlClass      GtkCssImageUrlClass;
+typedef struct _GtkCssImageUrlLoad       GtkCssImageUrlLoad;
 
 struct _GtkCssImageUrl
 {
@@ -40,6 +41,7 @@ struct _GtkCssImageUrl
 
   GFile           *file;                /* the file we're loading from */
   GtkCssImage     *loaded_image;        /* the actual image we render */
+  GtkCssImageUrlLoad *load;             /* shared with other images for the same file */
 };
 
 struct _GtkCssImageUrlClass
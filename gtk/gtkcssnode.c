@@ -24,6 +24,7 @@
 #include "gtkcssstylepropertyprivate.h"
 #include "gtkintl.h"
 #include "gtkmarshalers.h"
+#include "gtkprofilerprivate.h"
 #include "gtksettingsprivate.h"
 #include "gtktypebuiltins.h"
 
@@ -364,6 +365,7 @@ gtk_css_node_create_style (GtkCssNode *cssnode)
   parent = cssnode->parent ? cssnode->parent->style : NULL;
 
   style = lookup_in_global_parent_cache (cssnode, decl);
+  _gtk_profiler_count_style (cssnode, style != NULL);
   if (style)
     return g_object_ref (style);
 
@@ -139,24 +139,6 @@ gtk_css_selector_tree_get_matches (const GtkCssSelectorTree *tree)
   return (gpointer *) ((guint8 *)tree + tree->matches_offset);
 }
 
-static void
-g_ptr_array_insert_sorted (GPtrArray *array,
-                           gpointer   data)
-{
-  gint i;
-
-  for (i = 0; i < array->len; i++)
-    {
-      if (data == array->pdata[i])
-        return;
-
-      if (data < array->pdata[i])
-        break;
-    }
-
-  g_ptr_array_insert (array, i, data);
-}
-
 static void
 gtk_css_selector_tree_found_match (const GtkCssSelectorTree  *tree,
 				   GPtrArray                **array)
@@ -170,8 +152,9 @@ gtk_css_selector_tree_found_match (const GtkCssSelectorTree  *tree,
       if (!*array)
         *array = g_ptr_array_sized_new (16);
 
+      /* Sorted and deduplicated once all matches are found */
       for (i = 0; matches[i] != NULL; i++)
-        g_ptr_array_insert_sorted (*array, matches[i]);
+        g_ptr_array_add (*array, matches[i]);
     }
 }
 
@@ -1522,16 +1505,43 @@ gtk_css_selector_tree_match_foreach (const GtkCssSelector *selector,
   return FALSE;
 }
 
+static int
+compare_matches (gconstpointer a,
+                 gconstpointer b)
+{
+  gconstpointer match_a = *(gconstpointer *) a;
+  gconstpointer match_b = *(gconstpointer *) b;
+
+  return match_a < match_b ? -1 : match_a > match_b;
+}
+
 GPtrArray *
 _gtk_css_selector_tree_match_all (const GtkCssSelectorTree *tree,
 				  const GtkCssMatcher *matcher)
 {
   GPtrArray *array = NULL;
+  guint i, j;
 
   for (; tree != NULL;
        tree = gtk_css_selector_tree_get_sibling (tree))
     gtk_css_selector_foreach (&tree->selector, matcher, gtk_css_selector_tree_match_foreach, &array);
 
+  if (array == NULL)
+    return NULL;
+
+  /* Themes easily match dozens of rulesets per node, so instead of
+   * keeping the array sorted while matching, sort it once. A ruleset
+   * can be reached through several paths of the tree.
+   */
+  g_ptr_array_sort (array, compare_matches);
+
+  for (i = 0, j = 0; i < array->len; i++)
+    {
+      if (j == 0 || array->pdata[i] != array->pdata[j - 1])
+        array->pdata[j++] = array->pdata[i];
+    }
+  g_ptr_array_set_size (array, j);
+
   return array;
 }
 
@@ -37,10 +37,13 @@ G_BEGIN_DECLS
 
 /* typedef struct _GtkCssStyle           GtkCssStyle; */
 typedef struct _GtkCssStyleClass      GtkCssStyleClass;
+typedef struct _GtkCssBorderPath      GtkCssBorderPath;
 
 struct _GtkCssStyle
 {
   GObject parent;
+
+  GtkCssBorderPath *border_path;        /* cached by gtk_css_style_render_border() */
 };
 
 struct _GtkCssStyleClass
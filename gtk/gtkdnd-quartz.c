@@ -128,6 +128,7 @@ struct _GtkDragFindData
   selection_data.selection = GDK_NONE;
   selection_data.data = NULL;
   selection_data.length = -1;
+  selection_data.stream = NULL;
   selection_data.target = gdk_quartz_pasteboard_type_to_atom_libgtk_only (type);
   selection_data.display = gdk_display_get_default ();
 
@@ -141,6 +142,7 @@ struct _GtkDragFindData
 			     target_info,
 			     time);
 
+      _gtk_selection_data_flush_stream (&selection_data);
       if (selection_data.length >= 0)
         _gtk_quartz_set_selection_data_for_pasteboard (sender, &selection_data);
       
@@ -2622,6 +2622,7 @@ gtk_drag_drop (GtkDragSourceInfo *info,
               selection_data.target = pair->target;
               selection_data.data = NULL;
               selection_data.length = -1;
+              selection_data.stream = NULL;
 
               g_signal_emit_by_name (info->widget, "drag-data-get",
                                      info->context, &selection_data,
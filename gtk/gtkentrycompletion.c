@@ -86,6 +86,7 @@
 
 #include "gtkprivate.h"
 #include "gtkwindowprivate.h"
+#include "gtkbitmaskprivate.h"
 
 #include <string.h>
 
@@ -182,6 +183,7 @@ static gboolean gtk_entry_completion_insert_completion   (GtkEntryCompletion *co
 static void     gtk_entry_completion_insert_completion_text (GtkEntryCompletion *completion,
                                                              const gchar *text);
 static void     connect_completion_signals                  (GtkEntryCompletion *completion);
+static void     key_index_free                              (GtkEntryCompletionKeyIndex *index);
 static void     disconnect_completion_signals               (GtkEntryCompletion *completion);
 
 
@@ -820,6 +822,8 @@ gtk_entry_completion_dispose (GObject *object)
       priv->cell_area = NULL;
     }
 
+  g_clear_pointer (&priv->key_index, key_index_free);
+
   G_OBJECT_CLASS (gtk_entry_completion_parent_class)->dispose (object);
 }
 
@@ -840,6 +844,467 @@ gtk_entry_completion_get_area (GtkCellLayout *cell_layout)
   return priv->cell_area;
 }
 
+/* Key index
+ *
+ * With the default match function, every refilter used to normalize and
+ * casefold the text column of every row. For list models we instead keep
+ * the folded key of each row, plus the row numbers sorted by key, so that
+ * the rows matching a prefix are a range found by binary search. When the
+ * key grows, the new range is searched for inside the previous one.
+ *
+ * The index is updated from the model signals. Its handlers are connected
+ * before the filter model's, so the keys are current by the time the
+ * filter asks about a row.
+ */
+struct _GtkEntryCompletionKeyIndex
+{
+  GtkTreeModel *model;
+  gulong row_inserted_id;
+  gulong row_changed_id;
+  gulong row_deleted_id;
+  gulong rows_reordered_id;
+
+  gint column;
+  GPtrArray *keys;              /* folded keys in model order, NULL until needed */
+  GArray *sorted;               /* row numbers ordered by key */
+  guint sorted_valid : 1;
+
+  /* The rows matching range_key are sorted[range_start..range_end) */
+  gchar *range_key;
+  guint range_start;
+  guint range_end;
+  GtkBitmask *visible;
+};
+
+static gchar *
+normalize_key (const gchar *text)
+{
+  gchar *normalized;
+  gchar *key;
+
+  if (text == NULL)
+    return NULL;
+
+  normalized = g_utf8_normalize (text, -1, G_NORMALIZE_ALL);
+  if (normalized == NULL)
+    return NULL;
+
+  key = g_utf8_casefold (normalized, -1);
+  g_free (normalized);
+
+  return key;
+}
+
+static gchar *
+key_index_get_key (GtkEntryCompletionKeyIndex *index,
+                   GtkTreeIter                *iter)
+{
+  gchar *item = NULL;
+  gchar *key;
+
+  gtk_tree_model_get (index->model, iter, index->column, &item, -1);
+  key = normalize_key (item);
+  g_free (item);
+
+  return key;
+}
+
+/* Rows without a usable key sort first and never match */
+static gint
+compare_keys (const gchar *a,
+              const gchar *b)
+{
+  if (a == NULL)
+    return b == NULL ? 0 : -1;
+  if (b == NULL)
+    return 1;
+
+  return strcmp (a, b);
+}
+
+static gint
+compare_rows (gconstpointer a,
+              gconstpointer b,
+              gpointer      data)
+{
+  GPtrArray *keys = data;
+
+  return compare_keys (g_ptr_array_index (keys, *(const guint *) a),
+                       g_ptr_array_index (keys, *(const guint *) b));
+}
+
+static inline const gchar *
+key_index_sorted_key (GtkEntryCompletionKeyIndex *index,
+                      guint                       pos)
+{
+  return g_ptr_array_index (index->keys, g_array_index (index->sorted, guint, pos));
+}
+
+/* Returns the first position in [start, end) whose key is not less
+ * than @key, or, if @after is set, sorts after it.
+ */
+static guint
+key_index_bisect (GtkEntryCompletionKeyIndex *index,
+                  const gchar                *key,
+                  gboolean                    after,
+                  guint                       start,
+                  guint                       end)
+{
+  guint mid;
+  gint cmp;
+
+  while (start < end)
+    {
+      mid = start + (end - start) / 2;
+      cmp = compare_keys (key_index_sorted_key (index, mid), key);
+      if (cmp < 0 || (after && cmp == 0))
+        start = mid + 1;
+      else
+        end = mid;
+    }
+
+  return start;
+}
+
+/* Same as key_index_bisect(), but only compares the first @len bytes
+ * of each key, so that [lower, upper) is the range starting with @prefix.
+ */
+static guint
+key_index_bisect_prefix (GtkEntryCompletionKeyIndex *index,
+                         const gchar                *prefix,
+                         gsize                       len,
+                         gboolean                    after,
+                         guint                       start,
+                         guint                       end)
+{
+  const gchar *key;
+  guint mid;
+  gint cmp;
+
+  while (start < end)
+    {
+      mid = start + (end - start) / 2;
+      key = key_index_sorted_key (index, mid);
+      cmp = key ? strncmp (key, prefix, len) : -1;
+      if (cmp < 0 || (after && cmp == 0))
+        start = mid + 1;
+      else
+        end = mid;
+    }
+
+  return start;
+}
+
+static guint
+key_index_find_row (GtkEntryCompletionKeyIndex *index,
+                    guint                       row)
+{
+  const gchar *key;
+  guint pos;
+
+  key = g_ptr_array_index (index->keys, row);
+  for (pos = key_index_bisect (index, key, FALSE, 0, index->sorted->len);
+       pos < index->sorted->len;
+       pos++)
+    {
+      if (g_array_index (index->sorted, guint, pos) == row)
+        return pos;
+    }
+
+  g_assert_not_reached ();
+  return 0;
+}
+
+static void
+key_index_insert_sorted (GtkEntryCompletionKeyIndex *index,
+                         guint                       row)
+{
+  guint pos;
+
+  pos = key_index_bisect (index, g_ptr_array_index (index->keys, row), TRUE,
+                          0, index->sorted->len);
+  g_array_insert_val (index->sorted, pos, row);
+}
+
+static void
+key_index_sort (GtkEntryCompletionKeyIndex *index)
+{
+  guint i;
+
+  g_array_set_size (index->sorted, index->keys->len);
+  for (i = 0; i < index->keys->len; i++)
+    g_array_index (index->sorted, guint, i) = i;
+
+  g_array_sort_with_data (index->sorted, compare_rows, index->keys);
+  index->sorted_valid = TRUE;
+}
+
+static void
+key_index_clear_range (GtkEntryCompletionKeyIndex *index)
+{
+  g_clear_pointer (&index->range_key, g_free);
+  g_clear_pointer (&index->visible, _gtk_bitmask_free);
+}
+
+static void
+key_index_row_inserted (GtkTreeModel               *model,
+                        GtkTreePath                *path,
+                        GtkTreeIter                *iter,
+                        GtkEntryCompletionKeyIndex *index)
+{
+  guint row;
+
+  if (index->keys == NULL)
+    return;
+
+  key_index_clear_range (index);
+
+  row = gtk_tree_path_get_indices (path)[0];
+  g_ptr_array_insert (index->keys, row, key_index_get_key (index, iter));
+
+  /* Appending keeps the row numbers of all other rows */
+  if (index->sorted_valid && row == index->keys->len - 1)
+    key_index_insert_sorted (index, row);
+  else
+    index->sorted_valid = FALSE;
+}
+
+static void
+key_index_row_changed (GtkTreeModel               *model,
+                       GtkTreePath                *path,
+                       GtkTreeIter                *iter,
+                       GtkEntryCompletionKeyIndex *index)
+{
+  guint row;
+  gchar *key;
+
+  if (index->keys == NULL)
+    return;
+
+  row = gtk_tree_path_get_indices (path)[0];
+  key = key_index_get_key (index, iter);
+
+  if (compare_keys (key, g_ptr_array_index (index->keys, row)) == 0)
+    {
+      g_free (key);
+      return;
+    }
+
+  key_index_clear_range (index);
+
+  if (index->sorted_valid)
+    g_array_remove_index (index->sorted, key_index_find_row (index, row));
+
+  g_free (g_ptr_array_index (index->keys, row));
+  g_ptr_array_index (index->keys, row) = key;
+
+  if (index->sorted_valid)
+    key_index_insert_sorted (index, row);
+}
+
+static void
+key_index_row_deleted (GtkTreeModel               *model,
+                       GtkTreePath                *path,
+                       GtkEntryCompletionKeyIndex *index)
+{
+  guint row;
+
+  if (index->keys == NULL)
+    return;
+
+  key_index_clear_range (index);
+
+  row = gtk_tree_path_get_indices (path)[0];
+
+  if (index->sorted_valid && row == index->keys->len - 1)
+    g_array_remove_index (index->sorted, key_index_find_row (index, row));
+  else
+    index->sorted_valid = FALSE;
+
+  g_ptr_array_remove_index (index->keys, row);
+}
+
+static void
+key_index_rows_reordered (GtkTreeModel               *model,
+                          GtkTreePath                *path,
+                          GtkTreeIter                *iter,
+                          gint                       *new_order,
+                          GtkEntryCompletionKeyIndex *index)
+{
+  GPtrArray *keys;
+  guint *old_to_new;
+  guint i;
+
+  if (index->keys == NULL || gtk_tree_path_get_depth (path) > 0)
+    return;
+
+  key_index_clear_range (index);
+
+  keys = g_ptr_array_new_full (index->keys->len, g_free);
+  for (i = 0; i < index->keys->len; i++)
+    g_ptr_array_add (keys, g_ptr_array_index (index->keys, new_order[i]));
+
+  g_ptr_array_set_free_func (index->keys, NULL);
+  g_ptr_array_unref (index->keys);
+  index->keys = keys;
+
+  /* Keys don't change, so the sorted order only needs renumbering */
+  if (index->sorted_valid)
+    {
+      old_to_new = g_new (guint, keys->len);
+      for (i = 0; i < keys->len; i++)
+        old_to_new[new_order[i]] = i;
+
+      for (i = 0; i < index->sorted->len; i++)
+        g_array_index (index->sorted, guint, i) = old_to_new[g_array_index (index->sorted, guint, i)];
+
+      g_free (old_to_new);
+    }
+}
+
+static GtkEntryCompletionKeyIndex *
+key_index_new (GtkTreeModel *model)
+{
+  GtkEntryCompletionKeyIndex *index;
+
+  index = g_slice_new0 (GtkEntryCompletionKeyIndex);
+  index->model = g_object_ref (model);
+  index->column = -1;
+
+  index->row_inserted_id = g_signal_connect (model, "row-inserted",
+                                             G_CALLBACK (key_index_row_inserted), index);
+  index->row_changed_id = g_signal_connect (model, "row-changed",
+                                            G_CALLBACK (key_index_row_changed), index);
+  index->row_deleted_id = g_signal_connect (model, "row-deleted",
+                                            G_CALLBACK (key_index_row_deleted), index);
+  index->rows_reordered_id = g_signal_connect (model, "rows-reordered",
+                                               G_CALLBACK (key_index_rows_reordered), index);
+
+  return index;
+}
+
+static void
+key_index_reset (GtkEntryCompletionKeyIndex *index)
+{
+  key_index_clear_range (index);
+  g_clear_pointer (&index->keys, g_ptr_array_unref);
+  g_clear_pointer (&index->sorted, g_array_unref);
+  index->sorted_valid = FALSE;
+  index->column = -1;
+}
+
+static void
+key_index_free (GtkEntryCompletionKeyIndex *index)
+{
+  g_signal_handler_disconnect (index->model, index->row_inserted_id);
+  g_signal_handler_disconnect (index->model, index->row_changed_id);
+  g_signal_handler_disconnect (index->model, index->row_deleted_id);
+  g_signal_handler_disconnect (index->model, index->rows_reordered_id);
+
+  key_index_reset (index);
+  g_object_unref (index->model);
+
+  g_slice_free (GtkEntryCompletionKeyIndex, index);
+}
+
+/* Builds the keys for @column on first use. Only flat models with a
+ * string column are indexed; everything else keeps going through
+ * the default match function.
+ */
+static gboolean
+key_index_ensure (GtkEntryCompletionKeyIndex *index,
+                  gint                        column)
+{
+  GtkTreeIter iter;
+  gboolean valid;
+
+  if (index->keys != NULL && index->column == column)
+    return TRUE;
+
+  key_index_reset (index);
+
+  if (column < 0 ||
+      !(gtk_tree_model_get_flags (index->model) & GTK_TREE_MODEL_LIST_ONLY) ||
+      column >= gtk_tree_model_get_n_columns (index->model) ||
+      gtk_tree_model_get_column_type (index->model, column) != G_TYPE_STRING)
+    return FALSE;
+
+  index->column = column;
+  index->keys = g_ptr_array_new_with_free_func (g_free);
+  index->sorted = g_array_new (FALSE, FALSE, sizeof (guint));
+
+  for (valid = gtk_tree_model_get_iter_first (index->model, &iter);
+       valid;
+       valid = gtk_tree_model_iter_next (index->model, &iter))
+    g_ptr_array_add (index->keys, key_index_get_key (index, &iter));
+
+  key_index_sort (index);
+
+  return TRUE;
+}
+
+static void
+key_index_set_key (GtkEntryCompletionKeyIndex *index,
+                   const gchar                *key)
+{
+  gsize len;
+  guint start, end;
+  guint pos;
+
+  if (!index->sorted_valid)
+    key_index_sort (index);
+
+  /* A longer key can only match a subset of the previous range */
+  if (index->range_key && g_str_has_prefix (key, index->range_key))
+    {
+      start = index->range_start;
+      end = index->range_end;
+    }
+  else
+    {
+      start = 0;
+      end = index->sorted->len;
+    }
+
+  key_index_clear_range (index);
+
+  len = strlen (key);
+  start = key_index_bisect_prefix (index, key, len, FALSE, start, end);
+  end = key_index_bisect_prefix (index, key, len, TRUE, start, end);
+
+  index->visible = _gtk_bitmask_new ();
+  for (pos = start; pos < end; pos++)
+    index->visible = _gtk_bitmask_set (index->visible,
+                                       g_array_index (index->sorted, guint, pos),
+                                       TRUE);
+
+  index->range_key = g_strdup (key);
+  index->range_start = start;
+  index->range_end = end;
+}
+
+static gboolean
+key_index_matches (GtkEntryCompletionKeyIndex *index,
+                   GtkTreeIter                *iter,
+                   const gchar                *key)
+{
+  GtkTreePath *path;
+  const gchar *row_key;
+  guint row;
+
+  path = gtk_tree_model_get_path (index->model, iter);
+  row = gtk_tree_path_get_indices (path)[0];
+  gtk_tree_path_free (path);
+
+  if (index->range_key)
+    return _gtk_bitmask_get (index->visible, row);
+
+  /* The model changed since the last complete() */
+  row_key = g_ptr_array_index (index->keys, row);
+
+  return row_key && strncmp (key, row_key, strlen (key)) == 0;
+}
+
 /* all those callbacks */
 static gboolean
 gtk_entry_completion_default_completion_func (GtkEntryCompletion *completion,
@@ -901,6 +1366,12 @@ gtk_entry_completion_visible_func (GtkTreeModel *model,
                                             completion->priv->case_normalized_key,
                                             iter,
                                             completion->priv->match_data);
+  else if (completion->priv->key_index &&
+           completion->priv->key_index->keys &&
+           completion->priv->key_index->column == completion->priv->text_column)
+    ret = key_index_matches (completion->priv->key_index,
+                             iter,
+                             completion->priv->case_normalized_key);
   else if (completion->priv->text_column >= 0)
     ret = gtk_entry_completion_default_completion_func (completion,
                                                         completion->priv->case_normalized_key,
@@ -1138,6 +1609,8 @@ gtk_entry_completion_set_model (GtkEntryCompletion *completion,
   g_return_if_fail (GTK_IS_ENTRY_COMPLETION (completion));
   g_return_if_fail (model == NULL || GTK_IS_TREE_MODEL (model));
 
+  g_clear_pointer (&completion->priv->key_index, key_index_free);
+
   if (!model)
     {
       gtk_tree_view_set_model (GTK_TREE_VIEW (completion->priv->tree_view),
@@ -1147,6 +1620,9 @@ gtk_entry_completion_set_model (GtkEntryCompletion *completion,
       return;
     }
 
+  /* must come before the filter model, see the key index */
+  completion->priv->key_index = key_index_new (model);
+
   /* code will unref the old filter model (if any) */
   completion->priv->filter_model =
     GTK_TREE_MODEL_FILTER (gtk_tree_model_filter_new (model, NULL));
@@ -1292,6 +1768,10 @@ gtk_entry_completion_complete (GtkEntryCompletion *completion)
   completion->priv->case_normalized_key = g_utf8_casefold (tmp, -1);
   g_free (tmp);
 
+  if (!completion->priv->match_func &&
+      key_index_ensure (completion->priv->key_index, completion->priv->text_column))
+    key_index_set_key (completion->priv->key_index, completion->priv->case_normalized_key);
+
   gtk_tree_model_filter_refilter (completion->priv->filter_model);
 
   if (!gtk_tree_model_get_iter_first (GTK_TREE_MODEL (completion->priv->filter_model), &iter))
@@ -28,6 +28,8 @@
 
 G_BEGIN_DECLS
 
+typedef struct _GtkEntryCompletionKeyIndex GtkEntryCompletionKeyIndex;
+
 struct _GtkEntryCompletionPrivate
 {
   GtkWidget *entry;
@@ -46,6 +48,7 @@ struct _GtkEntryCompletionPrivate
   gint text_column;
 
   gchar *case_normalized_key;
+  GtkEntryCompletionKeyIndex *key_index;
 
   /* only used by GtkEntry when attached: */
   GtkWidget *popup_window;
@@ -0,0 +1,980 @@
+/* gtkfileindex.c
+ * Copyright (C) 2016 Red Hat, Inc.
+ *
+ * This library is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Library General Public
+ * License as published by the Free Software Foundation; either
+ * version 2 of the License, or (at your option) any later version.
+ *
+ * This library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Library General Public License for more details.
+ *
+ * You should have received a copy of the GNU Library General Public
+ * License along with this library. If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include "config.h"
+
+#include "gtkfileindexprivate.h"
+#include "gtkquery.h"
+
+#include <glib/gstdio.h>
+#include <string.h>
+
+#ifdef G_OS_WIN32
+#ifndef S_ISDIR
+#define S_ISDIR(mode) ((mode)&_S_IFDIR)
+#endif
+#endif
+
+/* GtkFileIndex keeps the names of all files below a root directory,
+ * for searching in the file chooser when no desktop indexer is around.
+ *
+ * Names are kept in the form gtk_query_matches_string() compares, and
+ * every three byte sequence of them maps to the list of entries that
+ * contain it. A lookup only checks the entries on the shortest list
+ * among the trigrams of the search words.
+ *
+ * Only the directories and the names in them are saved, as a GVariant
+ * in $XDG_CACHE_HOME/gtk-3.0/file-index; the trigram lists are rebuilt
+ * when the index is loaded. The index is kept current by comparing the
+ * modification times of its directories now and then, which catches
+ * files being added, removed or renamed, and by monitoring the
+ * directories closest to the root for changes in between.
+ *
+ * Entries that go away are only marked as removed, and the index is
+ * compacted when they make up half of it.
+ */
+
+#define INDEX_VERSION 1
+#define INDEX_FORMAT "(usa(sxa(sb)))"
+
+#define CHECK_INTERVAL (60 * G_TIME_SPAN_SECOND)
+#define MAX_MONITORS 256
+
+#define SCAN_ATTRIBUTES \
+  G_FILE_ATTRIBUTE_STANDARD_NAME "," \
+  G_FILE_ATTRIBUTE_STANDARD_TYPE "," \
+  G_FILE_ATTRIBUTE_STANDARD_IS_HIDDEN
+
+#define NO_DIR G_MAXUINT
+
+typedef struct
+{
+  gchar *path;
+  gint64 mtime;           /* -1 if the directory needs to be scanned */
+  GArray *entries;        /* guint, into GtkFileIndex::entries */
+  guint removed : 1;
+} IndexDir;
+
+typedef struct
+{
+  gchar *name;
+  gchar *key;             /* NULL if the name is its own key */
+  guint dir;
+  guint is_dir : 1;
+  guint removed : 1;
+} IndexEntry;
+
+struct _GtkFileIndex
+{
+  gchar *root;
+  gchar *cache_file;
+
+  GMutex lock;            /* protects everything up to dirty_lock */
+  gboolean loaded;
+  gboolean changed;       /* not saved yet */
+  gint64 last_check;
+  GPtrArray *dirs;        /* IndexDir, the root first */
+  GHashTable *dir_by_path;
+  GArray *entries;        /* IndexEntry */
+  guint n_removed;
+  GHashTable *trigrams;   /* trigram -> GArray of guint */
+
+  GMutex dirty_lock;
+  GHashTable *dirty;      /* paths reported by the monitors */
+
+  GPtrArray *monitors;    /* only used in the main thread */
+};
+
+G_LOCK_DEFINE_STATIC (indexes);
+static GHashTable *indexes = NULL;
+
+static void
+index_dir_free (IndexDir *dir)
+{
+  g_free (dir->path);
+  g_array_unref (dir->entries);
+  g_slice_free (IndexDir, dir);
+}
+
+static void
+index_entry_clear (IndexEntry *entry)
+{
+  g_free (entry->name);
+  g_free (entry->key);
+}
+
+static inline IndexDir *
+get_dir (GtkFileIndex *index,
+         guint         i)
+{
+  return g_ptr_array_index (index->dirs, i);
+}
+
+static inline IndexEntry *
+get_entry (GtkFileIndex *index,
+           guint         i)
+{
+  return &g_array_index (index->entries, IndexEntry, i);
+}
+
+static guint
+lookup_dir (GtkFileIndex *index,
+            const gchar  *path)
+{
+  return GPOINTER_TO_UINT (g_hash_table_lookup (index->dir_by_path, path)) - 1;
+}
+
+static guint
+ensure_dir (GtkFileIndex *index,
+            const gchar  *path)
+{
+  IndexDir *dir;
+  guint i;
+
+  i = lookup_dir (index, path);
+  if (i != NO_DIR)
+    return i;
+
+  dir = g_slice_new0 (IndexDir);
+  dir->path = g_strdup (path);
+  dir->mtime = -1;
+  dir->entries = g_array_new (FALSE, FALSE, sizeof (guint));
+
+  i = index->dirs->len;
+  g_ptr_array_add (index->dirs, dir);
+  g_hash_table_insert (index->dir_by_path, dir->path, GUINT_TO_POINTER (i + 1));
+
+  return i;
+}
+
+static void
+add_trigrams (GtkFileIndex *index,
+              const gchar  *key,
+              guint         id)
+{
+  const guchar *s = (const guchar *) key;
+  GArray *postings;
+  guint32 trigram;
+  gsize i, len;
+
+  len = strlen (key);
+
+  for (i = 0; i + 3 <= len; i++)
+    {
+      trigram = (s[i] << 16) | (s[i + 1] << 8) | s[i + 2];
+
+      postings = g_hash_table_lookup (index->trigrams, GUINT_TO_POINTER (trigram));
+      if (postings == NULL)
+        {
+          postings = g_array_new (FALSE, FALSE, sizeof (guint));
+          g_hash_table_insert (index->trigrams, GUINT_TO_POINTER (trigram), postings);
+        }
+
+      /* Entries are added in order, so a repeated trigram of the
+       * same name is always the last one on the list */
+      if (postings->len == 0 ||
+          g_array_index (postings, guint, postings->len - 1) != id)
+        g_array_append_val (postings, id);
+    }
+}
+
+static void
+add_entry (GtkFileIndex *index,
+           guint         dir,
+           const gchar  *name,
+           gboolean      is_dir)
+{
+  IndexEntry entry = { NULL, };
+  gchar *display_name;
+  guint id;
+
+  entry.name = g_strdup (name);
+  entry.dir = dir;
+  entry.is_dir = is_dir;
+
+  display_name = g_filename_display_name (name);
+  entry.key = gtk_query_prepare_string (display_name);
+  g_free (display_name);
+
+  if (strcmp (entry.key, name) == 0)
+    g_clear_pointer (&entry.key, g_free);
+
+  id = index->entries->len;
+  g_array_append_val (index->entries, entry);
+  g_array_append_val (get_dir (index, dir)->entries, id);
+
+  add_trigrams (index, entry.key ? entry.key : entry.name, id);
+}
+
+static void remove_dir (GtkFileIndex *index,
+                        guint         i);
+
+static void
+remove_entries (GtkFileIndex *index,
+                guint         i,
+                gboolean      recursive)
+{
+  IndexDir *dir = get_dir (index, i);
+  IndexEntry *entry;
+  gchar *path;
+  guint j, sub;
+
+  for (j = 0; j < dir->entries->len; j++)
+    {
+      entry = get_entry (index, g_array_index (dir->entries, guint, j));
+      entry->removed = TRUE;
+      index->n_removed++;
+
+      if (recursive && entry->is_dir)
+        {
+          path = g_build_filename (dir->path, entry->name, NULL);
+          sub = lookup_dir (index, path);
+          if (sub != NO_DIR)
+            remove_dir (index, sub);
+          g_free (path);
+        }
+    }
+
+  g_array_set_size (dir->entries, 0);
+  index->changed = TRUE;
+}
+
+static void
+remove_dir (GtkFileIndex *index,
+            guint         i)
+{
+  IndexDir *dir = get_dir (index, i);
+
+  dir->removed = TRUE;
+  g_hash_table_remove (index->dir_by_path, dir->path);
+  remove_entries (index, i, TRUE);
+}
+
+static gboolean
+get_mtime (const gchar *path,
+           gint64      *mtime)
+{
+  GStatBuf buf;
+
+  if (g_stat (path, &buf) != 0 || !S_ISDIR (buf.st_mode))
+    return FALSE;
+
+  *mtime = buf.st_mtime;
+
+  return TRUE;
+}
+
+/* Replaces the entries of a directory with what is there now. New
+ * subdirectories are queued to be scanned; subdirectories that are
+ * gone are removed with everything below them.
+ */
+static void
+scan_dir (GtkFileIndex *index,
+          guint         i,
+          GQueue       *pending,
+          GCancellable *cancellable)
+{
+  IndexDir *dir = get_dir (index, i);
+  GHashTable *old_subdirs;
+  GHashTableIter iter;
+  GFileEnumerator *enumerator;
+  GFileInfo *info;
+  GFile *file;
+  IndexEntry *entry;
+  const gchar *name;
+  gboolean is_dir;
+  gint64 mtime;
+  gchar *path;
+  guint j, sub;
+
+  if (!get_mtime (dir->path, &mtime))
+    {
+      remove_dir (index, i);
+      return;
+    }
+
+  old_subdirs = g_hash_table_new_full (g_str_hash, g_str_equal, g_free, NULL);
+  for (j = 0; j < dir->entries->len; j++)
+    {
+      entry = get_entry (index, g_array_index (dir->entries, guint, j));
+      if (entry->is_dir)
+        g_hash_table_add (old_subdirs, g_strdup (entry->name));
+    }
+
+  remove_entries (index, i, FALSE);
+  dir->mtime = mtime;
+
+  file = g_file_new_for_path (dir->path);
+  enumerator = g_file_enumerate_children (file,
+                                          SCAN_ATTRIBUTES,
+                                          G_FILE_QUERY_INFO_NOFOLLOW_SYMLINKS,
+                                          cancellable, NULL);
+  g_object_unref (file);
+
+  while (enumerator &&
+         g_file_enumerator_iterate (enumerator, &info, NULL, cancellable, NULL) &&
+         info != NULL)
+    {
+      if (g_file_info_get_is_hidden (info))
+        continue;
+
+      name = g_file_info_get_name (info);
+      is_dir = g_file_info_get_file_type (info) == G_FILE_TYPE_DIRECTORY;
+
+      add_entry (index, i, name, is_dir);
+
+      if (is_dir && !g_hash_table_remove (old_subdirs, name))
+        {
+          path = g_build_filename (dir->path, name, NULL);
+          sub = ensure_dir (index, path);
+          get_dir (index, sub)->mtime = -1;
+          g_queue_push_tail (pending, GUINT_TO_POINTER (sub));
+          g_free (path);
+        }
+    }
+
+  g_clear_object (&enumerator);
+
+  g_hash_table_iter_init (&iter, old_subdirs);
+  while (g_hash_table_iter_next (&iter, (gpointer *) &name, NULL))
+    {
+      path = g_build_filename (dir->path, name, NULL);
+      sub = lookup_dir (index, path);
+      if (sub != NO_DIR)
+        remove_dir (index, sub);
+      g_free (path);
+    }
+
+  g_hash_table_unref (old_subdirs);
+}
+
+static void
+scan_pending (GtkFileIndex *index,
+              GQueue       *pending,
+              GCancellable *cancellable)
+{
+  guint i;
+
+  /* Directories left over when cancelled still have an mtime of -1,
+   * so the next check picks them up again */
+  while (!g_queue_is_empty (pending) &&
+         !g_cancellable_is_cancelled (cancellable))
+    {
+      i = GPOINTER_TO_UINT (g_queue_pop_head (pending));
+      if (!get_dir (index, i)->removed)
+        scan_dir (index, i, pending, cancellable);
+    }
+
+  g_queue_clear (pending);
+}
+
+static void
+queue_dirty (GtkFileIndex *index,
+             GQueue       *pending)
+{
+  GHashTable *dirty;
+  GHashTableIter iter;
+  const gchar *path;
+  guint i;
+
+  g_mutex_lock (&index->dirty_lock);
+  dirty = index->dirty;
+  index->dirty = g_hash_table_new_full (g_str_hash, g_str_equal, g_free, NULL);
+  g_mutex_unlock (&index->dirty_lock);
+
+  g_hash_table_iter_init (&iter, dirty);
+  while (g_hash_table_iter_next (&iter, (gpointer *) &path, NULL))
+    {
+      i = lookup_dir (index, path);
+      if (i != NO_DIR)
+        g_queue_push_tail (pending, GUINT_TO_POINTER (i));
+    }
+
+  g_hash_table_unref (dirty);
+}
+
+static void
+queue_outdated (GtkFileIndex *index,
+                GQueue       *pending)
+{
+  IndexDir *dir;
+  gint64 mtime;
+  guint i, n;
+
+  n = index->dirs->len;
+  for (i = 0; i < n; i++)
+    {
+      dir = get_dir (index, i);
+      if (dir->removed)
+        continue;
+
+      if (!get_mtime (dir->path, &mtime))
+        remove_dir (index, i);
+      else if (mtime != dir->mtime)
+        g_queue_push_tail (pending, GUINT_TO_POINTER (i));
+    }
+}
+
+static void
+rebuild_trigrams (GtkFileIndex *index)
+{
+  IndexEntry *entry;
+  guint i;
+
+  g_hash_table_remove_all (index->trigrams);
+
+  for (i = 0; i < index->entries->len; i++)
+    {
+      entry = get_entry (index, i);
+      add_trigrams (index, entry->key ? entry->key : entry->name, i);
+    }
+}
+
+/* Drops removed directories and entries, renumbering the rest */
+static void
+compact (GtkFileIndex *index)
+{
+  GPtrArray *dirs;
+  GArray *entries;
+  IndexDir *dir;
+  IndexEntry *entry;
+  guint i, j, *id;
+
+  if (index->n_removed == 0 ||
+      index->n_removed < index->entries->len / 2)
+    return;
+
+  dirs = g_ptr_array_new_with_free_func ((GDestroyNotify) index_dir_free);
+  entries = g_array_new (FALSE, FALSE, sizeof (IndexEntry));
+  g_hash_table_remove_all (index->dir_by_path);
+
+  for (i = 0; i < index->dirs->len; i++)
+    {
+      dir = get_dir (index, i);
+      if (dir->removed)
+        {
+          index_dir_free (dir);
+          continue;
+        }
+
+      g_ptr_array_add (dirs, dir);
+      g_hash_table_insert (index->dir_by_path, dir->path, GUINT_TO_POINTER (dirs->len));
+
+      for (j = 0; j < dir->entries->len; j++)
+        {
+          id = &g_array_index (dir->entries, guint, j);
+          entry = get_entry (index, *id);
+          entry->dir = dirs->len - 1;
+          g_array_append_vals (entries, entry, 1);
+          /* Now owned by the new array */
+          entry->name = NULL;
+          entry->key = NULL;
+          *id = entries->len - 1;
+        }
+    }
+
+  for (i = 0; i < index->entries->len; i++)
+    index_entry_clear (get_entry (index, i));
+
+  /* All directories were either moved or freed above */
+  g_ptr_array_set_free_func (index->dirs, NULL);
+  g_ptr_array_unref (index->dirs);
+  g_array_unref (index->entries);
+  index->dirs = dirs;
+  index->entries = entries;
+  index->n_removed = 0;
+
+  rebuild_trigrams (index);
+}
+
+static void
+load (GtkFileIndex *index)
+{
+  GMappedFile *file;
+  GBytes *bytes;
+  GVariant *variant, *dirs, *children;
+  GVariantIter iter, child_iter;
+  const gchar *root, *relative, *name;
+  gboolean is_dir;
+  gint64 mtime;
+  guint32 version;
+  gchar *path, *child_path;
+  guint i;
+
+  file = g_mapped_file_new (index->cache_file, FALSE, NULL);
+  if (file == NULL)
+    return;
+
+  bytes = g_mapped_file_get_bytes (file);
+  g_mapped_file_unref (file);
+
+  variant = g_variant_new_from_bytes (G_VARIANT_TYPE (INDEX_FORMAT), bytes, FALSE);
+  g_bytes_unref (bytes);
+
+  /* The version also catches files written with another byte order */
+  g_variant_get (variant, "(u&s@a(sxa(sb)))", &version, &root, &dirs);
+  if (version != INDEX_VERSION || strcmp (root, index->root) != 0)
+    goto out;
+
+  g_variant_iter_init (&iter, dirs);
+  while (g_variant_iter_next (&iter, "(&sx@a(sb))", &relative, &mtime, &children))
+    {
+      path = g_build_filename (index->root, relative, NULL);
+      i = ensure_dir (index, path);
+      get_dir (index, i)->mtime = mtime;
+
+      g_variant_iter_init (&child_iter, children);
+      while (g_variant_iter_next (&child_iter, "(&sb)", &name, &is_dir))
+        {
+          add_entry (index, i, name, is_dir);
+
+          /* In case the file lacks it, it gets scanned at the next check */
+          if (is_dir)
+            {
+              child_path = g_build_filename (path, name, NULL);
+              ensure_dir (index, child_path);
+              g_free (child_path);
+            }
+        }
+
+      g_variant_unref (children);
+      g_free (path);
+    }
+
+out:
+  g_variant_unref (dirs);
+  g_variant_unref (variant);
+}
+
+static void
+save (GtkFileIndex *index)
+{
+  GVariantBuilder builder, children;
+  GVariant *variant;
+  IndexDir *dir;
+  IndexEntry *entry;
+  const gchar *relative;
+  gchar *cache_dir;
+  gsize root_len;
+  guint i, j;
+
+  root_len = strlen (index->root);
+
+  g_variant_builder_init (&builder, G_VARIANT_TYPE ("a(sxa(sb))"));
+
+  for (i = 0; i < index->dirs->len; i++)
+    {
+      dir = get_dir (index, i);
+      if (dir->removed)
+        continue;
+
+      relative = dir->path + root_len;
+      while (*relative == G_DIR_SEPARATOR)
+        relative++;
+
+      g_variant_builder_init (&children, G_VARIANT_TYPE ("a(sb)"));
+      for (j = 0; j < dir->entries->len; j++)
+        {
+          entry = get_entry (index, g_array_index (dir->entries, guint, j));
+          g_variant_builder_add (&children, "(sb)", entry->name, (gboolean) entry->is_dir);
+        }
+
+      g_variant_builder_add (&builder, "(sxa(sb))", relative, dir->mtime, &children);
+    }
+
+  variant = g_variant_new ("(usa(sxa(sb)))", INDEX_VERSION, index->root, &builder);
+  g_variant_ref_sink (variant);
+
+  cache_dir = g_path_get_dirname (index->cache_file);
+  g_mkdir_with_parents (cache_dir, 0700);
+  g_free (cache_dir);
+
+  g_file_set_contents (index->cache_file,
+                       g_variant_get_data (variant),
+                       g_variant_get_size (variant),
+                       NULL);
+
+  g_variant_unref (variant);
+
+  index->changed = FALSE;
+}
+
+static void
+refresh (GtkFileIndex *index,
+         GCancellable *cancellable)
+{
+  GQueue pending = G_QUEUE_INIT;
+  gint64 now;
+
+  if (!index->loaded)
+    {
+      load (index);
+      index->loaded = TRUE;
+    }
+
+  /* Also brings the root back if it was removed at some point */
+  ensure_dir (index, index->root);
+
+  now = g_get_monotonic_time ();
+  if (index->last_check == 0 || now - index->last_check > CHECK_INTERVAL)
+    {
+      queue_outdated (index, &pending);
+      index->last_check = now;
+    }
+
+  queue_dirty (index, &pending);
+  scan_pending (index, &pending, cancellable);
+
+  compact (index);
+
+  if (index->changed && !g_cancellable_is_cancelled (cancellable))
+    save (index);
+}
+
+static gboolean
+in_location (const gchar *path,
+             const gchar *location,
+             gsize        location_len,
+             gboolean     recursive)
+{
+  if (strcmp (path, location) == 0)
+    return TRUE;
+
+  return recursive &&
+         strncmp (path, location, location_len) == 0 &&
+         (path[location_len] == G_DIR_SEPARATOR ||
+          (location_len > 0 && location[location_len - 1] == G_DIR_SEPARATOR));
+}
+
+static GList *
+lookup (GtkFileIndex *index,
+        const gchar  *text,
+        const gchar  *location,
+        gboolean      recursive,
+        GCancellable *cancellable)
+{
+  GArray *best, *postings;
+  IndexEntry *entry;
+  IndexDir *dir;
+  const guchar *s;
+  const gchar *key;
+  gchar *prepared, **words, *path;
+  GList *files;
+  gsize location_len, len;
+  guint32 trigram;
+  guint i, j, n, id;
+  gboolean found;
+
+  prepared = gtk_query_prepare_string (text);
+  words = g_strsplit (prepared, " ", -1);
+  g_free (prepared);
+
+  location_len = strlen (location);
+  files = NULL;
+  best = NULL;
+
+  for (i = 0; words[i]; i++)
+    {
+      s = (const guchar *) words[i];
+      len = strlen (words[i]);
+
+      for (j = 0; j + 3 <= len; j++)
+        {
+          trigram = (s[j] << 16) | (s[j + 1] << 8) | s[j + 2];
+          postings = g_hash_table_lookup (index->trigrams, GUINT_TO_POINTER (trigram));
+          if (postings == NULL)
+            goto out;
+
+          if (best == NULL || postings->len < best->len)
+            best = postings;
+        }
+    }
+
+  /* Without words of three bytes or more, look at everything */
+  n = best ? best->len : index->entries->len;
+
+  for (i = 0; i < n; i++)
+    {
+      if (i % 4096 == 0 && g_cancellable_is_cancelled (cancellable))
+        break;
+
+      id = best ? g_array_index (best, guint, i) : i;
+      entry = get_entry (index, id);
+      if (entry->removed)
+        continue;
+
+      key = entry->key ? entry->key : entry->name;
+      found = TRUE;
+      for (j = 0; words[j]; j++)
+        {
+          if (strstr (key, words[j]) == NULL)
+            {
+              found = FALSE;
+              break;
+            }
+        }
+
+      if (!found)
+        continue;
+
+      dir = get_dir (index, entry->dir);
+      if (!in_location (dir->path, location, location_len, recursive))
+        continue;
+
+      path = g_build_filename (dir->path, entry->name, NULL);
+      files = g_list_prepend (files, g_file_new_for_path (path));
+      g_free (path);
+    }
+
+out:
+  g_strfreev (words);
+
+  return files;
+}
+
+static void
+monitor_changed (GFileMonitor      *monitor,
+                 GFile             *file,
+                 GFile             *other_file,
+                 GFileMonitorEvent  event,
+                 GtkFileIndex      *index)
+{
+  GFile *parent;
+
+  switch (event)
+    {
+    case G_FILE_MONITOR_EVENT_CREATED:
+    case G_FILE_MONITOR_EVENT_DELETED:
+    case G_FILE_MONITOR_EVENT_MOVED:
+    case G_FILE_MONITOR_EVENT_RENAMED:
+    case G_FILE_MONITOR_EVENT_MOVED_IN:
+    case G_FILE_MONITOR_EVENT_MOVED_OUT:
+      parent = g_file_get_parent (file);
+      if (parent)
+        {
+          g_mutex_lock (&index->dirty_lock);
+          g_hash_table_add (index->dirty, g_file_get_path (parent));
+          g_mutex_unlock (&index->dirty_lock);
+          g_object_unref (parent);
+        }
+      break;
+
+    default:
+      break;
+    }
+}
+
+/*
+ * _gtk_file_index_new:
+ * @root: an absolute path
+ * @cache_file: the file to save the index in
+ *
+ * Creates an index of the files below @root that is not shared.
+ * Use _gtk_file_index_get() instead, unless the index should be
+ * kept somewhere else.
+ *
+ * Returns: (transfer full): a new index, free it with
+ *     _gtk_file_index_free()
+ */
+GtkFileIndex *
+_gtk_file_index_new (const gchar *root,
+                     const gchar *cache_file)
+{
+  GtkFileIndex *index;
+
+  g_return_val_if_fail (g_path_is_absolute (root), NULL);
+  g_return_val_if_fail (cache_file != NULL, NULL);
+
+  index = g_new0 (GtkFileIndex, 1);
+  index->root = g_strdup (root);
+  index->cache_file = g_strdup (cache_file);
+
+  g_mutex_init (&index->lock);
+  index->dirs = g_ptr_array_new_with_free_func ((GDestroyNotify) index_dir_free);
+  index->dir_by_path = g_hash_table_new (g_str_hash, g_str_equal);
+  index->entries = g_array_new (FALSE, FALSE, sizeof (IndexEntry));
+  index->trigrams = g_hash_table_new_full (NULL, NULL, NULL, (GDestroyNotify) g_array_unref);
+
+  g_mutex_init (&index->dirty_lock);
+  index->dirty = g_hash_table_new_full (g_str_hash, g_str_equal, g_free, NULL);
+
+  return index;
+}
+
+void
+_gtk_file_index_free (GtkFileIndex *index)
+{
+  guint i;
+
+  for (i = 0; i < index->entries->len; i++)
+    index_entry_clear (get_entry (index, i));
+
+  g_array_unref (index->entries);
+  g_hash_table_unref (index->dir_by_path);
+  g_ptr_array_unref (index->dirs);
+  g_hash_table_unref (index->trigrams);
+  g_hash_table_unref (index->dirty);
+  g_clear_pointer (&index->monitors, g_ptr_array_unref);
+
+  g_mutex_clear (&index->lock);
+  g_mutex_clear (&index->dirty_lock);
+
+  g_free (index->root);
+  g_free (index->cache_file);
+  g_free (index);
+}
+
+/*
+ * _gtk_file_index_get:
+ * @root: an absolute path
+ *
+ * Returns the index of the files below @root. Indexes are shared and
+ * stay around until the application exits.
+ *
+ * Returns: (transfer none): the index for @root
+ */
+GtkFileIndex *
+_gtk_file_index_get (const gchar *root)
+{
+  GtkFileIndex *index;
+  gchar *checksum, *cache_file;
+
+  g_return_val_if_fail (g_path_is_absolute (root), NULL);
+
+  G_LOCK (indexes);
+
+  if (indexes == NULL)
+    indexes = g_hash_table_new (g_str_hash, g_str_equal);
+
+  index = g_hash_table_lookup (indexes, root);
+  if (index == NULL)
+    {
+      checksum = g_compute_checksum_for_string (G_CHECKSUM_SHA1, root, -1);
+      cache_file = g_build_filename (g_get_user_cache_dir (), "gtk-3.0", "file-index", checksum, NULL);
+      index = _gtk_file_index_new (root, cache_file);
+      g_free (cache_file);
+      g_free (checksum);
+
+      g_hash_table_insert (indexes, index->root, index);
+    }
+
+  G_UNLOCK (indexes);
+
+  return index;
+}
+
+const gchar *
+_gtk_file_index_get_root (GtkFileIndex *index)
+{
+  return index->root;
+}
+
+/*
+ * _gtk_file_index_refresh:
+ * @index: a #GtkFileIndex
+ * @cancellable: (allow-none): a #GCancellable
+ *
+ * Loads the index, or builds it if there is none yet, and brings it
+ * up to date. This blocks, so call it from a thread.
+ */
+void
+_gtk_file_index_refresh (GtkFileIndex *index,
+                         GCancellable *cancellable)
+{
+  g_mutex_lock (&index->lock);
+  refresh (index, cancellable);
+  g_mutex_unlock (&index->lock);
+}
+
+/*
+ * _gtk_file_index_lookup:
+ * @index: a #GtkFileIndex
+ * @text: the text to search for
+ * @location: the absolute path of the directory to search in
+ * @recursive: whether to search in subdirectories of @location
+ * @cancellable: (allow-none): a #GCancellable
+ *
+ * Finds the files whose names match @text the way
+ * gtk_query_matches_string() does. Like _gtk_file_index_refresh(),
+ * which it calls first, this blocks.
+ *
+ * Returns: (transfer full) (element-type GFile): the matching files
+ */
+GList *
+_gtk_file_index_lookup (GtkFileIndex *index,
+                        const gchar  *text,
+                        const gchar  *location,
+                        gboolean      recursive,
+                        GCancellable *cancellable)
+{
+  GList *files;
+
+  g_mutex_lock (&index->lock);
+  refresh (index, cancellable);
+  files = lookup (index, text, location, recursive, cancellable);
+  g_mutex_unlock (&index->lock);
+
+  return files;
+}
+
+/*
+ * _gtk_file_index_ensure_monitors:
+ * @index: a #GtkFileIndex
+ *
+ * Starts monitoring the directories closest to the root, so changes
+ * there show up in the next lookup. Call this from the main thread,
+ * after the index has been refreshed.
+ */
+void
+_gtk_file_index_ensure_monitors (GtkFileIndex *index)
+{
+  GFileMonitor *monitor;
+  GFile *file;
+  IndexDir *dir;
+  guint i;
+
+  if (index->monitors)
+    return;
+
+  /* Don't block the main thread on a refresh */
+  if (!g_mutex_trylock (&index->lock))
+    return;
+
+  if (index->loaded)
+    {
+      index->monitors = g_ptr_array_new_with_free_func (g_object_unref);
+
+      for (i = 0; i < index->dirs->len && index->monitors->len < MAX_MONITORS; i++)
+        {
+          dir = get_dir (index, i);
+          if (dir->removed)
+            continue;
+
+          file = g_file_new_for_path (dir->path);
+          monitor = g_file_monitor_directory (file, G_FILE_MONITOR_WATCH_MOVES, NULL, NULL);
+          g_object_unref (file);
+
+          if (monitor == NULL)
+            continue;
+
+          g_signal_connect (monitor, "changed", G_CALLBACK (monitor_changed), index);
+          g_ptr_array_add (index->monitors, monitor);
+        }
+    }
+
+  g_mutex_unlock (&index->lock);
+}
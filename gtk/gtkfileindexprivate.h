@@ -0,0 +1,44 @@
+/* gtkfileindexprivate.h
+ * Copyright (C) 2016 Red Hat, Inc.
+ *
+ * This library is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Library General Public
+ * License as published by the Free Software Foundation; either
+ * version 2 of the License, or (at your option) any later version.
+ *
+ * This library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Library General Public License for more details.
+ *
+ * You should have received a copy of the GNU Library General Public
+ * License along with this library. If not, see <http://www.gnu.org/licenses/>.
+ */
+#ifndef __GTK_FILE_INDEX_PRIVATE_H__
+#define __GTK_FILE_INDEX_PRIVATE_H__
+
+#include <gio/gio.h>
+
+G_BEGIN_DECLS
+
+typedef struct _GtkFileIndex GtkFileIndex;
+
+GtkFileIndex * _gtk_file_index_new             (const gchar   *root,
+                                                const gchar   *cache_file);
+void           _gtk_file_index_free            (GtkFileIndex  *index);
+GtkFileIndex * _gtk_file_index_get             (const gchar   *root);
+const gchar  * _gtk_file_index_get_root        (GtkFileIndex  *index);
+
+void           _gtk_file_index_refresh         (GtkFileIndex  *index,
+                                                GCancellable  *cancellable);
+GList        * _gtk_file_index_lookup          (GtkFileIndex  *index,
+                                                const gchar   *text,
+                                                const gchar   *location,
+                                                gboolean       recursive,
+                                                GCancellable  *cancellable);
+
+void           _gtk_file_index_ensure_monitors (GtkFileIndex  *index);
+
+G_END_DECLS
+
+#endif /* __GTK_FILE_INDEX_PRIVATE_H__ */
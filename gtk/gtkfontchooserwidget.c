@@ -105,6 +105,18 @@ struct _GtkFontChooserWidgetPrivate
   GDestroyNotify    filter_data_destroy;
 
   guint last_fontconfig_timestamp;
+
+  /* Casefolded words of the search entry */
+  gchar **search_terms;
+
+  /* Families still to be added to the model */
+  PangoFontFamily **load_families;
+  gint n_load_families;
+  gint load_position;
+  guint load_id;
+
+  /* in pango units, 0 if it needs to be computed */
+  gint preview_text_height;
 };
 
 /* This is the initial fixed height and the top padding of the preview entry */
@@ -122,9 +134,13 @@ enum {
   FAMILY_COLUMN,
   FACE_COLUMN,
   FONT_DESC_COLUMN,
-  PREVIEW_TITLE_COLUMN
+  PREVIEW_TITLE_COLUMN,
+  SEARCH_KEY_COLUMN
 };
 
+/* How long to spend adding fonts to the list per main loop iteration */
+#define LOAD_TIME_SLICE (8 * G_TIME_SPAN_MILLISECOND)
+
 static void gtk_font_chooser_widget_set_property         (GObject         *object,
                                                           guint            prop_id,
                                                           const GValue    *value,
@@ -133,6 +149,7 @@ static void gtk_font_chooser_widget_get_property         (GObject         *objec
                                                           guint            prop_id,
                                                           GValue          *value,
                                                           GParamSpec      *pspec);
+static void gtk_font_chooser_widget_dispose              (GObject         *object);
 static void gtk_font_chooser_widget_finalize             (GObject         *object);
 
 static void gtk_font_chooser_widget_screen_changed       (GtkWidget       *widget,
@@ -308,6 +325,16 @@ static void
 text_changed_cb (GtkEntry             *entry,
                  GtkFontChooserWidget *fc)
 {
+  GtkFontChooserWidgetPrivate *priv = fc->priv;
+  gchar *casefold;
+
+  g_clear_pointer (&priv->search_terms, g_strfreev);
+
+  casefold = g_utf8_casefold (gtk_entry_get_text (entry), -1);
+  if (casefold[0] != '\0')
+    priv->search_terms = g_strsplit (casefold, " ", 0);
+  g_free (casefold);
+
   gtk_font_chooser_widget_refilter_font_list (fc);
 }
 
@@ -582,6 +609,7 @@ gtk_font_chooser_widget_class_init (GtkFontChooserWidgetClass *klass)
   widget_class->screen_changed = gtk_font_chooser_widget_screen_changed;
   widget_class->style_updated = gtk_font_chooser_widget_style_updated;
 
+  gobject_class->dispose = gtk_font_chooser_widget_dispose;
   gobject_class->finalize = gtk_font_chooser_widget_finalize;
   gobject_class->set_property = gtk_font_chooser_widget_set_property;
   gobject_class->get_property = gtk_font_chooser_widget_get_property;
@@ -688,15 +716,121 @@ cmp_families (const void *a,
   return g_utf8_collate (a_name, b_name);
 }
 
+static void
+add_family (GtkFontChooserWidget *fontchooser,
+            PangoFontFamily      *family)
+{
+  GtkListStore *list_store = GTK_LIST_STORE (fontchooser->priv->model);
+  GtkTreeIter     iter;
+  PangoFontFace **faces;
+  int             j, n_faces;
+  const gchar    *fam_name = pango_font_family_get_name (family);
+
+  pango_font_family_list_faces (family, &faces, &n_faces);
+
+  for (j = 0; j < n_faces; j++)
+    {
+      GtkDelayedFontDescription *desc;
+      const gchar *face_name;
+      gchar *family_and_face, *search_key;
+
+      face_name = pango_font_face_get_face_name (faces[j]);
+
+      family_and_face = g_strconcat (fam_name, " ", face_name, NULL);
+      search_key = g_utf8_casefold (family_and_face, -1);
+      desc = gtk_delayed_font_description_new (faces[j]);
+
+      gtk_list_store_insert_with_values (list_store, &iter, -1,
+                                         FAMILY_COLUMN, family,
+                                         FACE_COLUMN, faces[j],
+                                         FONT_DESC_COLUMN, desc,
+                                         PREVIEW_TITLE_COLUMN, family_and_face,
+                                         SEARCH_KEY_COLUMN, search_key,
+                                         -1);
+
+      g_free (family_and_face);
+      g_free (search_key);
+      gtk_delayed_font_description_unref (desc);
+    }
+
+  g_free (faces);
+}
+
+static void
+gtk_font_chooser_widget_loading_done (GtkFontChooserWidget *fontchooser)
+{
+  GtkFontChooserWidgetPrivate *priv = fontchooser->priv;
+
+  g_clear_pointer (&priv->load_families, g_free);
+  priv->n_load_families = 0;
+  priv->load_position = 0;
+
+  if (priv->load_id)
+    {
+      g_source_remove (priv->load_id);
+      priv->load_id = 0;
+    }
+
+  /* now make sure the font list looks right */
+  if (!gtk_font_chooser_widget_find_font (fontchooser, priv->font_desc, &priv->font_iter))
+    memset (&priv->font_iter, 0, sizeof (GtkTreeIter));
+
+  gtk_font_chooser_widget_ensure_selection (fontchooser);
+}
+
+/* Returns whether there are more families to add */
+static gboolean
+load_fonts_slice (GtkFontChooserWidget *fontchooser)
+{
+  GtkFontChooserWidgetPrivate *priv = fontchooser->priv;
+  gint64 end_time;
+
+  end_time = g_get_monotonic_time () + LOAD_TIME_SLICE;
+
+  while (priv->load_position < priv->n_load_families &&
+         g_get_monotonic_time () < end_time)
+    add_family (fontchooser, priv->load_families[priv->load_position++]);
+
+  return priv->load_position < priv->n_load_families;
+}
+
+static gboolean
+load_fonts_idle (gpointer data)
+{
+  GtkFontChooserWidget *fontchooser = data;
+
+  if (load_fonts_slice (fontchooser))
+    return G_SOURCE_CONTINUE;
+
+  fontchooser->priv->load_id = 0;
+  gtk_font_chooser_widget_loading_done (fontchooser);
+
+  return G_SOURCE_REMOVE;
+}
+
+/* Adds the fonts that are still missing from the list right away */
+static void
+gtk_font_chooser_widget_finish_loading (GtkFontChooserWidget *fontchooser)
+{
+  GtkFontChooserWidgetPrivate *priv = fontchooser->priv;
+
+  if (priv->load_families == NULL)
+    return;
+
+  while (priv->load_position < priv->n_load_families)
+    add_family (fontchooser, priv->load_families[priv->load_position++]);
+
+  gtk_font_chooser_widget_loading_done (fontchooser);
+}
+
 static void
 gtk_font_chooser_widget_load_fonts (GtkFontChooserWidget *fontchooser,
                                     gboolean              force)
 {
   GtkFontChooserWidgetPrivate *priv = fontchooser->priv;
   GtkListStore *list_store;
-  gint n_families, i;
+  gint n_families;
   PangoFontFamily **families;
-  gchar *family_and_face;
   guint fontconfig_timestamp;
   gboolean need_reload;
   PangoFontMap *font_map;
@@ -731,47 +865,27 @@ gtk_font_chooser_widget_load_fonts (GtkFontChooserWidget *fontchooser,
   gtk_list_store_clear (list_store);
   g_signal_handlers_unblock_by_func (priv->family_face_list, cursor_changed_cb, fontchooser);
 
-  /* Iterate over families and faces */
-  for (i = 0; i < n_families; i++)
-    {
-      GtkTreeIter     iter;
-      PangoFontFace **faces;
-      int             j, n_faces;
-      const gchar    *fam_name = pango_font_family_get_name (families[i]);
-
-      pango_font_family_list_faces (families[i], &faces, &n_faces);
-
-      for (j = 0; j < n_faces; j++)
-        {
-          GtkDelayedFontDescription *desc;
-          const gchar *face_name;
-
-          face_name = pango_font_face_get_face_name (faces[j]);
-
-          family_and_face = g_strconcat (fam_name, " ", face_name, NULL);
-          desc = gtk_delayed_font_description_new (faces[j]);
-
-          gtk_list_store_insert_with_values (list_store, &iter, -1,
-                                             FAMILY_COLUMN, families[i],
-                                             FACE_COLUMN, faces[j],
-                                             FONT_DESC_COLUMN, desc,
-                                             PREVIEW_TITLE_COLUMN, family_and_face,
-                                             -1);
-
-          g_free (family_and_face);
-          gtk_delayed_font_description_unref (desc);
-        }
+  /* Listing the faces of every family and filling the list takes
+   * a while with many fonts, so it is done a slice at a time. The
+   * font map is not thread-safe, so this happens in the main thread.
+   */
+  g_free (priv->load_families);
+  priv->load_families = families;
+  priv->n_load_families = n_families;
+  priv->load_position = 0;
 
-      g_free (faces);
+  /* Fill the visible part of the list before the first frame */
+  if (!load_fonts_slice (fontchooser))
+    {
+      gtk_font_chooser_widget_loading_done (fontchooser);
+      return;
     }
 
-  g_free (families);
-
-  /* now make sure the font list looks right */
-  if (!gtk_font_chooser_widget_find_font (fontchooser, priv->font_desc, &priv->font_iter))
-    memset (&priv->font_iter, 0, sizeof (GtkTreeIter));
-
-  gtk_font_chooser_widget_ensure_selection (fontchooser);
+  if (priv->load_id == 0)
+    {
+      priv->load_id = gdk_threads_add_idle (load_fonts_idle, fontchooser);
+      g_source_set_name_by_id (priv->load_id, "[gtk+] load_fonts_idle");
+    }
 }
 
 static gboolean
@@ -781,9 +895,7 @@ visible_func (GtkTreeModel *model,
 {
   GtkFontChooserWidgetPrivate *priv = user_data;
   gboolean result = TRUE;
-  const gchar *search_text;
-  gchar **split_terms;
-  gchar *font_name, *font_name_casefold;
+  gchar *search_key;
   guint i;
 
   if (priv->filter_func != NULL)
@@ -806,33 +918,23 @@ visible_func (GtkTreeModel *model,
     }
 
   /* If there's no filter string we show the item */
-  search_text = gtk_entry_get_text (GTK_ENTRY (priv->search_entry));
-  if (strlen (search_text) == 0)
+  if (priv->search_terms == NULL)
     return TRUE;
 
   gtk_tree_model_get (model, iter,
-                      PREVIEW_TITLE_COLUMN, &font_name,
+                      SEARCH_KEY_COLUMN, &search_key,
                       -1);
 
-  if (font_name == NULL)
+  if (search_key == NULL)
     return FALSE;
 
-  split_terms = g_strsplit (search_text, " ", 0);
-  font_name_casefold = g_utf8_casefold (font_name, -1);
-
-  for (i = 0; split_terms[i] && result; i++)
+  for (i = 0; priv->search_terms[i] && result; i++)
     {
-      gchar* term_casefold = g_utf8_casefold (split_terms[i], -1);
-
-      if (!strstr (font_name_casefold, term_casefold))
+      if (!strstr (search_key, priv->search_terms[i]))
         result = FALSE;
-
-      g_free (term_casefold);
     }
 
-  g_free (font_name_casefold);
-  g_free (font_name);
-  g_strfreev (split_terms);
+  g_free (search_key);
 
   return result;
 }
@@ -844,13 +946,19 @@ gtk_font_chooser_widget_get_preview_text_height (GtkFontChooserWidget *fontchoos
   GtkWidget *treeview = fontchooser->priv->family_face_list;
   double dpi, font_size;
 
+  /* This is needed for every row that is drawn */
+  if (fontchooser->priv->preview_text_height != 0)
+    return fontchooser->priv->preview_text_height;
+
   dpi = gdk_screen_get_resolution (gtk_widget_get_screen (treeview));
   gtk_style_context_get (gtk_widget_get_style_context (treeview),
                          gtk_widget_get_state_flags (treeview),
                          "font-size", &font_size,
                          NULL);
 
-  return (dpi < 0.0 ? 96.0 : dpi) / 72.0 * PANGO_SCALE_X_LARGE * font_size * PANGO_SCALE;
+  fontchooser->priv->preview_text_height = (dpi < 0.0 ? 96.0 : dpi) / 72.0 * PANGO_SCALE_X_LARGE * font_size * PANGO_SCALE;
+
+  return fontchooser->priv->preview_text_height;
 }
 
 static PangoAttrList *
@@ -932,6 +1040,7 @@ gtk_font_chooser_widget_set_cell_size (GtkFontChooserWidget *fontchooser)
   PangoAttrList *attrs;
   GtkRequisition size;
 
+  priv->preview_text_height = 0;
   gtk_cell_renderer_set_fixed_size (priv->family_face_cell, -1, -1);
 
   attrs = gtk_font_chooser_widget_get_preview_attributes (fontchooser, 
@@ -952,6 +1061,23 @@ gtk_font_chooser_widget_set_cell_size (GtkFontChooserWidget *fontchooser)
   gtk_cell_renderer_set_fixed_size (priv->family_face_cell, size.width, size.height);
 }
 
+static void
+gtk_font_chooser_widget_dispose (GObject *object)
+{
+  GtkFontChooserWidget *fontchooser = GTK_FONT_CHOOSER_WIDGET (object);
+  GtkFontChooserWidgetPrivate *priv = fontchooser->priv;
+
+  /* The model goes away with the template children */
+  if (priv->load_id)
+    {
+      g_source_remove (priv->load_id);
+      priv->load_id = 0;
+    }
+  g_clear_pointer (&priv->load_families, g_free);
+
+  G_OBJECT_CLASS (gtk_font_chooser_widget_parent_class)->dispose (object);
+}
+
 static void
 gtk_font_chooser_widget_finalize (GObject *object)
 {
@@ -968,6 +1094,8 @@ gtk_font_chooser_widget_finalize (GObject *object)
 
   g_clear_object (&priv->font_map);
 
+  g_strfreev (priv->search_terms);
+
   G_OBJECT_CLASS (gtk_font_chooser_widget_parent_class)->finalize (object);
 }
 
@@ -1061,6 +1189,7 @@ gtk_font_chooser_widget_screen_changed (GtkWidget *widget,
   if (previous_screen == gtk_widget_get_screen (widget))
     return;
 
+  fontchooser->priv->preview_text_height = 0;
   gtk_font_chooser_widget_load_fonts (fontchooser, FALSE);
 }
 
@@ -1070,7 +1199,8 @@ gtk_font_chooser_widget_style_updated (GtkWidget *widget)
   GtkFontChooserWidget *fontchooser = GTK_FONT_CHOOSER_WIDGET (widget);
 
   GTK_WIDGET_CLASS (gtk_font_chooser_widget_parent_class)->style_updated (widget);
- 
+
+  fontchooser->priv->preview_text_height = 0;
   gtk_font_chooser_widget_load_fonts (fontchooser, FALSE);
 }
 
@@ -1081,6 +1211,8 @@ gtk_font_chooser_widget_get_family (GtkFontChooser *chooser)
   GtkFontChooserWidgetPrivate *priv = fontchooser->priv;
   PangoFontFamily *family;
 
+  gtk_font_chooser_widget_finish_loading (fontchooser);
+
   if (!gtk_list_store_iter_is_valid (GTK_LIST_STORE (priv->model), &priv->font_iter))
     return NULL;
 
@@ -1099,6 +1231,8 @@ gtk_font_chooser_widget_get_face (GtkFontChooser *chooser)
   GtkFontChooserWidgetPrivate *priv = fontchooser->priv;
   PangoFontFace *face;
 
+  gtk_font_chooser_widget_finish_loading (fontchooser);
+
   if (!gtk_list_store_iter_is_valid (GTK_LIST_STORE (priv->model), &priv->font_iter))
     return NULL;
 
@@ -42,6 +42,7 @@ struct _GtkIconHelperPrivate {
 
   guint use_fallback : 1;
   guint force_scale_pixbuf : 1;
+  guint load_async : 1;
   guint rendered_surface_is_symbolic : 1;
 
   cairo_surface_t *rendered_surface;
@@ -49,6 +50,19 @@ struct _GtkIconHelperPrivate {
 
 G_DEFINE_TYPE_WITH_PRIVATE (GtkIconHelper, gtk_icon_helper, GTK_TYPE_CSS_GADGET)
 
+/* Icons being loaded in a thread, shared by all icon helpers so that
+ * every icon is only loaded once, no matter how many widgets (or rows)
+ * show it. Once loaded, the icon theme keeps the icon in its cache and
+ * the widgets waiting for it are redrawn.
+ */
+typedef struct {
+  GtkIconInfo *info;
+  GCancellable *cancellable;
+  GSList *widgets;
+} PendingLoad;
+
+static GHashTable *pending_loads = NULL;
+
 static void
 gtk_icon_helper_invalidate (GtkIconHelper *self)
 {
@@ -425,6 +439,85 @@ ensure_surface_for_icon_set (GtkIconHelper    *self,
   return surface;
 }
 
+static void
+pending_load_widget_finalized (gpointer  data,
+                               GObject  *where_the_object_was)
+{
+  PendingLoad *load = data;
+
+  load->widgets = g_slist_remove (load->widgets, where_the_object_was);
+
+  /* Nobody is going to show the icon anymore. Forget about the load,
+   * so that the next widget asking for the icon starts a new one
+   * instead of waiting for a load that will never redraw it.
+   */
+  if (load->widgets == NULL)
+    {
+      g_cancellable_cancel (load->cancellable);
+      if (g_hash_table_lookup (pending_loads, load->info) == load)
+        g_hash_table_remove (pending_loads, load->info);
+    }
+}
+
+static void
+pending_load_done (GObject      *source,
+                   GAsyncResult *result,
+                   gpointer      data)
+{
+  PendingLoad *load = data;
+  GdkPixbuf *pixbuf;
+  GSList *l;
+
+  pixbuf = gtk_icon_info_load_icon_finish (load->info, result, NULL);
+  if (g_hash_table_lookup (pending_loads, load->info) == load)
+    g_hash_table_remove (pending_loads, load->info);
+
+  for (l = load->widgets; l; l = l->next)
+    {
+      g_object_weak_unref (l->data, pending_load_widget_finalized, load);
+
+      /* The icon (or the error) is now cached, so
+       * loading it again won't block */
+      if (!g_cancellable_is_cancelled (load->cancellable))
+        gtk_widget_queue_draw (l->data);
+    }
+
+  g_clear_object (&pixbuf);
+  g_slist_free (load->widgets);
+  g_object_unref (load->cancellable);
+  g_object_unref (load->info);
+  g_slice_free (PendingLoad, load);
+}
+
+static void
+load_icon_info_async (GtkIconHelper *self,
+                      GtkIconInfo   *info)
+{
+  GtkWidget *widget;
+  PendingLoad *load;
+
+  if (pending_loads == NULL)
+    pending_loads = g_hash_table_new (NULL, NULL);
+
+  load = g_hash_table_lookup (pending_loads, info);
+  if (load == NULL || g_cancellable_is_cancelled (load->cancellable))
+    {
+      load = g_slice_new0 (PendingLoad);
+      load->info = g_object_ref (info);
+      load->cancellable = g_cancellable_new ();
+      g_hash_table_insert (pending_loads, info, load);
+
+      gtk_icon_info_load_icon_async (info, load->cancellable, pending_load_done, load);
+    }
+
+  widget = gtk_css_gadget_get_owner (GTK_CSS_GADGET (self));
+  if (g_slist_find (load->widgets, widget) == NULL)
+    {
+      load->widgets = g_slist_prepend (load->widgets, widget);
+      g_object_weak_ref (G_OBJECT (widget), pending_load_widget_finalized, load);
+    }
+}
+
 static cairo_surface_t *
 ensure_surface_for_gicon (GtkIconHelper    *self,
                           GtkCssStyle      *style,
@@ -455,6 +548,19 @@ ensure_surface_for_gicon (GtkIconHelper    *self,
     {
       symbolic = gtk_icon_info_is_symbolic (info);
 
+      /* Only non-symbolic icons are loaded in a thread; symbolic ones
+       * need to be recolored for the style anyway. The size must not
+       * depend on the icon so nothing has to be resized once it arrives.
+       */
+      if (priv->load_async && !symbolic &&
+          (priv->pixel_size != -1 || priv->force_scale_pixbuf) &&
+          !gtk_icon_info_is_loaded (info))
+        {
+          load_icon_info_async (self, info);
+          g_object_unref (info);
+          return NULL;
+        }
+
       if (symbolic)
         {
           GdkRGBA fg, success_color, warning_color, error_color;
@@ -924,6 +1030,19 @@ _gtk_icon_helper_set_force_scale_pixbuf (GtkIconHelper *self,
     }
 }
 
+gboolean
+_gtk_icon_helper_get_load_async (GtkIconHelper *self)
+{
+  return self->priv->load_async;
+}
+
+void
+_gtk_icon_helper_set_load_async (GtkIconHelper *self,
+                                 gboolean       load_async)
+{
+  self->priv->load_async = load_async;
+}
+
 void 
 _gtk_icon_helper_set_pixbuf_scale (GtkIconHelper *self,
 				   int scale)
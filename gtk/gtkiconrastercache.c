@@ -0,0 +1,213 @@
+/* gtkiconrastercache.c
+ * Copyright (C) 2016 Red Hat, Inc.
+ *
+ * This library is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Library General Public
+ * License as published by the Free Software Foundation; either
+ * version 2 of the License, or (at your option) any later version.
+ *
+ * This library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Library General Public License for more details.
+ *
+ * You should have received a copy of the GNU Library General Public
+ * License along with this library. If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include "config.h"
+
+#include "gtkiconrastercacheprivate.h"
+#include "gtkprivate.h"
+
+#include <string.h>
+#include <glib/gstdio.h>
+
+/* The raster cache keeps icons that were loaded and scaled by
+ * GtkIconTheme on disk, so that other processes (or the next run)
+ * can mmap them instead of decoding and scaling the image again.
+ *
+ * It is only used if GTK_ICON_RASTER_CACHE is set in the environment.
+ * Every icon is stored in its own file, named after a checksum of its
+ * key, in $XDG_CACHE_HOME/gtk-3.0/icon-raster-cache. Files are written
+ * atomically, so concurrent processes never see partial entries.
+ *
+ * The stamp passed by the icon theme changes whenever the theme
+ * directories change, which invalidates all entries made before.
+ */
+
+#define RASTER_CACHE_MAGIC "GtkRast1"
+#define RASTER_CACHE_BYTE_ORDER 0x01020304
+
+typedef struct {
+  gchar   magic[8];
+  guint32 byte_order;
+  guint32 key_length;
+  guint64 stamp;
+  gdouble scale;
+  guint32 width;
+  guint32 height;
+  guint32 rowstride;
+  guint32 n_channels;
+} RasterCacheHeader;
+
+#define PIXELS_OFFSET(key_length) ((sizeof (RasterCacheHeader) + (key_length) + 7) & ~7)
+
+static const gchar *
+get_cache_dir (void)
+{
+  static gchar *cache_dir = NULL;
+
+  if (g_once_init_enter (&cache_dir))
+    {
+      gchar *dir = NULL;
+
+      if (gtk_get_env_flag ("GTK_ICON_RASTER_CACHE"))
+        {
+          dir = g_build_filename (g_get_user_cache_dir (), "gtk-3.0", "icon-raster-cache", NULL);
+          if (g_mkdir_with_parents (dir, 0700) != 0)
+            {
+              g_free (dir);
+              dir = NULL;
+            }
+        }
+
+      /* An empty string means the cache is disabled */
+      g_once_init_leave (&cache_dir, dir ? dir : g_strdup (""));
+    }
+
+  return cache_dir[0] ? cache_dir : NULL;
+}
+
+static gchar *
+get_cache_file (const gchar *key)
+{
+  gchar *checksum, *path;
+
+  checksum = g_compute_checksum_for_string (G_CHECKSUM_SHA1, key, -1);
+  path = g_build_filename (get_cache_dir (), checksum, NULL);
+  g_free (checksum);
+
+  return path;
+}
+
+gboolean
+_gtk_icon_raster_cache_is_enabled (void)
+{
+  return get_cache_dir () != NULL;
+}
+
+static void
+free_mapped_file (guchar   *pixels,
+                  gpointer  data)
+{
+  g_mapped_file_unref (data);
+}
+
+GdkPixbuf *
+_gtk_icon_raster_cache_lookup (const gchar *key,
+                               guint64      stamp,
+                               gdouble     *scale)
+{
+  RasterCacheHeader header;
+  GMappedFile *file;
+  const gchar *contents;
+  gsize length, key_length, offset, n_bytes;
+  gchar *path;
+
+  if (!_gtk_icon_raster_cache_is_enabled ())
+    return NULL;
+
+  path = get_cache_file (key);
+  /* Map the file privately writable, so that nothing can
+   * write through the pixbuf into the shared file */
+  file = g_mapped_file_new (path, TRUE, NULL);
+  g_free (path);
+
+  if (file == NULL)
+    return NULL;
+
+  contents = g_mapped_file_get_contents (file);
+  length = g_mapped_file_get_length (file);
+  key_length = strlen (key);
+
+  if (length < sizeof (RasterCacheHeader))
+    goto invalid;
+
+  memcpy (&header, contents, sizeof (RasterCacheHeader));
+
+  if (memcmp (header.magic, RASTER_CACHE_MAGIC, sizeof (header.magic)) != 0 ||
+      header.byte_order != RASTER_CACHE_BYTE_ORDER ||
+      header.stamp != stamp ||
+      header.key_length != key_length ||
+      (header.n_channels != 3 && header.n_channels != 4) ||
+      header.width == 0 || header.height == 0 ||
+      header.rowstride < header.width * header.n_channels)
+    goto invalid;
+
+  offset = PIXELS_OFFSET (key_length);
+  n_bytes = (gsize) header.rowstride * (header.height - 1) + header.width * header.n_channels;
+
+  if (length < offset || length - offset < n_bytes ||
+      memcmp (contents + sizeof (RasterCacheHeader), key, key_length) != 0)
+    goto invalid;
+
+  *scale = header.scale;
+
+  return gdk_pixbuf_new_from_data ((const guchar *) contents + offset,
+                                   GDK_COLORSPACE_RGB,
+                                   header.n_channels == 4,
+                                   8,
+                                   header.width, header.height,
+                                   header.rowstride,
+                                   free_mapped_file, file);
+
+invalid:
+  g_mapped_file_unref (file);
+  return NULL;
+}
+
+void
+_gtk_icon_raster_cache_store (const gchar *key,
+                              guint64      stamp,
+                              gdouble      scale,
+                              GdkPixbuf   *pixbuf)
+{
+  RasterCacheHeader header;
+  gsize key_length, offset, n_bytes;
+  gchar *contents, *path;
+
+  if (!_gtk_icon_raster_cache_is_enabled ())
+    return;
+
+  if (gdk_pixbuf_get_colorspace (pixbuf) != GDK_COLORSPACE_RGB ||
+      gdk_pixbuf_get_bits_per_sample (pixbuf) != 8)
+    return;
+
+  key_length = strlen (key);
+  offset = PIXELS_OFFSET (key_length);
+  n_bytes = gdk_pixbuf_get_byte_length (pixbuf);
+
+  memset (&header, 0, sizeof (RasterCacheHeader));
+  memcpy (header.magic, RASTER_CACHE_MAGIC, sizeof (header.magic));
+  header.byte_order = RASTER_CACHE_BYTE_ORDER;
+  header.key_length = key_length;
+  header.stamp = stamp;
+  header.scale = scale;
+  header.width = gdk_pixbuf_get_width (pixbuf);
+  header.height = gdk_pixbuf_get_height (pixbuf);
+  header.rowstride = gdk_pixbuf_get_rowstride (pixbuf);
+  header.n_channels = gdk_pixbuf_get_n_channels (pixbuf);
+
+  contents = g_malloc0 (offset + n_bytes);
+  memcpy (contents, &header, sizeof (RasterCacheHeader));
+  memcpy (contents + sizeof (RasterCacheHeader), key, key_length);
+  memcpy (contents + offset, gdk_pixbuf_get_pixels (pixbuf), n_bytes);
+
+  path = get_cache_file (key);
+  /* Failing to write the cache is not an error worth reporting */
+  g_file_set_contents (path, contents, offset + n_bytes, NULL);
+
+  g_free (path);
+  g_free (contents);
+}
@@ -0,0 +1,35 @@
+/* gtkiconrastercacheprivate.h
+ * Copyright (C) 2016 Red Hat, Inc.
+ *
+ * This library is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Library General Public
+ * License as published by the Free Software Foundation; either
+ * version 2 of the License, or (at your option) any later version.
+ *
+ * This library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Library General Public License for more details.
+ *
+ * You should have received a copy of the GNU Library General Public
+ * License along with this library. If not, see <http://www.gnu.org/licenses/>.
+ */
+#ifndef __GTK_ICON_RASTER_CACHE_PRIVATE_H__
+#define __GTK_ICON_RASTER_CACHE_PRIVATE_H__
+
+#include <gdk-pixbuf/gdk-pixbuf.h>
+
+G_BEGIN_DECLS
+
+gboolean   _gtk_icon_raster_cache_is_enabled (void);
+GdkPixbuf *_gtk_icon_raster_cache_lookup     (const gchar *key,
+                                              guint64      stamp,
+                                              gdouble     *scale);
+void       _gtk_icon_raster_cache_store      (const gchar *key,
+                                              guint64      stamp,
+                                              gdouble      scale,
+                                              GdkPixbuf   *pixbuf);
+
+G_END_DECLS
+
+#endif /* __GTK_ICON_RASTER_CACHE_PRIVATE_H__ */
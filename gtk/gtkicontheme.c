@@ -43,6 +43,7 @@
 #include "gtkdebug.h"
 #include "deprecated/gtkiconfactory.h"
 #include "gtkiconcache.h"
+#include "gtkiconrastercacheprivate.h"
 #include "gtkintl.h"
 #include "gtkmain.h"
 #include "deprecated/gtknumerableiconprivate.h"
@@ -159,7 +160,12 @@ typedef enum
   ICON_SUFFIX_SYMBOLIC_PNG = 1 << 4
 } IconSuffix;
 
+/* The LRU always keeps INFO_CACHE_LRU_SIZE infos, and more as long
+ * as their loaded pixbufs fit into INFO_CACHE_LRU_MAX_BYTES.
+ */
 #define INFO_CACHE_LRU_SIZE 32
+#define INFO_CACHE_LRU_MAX_SIZE 1024
+#define INFO_CACHE_LRU_MAX_BYTES (8 * 1024 * 1024)
 #if 0
 #define DEBUG_CACHE(args) g_print args
 #else
@@ -170,6 +176,12 @@ struct _GtkIconThemePrivate
 {
   GHashTable *info_cache;
   GList *info_cache_lru;
+  guint info_cache_lru_length;
+  gsize info_cache_lru_bytes;
+
+  /* Identifies the state of the theme directories for the
+   * on-disk raster cache, 0 if that cache is not used */
+  guint64 raster_cache_stamp;
 
   gchar *current_theme;
   gchar **search_path;
@@ -270,6 +282,12 @@ struct _GtkIconInfo
 
   gint symbolic_width;
   gint symbolic_height;
+
+  /* Size accounted for in the LRU cache */
+  gsize lru_bytes;
+
+  /* Stamp of the theme for the raster cache, 0 if not cacheable */
+  guint64 raster_cache_stamp;
 };
 
 typedef struct
@@ -1337,6 +1355,39 @@ add_unthemed_icon (GtkIconTheme *icon_theme,
     }
 }
 
+static guint64
+compute_raster_cache_stamp (GtkIconTheme *icon_theme)
+{
+  GtkIconThemePrivate *priv = icon_theme->priv;
+  GChecksum *checksum;
+  guint8 digest[20];
+  gsize digest_len = sizeof (digest);
+  guint64 stamp;
+  GList *l;
+
+  if (!_gtk_icon_raster_cache_is_enabled ())
+    return 0;
+
+  /* The same directories rescan_themes() watches for changes */
+  checksum = g_checksum_new (G_CHECKSUM_SHA1);
+  if (priv->current_theme)
+    g_checksum_update (checksum, (const guchar *) priv->current_theme, -1);
+  for (l = priv->dir_mtimes; l != NULL; l = l->next)
+    {
+      IconThemeDirMtime *dir_mtime = l->data;
+      gint64 mtime = dir_mtime->mtime;
+
+      g_checksum_update (checksum, (const guchar *) dir_mtime->dir, strlen (dir_mtime->dir) + 1);
+      g_checksum_update (checksum, (const guchar *) &mtime, sizeof (mtime));
+    }
+  g_checksum_get_digest (checksum, digest, &digest_len);
+  g_checksum_free (checksum);
+
+  memcpy (&stamp, digest, sizeof (stamp));
+
+  return stamp != 0 ? stamp : 1;
+}
+
 static void
 load_themes (GtkIconTheme *icon_theme)
 {
@@ -1417,6 +1468,7 @@ load_themes (GtkIconTheme *icon_theme)
     }
 
   priv->themes_valid = TRUE;
+  priv->raster_cache_stamp = compute_raster_cache_stamp (icon_theme);
   
   g_get_current_time (&tv);
   priv->last_stat_time = tv.tv_sec;
@@ -1479,17 +1531,32 @@ ensure_valid_themes (GtkIconTheme *icon_theme)
  * we remove it from the list, and when the proxy
  * pixmap is released we put it on the list.
  */
+static gsize
+icon_info_get_lru_bytes (GtkIconInfo *icon_info)
+{
+  if (icon_info->pixbuf == NULL)
+    return 0;
+
+  return (gsize) gdk_pixbuf_get_rowstride (icon_info->pixbuf) *
+         gdk_pixbuf_get_height (icon_info->pixbuf);
+}
+
 static void
-ensure_lru_cache_space (GtkIconTheme *icon_theme)
+ensure_lru_cache_space (GtkIconTheme *icon_theme,
+                        gsize         needed)
 {
   GtkIconThemePrivate *priv = icon_theme->priv;
   GList *l;
 
-  /* Remove last item if LRU full */
-  l = g_list_nth (priv->info_cache_lru, INFO_CACHE_LRU_SIZE - 1);
-  if (l)
+  /* Remove last items while the LRU is full */
+  while (priv->info_cache_lru_length >= INFO_CACHE_LRU_MAX_SIZE ||
+         (priv->info_cache_lru_length >= INFO_CACHE_LRU_SIZE &&
+          priv->info_cache_lru_bytes + needed > INFO_CACHE_LRU_MAX_BYTES))
     {
-      GtkIconInfo *icon_info = l->data;
+      GtkIconInfo *icon_info;
+
+      l = g_list_last (priv->info_cache_lru);
+      icon_info = l->data;
 
       DEBUG_CACHE (("removing (due to out of space) %p (%s %d 0x%x) from LRU cache (cache size %d)\n",
                     icon_info,
@@ -1498,6 +1565,8 @@ ensure_lru_cache_space (GtkIconTheme *icon_theme)
                     g_list_length (priv->info_cache_lru)));
 
       priv->info_cache_lru = g_list_delete_link (priv->info_cache_lru, l);
+      priv->info_cache_lru_length--;
+      priv->info_cache_lru_bytes -= icon_info->lru_bytes;
       g_object_unref (icon_info);
     }
 }
@@ -1516,10 +1585,13 @@ add_to_lru_cache (GtkIconTheme *icon_theme,
 
   g_assert (g_list_find (priv->info_cache_lru, icon_info) == NULL);
 
-  ensure_lru_cache_space (icon_theme);
+  icon_info->lru_bytes = icon_info_get_lru_bytes (icon_info);
+  ensure_lru_cache_space (icon_theme, icon_info->lru_bytes);
   /* prepend new info to LRU */
   priv->info_cache_lru = g_list_prepend (priv->info_cache_lru,
                                          g_object_ref (icon_info));
+  priv->info_cache_lru_length++;
+  priv->info_cache_lru_bytes += icon_info->lru_bytes;
 }
 
 static void
@@ -1554,6 +1626,8 @@ remove_from_lru_cache (GtkIconTheme *icon_theme,
                     g_list_length (priv->info_cache_lru)));
 
       priv->info_cache_lru = g_list_remove (priv->info_cache_lru, icon_info);
+      priv->info_cache_lru_length--;
+      priv->info_cache_lru_bytes -= icon_info->lru_bytes;
       g_object_unref (icon_info);
     }
 }
@@ -1832,6 +1906,7 @@ real_choose_icon (GtkIconTheme       *icon_theme,
       icon_info->key.scale = scale;
       icon_info->key.flags = flags;
       icon_info->in_cache = icon_theme;
+      icon_info->raster_cache_stamp = priv->raster_cache_stamp;
       DEBUG_CACHE (("adding %p (%s %d 0x%x) to cache (cache size %d)\n",
                     icon_info,
                     g_strjoinv (",", icon_info->key.icon_names),
@@ -3481,6 +3556,7 @@ icon_info_dup (GtkIconInfo *icon_info)
   dup->max_size = icon_info->max_size;
   dup->symbolic_width = icon_info->symbolic_width;
   dup->symbolic_height = icon_info->symbolic_height;
+  dup->raster_cache_stamp = icon_info->raster_cache_stamp;
 
   return dup;
 }
@@ -3807,6 +3883,49 @@ icon_info_get_pixbuf_ready (GtkIconInfo *icon_info)
   return FALSE;
 }
 
+/* Whether loading the icon completed, so that loading
+ * it again is cheap and does not touch the disk.
+ */
+gboolean
+gtk_icon_info_is_loaded (GtkIconInfo *icon_info)
+{
+  g_return_val_if_fail (GTK_IS_ICON_INFO (icon_info), FALSE);
+
+  return icon_info_get_pixbuf_ready (icon_info);
+}
+
+/* Returns the key under which the icon, loaded with the given
+ * parameters, is stored in the raster cache, or %NULL if it
+ * should not be cached.
+ */
+static gchar *
+icon_info_get_raster_cache_key (GtkIconInfo *icon_info,
+                                const gchar *variant)
+{
+  GStatBuf stat_buf;
+
+  if (icon_info->raster_cache_stamp == 0 ||
+      icon_info->filename == NULL ||
+      icon_info->is_resource ||
+      icon_info->cache_pixbuf != NULL)
+    return NULL;
+
+  /* Theme directory mtimes don't change when a single
+   * icon file is replaced, so include the file's stats */
+  if (g_stat (icon_info->filename, &stat_buf) != 0)
+    return NULL;
+
+  return g_strdup_printf ("%s\n%" G_GINT64_FORMAT " %" G_GINT64_FORMAT "\n%d %d %d %d %d %d %d %d %g\n%s",
+                          icon_info->filename,
+                          (gint64) stat_buf.st_mtime, (gint64) stat_buf.st_size,
+                          icon_info->desired_size, icon_info->desired_scale,
+                          icon_info->forced_size, icon_info->dir_type,
+                          icon_info->dir_size, icon_info->dir_scale,
+                          icon_info->min_size, icon_info->max_size,
+                          icon_info->unscaled_scale,
+                          variant);
+}
+
 /* This function contains the complicated logic for deciding
  * on the size at which to load the icon and loading it at
  * that size.
@@ -3818,6 +3937,7 @@ icon_info_ensure_scale_and_pixbuf (GtkIconInfo *icon_info)
   gint scaled_desired_size;
   GdkPixbuf *source_pixbuf;
   gdouble dir_scale;
+  gchar *raster_cache_key;
 
   if (icon_info->pixbuf)
     {
@@ -3864,6 +3984,21 @@ icon_info_ensure_scale_and_pixbuf (GtkIconInfo *icon_info)
         icon_info->scale = (gdouble) scaled_desired_size / (icon_info->dir_size * dir_scale);
     }
 
+  /* Another process may have loaded the icon at this size already */
+  raster_cache_key = icon_info_get_raster_cache_key (icon_info, "");
+  if (raster_cache_key)
+    {
+      icon_info->pixbuf = _gtk_icon_raster_cache_lookup (raster_cache_key,
+                                                         icon_info->raster_cache_stamp,
+                                                         &icon_info->scale);
+      if (icon_info->pixbuf)
+        {
+          g_free (raster_cache_key);
+          apply_emblems (icon_info);
+          return TRUE;
+        }
+    }
+
   /* At this point, we need to actually get the icon; either from the
    * builtin image or by loading the file
    */
@@ -3936,7 +4071,10 @@ icon_info_ensure_scale_and_pixbuf (GtkIconInfo *icon_info)
     }
 
   if (!source_pixbuf)
-    return FALSE;
+    {
+      g_free (raster_cache_key);
+      return FALSE;
+    }
 
   /* Do scale calculations that depend on the image size
    */
@@ -3971,6 +4109,15 @@ icon_info_ensure_scale_and_pixbuf (GtkIconInfo *icon_info)
       g_object_unref (source_pixbuf);
     }
 
+  if (raster_cache_key)
+    {
+      _gtk_icon_raster_cache_store (raster_cache_key,
+                                    icon_info->raster_cache_stamp,
+                                    icon_info->scale,
+                                    icon_info->pixbuf);
+      g_free (raster_cache_key);
+    }
+
   apply_emblems (icon_info);
 
   return TRUE;
@@ -4120,6 +4267,10 @@ load_icon_thread  (GTask        *task,
 {
   GtkIconInfo *dup = task_data;
 
+  /* Don't bother decoding icons nobody waits for anymore */
+  if (g_task_return_error_if_cancelled (task))
+    return;
+
   (void)icon_info_ensure_scale_and_pixbuf (dup);
   g_task_return_pointer (task, NULL, NULL);
 }
@@ -4416,6 +4567,34 @@ gtk_icon_info_load_symbolic_png (GtkIconInfo    *icon_info,
                                                error_color ? error_color : &error_default);
 }
 
+static gchar *
+symbolic_colors_to_string (const GdkRGBA *fg,
+                           const GdkRGBA *success_color,
+                           const GdkRGBA *warning_color,
+                           const GdkRGBA *error_color)
+{
+  const GdkRGBA *colors[4] = { fg, success_color, warning_color, error_color };
+  GString *string;
+  gchar *color;
+  gint i;
+
+  string = g_string_new ("symbolic");
+  for (i = 0; i < G_N_ELEMENTS (colors); i++)
+    {
+      g_string_append_c (string, ' ');
+      if (colors[i])
+        {
+          color = gdk_rgba_to_string (colors[i]);
+          g_string_append (string, color);
+          g_free (color);
+        }
+      else
+        g_string_append_c (string, '-');
+    }
+
+  return g_string_free (string, FALSE);
+}
+
 static GdkPixbuf *
 gtk_icon_info_load_symbolic_svg (GtkIconInfo    *icon_info,
                                  const GdkRGBA  *fg,
@@ -4581,7 +4760,33 @@ gtk_icon_info_load_symbolic_internal (GtkIconInfo    *icon_info,
   if (g_str_has_suffix (icon_uri, ".symbolic.png"))
     pixbuf = gtk_icon_info_load_symbolic_png (icon_info, fg, success_color, warning_color, error_color, error);
   else
-    pixbuf = gtk_icon_info_load_symbolic_svg (icon_info, fg, success_color, warning_color, error_color, error);
+    {
+      gchar *colors, *raster_cache_key;
+      gdouble scale;
+
+      /* Rendering the recolored SVG is expensive, so keep
+       * the result in the raster cache, keyed by the colors */
+      colors = symbolic_colors_to_string (fg, success_color, warning_color, error_color);
+      raster_cache_key = icon_info_get_raster_cache_key (icon_info, colors);
+      g_free (colors);
+
+      pixbuf = NULL;
+      if (raster_cache_key)
+        pixbuf = _gtk_icon_raster_cache_lookup (raster_cache_key,
+                                                icon_info->raster_cache_stamp,
+                                                &scale);
+      if (pixbuf == NULL)
+        {
+          pixbuf = gtk_icon_info_load_symbolic_svg (icon_info, fg, success_color, warning_color, error_color, error);
+          if (pixbuf && raster_cache_key)
+            _gtk_icon_raster_cache_store (raster_cache_key,
+                                          icon_info->raster_cache_stamp,
+                                          1.0,
+                                          pixbuf);
+        }
+
+      g_free (raster_cache_key);
+    }
 
   g_free (icon_uri);
 
@@ -1013,6 +1013,7 @@ gtk_icon_view_init (GtkIconView *icon_view)
 
   icon_view->priv->row_contexts = 
     g_ptr_array_new_with_free_func ((GDestroyNotify)g_object_unref);
+  icon_view->priv->row_starts = g_ptr_array_new ();
 
   gtk_style_context_add_class (gtk_widget_get_style_context (GTK_WIDGET (icon_view)),
                                GTK_STYLE_CLASS_VIEW);
@@ -1051,6 +1052,12 @@ gtk_icon_view_dispose (GObject *object)
       priv->row_contexts = NULL;
     }
 
+  if (priv->row_starts)
+    {
+      g_ptr_array_free (priv->row_starts, TRUE);
+      priv->row_starts = NULL;
+    }
+
   if (priv->cell_area)
     {
       gtk_cell_area_stop_editing (icon_view->priv->cell_area, TRUE);
@@ -1842,12 +1849,90 @@ gtk_icon_view_size_allocate (GtkWidget      *widget,
   g_object_thaw_notify (G_OBJECT (icon_view->priv->vadjustment));
 }
 
+static void
+gtk_icon_view_clear_row_index (GtkIconView *icon_view)
+{
+  /* May be called from destroy, after dispose freed the index */
+  if (icon_view->priv->row_starts)
+    g_ptr_array_set_size (icon_view->priv->row_starts, 0);
+}
+
+static gboolean
+gtk_icon_view_has_row_index (GtkIconView *icon_view)
+{
+  return icon_view->priv->row_starts != NULL &&
+         icon_view->priv->row_starts->len > 0;
+}
+
+/* Returns the first row whose items end at or below @y,
+ * or -1 if all rows end above @y.
+ */
+static gint
+gtk_icon_view_find_row (GtkIconView *icon_view,
+                        gint         y)
+{
+  GPtrArray *row_starts = icon_view->priv->row_starts;
+  GtkIconViewItem *item;
+  guint lo, hi, mid;
+
+  lo = 0;
+  hi = row_starts->len;
+  while (lo < hi)
+    {
+      mid = (lo + hi) / 2;
+      item = ((GList *) g_ptr_array_index (row_starts, mid))->data;
+
+      if (item->cell_area.y + item->cell_area.height < y)
+        lo = mid + 1;
+      else
+        hi = mid;
+    }
+
+  return lo < row_starts->len ? (gint) lo : -1;
+}
+
+static GtkIconViewItem *
+gtk_icon_view_get_nth_item (GtkIconView *icon_view,
+                            gint         index)
+{
+  GPtrArray *row_starts = icon_view->priv->row_starts;
+  GList *list;
+  guint lo, hi, mid;
+
+  if (index < 0)
+    return NULL;
+
+  if (!gtk_icon_view_has_row_index (icon_view))
+    return g_list_nth_data (icon_view->priv->items, index);
+
+  /* Find the last row starting at or before @index */
+  lo = 0;
+  hi = row_starts->len;
+  while (hi - lo > 1)
+    {
+      mid = (lo + hi) / 2;
+      list = g_ptr_array_index (row_starts, mid);
+
+      if (((GtkIconViewItem *) list->data)->index <= index)
+        lo = mid;
+      else
+        hi = mid;
+    }
+
+  list = g_ptr_array_index (row_starts, lo);
+  index -= ((GtkIconViewItem *) list->data)->index;
+
+  return g_list_nth_data (list, index);
+}
+
 static gboolean
 gtk_icon_view_draw (GtkWidget *widget,
                     cairo_t   *cr)
 {
   GtkIconView *icon_view;
-  GList *icons;
+  GList *icons, *last_link = NULL;
+  GdkRectangle clip;
+  gint row, last;
   GtkTreePath *path;
   gint dest_index;
   GtkIconViewDropPosition dest_pos;
@@ -1881,7 +1966,26 @@ gtk_icon_view_draw (GtkWidget *widget,
   else
     dest_index = -1;
 
-  for (icons = icon_view->priv->items; icons; icons = icons->next)
+  icons = icon_view->priv->items;
+  if (gdk_cairo_get_clip_rectangle (cr, &clip) &&
+      gtk_icon_view_has_row_index (icon_view))
+    {
+      /* Only walk the rows that intersect the clip */
+      row = gtk_icon_view_find_row (icon_view,
+                                    clip.y - icon_view->priv->item_padding);
+      if (row < 0)
+        icons = NULL;
+      else
+        {
+          icons = g_ptr_array_index (icon_view->priv->row_starts, row);
+          last = gtk_icon_view_find_row (icon_view,
+                                         clip.y + clip.height + icon_view->priv->item_padding);
+          if (last >= 0 && last + 1 < icon_view->priv->row_starts->len)
+            last_link = g_ptr_array_index (icon_view->priv->row_starts, last + 1);
+        }
+    }
+
+  for (; icons != last_link; icons = icons->next)
     {
       GtkIconViewItem *item = icons->data;
       GdkRectangle paint_area;
@@ -2215,8 +2319,8 @@ gtk_icon_view_set_cursor (GtkIconView     *icon_view,
     gtk_cell_area_stop_editing (icon_view->priv->cell_area, TRUE);
 
   if (gtk_tree_path_get_depth (path) == 1)
-    item = g_list_nth_data (icon_view->priv->items,
-			    gtk_tree_path_get_indices(path)[0]);
+    item = gtk_icon_view_get_nth_item (icon_view,
+                                       gtk_tree_path_get_indices(path)[0]);
   
   if (!item)
     return;
@@ -2959,6 +3063,8 @@ gtk_icon_view_layout (GtkIconView *icon_view)
   GtkRequestedSize *sizes;
   gboolean rtl;
 
+  g_ptr_array_set_size (priv->row_starts, 0);
+
   if (gtk_icon_view_is_empty (icon_view))
     return;
 
@@ -3043,6 +3149,8 @@ gtk_icon_view_layout (GtkIconView *icon_view)
 
       priv->height += priv->item_padding;
 
+      g_ptr_array_add (priv->row_starts, items);
+
       for (col = 0; col < n_columns && items; col++, items = items->next)
         {
           GtkIconViewItem *item = items->data;
@@ -3075,6 +3183,10 @@ gtk_icon_view_invalidate_sizes (GtkIconView *icon_view)
   g_list_foreach (icon_view->priv->items,
 		  (GFunc)gtk_icon_view_item_invalidate_size, NULL);
 
+  /* The rows are found by item position, which is gone until the
+   * next layout */
+  gtk_icon_view_clear_row_index (icon_view);
+
   /* Re-layout the items */
   gtk_widget_queue_resize (GTK_WIDGET (icon_view));
 }
@@ -3311,12 +3423,27 @@ _gtk_icon_view_get_item_at_coords (GtkIconView          *icon_view,
                                    gboolean              only_in_cell,
                                    GtkCellRenderer     **cell_at_pos)
 {
-  GList *items;
+  GList *items, *last_link = NULL;
+  gint row;
 
   if (cell_at_pos)
     *cell_at_pos = NULL;
 
-  for (items = icon_view->priv->items; items; items = items->next)
+  items = icon_view->priv->items;
+  if (gtk_icon_view_has_row_index (icon_view))
+    {
+      /* Items of neighbouring rows may both be hit within the
+       * row spacing, so check the two rows around @y */
+      row = gtk_icon_view_find_row (icon_view, y - icon_view->priv->row_spacing/2);
+      if (row < 0)
+        return NULL;
+
+      items = g_ptr_array_index (icon_view->priv->row_starts, row);
+      if (row + 2 < icon_view->priv->row_starts->len)
+        last_link = g_ptr_array_index (icon_view->priv->row_starts, row + 2);
+    }
+
+  for (; items != last_link; items = items->next)
     {
       GtkIconViewItem *item = items->data;
       GdkRectangle    *item_area = &item->cell_area;
@@ -3478,6 +3605,7 @@ gtk_icon_view_row_inserted (GtkTreeModel *model,
   */
   icon_view->priv->items = g_list_insert (icon_view->priv->items,
 					 item, index);
+  gtk_icon_view_clear_row_index (icon_view);
   
   list = g_list_nth (icon_view->priv->items, index + 1);
   for (; list; list = list->next)
@@ -3537,6 +3665,7 @@ gtk_icon_view_row_deleted (GtkTreeModel *model,
     }
   
   icon_view->priv->items = g_list_delete_link (icon_view->priv->items, list);
+  gtk_icon_view_clear_row_index (icon_view);
 
   verify_items (icon_view);  
   
@@ -3587,6 +3716,7 @@ gtk_icon_view_rows_reordered (GtkTreeModel *model,
   g_free (item_array);
   g_list_free (icon_view->priv->items);
   icon_view->priv->items = items;
+  gtk_icon_view_clear_row_index (icon_view);
 
   gtk_widget_queue_resize (GTK_WIDGET (icon_view));
 
@@ -3619,6 +3749,7 @@ gtk_icon_view_build_items (GtkIconView *icon_view)
     } while (gtk_tree_model_iter_next (icon_view->priv->model, &iter));
 
   icon_view->priv->items = g_list_reverse (items);
+  gtk_icon_view_clear_row_index (icon_view);
 }
 
 static void
@@ -4184,8 +4315,8 @@ gtk_icon_view_scroll_to_path (GtkIconView *icon_view,
   widget = GTK_WIDGET (icon_view);
 
   if (gtk_tree_path_get_depth (path) > 0)
-    item = g_list_nth_data (icon_view->priv->items,
-			    gtk_tree_path_get_indices(path)[0]);
+    item = gtk_icon_view_get_nth_item (icon_view,
+                                       gtk_tree_path_get_indices(path)[0]);
   
   if (!item || item->cell_area.width < 0 ||
       !gtk_widget_get_realized (widget))
@@ -4543,8 +4674,8 @@ gtk_icon_view_get_cell_rect (GtkIconView     *icon_view,
   g_return_val_if_fail (cell == NULL || GTK_IS_CELL_RENDERER (cell), FALSE);
 
   if (gtk_tree_path_get_depth (path) > 0)
-    item = g_list_nth_data (icon_view->priv->items,
-			    gtk_tree_path_get_indices(path)[0]);
+    item = gtk_icon_view_get_nth_item (icon_view,
+                                       gtk_tree_path_get_indices(path)[0]);
 
   if (!item)
     return FALSE;
@@ -5034,6 +5165,7 @@ gtk_icon_view_set_model (GtkIconView *icon_view,
       
       g_list_free_full (icon_view->priv->items, (GDestroyNotify) gtk_icon_view_item_free);
       icon_view->priv->items = NULL;
+      gtk_icon_view_clear_row_index (icon_view);
       icon_view->priv->anchor_item = NULL;
       icon_view->priv->cursor_item = NULL;
       icon_view->priv->last_single_clicked = NULL;
@@ -5397,8 +5529,8 @@ gtk_icon_view_select_path (GtkIconView *icon_view,
   g_return_if_fail (path != NULL);
 
   if (gtk_tree_path_get_depth (path) > 0)
-    item = g_list_nth_data (icon_view->priv->items,
-			    gtk_tree_path_get_indices(path)[0]);
+    item = gtk_icon_view_get_nth_item (icon_view,
+                                       gtk_tree_path_get_indices(path)[0]);
 
   if (item)
     _gtk_icon_view_select_item (icon_view, item);
@@ -5423,8 +5555,8 @@ gtk_icon_view_unselect_path (GtkIconView *icon_view,
   g_return_if_fail (icon_view->priv->model != NULL);
   g_return_if_fail (path != NULL);
 
-  item = g_list_nth_data (icon_view->priv->items,
-			  gtk_tree_path_get_indices(path)[0]);
+  item = gtk_icon_view_get_nth_item (icon_view,
+                                     gtk_tree_path_get_indices(path)[0]);
 
   if (!item)
     return;
@@ -5555,8 +5687,8 @@ gtk_icon_view_path_is_selected (GtkIconView *icon_view,
   g_return_val_if_fail (icon_view->priv->model != NULL, FALSE);
   g_return_val_if_fail (path != NULL, FALSE);
   
-  item = g_list_nth_data (icon_view->priv->items,
-			  gtk_tree_path_get_indices(path)[0]);
+  item = gtk_icon_view_get_nth_item (icon_view,
+                                     gtk_tree_path_get_indices(path)[0]);
 
   if (!item)
     return FALSE;
@@ -5586,8 +5718,8 @@ gtk_icon_view_get_item_row (GtkIconView *icon_view,
   g_return_val_if_fail (icon_view->priv->model != NULL, -1);
   g_return_val_if_fail (path != NULL, -1);
 
-  item = g_list_nth_data (icon_view->priv->items,
-                          gtk_tree_path_get_indices(path)[0]);
+  item = gtk_icon_view_get_nth_item (icon_view,
+                                     gtk_tree_path_get_indices(path)[0]);
 
   if (!item)
     return -1;
@@ -5617,8 +5749,8 @@ gtk_icon_view_get_item_column (GtkIconView *icon_view,
   g_return_val_if_fail (icon_view->priv->model != NULL, -1);
   g_return_val_if_fail (path != NULL, -1);
 
-  item = g_list_nth_data (icon_view->priv->items,
-                          gtk_tree_path_get_indices(path)[0]);
+  item = gtk_icon_view_get_nth_item (icon_view,
+                                     gtk_tree_path_get_indices(path)[0]);
 
   if (!item)
     return -1;
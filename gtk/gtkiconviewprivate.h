@@ -46,6 +46,10 @@ struct _GtkIconViewPrivate
 
   GPtrArray          *row_contexts;
 
+  /* The GList link of the first item in every row, filled in by
+   * gtk_icon_view_layout() and emptied when the items change */
+  GPtrArray          *row_starts;
+
   gint width, height;
 
   GtkSelectionMode selection_mode;
@@ -219,6 +219,7 @@ enum
   PROP_GICON,
   PROP_RESOURCE,
   PROP_USE_FALLBACK,
+  PROP_LOAD_ASYNC,
   NUM_PROPERTIES
 };
 
@@ -399,6 +400,26 @@ gtk_image_class_init (GtkImageClass *class)
                             FALSE,
                             GTK_PARAM_READWRITE|G_PARAM_EXPLICIT_NOTIFY);
 
+  /**
+   * GtkImage:load-async:
+   *
+   * Whether icons from the icon theme that have not been loaded yet
+   * should be loaded in a separate thread. Until the icon is available,
+   * nothing is drawn and the image is redrawn once it has been loaded.
+   *
+   * This only applies to images of type %GTK_IMAGE_ICON_NAME and
+   * %GTK_IMAGE_GICON with a #GtkImage:pixel-size set, whose size does
+   * not depend on the icon. Symbolic icons are always loaded immediately.
+   *
+   * Since: 3.22
+   */
+  image_props[PROP_LOAD_ASYNC] =
+      g_param_spec_boolean ("load-async",
+                            P_("Load asynchronously"),
+                            P_("Whether to load icons in a thread"),
+                            FALSE,
+                            GTK_PARAM_READWRITE|G_PARAM_EXPLICIT_NOTIFY);
+
   g_object_class_install_properties (gobject_class, NUM_PROPERTIES, image_props);
 
   gtk_widget_class_set_accessible_type (widget_class, GTK_TYPE_IMAGE_ACCESSIBLE);
@@ -505,6 +526,14 @@ gtk_image_set_property (GObject      *object,
         g_object_notify_by_pspec (object, pspec);
       break;
 
+    case PROP_LOAD_ASYNC:
+      if (_gtk_icon_helper_get_load_async (priv->icon_helper) != g_value_get_boolean (value))
+        {
+          _gtk_icon_helper_set_load_async (priv->icon_helper, g_value_get_boolean (value));
+          g_object_notify_by_pspec (object, pspec);
+        }
+      break;
+
     default:
       G_OBJECT_WARN_INVALID_PROPERTY_ID (object, prop_id, pspec);
       break;
@@ -563,6 +592,9 @@ gtk_image_get_property (GObject     *object,
     case PROP_STORAGE_TYPE:
       g_value_set_enum (value, _gtk_icon_helper_get_storage_type (priv->icon_helper));
       break;
+    case PROP_LOAD_ASYNC:
+      g_value_set_boolean (value, _gtk_icon_helper_get_load_async (priv->icon_helper));
+      break;
     default:
       G_OBJECT_WARN_INVALID_PROPERTY_ID (object, prop_id, pspec);
       break;
@@ -31,10 +31,16 @@ struct _GtkKeyHashEntry
   GdkModifierType modifiers;
   gpointer value;
 
+  /* Number of bits set in modifiers, for sorting results
+   */
+  guint n_modifiers;
+
   /* Set as a side effect of generating key_hash->keycode_hash
    */
   GdkKeymapKey *keys;		
   gint n_keys;
+  GdkModifierType mapped_modifiers;
+  gboolean mapped_modifiers_valid;
 };
 
 struct _GtkKeyHash
@@ -46,13 +52,44 @@ struct _GtkKeyHash
   GDestroyNotify destroy_notify;
 };
 
+/* The keycode hash maps each keycode to a GPtrArray of the entries
+ * whose keyval is on that key. The arrays are kept sorted the way
+ * lookups return their results: by number of modifiers, then by
+ * keyval, then from oldest to newest entry. A lookup then only has
+ * to filter an array.
+ */
+static gint
+entry_compare (const GtkKeyHashEntry *a,
+               const GtkKeyHashEntry *b)
+{
+  if (a->n_modifiers != b->n_modifiers)
+    return a->n_modifiers < b->n_modifiers ? -1 : 1;
+
+  if (a->keyval != b->keyval)
+    return a->keyval < b->keyval ? -1 : 1;
+
+  return 0;
+}
+
+/* Newer entries go after older ones that compare equal */
 static void
-key_hash_clear_keycode (gpointer key,
-			gpointer value,
-			gpointer data)
+keycode_entries_insert (GPtrArray       *entries,
+                        GtkKeyHashEntry *entry)
 {
-  GSList *keys = value;
-  g_slist_free (keys);
+  guint lo, hi, mid;
+
+  lo = 0;
+  hi = entries->len;
+  while (lo < hi)
+    {
+      mid = (lo + hi) / 2;
+      if (entry_compare (g_ptr_array_index (entries, mid), entry) <= 0)
+        lo = mid + 1;
+      else
+        hi = mid;
+    }
+
+  g_ptr_array_insert (entries, lo, entry);
 }
 
 static void
@@ -65,15 +102,27 @@ key_hash_insert_entry (GtkKeyHash      *key_hash,
   gdk_keymap_get_entries_for_keyval (key_hash->keymap,
 				     entry->keyval,
 				     &entry->keys, &entry->n_keys);
+
+  /* The mapping of virtual modifiers only changes together
+   * with the keymap, so don't redo it for every lookup
+   */
+  entry->mapped_modifiers = entry->modifiers;
+  entry->mapped_modifiers_valid =
+    gdk_keymap_map_virtual_modifiers (key_hash->keymap, &entry->mapped_modifiers);
   
   for (i = 0; i < entry->n_keys; i++)
     {
-      GSList *old_keys = g_hash_table_lookup (key_hash->keycode_hash,
-					      GUINT_TO_POINTER (entry->keys[i].keycode));
-      old_keys = g_slist_prepend (old_keys, entry);
-      g_hash_table_insert (key_hash->keycode_hash,
-			   GUINT_TO_POINTER (entry->keys[i].keycode),
-			   old_keys);
+      GPtrArray *entries = g_hash_table_lookup (key_hash->keycode_hash,
+					        GUINT_TO_POINTER (entry->keys[i].keycode));
+      if (entries == NULL)
+        {
+          entries = g_ptr_array_new ();
+          g_hash_table_insert (key_hash->keycode_hash,
+			       GUINT_TO_POINTER (entry->keys[i].keycode),
+			       entries);
+        }
+
+      keycode_entries_insert (entries, entry);
     }
 }
 
@@ -84,7 +133,8 @@ key_hash_get_keycode_hash (GtkKeyHash *key_hash)
     {
       GList *tmp_list;
   
-      key_hash->keycode_hash = g_hash_table_new (g_direct_hash, NULL);
+      key_hash->keycode_hash = g_hash_table_new_full (g_direct_hash, NULL, NULL,
+                                                      (GDestroyNotify) g_ptr_array_unref);
       
       /* Preserve the original insertion order
        */
@@ -103,12 +153,7 @@ key_hash_keys_changed (GdkKeymap  *keymap,
 {
   /* The keymap changed, so we have to regenerate the keycode hash
    */
-  if (key_hash->keycode_hash)
-    {
-      g_hash_table_foreach (key_hash->keycode_hash, key_hash_clear_keycode, NULL);
-      g_hash_table_destroy (key_hash->keycode_hash);
-      key_hash->keycode_hash = NULL;
-    }
+  g_clear_pointer (&key_hash->keycode_hash, g_hash_table_destroy);
 }
 
 /**
@@ -174,10 +219,7 @@ _gtk_key_hash_free (GtkKeyHash *key_hash)
 					key_hash);
 
   if (key_hash->keycode_hash)
-    {
-      g_hash_table_foreach (key_hash->keycode_hash, key_hash_clear_keycode, NULL);
-      g_hash_table_destroy (key_hash->keycode_hash);
-    }
+    g_hash_table_destroy (key_hash->keycode_hash);
   
   g_hash_table_destroy (key_hash->reverse_hash);
 
@@ -203,12 +245,20 @@ _gtk_key_hash_add_entry (GtkKeyHash      *key_hash,
 			 gpointer         value)
 {
   GtkKeyHashEntry *entry = g_slice_new (GtkKeyHashEntry);
+  guint bits;
 
   entry->value = value;
   entry->keyval = keyval;
   entry->modifiers = modifiers;
   entry->keys = NULL;
 
+  entry->n_modifiers = 0;
+  for (bits = modifiers; bits; bits >>= 1)
+    {
+      if (bits & 1)
+        entry->n_modifiers++;
+    }
+
   key_hash->entries_list = g_list_prepend (key_hash->entries_list, entry);
   g_hash_table_insert (key_hash->reverse_hash, value, key_hash->entries_list);
 
@@ -240,20 +290,12 @@ _gtk_key_hash_remove_entry (GtkKeyHash *key_hash,
 	  
 	  for (i = 0; i < entry->n_keys; i++)
 	    {
-	      GSList *old_keys = g_hash_table_lookup (key_hash->keycode_hash,
-						      GUINT_TO_POINTER (entry->keys[i].keycode));
+	      GPtrArray *entries = g_hash_table_lookup (key_hash->keycode_hash,
+						        GUINT_TO_POINTER (entry->keys[i].keycode));
 	      
-	      GSList *new_keys = g_slist_remove (old_keys, entry);
-	      if (new_keys != old_keys)
-		{
-		  if (new_keys)
-		    g_hash_table_insert (key_hash->keycode_hash,
-					 GUINT_TO_POINTER (entry->keys[i].keycode),
-					 new_keys);
-		  else
-		    g_hash_table_remove (key_hash->keycode_hash,
-					 GUINT_TO_POINTER (entry->keys[i].keycode));
-		}
+	      if (entries && g_ptr_array_remove (entries, entry) && entries->len == 0)
+		g_hash_table_remove (key_hash->keycode_hash,
+				     GUINT_TO_POINTER (entry->keys[i].keycode));
 	    }
 	}
 	  
@@ -264,91 +306,21 @@ _gtk_key_hash_remove_entry (GtkKeyHash *key_hash,
     }
 }
 
-static gint
-lookup_result_compare (gconstpointer a,
-		       gconstpointer b)
-{
-  const GtkKeyHashEntry *entry_a = a;
-  const GtkKeyHashEntry *entry_b = b;
-  guint modifiers;
-
-  gint n_bits_a = 0;
-  gint n_bits_b = 0;
-
-  modifiers = entry_a->modifiers;
-  while (modifiers)
-    {
-      if (modifiers & 1)
-	n_bits_a++;
-      modifiers >>= 1;
-    }
-
-  modifiers = entry_b->modifiers;
-  while (modifiers)
-    {
-      if (modifiers & 1)
-	n_bits_b++;
-      modifiers >>= 1;
-    }
-
-  return n_bits_a < n_bits_b ? -1 : (n_bits_a == n_bits_b ? 0 : 1);
-  
-}
-
-/* Sort a list of results so that matches with less modifiers come
- * before matches with more modifiers
- */
-static GSList *
-sort_lookup_results (GSList *slist)
-{
-  return g_slist_sort (slist, lookup_result_compare);
-}
-
-static gint
-lookup_result_compare_by_keyval (gconstpointer a,
-		                 gconstpointer b)
-{
-  const GtkKeyHashEntry *entry_a = a;
-  const GtkKeyHashEntry *entry_b = b;
-
-  if (entry_a->keyval < entry_b->keyval)
-	return -1;
-  else if (entry_a->keyval > entry_b->keyval)
-	return 1;
-  else
-	return 0;
-}
-
-static GSList *
-sort_lookup_results_by_keyval (GSList *slist)
-{
-  return g_slist_sort (slist, lookup_result_compare_by_keyval);
-}
-
-/* Return true if keyval is defined in keyboard group
+/* Return true if the keyval of entry is defined in keyboard group.
+ * entry->keys holds the keymap entries for the keyval already.
  */
 static gboolean 
-keyval_in_group (GdkKeymap  *keymap,
-                 guint      keyval,
-                 gint       group)
+keyval_in_group (GtkKeyHashEntry *entry,
+                 gint             group)
 {                 
-  GtkKeyHashEntry entry;
   gint i;
 
-  gdk_keymap_get_entries_for_keyval (keymap,
-				     keyval,
-				     &entry.keys, &entry.n_keys);
-
-  for (i = 0; i < entry.n_keys; i++)
+  for (i = 0; i < entry->n_keys; i++)
     {
-      if (entry.keys[i].group == group)
-        {
-          g_free (entry.keys);
-          return TRUE;
-        }
+      if (entry->keys[i].group == group)
+        return TRUE;
     }
 
-  g_free (entry.keys);
   return FALSE;
 }
 
@@ -360,6 +332,9 @@ keyval_in_group (GdkKeymap  *keymap,
  * @mask: mask of modifiers to consider when matching against the
  *        modifiers in entries.
  * @group: group field from a #GdkEventKey
+ * @results: (out caller-allocates): return location for the values
+ *     of the matching entries
+ * @max_results: the number of values @results has room for
  * 
  * Looks up the best matching entry or entries in the hash table for
  * a given event. The results are sorted so that entries with less
@@ -373,21 +348,27 @@ keyval_in_group (GdkKeymap  *keymap,
  * This means that fuzzy matches won’t be considered if their keyval is 
  * present in the current group.
  * 
- * Returns: A newly-allocated #GSList of matching entries.
- *     Free with g_slist_free() when no longer needed.
+ * Nothing is allocated: the values of the first @max_results matches
+ * are stored in @results. If the return value is larger than
+ * @max_results, call again with more room to get all of them.
+ *
+ * Returns: the number of matching entries
  */
-GSList *
+guint
 _gtk_key_hash_lookup (GtkKeyHash      *key_hash,
 		      guint16          hardware_keycode,
 		      GdkModifierType  state,
 		      GdkModifierType  mask,
-		      gint             group)
+		      gint             group,
+		      gpointer        *results,
+		      guint            max_results)
 {
   GHashTable *keycode_hash = key_hash_get_keycode_hash (key_hash);
-  GSList *keys = g_hash_table_lookup (keycode_hash, GUINT_TO_POINTER ((guint)hardware_keycode));
-  GSList *results = NULL;
-  GSList *l;
+  GPtrArray *entries = g_hash_table_lookup (keycode_hash, GUINT_TO_POINTER ((guint)hardware_keycode));
+  guint n_results = 0;
+  guint n;
   gboolean have_exact = FALSE;
+  gboolean shadowed = FALSE;
   guint keyval;
   gint effective_group;
   gint level;
@@ -423,12 +404,11 @@ _gtk_key_hash_lookup (GtkKeyHash      *key_hash,
 		       "    keyval = %u, group = %d, level = %d, consumed_modifiers = 0x%04x",
 		       hardware_keycode, state, keyval, effective_group, level, consumed_modifiers));
 
-  if (keys)
+  if (entries)
     {
-      GSList *tmp_list = keys;
-      while (tmp_list)
+      for (n = 0; n < entries->len; n++)
 	{
-	  GtkKeyHashEntry *entry = tmp_list->data;
+	  GtkKeyHashEntry *entry = g_ptr_array_index (entries, n);
 
 	  /* If the virtual Super, Hyper or Meta modifiers are present,
 	   * they will also be mapped to some of the Mod2 - Mod5 modifiers,
@@ -438,8 +418,8 @@ _gtk_key_hash_lookup (GtkKeyHash      *key_hash,
 	   * both mapped to Mod4, then pressing a key that is mapped to Mod4
 	   * will not match a Super+Hyper entry.
 	   */
-          modifiers = entry->modifiers;
-          if (gdk_keymap_map_virtual_modifiers (key_hash->keymap, &modifiers) &&
+          modifiers = entry->mapped_modifiers;
+          if (entry->mapped_modifiers_valid &&
 	      ((modifiers & ~consumed_modifiers & mask & ~vmods) == (state & ~consumed_modifiers & mask & ~vmods) ||
 	       (modifiers & ~consumed_modifiers & mask & ~xmods) == (state & ~consumed_modifiers & mask & ~xmods)))
 	    {
@@ -458,13 +438,12 @@ _gtk_key_hash_lookup (GtkKeyHash      *key_hash,
 				       entry->keyval, entry->modifiers));
 
 		  if (!have_exact)
-		    {
-		      g_slist_free (results);
-		      results = NULL;
-		    }
+		    n_results = 0;
 
 		  have_exact = TRUE;
-		  results = g_slist_prepend (results, entry);
+		  if (n_results < max_results)
+		    results[n_results] = entry->value;
+		  n_results++;
 		}
 
 	      if (!have_exact)
@@ -480,47 +459,29 @@ _gtk_key_hash_lookup (GtkKeyHash      *key_hash,
 			  GTK_NOTE (KEYBINDINGS,
 				    g_message ("  found group = %d, level = %d",
 					       entry->keys[i].group, entry->keys[i].level));
-			  results = g_slist_prepend (results, entry);
+
+			  /* If the current group also defines this keyval, a
+			   * widget up in the stack may have an exact match,
+			   * and we don't want to 'steal' it.
+			   */
+			  if (keyval_in_group (entry, group))
+			    shadowed = TRUE;
+
+			  if (n_results < max_results)
+			    results[n_results] = entry->value;
+			  n_results++;
 			  break;
 			}
 		    }
 		}
 	    }
-
-	  tmp_list = tmp_list->next;
 	}
     }
 
-  if (!have_exact && results) 
-    {
-      /* If there are fuzzy matches, check that the current group doesn't also 
-       * define these keyvals; if yes, discard results because a widget up in 
-       * the stack may have an exact match and we don't want to 'steal' it.
-       */
-      guint oldkeyval = 0;
-      GtkKeyHashEntry *keyhashentry;
+  if (!have_exact && shadowed)
+    return 0;
 
-      results = sort_lookup_results_by_keyval (results);
-      for (l = results; l; l = l->next)
-        {
-          keyhashentry = l->data;
-          if (l == results || oldkeyval != keyhashentry->keyval)
-            {
-              oldkeyval = keyhashentry->keyval;
-              if (keyval_in_group (key_hash->keymap, oldkeyval, group))
-                {
-       	          g_slist_free (results);
-       	          return NULL;
-                }
-            }
-        }
-    }
-    
-  results = sort_lookup_results (results);
-  for (l = results; l; l = l->next)
-    l->data = ((GtkKeyHashEntry *)l->data)->value;
-
-  return results;
+  return n_results;
 }
 
 /**
@@ -544,7 +505,6 @@ _gtk_key_hash_lookup_keyval (GtkKeyHash     *key_hash,
   GdkKeymapKey *keys;
   gint n_keys;
   GSList *results = NULL;
-  GSList *l;
 
   if (!keyval)			/* Key without symbol */
     return NULL;
@@ -557,24 +517,20 @@ _gtk_key_hash_lookup_keyval (GtkKeyHash     *key_hash,
   if (n_keys)
     {
       GHashTable *keycode_hash = key_hash_get_keycode_hash (key_hash);
-      GSList *entries = g_hash_table_lookup (keycode_hash, GUINT_TO_POINTER (keys[0].keycode));
+      GPtrArray *entries = g_hash_table_lookup (keycode_hash, GUINT_TO_POINTER (keys[0].keycode));
+      guint i;
 
-      while (entries)
+      /* Backwards, so that the list ends up oldest entry first */
+      for (i = entries ? entries->len : 0; i > 0; i--)
 	{
-	  GtkKeyHashEntry *entry = entries->data;
+	  GtkKeyHashEntry *entry = g_ptr_array_index (entries, i - 1);
 
 	  if (entry->keyval == keyval && entry->modifiers == modifiers)
-	    results = g_slist_prepend (results, entry);
-
-	  entries = entries->next;
+	    results = g_slist_prepend (results, entry->value);
 	}
     }
 
   g_free (keys);
-	  
-  results = sort_lookup_results (results);
-  for (l = results; l; l = l->next)
-    l->data = ((GtkKeyHashEntry *)l->data)->value;
 
   return results;
 }
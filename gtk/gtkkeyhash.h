@@ -34,11 +34,13 @@ void        _gtk_key_hash_add_entry     (GtkKeyHash      *key_hash,
 					 gpointer         value);
 void        _gtk_key_hash_remove_entry  (GtkKeyHash      *key_hash,
 					 gpointer         value);
-GSList *    _gtk_key_hash_lookup        (GtkKeyHash      *key_hash,
+guint       _gtk_key_hash_lookup        (GtkKeyHash      *key_hash,
 					 guint16          hardware_keycode,
 					 GdkModifierType  state,
 					 GdkModifierType  mask,
-					 gint             group);
+					 gint             group,
+					 gpointer        *results,
+					 guint            max_results);
 GSList *    _gtk_key_hash_lookup_keyval (GtkKeyHash      *key_hash,
 					 guint            keyval,
 					 GdkModifierType  modifiers);
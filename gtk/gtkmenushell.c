@@ -1795,7 +1795,7 @@ gtk_menu_shell_activate_mnemonic (GtkMenuShell *menu_shell,
 {
   GtkMnemonicHash *mnemonic_hash;
   GtkKeyHash *key_hash;
-  GSList *entries;
+  gpointer entry;
   gboolean result = FALSE;
 
   mnemonic_hash = gtk_menu_shell_get_mnemonic_hash (menu_shell, FALSE);
@@ -1806,18 +1806,14 @@ gtk_menu_shell_activate_mnemonic (GtkMenuShell *menu_shell,
   if (!key_hash)
     return FALSE;
 
-  entries = _gtk_key_hash_lookup (key_hash,
-                                  event->hardware_keycode,
-                                  event->state,
-                                  gtk_accelerator_get_default_mod_mask (),
-                                  event->group);
-
-  if (entries)
-    {
-      result = _gtk_mnemonic_hash_activate (mnemonic_hash,
-                                            GPOINTER_TO_UINT (entries->data));
-      g_slist_free (entries);
-    }
+  if (_gtk_key_hash_lookup (key_hash,
+                            event->hardware_keycode,
+                            event->state,
+                            gtk_accelerator_get_default_mod_mask (),
+                            event->group,
+                            &entry, 1) > 0)
+    result = _gtk_mnemonic_hash_activate (mnemonic_hash,
+                                          GPOINTER_TO_UINT (entry));
 
   return result;
 }
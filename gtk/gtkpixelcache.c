@@ -20,6 +20,7 @@
 #include "gtkdebug.h"
 #include "gtkprivate.h"
 #include "gtkpixelcacheprivate.h"
+#include "gtkprofilerprivate.h"
 #include "gtkrenderbackgroundprivate.h"
 #include "gtkstylecontextprivate.h"
 
@@ -441,6 +442,8 @@ _gtk_pixel_cache_draw (GtkPixelCache         *cache,
                        GtkPixelCacheDrawFunc  draw,
                        gpointer               user_data)
 {
+  gboolean dirty;
+
   if (cache->timeout_tag)
     g_source_remove (cache->timeout_tag);
 
@@ -451,12 +454,15 @@ _gtk_pixel_cache_draw (GtkPixelCache         *cache,
   _gtk_pixel_cache_create_surface_if_needed (cache, window,
                                              view_rect, canvas_rect);
   _gtk_pixel_cache_set_position (cache, view_rect, canvas_rect);
+  dirty = cache->surface_dirty != NULL && !cairo_region_is_empty (cache->surface_dirty);
   _gtk_pixel_cache_repaint (cache, window, draw, view_rect, canvas_rect, user_data);
 
   if (cache->surface && context_is_unscaled (cr) &&
       /* Don't use backing surface if rendering elsewhere */
       cairo_surface_get_type (cache->surface) == cairo_surface_get_type (cairo_get_target (cr)))
     {
+      _gtk_profiler_count_cache (GTK_PROFILER_CACHE_PIXEL, !dirty);
+
       cairo_save (cr);
       cairo_set_source_surface (cr, cache->surface,
                                 cache->surface_x + view_rect->x + canvas_rect->x,
@@ -468,6 +474,8 @@ _gtk_pixel_cache_draw (GtkPixelCache         *cache,
     }
   else
     {
+      _gtk_profiler_count_cache (GTK_PROFILER_CACHE_PIXEL, FALSE);
+
       cairo_rectangle (cr,
                        view_rect->x, view_rect->y,
                        view_rect->width, view_rect->height);
@@ -55,6 +55,7 @@ struct _GtkPrintOperationPrivate
   guint support_selection  : 1;
   guint has_selection      : 1;
   guint embed_page_setup   : 1;
+  guint parallel_rendering : 1;
 
   GtkPageDrawingState      page_drawing_state;
 
@@ -141,7 +141,8 @@ enum
   PROP_EMBED_PAGE_SETUP,
   PROP_HAS_SELECTION,
   PROP_SUPPORT_SELECTION,
-  PROP_N_PAGES_TO_PRINT
+  PROP_N_PAGES_TO_PRINT,
+  PROP_PARALLEL_RENDERING
 };
 
 static guint signals[LAST_SIGNAL] = { 0 };
@@ -155,6 +156,8 @@ static void          common_render_page      (GtkPrintOperation             *op,
 static void          increment_page_sequence (PrintPagesData *data);
 static void          prepare_data            (PrintPagesData *data);
 static void          clamp_page_ranges       (PrintPagesData *data);
+static gboolean      render_pages_parallel   (PrintPagesData *data);
+static void          free_pages_parallel     (PrintPagesData *data);
 
 
 G_DEFINE_TYPE_WITH_CODE (GtkPrintOperation, gtk_print_operation, G_TYPE_OBJECT,
@@ -243,6 +246,7 @@ gtk_print_operation_init (GtkPrintOperation *operation)
   priv->support_selection = FALSE;
   priv->has_selection = FALSE;
   priv->embed_page_setup = FALSE;
+  priv->parallel_rendering = FALSE;
 
   priv->page_drawing_state = GTK_PAGE_DRAWING_STATE_READY;
 
@@ -419,6 +423,9 @@ gtk_print_operation_set_property (GObject      *object,
     case PROP_EMBED_PAGE_SETUP:
       gtk_print_operation_set_embed_page_setup (op, g_value_get_boolean (value));
       break;
+    case PROP_PARALLEL_RENDERING:
+      gtk_print_operation_set_parallel_rendering (op, g_value_get_boolean (value));
+      break;
     case PROP_HAS_SELECTION:
       gtk_print_operation_set_has_selection (op, g_value_get_boolean (value));
       break;
@@ -496,6 +503,9 @@ gtk_print_operation_get_property (GObject    *object,
     case PROP_N_PAGES_TO_PRINT:
       g_value_set_int (value, priv->nr_of_pages_to_print);
       break;
+    case PROP_PARALLEL_RENDERING:
+      g_value_set_boolean (value, priv->parallel_rendering);
+      break;
     default:
       G_OBJECT_WARN_INVALID_PROPERTY_ID (object, prop_id, pspec);
       break;
@@ -525,6 +535,14 @@ struct _PrintPagesData
   gboolean initialized;
   gboolean is_preview;
   gboolean done;
+
+  /* Parallel rendering, see render_pages_parallel() */
+  gboolean parallel;
+  GThreadPool *pool;
+  GQueue pending;
+  GMutex mutex;
+  GCond cond;
+  gint rendered;
 };
 
 typedef struct
@@ -1449,6 +1467,25 @@ gtk_print_operation_class_init (GtkPrintOperationClass *class)
 						     G_MAXINT,
 						     -1,
 						     GTK_PARAM_READABLE|G_PARAM_EXPLICIT_NOTIFY));
+
+  /**
+   * GtkPrintOperation:parallel-rendering:
+   *
+   * If %TRUE, the #GtkPrintOperation::draw-page signal is emitted from
+   * worker threads for several pages at once, and the pages are written
+   * to the output in order as they complete.
+   *
+   * See gtk_print_operation_set_parallel_rendering().
+   *
+   * Since: 3.22
+   */
+  g_object_class_install_property (gobject_class,
+				   PROP_PARALLEL_RENDERING,
+				   g_param_spec_boolean ("parallel-rendering",
+							 P_("Parallel Rendering"),
+							 P_("TRUE if pages are rendered in worker threads"),
+							 FALSE,
+							 GTK_PARAM_READWRITE|G_PARAM_EXPLICIT_NOTIFY));
 }
 
 /**
@@ -2369,6 +2406,8 @@ print_pages_idle_done (gpointer user_data)
       g_signal_emit (data->op, signals[DONE], 0, result);
     }
   
+  free_pages_parallel (data);
+
   g_object_unref (data->op);
   g_free (data->pages);
   g_free (data);
@@ -2470,6 +2509,63 @@ gtk_print_operation_get_embed_page_setup (GtkPrintOperation *op)
   return op->priv->embed_page_setup;
 }
 
+/**
+ * gtk_print_operation_set_parallel_rendering:
+ * @op: a #GtkPrintOperation
+ * @parallel: %TRUE to render pages in worker threads
+ *
+ * If @parallel is %TRUE, @op renders several pages concurrently when
+ * printing or exporting. Each page is drawn into a recording surface
+ * by emitting #GtkPrintOperation::draw-page from a worker thread, and
+ * the recorded pages are then written to the output in page order.
+ * Progress is reported with #GtkPrintOperation::status-changed.
+ *
+ * This only works if the #GtkPrintOperation::draw-page handlers are
+ * thread-safe: they must not touch widgets or other unlocked shared
+ * state, and must not call gtk_print_operation_set_defer_drawing().
+ * Each handler gets its own #GtkPrintContext, which is only valid
+ * while the handler runs. #GtkPrintOperation::request-page-setup is
+ * still emitted in the main thread. Previews are always rendered in
+ * the main thread.
+ *
+ * Since: 3.22
+ */
+void
+gtk_print_operation_set_parallel_rendering (GtkPrintOperation *op,
+                                            gboolean           parallel)
+{
+  GtkPrintOperationPrivate *priv;
+
+  g_return_if_fail (GTK_IS_PRINT_OPERATION (op));
+
+  priv = op->priv;
+
+  parallel = parallel != FALSE;
+  if (priv->parallel_rendering != parallel)
+    {
+      priv->parallel_rendering = parallel;
+      g_object_notify (G_OBJECT (op), "parallel-rendering");
+    }
+}
+
+/**
+ * gtk_print_operation_get_parallel_rendering:
+ * @op: a #GtkPrintOperation
+ *
+ * Gets the value of #GtkPrintOperation:parallel-rendering property.
+ *
+ * Returns: whether pages are rendered in worker threads
+ *
+ * Since: 3.22
+ */
+gboolean
+gtk_print_operation_get_parallel_rendering (GtkPrintOperation *op)
+{
+  g_return_val_if_fail (GTK_IS_PRINT_OPERATION (op), FALSE);
+
+  return op->priv->parallel_rendering;
+}
+
 /**
  * gtk_print_operation_draw_page_finish:
  * @op: a #GtkPrintOperation
@@ -2507,29 +2603,16 @@ gtk_print_operation_draw_page_finish (GtkPrintOperation *op)
 }
 
 static void
-common_render_page (GtkPrintOperation *op,
-		    gint               page_nr)
+setup_page_transform (GtkPrintOperation *op,
+                      GtkPrintContext   *print_context,
+                      gint               page_position)
 {
   GtkPrintOperationPrivate *priv = op->priv;
   GtkPageSetup *page_setup;
-  GtkPrintContext *print_context;
   cairo_t *cr;
 
-  print_context = priv->print_context;
-  
-  page_setup = create_page_setup (op);
-  
-  g_signal_emit (op, signals[REQUEST_PAGE_SETUP], 0, 
-		 print_context, page_nr, page_setup);
-  
-  _gtk_print_context_set_page_setup (print_context, page_setup);
-  
-  priv->start_page (op, print_context, page_setup);
-  
   cr = gtk_print_context_get_cairo_context (print_context);
-  
-  cairo_save (cr);
-  
+
   if (priv->manual_orientation)
     _gtk_print_context_rotate_according_to_orientation (print_context);
   else
@@ -2627,36 +2710,36 @@ common_render_page (GtkPrintOperation *op,
       switch (priv->manual_number_up_layout)
         {
           case GTK_NUMBER_UP_LAYOUT_LEFT_TO_RIGHT_TOP_TO_BOTTOM:
-            x = priv->page_position % columns;
-            y = (priv->page_position / columns) % rows;
+            x = page_position % columns;
+            y = (page_position / columns) % rows;
             break;
           case GTK_NUMBER_UP_LAYOUT_LEFT_TO_RIGHT_BOTTOM_TO_TOP:
-            x = priv->page_position % columns;
-            y = rows - 1 - (priv->page_position / columns) % rows;
+            x = page_position % columns;
+            y = rows - 1 - (page_position / columns) % rows;
             break;
           case GTK_NUMBER_UP_LAYOUT_RIGHT_TO_LEFT_TOP_TO_BOTTOM:
-            x = columns - 1 - priv->page_position % columns;
-            y = (priv->page_position / columns) % rows;
+            x = columns - 1 - page_position % columns;
+            y = (page_position / columns) % rows;
             break;
           case GTK_NUMBER_UP_LAYOUT_RIGHT_TO_LEFT_BOTTOM_TO_TOP:
-            x = columns - 1 - priv->page_position % columns;
-            y = rows - 1 - (priv->page_position / columns) % rows;
+            x = columns - 1 - page_position % columns;
+            y = rows - 1 - (page_position / columns) % rows;
             break;
           case GTK_NUMBER_UP_LAYOUT_TOP_TO_BOTTOM_LEFT_TO_RIGHT:
-            x = (priv->page_position / rows) % columns;
-            y = priv->page_position % rows;
+            x = (page_position / rows) % columns;
+            y = page_position % rows;
             break;
           case GTK_NUMBER_UP_LAYOUT_TOP_TO_BOTTOM_RIGHT_TO_LEFT:
-            x = columns - 1 - (priv->page_position / rows) % columns;
-            y = priv->page_position % rows;
+            x = columns - 1 - (page_position / rows) % columns;
+            y = page_position % rows;
             break;
           case GTK_NUMBER_UP_LAYOUT_BOTTOM_TO_TOP_LEFT_TO_RIGHT:
-            x = (priv->page_position / rows) % columns;
-            y = rows - 1 - priv->page_position % rows;
+            x = (page_position / rows) % columns;
+            y = rows - 1 - page_position % rows;
             break;
           case GTK_NUMBER_UP_LAYOUT_BOTTOM_TO_TOP_RIGHT_TO_LEFT:
-            x = columns - 1 - (priv->page_position / rows) % columns;
-            y = rows - 1 - priv->page_position % rows;
+            x = columns - 1 - (page_position / rows) % columns;
+            y = rows - 1 - page_position % rows;
             break;
           default:
             g_assert_not_reached();
@@ -2723,7 +2806,34 @@ common_render_page (GtkPrintOperation *op,
           cairo_rotate (cr, - G_PI / 2);
         }
     }
+}
+
+static void
+common_render_page (GtkPrintOperation *op,
+		    gint               page_nr)
+{
+  GtkPrintOperationPrivate *priv = op->priv;
+  GtkPageSetup *page_setup;
+  GtkPrintContext *print_context;
+  cairo_t *cr;
+
+  print_context = priv->print_context;
+  
+  page_setup = create_page_setup (op);
+  
+  g_signal_emit (op, signals[REQUEST_PAGE_SETUP], 0, 
+		 print_context, page_nr, page_setup);
+  
+  _gtk_print_context_set_page_setup (print_context, page_setup);
   
+  priv->start_page (op, print_context, page_setup);
+  
+  cr = gtk_print_context_get_cairo_context (print_context);
+  
+  cairo_save (cr);
+
+  setup_page_transform (op, print_context, priv->page_position);
+
   priv->page_drawing_state = GTK_PAGE_DRAWING_STATE_DRAWING;
 
   g_signal_emit (op, signals[DRAW_PAGE], 0, 
@@ -2733,6 +2843,221 @@ common_render_page (GtkPrintOperation *op,
     gtk_print_operation_draw_page_finish (op);
 }
 
+typedef struct
+{
+  PrintPagesData *data;
+  GtkPrintContext *print_context;
+  GtkPageSetup *page_setup;
+  cairo_surface_t *surface;
+  cairo_matrix_t unit_matrix;
+  gint page_nr;
+  gint page_position;
+  gboolean rendered;
+} ParallelPage;
+
+static void
+parallel_page_free (ParallelPage *page)
+{
+  g_object_unref (page->print_context);
+  g_object_unref (page->page_setup);
+  cairo_surface_destroy (page->surface);
+  g_slice_free (ParallelPage, page);
+}
+
+/* Runs in a worker thread. The draw-page handlers only ever see the
+ * private print context of the page, which draws into a recording
+ * surface, so nothing here touches the real output stream.
+ */
+static void
+render_page_thread (gpointer page_data,
+                    gpointer user_data)
+{
+  ParallelPage *page = page_data;
+  PrintPagesData *data = page->data;
+  cairo_t *cr;
+
+  cr = gtk_print_context_get_cairo_context (page->print_context);
+
+  cairo_save (cr);
+  setup_page_transform (data->op, page->print_context, page->page_position);
+  g_signal_emit (data->op, signals[DRAW_PAGE], 0,
+                 page->print_context, page->page_nr);
+  cairo_restore (cr);
+
+  g_mutex_lock (&data->mutex);
+  page->rendered = TRUE;
+  g_cond_broadcast (&data->cond);
+  g_mutex_unlock (&data->mutex);
+}
+
+static ParallelPage *
+parallel_page_new (PrintPagesData *data)
+{
+  GtkPrintOperationPrivate *priv = data->op->priv;
+  ParallelPage *page;
+  gdouble top, bottom, left, right;
+  cairo_t *cr;
+
+  page = g_slice_new0 (ParallelPage);
+  page->data = data;
+  page->page_nr = data->page;
+  page->page_position = priv->page_position;
+  page->page_setup = create_page_setup (data->op);
+
+  page->print_context = _gtk_print_context_new (data->op);
+  _gtk_print_context_set_page_setup (page->print_context, page->page_setup);
+
+  page->surface = cairo_recording_surface_create (CAIRO_CONTENT_COLOR_ALPHA, NULL);
+  cr = cairo_create (page->surface);
+  gtk_print_context_set_cairo_context (page->print_context, cr,
+                                       gtk_print_context_get_dpi_x (priv->print_context),
+                                       gtk_print_context_get_dpi_y (priv->print_context));
+  cairo_get_matrix (cr, &page->unit_matrix);
+  cairo_destroy (cr);
+
+  /* Hard margins are returned in units but stored in pixels */
+  if (gtk_print_context_get_hard_margins (priv->print_context,
+                                          &top, &bottom, &left, &right))
+    _gtk_print_context_set_hard_margins (page->print_context,
+                                         top * page->unit_matrix.yy,
+                                         bottom * page->unit_matrix.yy,
+                                         left * page->unit_matrix.xx,
+                                         right * page->unit_matrix.xx);
+
+  g_signal_emit (data->op, signals[REQUEST_PAGE_SETUP], 0,
+                 page->print_context, page->page_nr, page->page_setup);
+
+  _gtk_print_context_set_page_setup (page->print_context, page->page_setup);
+
+  return page;
+}
+
+/* Plays a rendered page back into the real print context, going
+ * through start_page/end_page exactly like common_render_page() would.
+ */
+static void
+replay_page (GtkPrintOperation *op,
+             ParallelPage      *page)
+{
+  GtkPrintOperationPrivate *priv = op->priv;
+  cairo_matrix_t matrix;
+  cairo_t *cr;
+
+  priv->page_position = page->page_position;
+
+  _gtk_print_context_set_page_setup (priv->print_context, page->page_setup);
+
+  priv->start_page (op, priv->print_context, page->page_setup);
+
+  cr = gtk_print_context_get_cairo_context (priv->print_context);
+
+  /* The recording already contains the unit scale of the page's
+   * own context, undo ours so it is not applied twice.
+   */
+  matrix = page->unit_matrix;
+  cairo_matrix_invert (&matrix);
+
+  cairo_save (cr);
+  cairo_transform (cr, &matrix);
+  cairo_set_source_surface (cr, page->surface, 0, 0);
+  cairo_paint (cr);
+  cairo_restore (cr);
+
+  priv->end_page (op, priv->print_context);
+}
+
+/* Instead of emitting draw-page for one page per idle, queue up to
+ * two pages per processor on a thread pool and replay them in order
+ * as they complete. Only the window of queued pages is kept in
+ * memory, so long jobs stream into the output like serial ones do.
+ */
+static gboolean
+render_pages_parallel (PrintPagesData *data)
+{
+  GtkPrintOperation *op = data->op;
+  ParallelPage *page;
+  guint max_pending;
+  gint64 end_time;
+  gchar *text;
+
+  max_pending = 2 * g_get_num_processors ();
+
+  if (data->pool == NULL)
+    {
+      g_mutex_init (&data->mutex);
+      g_cond_init (&data->cond);
+      data->pool = g_thread_pool_new (render_page_thread, NULL,
+                                      g_get_num_processors (), FALSE, NULL);
+    }
+
+  while (!data->done && g_queue_get_length (&data->pending) < max_pending)
+    {
+      increment_page_sequence (data);
+      if (data->done)
+        break;
+
+      page = parallel_page_new (data);
+      g_queue_push_tail (&data->pending, page);
+      g_thread_pool_push (data->pool, page, NULL);
+    }
+
+  page = g_queue_peek_head (&data->pending);
+  if (page == NULL)
+    return data->done;
+
+  /* Don't spin the main loop while the oldest page is still being
+   * drawn, but don't block it for long either.
+   */
+  end_time = g_get_monotonic_time () + 10 * G_TIME_SPAN_MILLISECOND;
+  g_mutex_lock (&data->mutex);
+  while (!page->rendered)
+    {
+      if (!g_cond_wait_until (&data->cond, &data->mutex, end_time))
+        break;
+    }
+  g_mutex_unlock (&data->mutex);
+
+  while ((page = g_queue_peek_head (&data->pending)) != NULL)
+    {
+      gboolean rendered;
+
+      g_mutex_lock (&data->mutex);
+      rendered = page->rendered;
+      g_mutex_unlock (&data->mutex);
+
+      if (!rendered)
+        break;
+
+      g_queue_pop_head (&data->pending);
+      replay_page (op, page);
+      parallel_page_free (page);
+
+      data->rendered++;
+    }
+
+  text = g_strdup_printf (_("Generating data (%d pages done)"), data->rendered);
+  _gtk_print_operation_set_status (op, GTK_PRINT_STATUS_GENERATING_DATA, text);
+  g_free (text);
+
+  return data->done && g_queue_is_empty (&data->pending);
+}
+
+static void
+free_pages_parallel (PrintPagesData *data)
+{
+  if (data->pool == NULL)
+    return;
+
+  /* Drops pages that were not started yet and waits for the rest */
+  g_thread_pool_free (data->pool, TRUE, TRUE);
+  data->pool = NULL;
+
+  while (!g_queue_is_empty (&data->pending))
+    parallel_page_free (g_queue_pop_head (&data->pending));
+  g_mutex_clear (&data->mutex);
+  g_cond_clear (&data->cond);
+}
+
 static void
 prepare_data (PrintPagesData *data)
 {
@@ -2928,6 +3253,12 @@ print_pages_idle (gpointer user_data)
           goto out;
         }
 
+      if (data->parallel)
+        {
+          done = render_pages_parallel (data);
+          goto out;
+        }
+
       increment_page_sequence (data);
 
       if (!data->done)
@@ -2947,6 +3278,9 @@ print_pages_idle (gpointer user_data)
 
       if (done && !data->is_preview)
         {
+          /* No draw-page handler may still be running at end-print */
+          free_pages_parallel (data);
+
           g_signal_emit (data->op, signals[END_PRINT], 0, priv->print_context);
           priv->end_run (data->op, priv->is_sync, priv->cancelled);
         }
@@ -3090,6 +3424,8 @@ print_pages (GtkPrintOperation       *op,
       priv->manual_number_up = gtk_print_settings_get_number_up (priv->print_settings);
       priv->manual_number_up_layout = gtk_print_settings_get_number_up_layout (priv->print_settings);
     }
+  else
+    data->parallel = priv->parallel_rendering;
   
   priv->print_pages_idle_id = gdk_threads_add_idle_full (G_PRIORITY_DEFAULT_IDLE + 10,
 					                 print_pages_idle, 
@@ -307,6 +307,11 @@ GDK_AVAILABLE_IN_ALL
 gboolean                gtk_print_operation_get_embed_page_setup   (GtkPrintOperation  *op);
 GDK_AVAILABLE_IN_ALL
 gint                    gtk_print_operation_get_n_pages_to_print   (GtkPrintOperation  *op);
+GDK_AVAILABLE_IN_3_22
+void                    gtk_print_operation_set_parallel_rendering (GtkPrintOperation  *op,
+                                                                    gboolean            parallel);
+GDK_AVAILABLE_IN_3_22
+gboolean                gtk_print_operation_get_parallel_rendering (GtkPrintOperation  *op);
 
 GDK_AVAILABLE_IN_ALL
 GtkPageSetup           *gtk_print_run_page_setup_dialog            (GtkWindow          *parent,
@@ -26,6 +26,7 @@
 
 #include <locale.h>
 #include <stdlib.h>
+#include <string.h>
 
 #include "gdk/gdk.h"
 
@@ -267,3 +268,18 @@ _gtk_ensure_resources (void)
 
   g_once (&register_resources_once, register_resources, NULL);
 }
+
+/* gtk_get_env_flag:
+ * @name: the name of an environment variable
+ *
+ * Returns whether the variable @name is set to something other than
+ * an empty string or 0, for optional behaviour that is turned on from
+ * the environment.
+ */
+gboolean
+gtk_get_env_flag (const char *name)
+{
+  const char *env = g_getenv (name);
+
+  return env != NULL && env[0] != '\0' && strcmp (env, "0") != 0;
+}
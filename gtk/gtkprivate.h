@@ -97,6 +97,8 @@ void _gtk_load_dll_with_libgtk3_manifest (const char *dllname);
 
 gboolean        gtk_simulate_touchscreen (void);
 
+gboolean        gtk_get_env_flag         (const char *name);
+
 guint gtk_get_display_debug_flags (GdkDisplay *display);
 
 #ifdef G_ENABLE_DEBUG
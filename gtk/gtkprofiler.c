@@ -0,0 +1,510 @@
+/* gtkprofiler.c
+ * Copyright (C) 2016 Red Hat, Inc.
+ *
+ * This library is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Library General Public
+ * License as published by the Free Software Foundation; either
+ * version 2 of the License, or (at your option) any later version.
+ *
+ * This library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Library General Public License for more details.
+ *
+ * You should have received a copy of the GNU Library General Public
+ * License along with this library. If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include "config.h"
+
+#include "gtkprofilerprivate.h"
+
+#include <string.h>
+
+/* The profiler collects the timings shown by the performance page of
+ * the inspector. Nothing is recorded unless the inspector asked for it.
+ *
+ * Only work done while one of the watched frame clocks is inside a
+ * frame is accounted for, so that the inspector, which has its own
+ * frame clock, does not show up in its own measurements.
+ *
+ * Timings of widget operations nest: the time a widget spends in the
+ * operations of its children is counted in its total time, but not
+ * in its self time.
+ */
+
+#define MAX_EVENTS 250000
+
+typedef struct {
+  gint64 start;
+  gint64 children;
+} StackEntry;
+
+typedef struct {
+  GdkFrameClock *clock;
+  gulong handlers[6];
+  gint64 frame_start;
+  gint64 phase_start;
+} FrameWatch;
+
+static gboolean recording = FALSE;
+static guint in_frame = 0;
+static GArray *events = NULL;
+static GArray *stack = NULL;
+static GPtrArray *watches = NULL;
+static GHashTable *widget_stats = NULL;
+static GHashTable *node_stats = NULL;
+static GPtrArray *finished_widget_stats = NULL;
+static GPtrArray *finished_node_stats = NULL;
+static guint cache_hits[GTK_PROFILER_N_CACHES];
+static guint cache_misses[GTK_PROFILER_N_CACHES];
+
+static const gchar *operation_names[GTK_PROFILER_N_OPERATIONS] = {
+  "Frame",
+  "Update",
+  "Layout",
+  "Paint",
+  "Measure",
+  "Allocate",
+  "Draw"
+};
+
+const gchar *
+_gtk_profiler_operation_get_name (GtkProfilerOperation operation)
+{
+  g_return_val_if_fail (operation < GTK_PROFILER_N_OPERATIONS, NULL);
+
+  return operation_names[operation];
+}
+
+static void
+add_event (GtkProfilerOperation  operation,
+           const gchar          *name,
+           gint64                start,
+           gint64                end,
+           guint                 depth)
+{
+  GtkProfilerEvent event;
+
+  if (events->len >= MAX_EVENTS)
+    return;
+
+  event.start = start;
+  event.end = end;
+  event.name = name;
+  event.operation = operation;
+  event.depth = depth;
+
+  g_array_append_val (events, event);
+}
+
+static void
+widget_stats_free (gpointer data)
+{
+  GtkProfilerWidgetStats *stats = data;
+
+  g_free (stats->name);
+  g_free (stats);
+}
+
+static void
+node_stats_free (gpointer data)
+{
+  GtkProfilerNodeStats *stats = data;
+
+  g_free (stats->name);
+  g_free (stats);
+}
+
+static void
+widget_finalized (gpointer  data,
+                  GObject  *where_the_object_was)
+{
+  gpointer stats;
+
+  if (g_hash_table_lookup_extended (widget_stats, where_the_object_was, NULL, &stats))
+    {
+      g_hash_table_steal (widget_stats, where_the_object_was);
+      g_ptr_array_add (finished_widget_stats, stats);
+    }
+}
+
+static void
+node_finalized (gpointer  data,
+                GObject  *where_the_object_was)
+{
+  gpointer stats;
+
+  if (g_hash_table_lookup_extended (node_stats, where_the_object_was, NULL, &stats))
+    {
+      g_hash_table_steal (node_stats, where_the_object_was);
+      g_ptr_array_add (finished_node_stats, stats);
+    }
+}
+
+static void
+frame_watch_free (gpointer data)
+{
+  FrameWatch *watch = data;
+  guint i;
+
+  for (i = 0; i < G_N_ELEMENTS (watch->handlers); i++)
+    g_signal_handler_disconnect (watch->clock, watch->handlers[i]);
+
+  g_object_unref (watch->clock);
+  g_free (watch);
+}
+
+static void
+clear_data (void)
+{
+  GHashTableIter iter;
+  gpointer key;
+
+  if (widget_stats)
+    {
+      g_hash_table_iter_init (&iter, widget_stats);
+      while (g_hash_table_iter_next (&iter, &key, NULL))
+        g_object_weak_unref (key, widget_finalized, NULL);
+      g_hash_table_unref (widget_stats);
+      widget_stats = NULL;
+    }
+
+  if (node_stats)
+    {
+      g_hash_table_iter_init (&iter, node_stats);
+      while (g_hash_table_iter_next (&iter, &key, NULL))
+        g_object_weak_unref (key, node_finalized, NULL);
+      g_hash_table_unref (node_stats);
+      node_stats = NULL;
+    }
+
+  g_clear_pointer (&finished_widget_stats, g_ptr_array_unref);
+  g_clear_pointer (&finished_node_stats, g_ptr_array_unref);
+  g_clear_pointer (&events, g_array_unref);
+
+  memset (cache_hits, 0, sizeof (cache_hits));
+  memset (cache_misses, 0, sizeof (cache_misses));
+}
+
+/*
+ * Starts a new capture, discarding the previous one, or stops the
+ * current capture. The data of a stopped capture stays available
+ * until the next one starts.
+ */
+void
+_gtk_profiler_set_recording (gboolean record)
+{
+  if (recording == record)
+    return;
+
+  recording = record;
+
+  if (record)
+    {
+      clear_data ();
+
+      events = g_array_new (FALSE, FALSE, sizeof (GtkProfilerEvent));
+      stack = g_array_new (FALSE, FALSE, sizeof (StackEntry));
+      watches = g_ptr_array_new_with_free_func (frame_watch_free);
+      widget_stats = g_hash_table_new_full (NULL, NULL, NULL, widget_stats_free);
+      node_stats = g_hash_table_new_full (NULL, NULL, NULL, node_stats_free);
+      finished_widget_stats = g_ptr_array_new_with_free_func (widget_stats_free);
+      finished_node_stats = g_ptr_array_new_with_free_func (node_stats_free);
+    }
+  else
+    {
+      g_clear_pointer (&watches, g_ptr_array_unref);
+      g_clear_pointer (&stack, g_array_unref);
+      in_frame = 0;
+    }
+}
+
+gboolean
+_gtk_profiler_get_recording (void)
+{
+  return recording;
+}
+
+static void
+frame_started (GdkFrameClock *clock,
+               FrameWatch    *watch)
+{
+  watch->frame_start = g_get_monotonic_time ();
+  watch->phase_start = watch->frame_start;
+  in_frame++;
+}
+
+static void
+phase_ended (FrameWatch           *watch,
+             GtkProfilerOperation  operation)
+{
+  gint64 now;
+
+  if (watch->frame_start == 0)
+    return;
+
+  now = g_get_monotonic_time ();
+  if (operation != GTK_PROFILER_N_OPERATIONS)
+    add_event (operation, operation_names[operation], watch->phase_start, now, 1);
+  watch->phase_start = now;
+}
+
+static void
+before_paint_done (GdkFrameClock *clock,
+                   FrameWatch    *watch)
+{
+  phase_ended (watch, GTK_PROFILER_N_OPERATIONS);
+}
+
+static void
+update_done (GdkFrameClock *clock,
+             FrameWatch    *watch)
+{
+  phase_ended (watch, GTK_PROFILER_UPDATE);
+}
+
+static void
+layout_done (GdkFrameClock *clock,
+             FrameWatch    *watch)
+{
+  phase_ended (watch, GTK_PROFILER_LAYOUT);
+}
+
+static void
+paint_done (GdkFrameClock *clock,
+            FrameWatch    *watch)
+{
+  phase_ended (watch, GTK_PROFILER_PAINT);
+}
+
+static void
+frame_done (GdkFrameClock *clock,
+            FrameWatch    *watch)
+{
+  if (watch->frame_start == 0)
+    return;
+
+  add_event (GTK_PROFILER_FRAME, operation_names[GTK_PROFILER_FRAME],
+             watch->frame_start, g_get_monotonic_time (), 0);
+  watch->frame_start = 0;
+  in_frame--;
+}
+
+/*
+ * Records the phases of the frames of @clock, and the work done by
+ * widgets during these frames, until recording stops.
+ */
+void
+_gtk_profiler_watch_frame_clock (GdkFrameClock *clock)
+{
+  FrameWatch *watch;
+  guint i;
+
+  if (!recording)
+    return;
+
+  for (i = 0; i < watches->len; i++)
+    {
+      watch = g_ptr_array_index (watches, i);
+      if (watch->clock == clock)
+        return;
+    }
+
+  /* A phase ends when all of its handlers ran, so connect after them */
+  watch = g_new0 (FrameWatch, 1);
+  watch->clock = g_object_ref (clock);
+  watch->handlers[0] = g_signal_connect (clock, "before-paint", G_CALLBACK (frame_started), watch);
+  watch->handlers[1] = g_signal_connect_after (clock, "before-paint", G_CALLBACK (before_paint_done), watch);
+  watch->handlers[2] = g_signal_connect_after (clock, "update", G_CALLBACK (update_done), watch);
+  watch->handlers[3] = g_signal_connect_after (clock, "layout", G_CALLBACK (layout_done), watch);
+  watch->handlers[4] = g_signal_connect_after (clock, "paint", G_CALLBACK (paint_done), watch);
+  watch->handlers[5] = g_signal_connect_after (clock, "after-paint", G_CALLBACK (frame_done), watch);
+
+  g_ptr_array_add (watches, watch);
+}
+
+/*
+ * Returns the start time to pass to _gtk_profiler_end(),
+ * or 0 if nothing needs to be recorded.
+ */
+gint64
+_gtk_profiler_begin (void)
+{
+  StackEntry entry;
+
+  if (G_LIKELY (!recording) || in_frame == 0)
+    return 0;
+
+  entry.start = g_get_monotonic_time ();
+  entry.children = 0;
+  g_array_append_val (stack, entry);
+
+  return entry.start;
+}
+
+static GtkProfilerWidgetStats *
+get_widget_stats (GtkWidget *widget)
+{
+  GtkProfilerWidgetStats *stats;
+  const gchar *type_name, *name;
+
+  stats = g_hash_table_lookup (widget_stats, widget);
+  if (stats)
+    return stats;
+
+  type_name = G_OBJECT_TYPE_NAME (widget);
+  name = gtk_widget_get_name (widget);
+
+  stats = g_new0 (GtkProfilerWidgetStats, 1);
+  if (g_strcmp0 (name, type_name) != 0)
+    stats->name = g_strdup_printf ("%s#%s", type_name, name);
+  else
+    stats->name = g_strdup (type_name);
+
+  g_hash_table_insert (widget_stats, widget, stats);
+  g_object_weak_ref (G_OBJECT (widget), widget_finalized, NULL);
+
+  return stats;
+}
+
+void
+_gtk_profiler_end (GtkWidget            *widget,
+                   GtkProfilerOperation  operation,
+                   gint64                start)
+{
+  GtkProfilerWidgetStats *stats;
+  gint64 end, duration, children;
+
+  if (start == 0 || stack == NULL || stack->len == 0)
+    return;
+
+  end = g_get_monotonic_time ();
+  duration = end - start;
+
+  children = g_array_index (stack, StackEntry, stack->len - 1).children;
+  g_array_set_size (stack, stack->len - 1);
+  if (stack->len > 0)
+    g_array_index (stack, StackEntry, stack->len - 1).children += duration;
+
+  add_event (operation, G_OBJECT_TYPE_NAME (widget), start, end, 2 + stack->len);
+
+  stats = get_widget_stats (widget);
+  stats->total_time[operation] += duration;
+  stats->self_time[operation] += duration - children;
+  stats->count[operation]++;
+}
+
+void
+_gtk_profiler_count_style (GtkCssNode *node,
+                           gboolean    cache_hit)
+{
+  GtkProfilerNodeStats *stats;
+  const gchar *name, *id;
+
+  if (G_LIKELY (!recording) || in_frame == 0)
+    return;
+
+  _gtk_profiler_count_cache (GTK_PROFILER_CACHE_STYLE, cache_hit);
+
+  stats = g_hash_table_lookup (node_stats, node);
+  if (stats == NULL)
+    {
+      name = gtk_css_node_get_name (node);
+      if (name == NULL)
+        name = g_type_name (gtk_css_node_get_widget_type (node));
+      if (name == NULL)
+        name = G_OBJECT_TYPE_NAME (node);
+      id = gtk_css_node_get_id (node);
+
+      stats = g_new0 (GtkProfilerNodeStats, 1);
+      if (id)
+        stats->name = g_strdup_printf ("%s#%s", name, id);
+      else
+        stats->name = g_strdup (name);
+
+      g_hash_table_insert (node_stats, node, stats);
+      g_object_weak_ref (G_OBJECT (node), node_finalized, NULL);
+    }
+
+  stats->recomputed++;
+  if (cache_hit)
+    stats->cache_hits++;
+}
+
+void
+_gtk_profiler_count_cache (GtkProfilerCache cache,
+                           gboolean         hit)
+{
+  if (G_LIKELY (!recording) || in_frame == 0)
+    return;
+
+  if (hit)
+    cache_hits[cache]++;
+  else
+    cache_misses[cache]++;
+}
+
+const GtkProfilerEvent *
+_gtk_profiler_get_events (guint *n_events)
+{
+  if (events == NULL)
+    {
+      *n_events = 0;
+      return NULL;
+    }
+
+  *n_events = events->len;
+  return (const GtkProfilerEvent *) events->data;
+}
+
+static GPtrArray *
+collect_stats (GHashTable *live,
+               GPtrArray  *finished)
+{
+  GPtrArray *result;
+  GHashTableIter iter;
+  gpointer value;
+  guint i;
+
+  result = g_ptr_array_new ();
+
+  if (live)
+    {
+      g_hash_table_iter_init (&iter, live);
+      while (g_hash_table_iter_next (&iter, NULL, &value))
+        g_ptr_array_add (result, value);
+    }
+
+  if (finished)
+    {
+      for (i = 0; i < finished->len; i++)
+        g_ptr_array_add (result, g_ptr_array_index (finished, i));
+    }
+
+  return result;
+}
+
+/* The returned array must be freed, but not its elements, which stay
+ * valid until the next capture starts.
+ */
+GPtrArray *
+_gtk_profiler_get_widget_stats (void)
+{
+  return collect_stats (widget_stats, finished_widget_stats);
+}
+
+GPtrArray *
+_gtk_profiler_get_node_stats (void)
+{
+  return collect_stats (node_stats, finished_node_stats);
+}
+
+void
+_gtk_profiler_get_cache_statistics (GtkProfilerCache  cache,
+                                    guint            *hits,
+                                    guint            *misses)
+{
+  *hits = cache_hits[cache];
+  *misses = cache_misses[cache];
+}
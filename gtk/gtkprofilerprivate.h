@@ -0,0 +1,87 @@
+/* gtkprofilerprivate.h
+ * Copyright (C) 2016 Red Hat, Inc.
+ *
+ * This library is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Library General Public
+ * License as published by the Free Software Foundation; either
+ * version 2 of the License, or (at your option) any later version.
+ *
+ * This library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Library General Public License for more details.
+ *
+ * You should have received a copy of the GNU Library General Public
+ * License along with this library. If not, see <http://www.gnu.org/licenses/>.
+ */
+#ifndef __GTK_PROFILER_PRIVATE_H__
+#define __GTK_PROFILER_PRIVATE_H__
+
+#include <gtk/gtkwidget.h>
+#include "gtkcssnodeprivate.h"
+
+G_BEGIN_DECLS
+
+typedef enum {
+  GTK_PROFILER_FRAME,
+  GTK_PROFILER_UPDATE,
+  GTK_PROFILER_LAYOUT,
+  GTK_PROFILER_PAINT,
+  GTK_PROFILER_MEASURE,
+  GTK_PROFILER_ALLOCATE,
+  GTK_PROFILER_DRAW,
+  GTK_PROFILER_N_OPERATIONS
+} GtkProfilerOperation;
+
+typedef enum {
+  GTK_PROFILER_CACHE_PIXEL,
+  GTK_PROFILER_CACHE_STYLE,
+  GTK_PROFILER_CACHE_RENDER,
+  GTK_PROFILER_N_CACHES
+} GtkProfilerCache;
+
+typedef struct {
+  gint64       start;
+  gint64       end;
+  const gchar *name;
+  guint        operation : 8;
+  guint        depth     : 24;
+} GtkProfilerEvent;
+
+typedef struct {
+  gchar  *name;
+  gint64  total_time[GTK_PROFILER_N_OPERATIONS];
+  gint64  self_time[GTK_PROFILER_N_OPERATIONS];
+  guint   count[GTK_PROFILER_N_OPERATIONS];
+} GtkProfilerWidgetStats;
+
+typedef struct {
+  gchar *name;
+  guint  recomputed;
+  guint  cache_hits;
+} GtkProfilerNodeStats;
+
+void                    _gtk_profiler_set_recording        (gboolean              recording);
+gboolean                _gtk_profiler_get_recording        (void);
+void                    _gtk_profiler_watch_frame_clock    (GdkFrameClock        *clock);
+
+gint64                  _gtk_profiler_begin                (void);
+void                    _gtk_profiler_end                  (GtkWidget            *widget,
+                                                            GtkProfilerOperation  operation,
+                                                            gint64                start);
+void                    _gtk_profiler_count_style          (GtkCssNode           *node,
+                                                            gboolean              cache_hit);
+void                    _gtk_profiler_count_cache          (GtkProfilerCache      cache,
+                                                            gboolean              hit);
+
+const GtkProfilerEvent *_gtk_profiler_get_events           (guint                *n_events);
+GPtrArray *             _gtk_profiler_get_widget_stats     (void);
+GPtrArray *             _gtk_profiler_get_node_stats       (void);
+void                    _gtk_profiler_get_cache_statistics (GtkProfilerCache      cache,
+                                                            guint                *hits,
+                                                            guint                *misses);
+const gchar *           _gtk_profiler_operation_get_name   (GtkProfilerOperation  operation);
+
+G_END_DECLS
+
+#endif /* __GTK_PROFILER_PRIVATE_H__ */
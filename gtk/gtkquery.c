@@ -100,8 +100,11 @@ gtk_query_set_location (GtkQuery *query,
   g_set_object (&query->priv->location, file);
 }
 
-static gchar *
-prepare_string_for_compare (const gchar *string)
+/* Returns the form of @string that query words are compared
+ * against, see gtk_query_matches_string()
+ */
+gchar *
+gtk_query_prepare_string (const gchar *string)
 {
   gchar *normalized, *res;
 
@@ -125,12 +128,12 @@ gtk_query_matches_string (GtkQuery    *query,
 
   if (!query->priv->words)
     {
-      prepared = prepare_string_for_compare (query->priv->text);
+      prepared = gtk_query_prepare_string (query->priv->text);
       query->priv->words = g_strsplit (prepared, " ", -1);
       g_free (prepared);
     }
 
-  prepared = prepare_string_for_compare (string);
+  prepared = gtk_query_prepare_string (string);
 
   found = TRUE;
   for (i = 0; query->priv->words[i]; i++)
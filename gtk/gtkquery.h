@@ -63,6 +63,7 @@ void         gtk_query_set_location   (GtkQuery    *query,
 
 gboolean     gtk_query_matches_string (GtkQuery    *query,
                                        const gchar *string);
+gchar       *gtk_query_prepare_string (const gchar *string);
 
 G_END_DECLS
 
@@ -0,0 +1,858 @@
+/* gtkrecentjournal.c
+ * Copyright (C) 2016 Red Hat, Inc.
+ *
+ * This library is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Library General Public
+ * License as published by the Free Software Foundation; either
+ * version 2 of the License, or (at your option) any later version.
+ *
+ * This library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Library General Public License for more details.
+ *
+ * You should have received a copy of the GNU Library General Public
+ * License along with this library. If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include "config.h"
+
+#include "gtkrecentjournalprivate.h"
+
+#include <errno.h>
+#include <string.h>
+#include <stdlib.h>
+#include <time.h>
+#include <sys/types.h>
+#include <sys/stat.h>
+#include <glib/gstdio.h>
+
+#ifdef G_OS_UNIX
+#include <fcntl.h>
+#include <unistd.h>
+#endif
+
+/* The recently used resources list is stored in an XBEL file, which
+ * other toolkits and older versions of GTK+ read and write as a whole.
+ * Rewriting that file on every change, and reparsing it in every
+ * process whenever someone else changed it, gets expensive once the
+ * list is large, so next to it we keep a journal of the changes
+ * that have not been folded into the XBEL file yet:
+ *
+ *   # gtk-recent-journal 1 <stamp>
+ *   A <uri> <title> <description> <mime type> <private> <app name> <app exec> <time> <n groups> <group>...
+ *   R <uri>
+ *   M <uri> <new uri>
+ *   C
+ *
+ * Fields are separated by tabs, with tabs, newlines and backslashes
+ * escaped. An "A" record is one call to gtk_recent_manager_add_full(),
+ * "R" removes an item, "M" moves it and "C" removes all items. The
+ * stamp identifies the XBEL file the records apply to. If the XBEL
+ * file gets replaced by someone who does not know about the journal,
+ * the records are stale; they are still replayed on top of the new
+ * file, and the next writer folds them into it.
+ *
+ * The journal is only ever appended to, under an exclusive lock, so
+ * that readers only need to replay the records added since they last
+ * looked. The writer folds it back into the XBEL file and truncates
+ * it when asked to, which GtkRecentManager does shortly after each
+ * change, and whenever it has grown too large.
+ *
+ * Locking needs fcntl(), so the journal is only used on Unix; the
+ * functions taking a journal accept %NULL and then only operate on
+ * the bookmarks.
+ */
+
+#define JOURNAL_SUFFIX   ".journal"
+#define JOURNAL_MAGIC    "# gtk-recent-journal 1 "
+#define MAX_HEADER_SIZE  256
+#define MAX_JOURNAL_SIZE (256 * 1024)
+
+struct _GtkRecentJournal
+{
+  gchar *filename;   /* the XBEL file */
+  gchar *path;       /* the journal next to it */
+  gchar *stamp;      /* stamp of the XBEL file we loaded */
+  goffset offset;    /* how far we replayed the journal, 0 if not at all */
+  gboolean stale;    /* we replayed records meant for another XBEL file */
+  GString *pending;  /* our records that are not written yet */
+};
+
+GtkRecentJournal *
+_gtk_recent_journal_new (const gchar *filename)
+{
+#ifdef G_OS_UNIX
+  GtkRecentJournal *journal;
+
+  g_return_val_if_fail (filename != NULL, NULL);
+
+  journal = g_slice_new0 (GtkRecentJournal);
+  journal->filename = g_strdup (filename);
+  journal->path = g_strconcat (filename, JOURNAL_SUFFIX, NULL);
+  journal->pending = g_string_new (NULL);
+
+  return journal;
+#else
+  return NULL;
+#endif
+}
+
+void
+_gtk_recent_journal_free (GtkRecentJournal *journal)
+{
+  if (journal == NULL)
+    return;
+
+  g_free (journal->filename);
+  g_free (journal->path);
+  g_free (journal->stamp);
+  g_string_free (journal->pending, TRUE);
+  g_slice_free (GtkRecentJournal, journal);
+}
+
+const gchar *
+_gtk_recent_journal_get_path (GtkRecentJournal *journal)
+{
+  return journal->path;
+}
+
+/* Records */
+
+static void
+append_field (GString     *record,
+              const gchar *value)
+{
+  const gchar *p;
+
+  g_string_append_c (record, '\t');
+
+  if (value == NULL)
+    return;
+
+  for (p = value; *p; p++)
+    {
+      switch (*p)
+        {
+        case '\\':
+          g_string_append (record, "\\\\");
+          break;
+        case '\t':
+          g_string_append (record, "\\t");
+          break;
+        case '\n':
+          g_string_append (record, "\\n");
+          break;
+        default:
+          g_string_append_c (record, *p);
+          break;
+        }
+    }
+}
+
+/* unescapes in place */
+static void
+parse_field (gchar *field)
+{
+  gchar *p, *q;
+
+  for (p = q = field; *p; p++, q++)
+    {
+      if (*p == '\\' && p[1] != '\0')
+        {
+          p++;
+          if (*p == 't')
+            *q = '\t';
+          else if (*p == 'n')
+            *q = '\n';
+          else
+            *q = *p;
+        }
+      else
+        *q = *p;
+    }
+
+  *q = '\0';
+}
+
+static void
+apply_add (GBookmarkFile  *bookmarks,
+           const gchar    *uri,
+           const gchar    *title,
+           const gchar    *description,
+           const gchar    *mime_type,
+           gboolean        is_private,
+           const gchar    *app_name,
+           const gchar    *app_exec,
+           time_t          stamp,
+           gchar         **groups)
+{
+  gboolean existed;
+  gint i;
+
+  existed = g_bookmark_file_has_item (bookmarks, uri);
+
+  if (title && *title)
+    g_bookmark_file_set_title (bookmarks, uri, title);
+
+  if (description && *description)
+    g_bookmark_file_set_description (bookmarks, uri, description);
+
+  g_bookmark_file_set_mime_type (bookmarks, uri, mime_type);
+
+  for (i = 0; groups && groups[i] != NULL; i++)
+    g_bookmark_file_add_group (bookmarks, uri, groups[i]);
+
+  /* this is what g_bookmark_file_add_application() does, except that
+   * we use the time of the original call, so that every process
+   * replaying the record ends up with the same data
+   */
+  g_bookmark_file_set_app_info (bookmarks, uri, app_name, app_exec,
+                                -1, stamp, NULL);
+
+  g_bookmark_file_set_is_private (bookmarks, uri, is_private);
+
+  if (!existed)
+    g_bookmark_file_set_added (bookmarks, uri, stamp);
+  g_bookmark_file_set_modified (bookmarks, uri, stamp);
+}
+
+static void
+add_changed (GHashTable  *changed,
+             const gchar *uri)
+{
+  if (changed != NULL && uri != NULL)
+    g_hash_table_add (changed, g_strdup (uri));
+}
+
+static void
+replay_record (gchar          *line,
+               GBookmarkFile **bookmarks,
+               GHashTable     *changed)
+{
+  gchar **fields;
+  guint n_fields, i;
+
+  fields = g_strsplit (line, "\t", -1);
+  n_fields = g_strv_length (fields);
+  for (i = 1; i < n_fields; i++)
+    parse_field (fields[i]);
+
+  switch (fields[0][0])
+    {
+    case 'A':
+      if (n_fields >= 10 &&
+          n_fields == 10 + (guint) atoi (fields[9]))
+        {
+          apply_add (*bookmarks,
+                     fields[1], fields[2], fields[3], fields[4],
+                     atoi (fields[5]) != 0,
+                     fields[6], fields[7],
+                     (time_t) g_ascii_strtoll (fields[8], NULL, 10),
+                     fields + 10);
+          add_changed (changed, fields[1]);
+        }
+      break;
+
+    case 'R':
+      if (n_fields == 2)
+        {
+          g_bookmark_file_remove_item (*bookmarks, fields[1], NULL);
+          add_changed (changed, fields[1]);
+        }
+      break;
+
+    case 'M':
+      if (n_fields == 3)
+        {
+          g_bookmark_file_move_item (*bookmarks, fields[1],
+                                     *fields[2] ? fields[2] : NULL,
+                                     NULL);
+          add_changed (changed, fields[1]);
+          add_changed (changed, fields[2]);
+        }
+      break;
+
+    case 'C':
+      {
+        GBookmarkFile *old = *bookmarks;
+
+        /* allocate first, callers compare the pointers */
+        *bookmarks = g_bookmark_file_new ();
+        g_bookmark_file_free (old);
+      }
+      break;
+
+    default:
+      break;
+    }
+
+  g_strfreev (fields);
+}
+
+/* Replays the complete lines in data, and returns how many bytes
+ * they took up.
+ */
+static gsize
+replay_records (gchar          *data,
+                gsize           length,
+                GBookmarkFile **bookmarks,
+                GHashTable     *changed)
+{
+  gchar *line, *end;
+
+  line = data;
+  while (line < data + length &&
+         (end = memchr (line, '\n', data + length - line)) != NULL)
+    {
+      *end = '\0';
+      if (end > line)
+        replay_record (line, bookmarks, changed);
+      line = end + 1;
+    }
+
+  return line - data;
+}
+
+void
+_gtk_recent_journal_add_item (GtkRecentJournal    *journal,
+                              GBookmarkFile       *bookmarks,
+                              const gchar         *uri,
+                              const GtkRecentData *data)
+{
+  gchar *app_exec;
+  time_t stamp;
+  gint n_groups, i;
+
+  if (data->app_exec && *data->app_exec)
+    app_exec = g_strdup (data->app_exec);
+  else
+    app_exec = g_strjoin (" ", g_get_prgname (), "%u", NULL);
+
+  stamp = time (NULL);
+
+  apply_add (bookmarks, uri,
+             data->display_name, data->description, data->mime_type,
+             data->is_private,
+             data->app_name, app_exec,
+             stamp, data->groups);
+
+  if (journal != NULL)
+    {
+      n_groups = data->groups ? g_strv_length (data->groups) : 0;
+
+      g_string_append_c (journal->pending, 'A');
+      append_field (journal->pending, uri);
+      append_field (journal->pending, data->display_name);
+      append_field (journal->pending, data->description);
+      append_field (journal->pending, data->mime_type);
+      g_string_append_printf (journal->pending, "\t%d", data->is_private ? 1 : 0);
+      append_field (journal->pending, data->app_name);
+      append_field (journal->pending, app_exec);
+      g_string_append_printf (journal->pending, "\t%" G_GINT64_FORMAT, (gint64) stamp);
+      g_string_append_printf (journal->pending, "\t%d", n_groups);
+      for (i = 0; i < n_groups; i++)
+        append_field (journal->pending, data->groups[i]);
+      g_string_append_c (journal->pending, '\n');
+    }
+
+  g_free (app_exec);
+}
+
+void
+_gtk_recent_journal_log_remove (GtkRecentJournal *journal,
+                                const gchar      *uri)
+{
+  if (journal == NULL)
+    return;
+
+  g_string_append_c (journal->pending, 'R');
+  append_field (journal->pending, uri);
+  g_string_append_c (journal->pending, '\n');
+}
+
+void
+_gtk_recent_journal_log_move (GtkRecentJournal *journal,
+                              const gchar      *uri,
+                              const gchar      *new_uri)
+{
+  if (journal == NULL)
+    return;
+
+  g_string_append_c (journal->pending, 'M');
+  append_field (journal->pending, uri);
+  append_field (journal->pending, new_uri);
+  g_string_append_c (journal->pending, '\n');
+}
+
+void
+_gtk_recent_journal_log_clear (GtkRecentJournal *journal)
+{
+  if (journal == NULL)
+    return;
+
+  /* nothing before a clear matters anymore */
+  g_string_assign (journal->pending, "C\n");
+}
+
+/* Files */
+
+#ifdef G_OS_UNIX
+
+static gchar *
+get_stamp (const gchar *filename)
+{
+  GStatBuf buf;
+
+  if (g_stat (filename, &buf) < 0)
+    return g_strdup ("none");
+
+  /* the XBEL file is always replaced by renaming a new file over
+   * it, so the inode changes even if size and mtime don't
+   */
+  return g_strdup_printf ("%" G_GUINT64_FORMAT "-%" G_GINT64_FORMAT "-%" G_GINT64_FORMAT,
+                          (guint64) buf.st_ino,
+                          (gint64) buf.st_mtime,
+                          (gint64) buf.st_size);
+}
+
+static void
+set_errno_error (GError      **error,
+                 int           saved_errno,
+                 const gchar  *format,
+                 const gchar  *path)
+{
+  g_set_error (error, G_FILE_ERROR,
+               g_file_error_from_errno (saved_errno),
+               format, path, g_strerror (saved_errno));
+}
+
+/* Returns -1 without setting @error if the journal doesn't exist
+ * and we only want to read it.
+ */
+static int
+journal_open (GtkRecentJournal  *journal,
+              gboolean           write,
+              GError           **error)
+{
+  struct flock lock;
+  int fd;
+
+  fd = g_open (journal->path, write ? O_RDWR | O_CREAT : O_RDONLY, 0600);
+  if (fd < 0)
+    {
+      int saved_errno = errno;
+
+      if (!write && saved_errno == ENOENT)
+        return -1;
+
+      set_errno_error (error, saved_errno, "Failed to open '%s': %s", journal->path);
+      return -1;
+    }
+
+  memset (&lock, 0, sizeof (lock));
+  lock.l_type = write ? F_WRLCK : F_RDLCK;
+  lock.l_whence = SEEK_SET;
+
+  while (fcntl (fd, F_SETLKW, &lock) < 0)
+    {
+      int saved_errno = errno;
+
+      if (saved_errno == EINTR)
+        continue;
+
+      set_errno_error (error, saved_errno, "Failed to lock '%s': %s", journal->path);
+      close (fd);
+      return -1;
+    }
+
+  return fd;
+}
+
+static goffset
+get_size (int fd)
+{
+  struct stat buf;
+
+  if (fstat (fd, &buf) < 0)
+    return 0;
+
+  return buf.st_size;
+}
+
+static gchar *
+read_from (int      fd,
+           goffset  offset,
+           gsize   *length)
+{
+  gchar *data;
+  goffset size;
+  gsize n_read;
+  gssize res;
+
+  size = get_size (fd);
+  if (size <= offset)
+    {
+      *length = 0;
+      return g_strdup ("");
+    }
+
+  data = g_malloc (size - offset + 1);
+  n_read = 0;
+  while (n_read < size - offset)
+    {
+      res = pread (fd, data + n_read, size - offset - n_read, offset + n_read);
+      if (res < 0 && errno == EINTR)
+        continue;
+      if (res <= 0)
+        break;
+      n_read += res;
+    }
+
+  data[n_read] = '\0';
+  *length = n_read;
+
+  return data;
+}
+
+/* Returns the length of the header, or 0 if there is none */
+static gsize
+read_header (int     fd,
+             gchar **stamp)
+{
+  gchar buf[MAX_HEADER_SIZE + 1];
+  gssize res;
+  gchar *end;
+
+  *stamp = NULL;
+
+  if (fd < 0)
+    return 0;
+
+  do
+    res = pread (fd, buf, MAX_HEADER_SIZE, 0);
+  while (res < 0 && errno == EINTR);
+
+  if (res <= 0)
+    return 0;
+
+  buf[res] = '\0';
+  if (!g_str_has_prefix (buf, JOURNAL_MAGIC))
+    return 0;
+
+  end = strchr (buf, '\n');
+  if (end == NULL)
+    return 0;
+
+  *stamp = g_strndup (buf + strlen (JOURNAL_MAGIC), end - buf - strlen (JOURNAL_MAGIC));
+
+  return end - buf + 1;
+}
+
+static gboolean
+write_all (int           fd,
+           const gchar  *data,
+           gsize         length,
+           goffset       offset)
+{
+  gssize res;
+
+  while (length > 0)
+    {
+      res = pwrite (fd, data, length, offset);
+      if (res < 0 && errno == EINTR)
+        continue;
+      if (res <= 0)
+        return FALSE;
+
+      data += res;
+      offset += res;
+      length -= res;
+    }
+
+  return TRUE;
+}
+
+static gboolean
+reset_journal (GtkRecentJournal  *journal,
+               int                fd,
+               GError           **error)
+{
+  gchar *header;
+  gboolean res;
+
+  header = g_strconcat (JOURNAL_MAGIC, journal->stamp, "\n", NULL);
+  res = ftruncate (fd, 0) == 0 &&
+        write_all (fd, header, strlen (header), 0);
+  if (!res)
+    set_errno_error (error, errno, "Failed to write '%s': %s", journal->path);
+  else
+    {
+      journal->offset = strlen (header);
+      journal->stale = FALSE;
+    }
+
+  g_free (header);
+
+  return res;
+}
+
+/* Brings @bookmarks up to date with the XBEL file and the journal.
+ * Must be called with the journal locked. If only new records had
+ * to be replayed, their URIs are added to @changed; otherwise
+ * *@bookmarks is replaced.
+ */
+static gboolean
+update_locked (GtkRecentJournal  *journal,
+               int                fd,
+               GBookmarkFile    **bookmarks,
+               GHashTable        *changed,
+               GError           **error)
+{
+  GBookmarkFile *reloaded;
+  GError *local_error = NULL;
+  gchar *stamp, *header_stamp;
+  gsize header_length, length;
+  gboolean valid, exists;
+  goffset start;
+  gchar *data;
+
+  stamp = get_stamp (journal->filename);
+  header_length = read_header (fd, &header_stamp);
+  valid = header_stamp != NULL && strcmp (header_stamp, stamp) == 0;
+  g_free (header_stamp);
+
+  if (*bookmarks != NULL && g_strcmp0 (stamp, journal->stamp) == 0)
+    {
+      if (valid)
+        {
+          start = journal->offset > 0 ? journal->offset : (goffset) header_length;
+          if (start <= get_size (fd))
+            {
+              data = read_from (fd, start, &length);
+              journal->offset = start + replay_records (data, length, bookmarks, changed);
+              g_free (data);
+              g_free (stamp);
+
+              return TRUE;
+            }
+        }
+      else if (journal->offset == 0)
+        {
+          g_free (stamp);
+
+          return TRUE;
+        }
+    }
+
+  /* the XBEL file was replaced, or the journal was reset under us */
+  reloaded = g_bookmark_file_new ();
+  exists = TRUE;
+  if (!g_bookmark_file_load_from_file (reloaded, journal->filename, &local_error))
+    {
+      if (!g_error_matches (local_error, G_FILE_ERROR, G_FILE_ERROR_NOENT))
+        {
+          g_propagate_error (error, local_error);
+          g_bookmark_file_free (reloaded);
+
+          /* don't replay the journal on top of what we have */
+          g_free (journal->stamp);
+          journal->stamp = stamp;
+          journal->offset = 0;
+
+          return FALSE;
+        }
+
+      g_clear_error (&local_error);
+      exists = FALSE;
+    }
+
+  journal->offset = 0;
+  journal->stale = FALSE;
+  if (valid || (header_length > 0 && exists))
+    {
+      gsize replayed;
+
+      /* records for an older XBEL file would be lost if we dropped
+       * them, so they are applied to the new one too, and folded into
+       * it on the next write; if the file was removed, so is the list
+       */
+      data = read_from (fd, header_length, &length);
+      replayed = replay_records (data, length, &reloaded, NULL);
+      if (valid)
+        journal->offset = header_length + replayed;
+      else
+        journal->stale = replayed > 0;
+      g_free (data);
+    }
+
+  /* our own changes are not in the journal yet */
+  if (journal->pending->len > 0)
+    {
+      data = g_strndup (journal->pending->str, journal->pending->len);
+      replay_records (data, journal->pending->len, &reloaded, NULL);
+      g_free (data);
+    }
+
+  if (*bookmarks != NULL)
+    g_bookmark_file_free (*bookmarks);
+  *bookmarks = reloaded;
+
+  g_free (journal->stamp);
+  journal->stamp = stamp;
+
+  return TRUE;
+}
+
+static gboolean
+compact_locked (GtkRecentJournal  *journal,
+                int                fd,
+                GBookmarkFile     *bookmarks,
+                GError           **error)
+{
+  if (!g_bookmark_file_to_file (bookmarks, journal->filename, error))
+    return FALSE;
+
+  g_free (journal->stamp);
+  journal->stamp = get_stamp (journal->filename);
+
+  return reset_journal (journal, fd, error);
+}
+
+#endif /* G_OS_UNIX */
+
+/*
+ * _gtk_recent_journal_load:
+ * @journal: a #GtkRecentJournal
+ * @bookmarks: (inout): the bookmarks to update, or %NULL
+ * @changed: (allow-none): a set of URIs to add the changed items to
+ * @error: return location for an error
+ *
+ * Brings *@bookmarks up to date. As long as the XBEL file stays the
+ * same, this only replays the journal records that were added since
+ * the last call, and adds the URIs they touched to @changed.
+ * Otherwise, the XBEL file is loaded again and *@bookmarks replaced.
+ *
+ * Returns: %FALSE if the XBEL file could not be parsed
+ */
+gboolean
+_gtk_recent_journal_load (GtkRecentJournal  *journal,
+                          GBookmarkFile    **bookmarks,
+                          GHashTable        *changed,
+                          GError           **error)
+{
+#ifdef G_OS_UNIX
+  GError *local_error = NULL;
+  gboolean res;
+  int fd;
+
+  fd = journal_open (journal, FALSE, &local_error);
+  if (local_error)
+    {
+      /* we can still read the XBEL file */
+      g_clear_error (&local_error);
+    }
+
+  res = update_locked (journal, fd, bookmarks, changed, error);
+
+  if (fd >= 0)
+    close (fd);
+
+  return res;
+#else
+  g_assert_not_reached ();
+  return FALSE;
+#endif
+}
+
+/*
+ * _gtk_recent_journal_write:
+ * @journal: a #GtkRecentJournal
+ * @bookmarks: (inout): the bookmarks
+ * @compact: %TRUE to fold the journal into the XBEL file
+ * @changed: (allow-none): a set of URIs to add the changed items to
+ * @error: return location for an error
+ *
+ * Appends the changes made since the last call to the journal,
+ * after bringing *@bookmarks up to date like _gtk_recent_journal_load()
+ * does. If @compact is %TRUE, or the journal has grown too large,
+ * *@bookmarks is written to the XBEL file and the journal is emptied.
+ *
+ * Returns: %TRUE if the changes were written
+ */
+gboolean
+_gtk_recent_journal_write (GtkRecentJournal  *journal,
+                           GBookmarkFile    **bookmarks,
+                           gboolean           compact,
+                           GHashTable        *changed,
+                           GError           **error)
+{
+#ifdef G_OS_UNIX
+  GError *local_error = NULL;
+  gchar *header_stamp;
+  gboolean res = TRUE;
+  gboolean force = FALSE;
+  gsize header_length;
+  goffset size;
+  int fd;
+
+  fd = journal_open (journal, TRUE, error);
+  if (fd < 0)
+    return FALSE;
+
+  if (!update_locked (journal, fd, bookmarks, changed, &local_error))
+    {
+      /* the XBEL file is broken, replace it with what we have */
+      g_clear_error (&local_error);
+      force = TRUE;
+    }
+
+  /* resetting the journal below drops the stale records */
+  if (journal->stale)
+    force = TRUE;
+
+  if (journal->pending->len > 0)
+    {
+      read_header (fd, &header_stamp);
+      if (header_stamp == NULL || g_strcmp0 (header_stamp, journal->stamp) != 0)
+        res = reset_journal (journal, fd, error);
+      g_free (header_stamp);
+
+      size = get_size (fd);
+      if (res && !write_all (fd, journal->pending->str, journal->pending->len, size))
+        {
+          set_errno_error (error, errno, "Failed to write '%s': %s", journal->path);
+          res = FALSE;
+        }
+
+      if (res)
+        {
+          journal->offset = size + journal->pending->len;
+          g_string_truncate (journal->pending, 0);
+        }
+
+      /* make the first write visible to readers of the XBEL file */
+      if (g_strcmp0 (journal->stamp, "none") == 0)
+        force = TRUE;
+    }
+
+  if (res)
+    {
+      header_length = read_header (fd, &header_stamp);
+      g_free (header_stamp);
+
+      size = get_size (fd);
+      if (force ||
+          (compact && size > (goffset) header_length) ||
+          size > MAX_JOURNAL_SIZE)
+        res = compact_locked (journal, fd, *bookmarks, error);
+    }
+
+  close (fd);
+
+  return res;
+#else
+  g_assert_not_reached ();
+  return FALSE;
+#endif
+}
@@ -0,0 +1,53 @@
+/* gtkrecentjournalprivate.h
+ * Copyright (C) 2016 Red Hat, Inc.
+ *
+ * This library is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Library General Public
+ * License as published by the Free Software Foundation; either
+ * version 2 of the License, or (at your option) any later version.
+ *
+ * This library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Library General Public License for more details.
+ *
+ * You should have received a copy of the GNU Library General Public
+ * License along with this library. If not, see <http://www.gnu.org/licenses/>.
+ */
+#ifndef __GTK_RECENT_JOURNAL_PRIVATE_H__
+#define __GTK_RECENT_JOURNAL_PRIVATE_H__
+
+#include "gtkrecentmanager.h"
+
+G_BEGIN_DECLS
+
+typedef struct _GtkRecentJournal GtkRecentJournal;
+
+GtkRecentJournal *_gtk_recent_journal_new         (const gchar          *filename);
+void              _gtk_recent_journal_free        (GtkRecentJournal     *journal);
+const gchar *     _gtk_recent_journal_get_path    (GtkRecentJournal     *journal);
+
+void              _gtk_recent_journal_add_item    (GtkRecentJournal     *journal,
+                                                   GBookmarkFile        *bookmarks,
+                                                   const gchar          *uri,
+                                                   const GtkRecentData  *data);
+void              _gtk_recent_journal_log_remove  (GtkRecentJournal     *journal,
+                                                   const gchar          *uri);
+void              _gtk_recent_journal_log_move    (GtkRecentJournal     *journal,
+                                                   const gchar          *uri,
+                                                   const gchar          *new_uri);
+void              _gtk_recent_journal_log_clear   (GtkRecentJournal     *journal);
+
+gboolean          _gtk_recent_journal_load        (GtkRecentJournal     *journal,
+                                                   GBookmarkFile       **bookmarks,
+                                                   GHashTable           *changed,
+                                                   GError              **error);
+gboolean          _gtk_recent_journal_write       (GtkRecentJournal     *journal,
+                                                   GBookmarkFile       **bookmarks,
+                                                   gboolean              compact,
+                                                   GHashTable           *changed,
+                                                   GError              **error);
+
+G_END_DECLS
+
+#endif /* __GTK_RECENT_JOURNAL_PRIVATE_H__ */
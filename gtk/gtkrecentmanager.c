@@ -100,6 +100,7 @@
 #include <gio/gio.h>
 
 #include "gtkrecentmanager.h"
+#include "gtkrecentjournalprivate.h"
 #include "gtkintl.h"
 #include "gtksettings.h"
 #include "gtkicontheme.h"
@@ -113,6 +114,12 @@
 /* return all items by default */
 #define DEFAULT_LIMIT   -1
 
+/* how long to wait after writing to the journal before folding it
+ * into the XBEL file, in seconds; changes made in the meantime are
+ * folded together
+ */
+#define COMPACT_DELAY   2
+
 /* keep in sync with xdgmime */
 #define GTK_RECENT_DEFAULT_MIME "application/octet-stream"
 
@@ -167,15 +174,24 @@ struct _GtkRecentManagerPrivate
   gchar *filename;
 
   guint is_dirty : 1;
+  guint compact  : 1;
 
   gint size;
 
   GBookmarkFile *recent_items;
 
+  /* URI → GtkRecentInfo, built on demand from recent_items */
+  GHashTable *infos;
+
   GFileMonitor *monitor;
 
+  GtkRecentJournal *journal;
+  GFileMonitor *journal_monitor;
+
   guint changed_timeout;
   guint changed_age;
+
+  guint compact_timeout;
 };
 
 enum
@@ -209,12 +225,18 @@ static void     gtk_recent_manager_changed             (GtkRecentManager  *manag
 static void     gtk_recent_manager_real_changed        (GtkRecentManager  *manager);
 static void     gtk_recent_manager_set_filename        (GtkRecentManager  *manager,
                                                         const gchar       *filename);
+static void     gtk_recent_manager_compact             (GtkRecentManager  *manager);
 static void     gtk_recent_manager_clamp_to_age        (GtkRecentManager  *manager,
                                                         gint               age);
 static void     gtk_recent_manager_enabled_changed     (GtkRecentManager  *manager);
 
 
 static void     build_recent_items_list                (GtkRecentManager  *manager);
+static void     update_recent_items                    (GtkRecentManager  *manager,
+                                                        GBookmarkFile     *old_items,
+                                                        GHashTable        *changed);
+static void     build_recent_info                      (GBookmarkFile     *bookmarks,
+                                                        GtkRecentInfo     *info);
 static void     purge_recent_items_list                (GtkRecentManager  *manager,
                                                         GError           **error);
 
@@ -345,6 +367,9 @@ gtk_recent_manager_init (GtkRecentManager *manager)
 
   priv->size = 0;
   priv->filename = NULL;
+  priv->infos = g_hash_table_new_full (g_str_hash, g_str_equal,
+                                       g_free,
+                                       (GDestroyNotify) gtk_recent_info_unref);
 
   settings = gtk_settings_get_default ();
   if (settings)
@@ -404,6 +429,9 @@ gtk_recent_manager_finalize (GObject *object)
   if (priv->recent_items != NULL)
     g_bookmark_file_free (priv->recent_items);
 
+  _gtk_recent_journal_free (priv->journal);
+  g_hash_table_unref (priv->infos);
+
   G_OBJECT_CLASS (gtk_recent_manager_parent_class)->finalize (object);
 }
 
@@ -422,6 +450,15 @@ gtk_recent_manager_dispose (GObject *gobject)
       priv->monitor = NULL;
     }
 
+  if (priv->journal_monitor != NULL)
+    {
+      g_signal_handlers_disconnect_by_func (priv->journal_monitor,
+                                            G_CALLBACK (gtk_recent_manager_monitor_changed),
+                                            manager);
+      g_object_unref (priv->journal_monitor);
+      priv->journal_monitor = NULL;
+    }
+
   if (priv->changed_timeout != 0)
     {
       g_source_remove (priv->changed_timeout);
@@ -429,6 +466,15 @@ gtk_recent_manager_dispose (GObject *gobject)
       priv->changed_age = 0;
     }
 
+  /* fold the journal now instead of leaving it to the next writer */
+  if (priv->compact_timeout != 0)
+    {
+      g_source_remove (priv->compact_timeout);
+      priv->compact_timeout = 0;
+      priv->is_dirty = TRUE;
+      priv->compact = TRUE;
+    }
+
   if (priv->is_dirty)
     {
       g_object_ref (manager);
@@ -446,6 +492,17 @@ gtk_recent_manager_enabled_changed (GtkRecentManager *manager)
   gtk_recent_manager_changed (manager);
 }
 
+static gboolean
+compact_journal_timeout (gpointer data)
+{
+  GtkRecentManager *manager = data;
+
+  manager->priv->compact_timeout = 0;
+  gtk_recent_manager_compact (manager);
+
+  return G_SOURCE_REMOVE;
+}
+
 static void
 gtk_recent_manager_real_changed (GtkRecentManager *manager)
 {
@@ -490,12 +547,51 @@ gtk_recent_manager_real_changed (GtkRecentManager *manager)
             {
               g_bookmark_file_free (priv->recent_items);
               priv->recent_items = g_bookmark_file_new ();
+              g_hash_table_remove_all (priv->infos);
+              _gtk_recent_journal_log_clear (priv->journal);
             }
           else if (age > 0)
             gtk_recent_manager_clamp_to_age (manager, age);
         }
 
-      if (priv->filename != NULL)
+      if (priv->journal != NULL)
+        {
+          GBookmarkFile *old_items = priv->recent_items;
+          GHashTable *changed;
+
+          /* append our changes, picking up those of others on the way */
+          changed = g_hash_table_new_full (g_str_hash, g_str_equal, g_free, NULL);
+          write_error = NULL;
+          if (!_gtk_recent_journal_write (priv->journal, &priv->recent_items,
+                                          priv->compact, changed, &write_error))
+            {
+              filename_warning ("Attempting to store changes into '%s', but failed: %s",
+                                _gtk_recent_journal_get_path (priv->journal),
+                                write_error->message);
+              g_error_free (write_error);
+            }
+
+          update_recent_items (manager, old_items, changed);
+          g_hash_table_unref (changed);
+
+          /* keep the XBEL file current for those who don't read the
+           * journal, without rewriting it for every single change
+           */
+          if (!priv->compact && priv->compact_timeout == 0)
+            {
+              priv->compact_timeout = gdk_threads_add_timeout_seconds (COMPACT_DELAY, compact_journal_timeout, manager);
+              g_source_set_name_by_id (priv->compact_timeout, "[gtk+] compact_journal_timeout");
+            }
+
+          if (g_file_test (priv->filename, G_FILE_TEST_EXISTS) &&
+              g_chmod (priv->filename, 0600) < 0)
+            {
+              filename_warning ("Attempting to set the permissions of '%s', but failed: %s",
+                                priv->filename,
+                                g_strerror (errno));
+            }
+        }
+      else if (priv->filename != NULL)
         {
           write_error = NULL;
           g_bookmark_file_to_file (priv->recent_items, priv->filename, &write_error);
@@ -517,6 +613,7 @@ gtk_recent_manager_real_changed (GtkRecentManager *manager)
 
       /* mark us as clean */
       priv->is_dirty = FALSE;
+      priv->compact = FALSE;
     }
   else
     {
@@ -597,6 +694,9 @@ gtk_recent_manager_set_filename (GtkRecentManager *manager,
    */
   if (priv->filename)
     {
+      if (priv->compact_timeout != 0)
+        gtk_recent_manager_compact (manager);
+
       g_free (priv->filename);
 
       if (priv->monitor)
@@ -608,6 +708,17 @@ gtk_recent_manager_set_filename (GtkRecentManager *manager,
           priv->monitor = NULL;
         }
 
+      if (priv->journal_monitor)
+        {
+          g_signal_handlers_disconnect_by_func (priv->journal_monitor,
+                                                G_CALLBACK (gtk_recent_manager_monitor_changed),
+                                                manager);
+          g_object_unref (priv->journal_monitor);
+          priv->journal_monitor = NULL;
+        }
+
+      g_clear_pointer (&priv->journal, _gtk_recent_journal_free);
+
       if (!filename || *filename == '\0')
         return;
       else
@@ -642,6 +753,20 @@ gtk_recent_manager_set_filename (GtkRecentManager *manager,
                           manager);
 
       g_object_unref (file);
+
+      priv->journal = _gtk_recent_journal_new (priv->filename);
+      if (priv->journal != NULL)
+        {
+          file = g_file_new_for_path (_gtk_recent_journal_get_path (priv->journal));
+
+          priv->journal_monitor = g_file_monitor_file (file, G_FILE_MONITOR_NONE, NULL, NULL);
+          if (priv->journal_monitor != NULL)
+            g_signal_connect (priv->journal_monitor, "changed",
+                              G_CALLBACK (gtk_recent_manager_monitor_changed),
+                              manager);
+
+          g_object_unref (file);
+        }
     }
 
   build_recent_items_list (manager);
@@ -659,6 +784,38 @@ build_recent_items_list (GtkRecentManager *manager)
   GError *read_error;
   gint size;
 
+  if (priv->journal != NULL)
+    {
+      GBookmarkFile *old_items = priv->recent_items;
+      GHashTable *changed;
+
+      /* only replays what others appended to the journal, unless
+       * the whole file was rewritten
+       */
+      changed = g_hash_table_new_full (g_str_hash, g_str_equal, g_free, NULL);
+      read_error = NULL;
+      if (!_gtk_recent_journal_load (priv->journal, &priv->recent_items,
+                                     changed, &read_error))
+        {
+          if (read_error->domain == G_FILE_ERROR)
+            filename_warning ("Attempting to read the recently used resources "
+                              "file at '%s', but the parser failed: %s.",
+                              priv->filename,
+                              read_error->message);
+
+          g_error_free (read_error);
+        }
+
+      update_recent_items (manager, old_items, changed);
+      g_hash_table_unref (changed);
+
+      priv->is_dirty = FALSE;
+
+      return;
+    }
+
+  g_hash_table_remove_all (priv->infos);
+
   if (!priv->recent_items)
     {
       priv->recent_items = g_bookmark_file_new ();
@@ -707,6 +864,59 @@ build_recent_items_list (GtkRecentManager *manager)
   priv->is_dirty = FALSE;
 }
 
+/* drops the cached infos for the items that changed in recent_items */
+static void
+update_recent_items (GtkRecentManager *manager,
+                     GBookmarkFile    *old_items,
+                     GHashTable       *changed)
+{
+  GtkRecentManagerPrivate *priv = manager->priv;
+  GHashTableIter iter;
+  gpointer uri;
+  gint size;
+
+  if (priv->recent_items != old_items)
+    g_hash_table_remove_all (priv->infos);
+  else
+    {
+      g_hash_table_iter_init (&iter, changed);
+      while (g_hash_table_iter_next (&iter, &uri, NULL))
+        g_hash_table_remove (priv->infos, uri);
+    }
+
+  size = priv->recent_items ? g_bookmark_file_get_size (priv->recent_items) : 0;
+  if (priv->size != size)
+    {
+      priv->size = size;
+
+      g_object_notify (G_OBJECT (manager), "size");
+    }
+}
+
+/* returns a reference to the info for @uri, which must exist */
+static GtkRecentInfo *
+get_recent_info (GtkRecentManager *manager,
+                 const gchar      *uri)
+{
+  GtkRecentManagerPrivate *priv = manager->priv;
+  GtkRecentInfo *info;
+
+  info = g_hash_table_lookup (priv->infos, uri);
+  if (info == NULL)
+    {
+      info = gtk_recent_info_new (uri);
+
+      /* fill the RecentInfo structure with the data retrieved by our
+       * parser object from the storage file
+       */
+      build_recent_info (priv->recent_items, info);
+
+      g_hash_table_insert (priv->infos, g_strdup (uri), info);
+    }
+
+  return gtk_recent_info_ref (info);
+}
+
 
 /********************
  * GtkRecentManager *
@@ -968,32 +1178,12 @@ gtk_recent_manager_add_full (GtkRecentManager    *manager,
       priv->size = 0;
     }
 
-  if (data->display_name)
-    g_bookmark_file_set_title (priv->recent_items, uri, data->display_name);
-
-  if (data->description)
-    g_bookmark_file_set_description (priv->recent_items, uri, data->description);
-
-  g_bookmark_file_set_mime_type (priv->recent_items, uri, data->mime_type);
-
-  if (data->groups && data->groups[0] != '\0')
-    {
-      gint j;
-
-      for (j = 0; (data->groups)[j] != NULL; j++)
-        g_bookmark_file_add_group (priv->recent_items, uri, (data->groups)[j]);
-    }
-
   /* register the application; this will take care of updating the
    * registration count and time in case the application has
    * already registered the same document inside the list
    */
-  g_bookmark_file_add_application (priv->recent_items, uri,
-                                   data->app_name,
-                                   data->app_exec);
-
-  g_bookmark_file_set_is_private (priv->recent_items, uri,
-                                  data->is_private);
+  _gtk_recent_journal_add_item (priv->journal, priv->recent_items, uri, data);
+  g_hash_table_remove (priv->infos, uri);
 
   /* mark us as dirty, so that when emitting the "changed" signal we
    * will dump our changes
@@ -1058,6 +1248,9 @@ gtk_recent_manager_remove_item (GtkRecentManager  *manager,
       return FALSE;
     }
 
+  _gtk_recent_journal_log_remove (priv->journal, uri);
+  g_hash_table_remove (priv->infos, uri);
+
   priv->is_dirty = TRUE;
   gtk_recent_manager_changed (manager);
 
@@ -1175,7 +1368,6 @@ gtk_recent_manager_lookup_item (GtkRecentManager  *manager,
                                 GError           **error)
 {
   GtkRecentManagerPrivate *priv;
-  GtkRecentInfo *info = NULL;
 
   g_return_val_if_fail (GTK_IS_RECENT_MANAGER (manager), NULL);
   g_return_val_if_fail (uri != NULL, NULL);
@@ -1204,15 +1396,7 @@ gtk_recent_manager_lookup_item (GtkRecentManager  *manager,
       return NULL;
     }
 
-  info = gtk_recent_info_new (uri);
-  g_return_val_if_fail (info != NULL, NULL);
-
-  /* fill the RecentInfo structure with the data retrieved by our
-   * parser object from the storage file
-   */
-  build_recent_info (priv->recent_items, info);
-
-  return info;
+  return get_recent_info (manager, uri);
 }
 
 /**
@@ -1280,6 +1464,11 @@ gtk_recent_manager_move_item (GtkRecentManager  *recent_manager,
       return FALSE;
     }
 
+  _gtk_recent_journal_log_move (priv->journal, uri, new_uri);
+  g_hash_table_remove (priv->infos, uri);
+  if (new_uri != NULL)
+    g_hash_table_remove (priv->infos, new_uri);
+
   priv->is_dirty = TRUE;
   gtk_recent_manager_changed (recent_manager);
 
@@ -1315,14 +1504,7 @@ gtk_recent_manager_get_items (GtkRecentManager *manager)
 
   uris = g_bookmark_file_get_uris (priv->recent_items, &uris_len);
   for (i = 0; i < uris_len; i++)
-    {
-      GtkRecentInfo *info;
-
-      info = gtk_recent_info_new (uris[i]);
-      build_recent_info (priv->recent_items, info);
-
-      retval = g_list_prepend (retval, info);
-    }
+    retval = g_list_prepend (retval, get_recent_info (manager, uris[i]));
 
   g_strfreev (uris);
 
@@ -1342,6 +1524,9 @@ purge_recent_items_list (GtkRecentManager  *manager,
   priv->recent_items = g_bookmark_file_new ();
   priv->size = 0;
 
+  g_hash_table_remove_all (priv->infos);
+  _gtk_recent_journal_log_clear (priv->journal);
+
   /* emit the changed signal, to ensure that the purge is written */
   priv->is_dirty = TRUE;
   gtk_recent_manager_changed (manager);
@@ -1383,6 +1568,21 @@ gtk_recent_manager_purge_items (GtkRecentManager  *manager,
   return purged;
 }
 
+/* writes our changes, and folds the journal into the XBEL file */
+static void
+gtk_recent_manager_compact (GtkRecentManager *manager)
+{
+  if (manager->priv->compact_timeout != 0)
+    {
+      g_source_remove (manager->priv->compact_timeout);
+      manager->priv->compact_timeout = 0;
+    }
+
+  manager->priv->is_dirty = TRUE;
+  manager->priv->compact = TRUE;
+  gtk_recent_manager_real_changed (manager);
+}
+
 static gboolean
 emit_manager_changed (gpointer data)
 {
@@ -1450,7 +1650,11 @@ gtk_recent_manager_clamp_to_age (GtkRecentManager *manager,
       modified = g_bookmark_file_get_modified (priv->recent_items, uri, NULL);
       item_age = (gint) ((now - modified) / (60 * 60 * 24));
       if (item_age > age)
-        g_bookmark_file_remove_item (priv->recent_items, uri, NULL);
+        {
+          g_bookmark_file_remove_item (priv->recent_items, uri, NULL);
+          g_hash_table_remove (priv->infos, uri);
+          _gtk_recent_journal_log_remove (priv->journal, uri);
+        }
     }
 
   g_strfreev (uris);
@@ -2494,8 +2698,9 @@ _gtk_recent_manager_sync (void)
 {
   if (recent_manager_singleton)
     {
-      /* force a dump of the contents of the recent manager singleton */
-      recent_manager_singleton->priv->is_dirty = TRUE;
-      gtk_recent_manager_real_changed (recent_manager_singleton);
+      /* force a dump of the contents of the recent manager singleton,
+       * folding the journal into the file for those who don't read it
+       */
+      gtk_recent_manager_compact (recent_manager_singleton);
     }
 }
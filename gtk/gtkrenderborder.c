@@ -691,6 +691,128 @@ render_border (cairo_t       *cr,
   cairo_restore (cr);
 }
 
+/* The path of a uniform solid border, which is all most themes use.
+ * It only depends on the style and the size of the border box, so it
+ * is kept on the style, relative to the box origin, and reused as
+ * long as the widget keeps its style and size.
+ */
+struct _GtkCssBorderPath
+{
+  double width;
+  double height;
+  GtkJunctionSides junction;
+  cairo_path_t *path;
+};
+
+void
+gtk_css_border_path_free (GtkCssBorderPath *path)
+{
+  if (path == NULL)
+    return;
+
+  cairo_path_destroy (path->path);
+  g_slice_free (GtkCssBorderPath, path);
+}
+
+static void
+add_uniform_border_path (GtkCssStyle      *style,
+                         cairo_t          *cr,
+                         const double      border_width[4],
+                         double            width,
+                         double            height,
+                         GtkJunctionSides  junction)
+{
+  GtkRoundedBox border_box, padding_box;
+
+  _gtk_rounded_box_init_rect (&border_box, 0, 0, width, height);
+  _gtk_rounded_box_apply_border_radius_for_style (&border_box, style, junction);
+
+  padding_box = border_box;
+  _gtk_rounded_box_shrink (&padding_box,
+                           border_width[GTK_CSS_TOP],
+                           border_width[GTK_CSS_RIGHT],
+                           border_width[GTK_CSS_BOTTOM],
+                           border_width[GTK_CSS_LEFT]);
+
+  _gtk_rounded_box_path (&border_box, cr);
+  _gtk_rounded_box_path (&padding_box, cr);
+}
+
+static void
+render_uniform_border (GtkCssStyle      *style,
+                       cairo_t          *cr,
+                       double            x,
+                       double            y,
+                       double            width,
+                       double            height,
+                       const double      border_width[4],
+                       GtkJunctionSides  junction,
+                       const GdkRGBA    *color)
+{
+  GtkCssBorderPath *cache = style->border_path;
+
+  if (cache == NULL)
+    {
+      cache = g_slice_new0 (GtkCssBorderPath);
+      style->border_path = cache;
+    }
+
+  cairo_save (cr);
+
+  cairo_set_fill_rule (cr, CAIRO_FILL_RULE_EVEN_ODD);
+  cairo_translate (cr, x, y);
+  gdk_cairo_set_source_rgba (cr, color);
+  cairo_new_path (cr);
+
+  if (cache->path == NULL ||
+      cache->width != width ||
+      cache->height != height ||
+      cache->junction != junction)
+    {
+      if (cache->path)
+        cairo_path_destroy (cache->path);
+
+      /* Built on @cr and copied back in its user space, which is
+       * the box origin here
+       */
+      add_uniform_border_path (style, cr, border_width, width, height, junction);
+      cache->path = cairo_copy_path (cr);
+      cache->width = width;
+      cache->height = height;
+      cache->junction = junction;
+
+      /* Don't keep the error of a broken @cr for the next one */
+      if (cache->path->status != CAIRO_STATUS_SUCCESS)
+        g_clear_pointer (&cache->path, cairo_path_destroy);
+    }
+  else
+    cairo_append_path (cr, cache->path);
+
+  cairo_fill (cr);
+
+  cairo_restore (cr);
+}
+
+static gboolean
+border_is_uniform (const GtkBorderStyle border_style[4],
+                   const GdkRGBA        colors[4])
+{
+  guint i;
+
+  for (i = 0; i < 4; i++)
+    {
+      if (border_style[i] != GTK_BORDER_STYLE_SOLID &&
+          border_style[i] != GTK_BORDER_STYLE_NONE &&
+          border_style[i] != GTK_BORDER_STYLE_HIDDEN)
+        return FALSE;
+
+      if (!gdk_rgba_equal (&colors[0], &colors[i]))
+        return FALSE;
+    }
+
+  return TRUE;
+}
+
 gboolean
 gtk_css_style_render_has_border (GtkCssStyle *style)
 {
@@ -750,6 +872,12 @@ gtk_css_style_render_border (GtkCssStyle      *style,
       colors[2] = *_gtk_css_rgba_value_get_rgba (gtk_css_style_get_value (style, GTK_CSS_PROPERTY_BORDER_BOTTOM_COLOR));
       colors[3] = *_gtk_css_rgba_value_get_rgba (gtk_css_style_get_value (style, GTK_CSS_PROPERTY_BORDER_LEFT_COLOR));
 
+      if (hidden_side == 0 && border_is_uniform (border_style, colors))
+        {
+          render_uniform_border (style, cr, x, y, width, height, border_width, junction, &colors[0]);
+          return;
+        }
+
       _gtk_rounded_box_init_rect (&border_box, x, y, width, height);
       _gtk_rounded_box_apply_border_radius_for_style (&border_box, style, junction);
 
@@ -24,6 +24,7 @@
 
 #include "gtkborder.h"
 #include "gtkcssimageprivate.h"
+#include "gtkcssstyleprivate.h"
 #include "gtkcssvalueprivate.h"
 
 G_BEGIN_DECLS
@@ -58,6 +59,7 @@ gboolean        gtk_css_style_render_outline_get_clip   (GtkCssStyle
                                                          gdouble                 height,
                                                          GdkRectangle           *out_clip) G_GNUC_WARN_UNUSED_RESULT;
 
+void            gtk_css_border_path_free                (GtkCssBorderPath       *path);
 
 G_END_DECLS
 
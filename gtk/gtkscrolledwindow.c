@@ -234,6 +234,12 @@ struct _GtkScrolledWindowPrivate
 
   guint scroll_events_overshoot_id;
 
+  /* Smooth scroll deltas received since the last frame, in
+   * adjustment units. They are applied once per frame */
+  gdouble pending_scroll_dx;
+  gdouble pending_scroll_dy;
+  guint   pending_scroll_id;
+
   /* Kinetic scrolling */
   GtkGesture *long_press_gesture;
   GtkGesture *swipe_gesture;
@@ -372,6 +378,7 @@ static void _gtk_scrolled_window_set_adjustment_value  (GtkScrolledWindow *scrol
                                                         gdouble            value);
 
 static void gtk_scrolled_window_cancel_deceleration (GtkScrolledWindow *scrolled_window);
+static void gtk_scrolled_window_flush_pending_scroll (GtkScrolledWindow *scrolled_window);
 
 static gboolean _gtk_scrolled_window_get_overshoot (GtkScrolledWindow *scrolled_window,
                                                     gint              *overshoot_x,
@@ -2709,6 +2716,12 @@ gtk_scrolled_window_destroy (GtkWidget *widget)
       priv->scroll_events_overshoot_id = 0;
     }
 
+  if (priv->pending_scroll_id)
+    {
+      gtk_widget_remove_tick_callback (widget, priv->pending_scroll_id);
+      priv->pending_scroll_id = 0;
+    }
+
   g_clear_object (&priv->drag_gesture);
   g_clear_object (&priv->swipe_gesture);
   g_clear_object (&priv->long_press_gesture);
@@ -3247,11 +3260,110 @@ start_scroll_deceleration_cb (gpointer user_data)
   priv->scroll_events_overshoot_id = 0;
 
   if (!priv->deceleration_id)
-    gtk_scrolled_window_start_deceleration (scrolled_window);
+    {
+      gtk_scrolled_window_flush_pending_scroll (scrolled_window);
+      gtk_scrolled_window_start_deceleration (scrolled_window);
+    }
 
   return FALSE;
 }
 
+static void
+gtk_scrolled_window_queue_overshoot_deceleration (GtkScrolledWindow *scrolled_window)
+{
+  GtkScrolledWindowPrivate *priv = scrolled_window->priv;
+
+  if (priv->scroll_events_overshoot_id)
+    {
+      g_source_remove (priv->scroll_events_overshoot_id);
+      priv->scroll_events_overshoot_id = 0;
+    }
+
+  if (_gtk_scrolled_window_get_overshoot (scrolled_window, NULL, NULL))
+    {
+      priv->scroll_events_overshoot_id =
+        gdk_threads_add_timeout (50, start_scroll_deceleration_cb, scrolled_window);
+      g_source_set_name_by_id (priv->scroll_events_overshoot_id,
+                               "[gtk+] start_scroll_deceleration_cb");
+    }
+}
+
+/* Applies the smooth scroll deltas accumulated since the last frame */
+static void
+gtk_scrolled_window_flush_pending_scroll (GtkScrolledWindow *scrolled_window)
+{
+  GtkScrolledWindowPrivate *priv = scrolled_window->priv;
+  GtkAdjustment *adj;
+
+  if (priv->pending_scroll_id)
+    {
+      gtk_widget_remove_tick_callback (GTK_WIDGET (scrolled_window),
+                                       priv->pending_scroll_id);
+      priv->pending_scroll_id = 0;
+    }
+
+  if (priv->pending_scroll_dx != 0.0)
+    {
+      adj = gtk_range_get_adjustment (GTK_RANGE (priv->hscrollbar));
+      _gtk_scrolled_window_set_adjustment_value (scrolled_window, adj,
+                                                 priv->unclamped_hadj_value +
+                                                 priv->pending_scroll_dx);
+      priv->pending_scroll_dx = 0.0;
+    }
+
+  if (priv->pending_scroll_dy != 0.0)
+    {
+      adj = gtk_range_get_adjustment (GTK_RANGE (priv->vscrollbar));
+      _gtk_scrolled_window_set_adjustment_value (scrolled_window, adj,
+                                                 priv->unclamped_vadj_value +
+                                                 priv->pending_scroll_dy);
+      priv->pending_scroll_dy = 0.0;
+    }
+}
+
+static gboolean
+pending_scroll_cb (GtkWidget     *widget,
+                   GdkFrameClock *frame_clock,
+                   gpointer       user_data)
+{
+  GtkScrolledWindow *scrolled_window = GTK_SCROLLED_WINDOW (widget);
+  GtkScrolledWindowPrivate *priv = scrolled_window->priv;
+
+  /* Returning G_SOURCE_REMOVE takes care of the tick callback */
+  priv->pending_scroll_id = 0;
+  gtk_scrolled_window_flush_pending_scroll (scrolled_window);
+
+  if (!priv->deceleration_id)
+    gtk_scrolled_window_queue_overshoot_deceleration (scrolled_window);
+
+  return G_SOURCE_REMOVE;
+}
+
+/* Touchpads often send several smooth scroll events per frame. Adding
+ * up their deltas and setting the adjustments once in the frame clock
+ * update phase saves relayouts and redraws that nobody gets to see.
+ */
+static void
+gtk_scrolled_window_queue_scroll (GtkScrolledWindow *scrolled_window,
+                                  gdouble            dx,
+                                  gdouble            dy)
+{
+  GtkScrolledWindowPrivate *priv = scrolled_window->priv;
+
+  priv->pending_scroll_dx += dx;
+  priv->pending_scroll_dy += dy;
+
+  if (!gtk_widget_get_mapped (GTK_WIDGET (scrolled_window)))
+    {
+      gtk_scrolled_window_flush_pending_scroll (scrolled_window);
+      return;
+    }
+
+  if (priv->pending_scroll_id == 0)
+    priv->pending_scroll_id =
+      gtk_widget_add_tick_callback (GTK_WIDGET (scrolled_window),
+                                    pending_scroll_cb, NULL, NULL);
+}
 
 static gboolean
 gtk_scrolled_window_scroll_event (GtkWidget      *widget,
@@ -3296,32 +3408,18 @@ gtk_scrolled_window_scroll_event (GtkWidget      *widget,
       if (delta_x != 0.0 &&
           may_hscroll (scrolled_window))
         {
-          GtkAdjustment *adj;
-          gdouble new_value;
-          gdouble scroll_unit;
-
-          adj = gtk_range_get_adjustment (GTK_RANGE (priv->hscrollbar));
-          scroll_unit = get_scroll_unit (scrolled_window, GTK_ORIENTATION_HORIZONTAL);
-
-          new_value = priv->unclamped_hadj_value + delta_x * scroll_unit;
-          _gtk_scrolled_window_set_adjustment_value (scrolled_window, adj,
-                                                     new_value);
+          gtk_scrolled_window_queue_scroll (scrolled_window,
+                                            delta_x * get_scroll_unit (scrolled_window, GTK_ORIENTATION_HORIZONTAL),
+                                            0.0);
           handled = TRUE;
         }
 
       if (delta_y != 0.0 &&
           may_vscroll (scrolled_window))
         {
-          GtkAdjustment *adj;
-          gdouble new_value;
-          gdouble scroll_unit;
-
-          adj = gtk_range_get_adjustment (GTK_RANGE (priv->vscrollbar));
-          scroll_unit = get_scroll_unit (scrolled_window, GTK_ORIENTATION_VERTICAL);
-
-          new_value = priv->unclamped_vadj_value + delta_y * scroll_unit;
-          _gtk_scrolled_window_set_adjustment_value (scrolled_window, adj,
-                                                     new_value);
+          gtk_scrolled_window_queue_scroll (scrolled_window,
+                                            0.0,
+                                            delta_y * get_scroll_unit (scrolled_window, GTK_ORIENTATION_VERTICAL));
           handled = TRUE;
         }
 
@@ -3377,6 +3475,9 @@ gtk_scrolled_window_scroll_event (GtkWidget      *widget,
 
       gtk_scrolled_window_invalidate_overshoot (scrolled_window);
 
+      if (start_deceleration)
+        gtk_scrolled_window_flush_pending_scroll (scrolled_window);
+
       if (priv->scroll_events_overshoot_id)
         {
           g_source_remove (priv->scroll_events_overshoot_id);
@@ -3386,13 +3487,8 @@ gtk_scrolled_window_scroll_event (GtkWidget      *widget,
       if (start_deceleration &&
           scroll_history_finish (scrolled_window, &vel_x, &vel_y))
         gtk_scrolled_window_decelerate (scrolled_window, vel_x, vel_y);
-      else if (_gtk_scrolled_window_get_overshoot (scrolled_window, NULL, NULL))
-        {
-          priv->scroll_events_overshoot_id =
-            gdk_threads_add_timeout (50, start_scroll_deceleration_cb, scrolled_window);
-          g_source_set_name_by_id (priv->scroll_events_overshoot_id,
-                                   "[gtk+] start_scroll_deceleration_cb");
-        }
+      else
+        gtk_scrolled_window_queue_overshoot_deceleration (scrolled_window);
     }
 
   return handled;
@@ -3930,6 +4026,7 @@ gtk_scrolled_window_unmap (GtkWidget *widget)
 
   GTK_WIDGET_CLASS (gtk_scrolled_window_parent_class)->unmap (widget);
 
+  gtk_scrolled_window_flush_pending_scroll (scrolled_window);
   gtk_scrolled_window_update_animating (scrolled_window);
 
   indicator_stop_fade (&scrolled_window->priv->hindicator);
@@ -25,6 +25,7 @@
 #include "gtksearchenginetracker.h"
 #include "gtksearchenginemodel.h"
 #include "gtksearchenginequartz.h"
+#include "gtksearchengineindex.h"
 #include "gtkintl.h"
 
 #include <gdk/gdk.h> /* for GDK_WINDOWING_QUARTZ */
@@ -389,6 +390,20 @@ _gtk_search_engine_new (void)
     }
 #endif
 
+  if (!engine->priv->native)
+    {
+      engine->priv->native = _gtk_search_engine_index_new ();
+      if (engine->priv->native)
+        {
+          g_debug ("Using built-in index search engine");
+          connect_engine_signals (engine->priv->native, engine);
+          _gtk_search_engine_simple_set_indexed_cb (GTK_SEARCH_ENGINE_SIMPLE (engine->priv->simple),
+                                                    _gtk_search_engine_index_is_indexed,
+                                                    g_object_ref (engine->priv->native),
+                                                    g_object_unref);
+        }
+    }
+
   engine->priv->hits = g_hash_table_new_full (search_hit_hash, search_hit_equal,
                                               (GDestroyNotify)_gtk_search_hit_free, NULL);
 
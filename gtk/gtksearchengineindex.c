@@ -0,0 +1,379 @@
+/* gtksearchengineindex.c
+ * Copyright (C) 2016 Red Hat, Inc.
+ *
+ * This library is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Library General Public
+ * License as published by the Free Software Foundation; either
+ * version 2 of the License, or (at your option) any later version.
+ *
+ * This library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Library General Public License for more details.
+ *
+ * You should have received a copy of the GNU Library General Public
+ * License along with this library. If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include "config.h"
+
+#include "gtksearchengineindex.h"
+#include "gtkfileindexprivate.h"
+
+/* A search engine backed by GtkFileIndex, for systems without a
+ * desktop indexer. The directories to index are listed in the
+ * GTK_SEARCH_INDEX_ROOTS environment variable; the engine is only
+ * created when it is set.
+ */
+
+struct _GtkSearchEngineIndex
+{
+  GtkSearchEngine parent;
+
+  GtkQuery *query;
+
+  GPtrArray *roots;       /* GFile */
+  GPtrArray *indexes;     /* GtkFileIndex, shared */
+
+  GCancellable *cancellable;
+  guint n_pending;
+};
+
+struct _GtkSearchEngineIndexClass
+{
+  GtkSearchEngineClass parent_class;
+};
+
+typedef struct
+{
+  GtkFileIndex *index;
+  gchar *text;
+  gchar *location;
+  gboolean recursive;
+} LookupData;
+
+G_DEFINE_TYPE (GtkSearchEngineIndex, _gtk_search_engine_index, GTK_TYPE_SEARCH_ENGINE)
+
+static void
+lookup_data_free (LookupData *data)
+{
+  g_free (data->text);
+  g_free (data->location);
+  g_slice_free (LookupData, data);
+}
+
+static void
+free_files (GList *files)
+{
+  g_list_free_full (files, g_object_unref);
+}
+
+static void
+gtk_search_engine_index_dispose (GObject *object)
+{
+  GtkSearchEngineIndex *engine = GTK_SEARCH_ENGINE_INDEX (object);
+
+  if (engine->cancellable)
+    {
+      g_cancellable_cancel (engine->cancellable);
+      g_clear_object (&engine->cancellable);
+    }
+
+  g_clear_object (&engine->query);
+
+  G_OBJECT_CLASS (_gtk_search_engine_index_parent_class)->dispose (object);
+}
+
+static void
+gtk_search_engine_index_finalize (GObject *object)
+{
+  GtkSearchEngineIndex *engine = GTK_SEARCH_ENGINE_INDEX (object);
+
+  g_ptr_array_unref (engine->roots);
+  g_ptr_array_unref (engine->indexes);
+
+  G_OBJECT_CLASS (_gtk_search_engine_index_parent_class)->finalize (object);
+}
+
+static void
+lookup_thread (GTask        *task,
+               gpointer      source_object,
+               gpointer      task_data,
+               GCancellable *cancellable)
+{
+  LookupData *data = task_data;
+  GList *files;
+
+  files = _gtk_file_index_lookup (data->index,
+                                  data->text,
+                                  data->location,
+                                  data->recursive,
+                                  cancellable);
+
+  g_task_return_pointer (task, files, (GDestroyNotify) free_files);
+}
+
+static void
+lookup_done (GObject      *source,
+             GAsyncResult *result,
+             gpointer      user_data)
+{
+  GtkSearchEngineIndex *engine = GTK_SEARCH_ENGINE_INDEX (source);
+  GTask *task = G_TASK (result);
+  LookupData *data;
+  GtkSearchHit *hit;
+  GList *files, *hits, *l;
+
+  files = g_task_propagate_pointer (task, NULL);
+
+  data = g_task_get_task_data (task);
+  if (data)
+    _gtk_file_index_ensure_monitors (data->index);
+
+  /* A search that has been stopped */
+  if (g_task_get_cancellable (task) != engine->cancellable)
+    {
+      free_files (files);
+      return;
+    }
+
+  hits = NULL;
+  for (l = files; l; l = l->next)
+    {
+      hit = g_new (GtkSearchHit, 1);
+      hit->file = l->data;
+      hit->info = NULL;
+      hits = g_list_prepend (hits, hit);
+    }
+  g_list_free (files);
+
+  if (hits)
+    {
+      _gtk_search_engine_hits_added (GTK_SEARCH_ENGINE (engine), hits);
+      g_list_free_full (hits, (GDestroyNotify) _gtk_search_hit_free);
+    }
+
+  engine->n_pending--;
+  if (engine->n_pending == 0)
+    {
+      g_clear_object (&engine->cancellable);
+      _gtk_search_engine_finished (GTK_SEARCH_ENGINE (engine));
+    }
+}
+
+static void
+gtk_search_engine_index_start (GtkSearchEngine *engine)
+{
+  GtkSearchEngineIndex *index_engine;
+  GFile *location, *root;
+  const gchar *text;
+  gboolean recursive;
+  LookupData *data;
+  GTask *task;
+  guint i;
+
+  index_engine = GTK_SEARCH_ENGINE_INDEX (engine);
+
+  if (index_engine->cancellable != NULL)
+    return;
+
+  if (index_engine->query == NULL)
+    return;
+
+  index_engine->cancellable = g_cancellable_new ();
+
+  text = gtk_query_get_text (index_engine->query);
+  location = gtk_query_get_location (index_engine->query);
+  recursive = _gtk_search_engine_get_recursive (engine);
+
+  for (i = 0; i < index_engine->roots->len; i++)
+    {
+      root = g_ptr_array_index (index_engine->roots, i);
+
+      if (text == NULL || location == NULL || !g_file_is_native (location))
+        continue;
+
+      if (!g_file_equal (location, root) &&
+          !g_file_has_prefix (location, root) &&
+          !(recursive && g_file_has_prefix (root, location)))
+        continue;
+
+      data = g_slice_new0 (LookupData);
+      data->index = g_ptr_array_index (index_engine->indexes, i);
+      data->text = g_strdup (text);
+      data->location = g_file_get_path (location);
+      data->recursive = recursive;
+
+      task = g_task_new (engine, index_engine->cancellable, lookup_done, NULL);
+      g_task_set_task_data (task, data, (GDestroyNotify) lookup_data_free);
+      g_task_run_in_thread (task, lookup_thread);
+      g_object_unref (task);
+
+      index_engine->n_pending++;
+    }
+
+  /* Nothing indexed here. Finish from an idle anyway, like any search */
+  if (index_engine->n_pending == 0)
+    {
+      task = g_task_new (engine, index_engine->cancellable, lookup_done, NULL);
+      g_task_return_pointer (task, NULL, NULL);
+      g_object_unref (task);
+
+      index_engine->n_pending++;
+    }
+}
+
+static void
+gtk_search_engine_index_stop (GtkSearchEngine *engine)
+{
+  GtkSearchEngineIndex *index_engine = GTK_SEARCH_ENGINE_INDEX (engine);
+
+  if (index_engine->cancellable)
+    {
+      g_cancellable_cancel (index_engine->cancellable);
+      g_clear_object (&index_engine->cancellable);
+      index_engine->n_pending = 0;
+    }
+}
+
+static void
+gtk_search_engine_index_set_query (GtkSearchEngine *engine,
+                                   GtkQuery        *query)
+{
+  GtkSearchEngineIndex *index_engine = GTK_SEARCH_ENGINE_INDEX (engine);
+
+  g_set_object (&index_engine->query, query);
+}
+
+static void
+_gtk_search_engine_index_class_init (GtkSearchEngineIndexClass *class)
+{
+  GObjectClass *gobject_class;
+  GtkSearchEngineClass *engine_class;
+
+  gobject_class = G_OBJECT_CLASS (class);
+  gobject_class->dispose = gtk_search_engine_index_dispose;
+  gobject_class->finalize = gtk_search_engine_index_finalize;
+
+  engine_class = GTK_SEARCH_ENGINE_CLASS (class);
+  engine_class->set_query = gtk_search_engine_index_set_query;
+  engine_class->start = gtk_search_engine_index_start;
+  engine_class->stop = gtk_search_engine_index_stop;
+}
+
+static void
+_gtk_search_engine_index_init (GtkSearchEngineIndex *engine)
+{
+  engine->roots = g_ptr_array_new_with_free_func (g_object_unref);
+  engine->indexes = g_ptr_array_new ();
+}
+
+static void
+refresh_thread (GTask        *task,
+                gpointer      source_object,
+                gpointer      task_data,
+                GCancellable *cancellable)
+{
+  _gtk_file_index_refresh (task_data, cancellable);
+
+  g_task_return_boolean (task, TRUE);
+}
+
+GtkSearchEngine *
+_gtk_search_engine_index_new (void)
+{
+  GtkSearchEngineIndex *engine;
+  GtkFileIndex *index;
+  const gchar *env;
+  gchar **paths;
+  gchar *path;
+  GFile *root;
+  GTask *task;
+  gint i;
+
+  env = g_getenv ("GTK_SEARCH_INDEX_ROOTS");
+  if (env == NULL || env[0] == '\0')
+    return NULL;
+
+  engine = g_object_new (GTK_TYPE_SEARCH_ENGINE_INDEX, NULL);
+
+  paths = g_strsplit (env, G_SEARCHPATH_SEPARATOR_S, -1);
+  for (i = 0; paths[i]; i++)
+    {
+      if (!g_path_is_absolute (paths[i]))
+        continue;
+
+      /* Canonicalizes the path */
+      root = g_file_new_for_path (paths[i]);
+      path = g_file_get_path (root);
+      index = _gtk_file_index_get (path);
+      g_free (path);
+
+      g_ptr_array_add (engine->roots, root);
+      g_ptr_array_add (engine->indexes, index);
+
+      /* Load the index, or build it, before the first search */
+      task = g_task_new (NULL, NULL, NULL, NULL);
+      g_task_set_task_data (task, index, NULL);
+      g_task_run_in_thread (task, refresh_thread);
+      g_object_unref (task);
+    }
+  g_strfreev (paths);
+
+  if (engine->roots->len == 0)
+    {
+      g_object_unref (engine);
+      return NULL;
+    }
+
+  return GTK_SEARCH_ENGINE (engine);
+}
+
+/* The index skips hidden files and directories, so anything below
+ * one of them has to be searched the slow way
+ */
+static gboolean
+has_hidden_component (const gchar *relative)
+{
+  gchar **components;
+  gboolean hidden;
+  guint i;
+
+  components = g_strsplit (relative, G_DIR_SEPARATOR_S, -1);
+  hidden = FALSE;
+  for (i = 0; components[i] && !hidden; i++)
+    hidden = components[i][0] == '.';
+  g_strfreev (components);
+
+  return hidden;
+}
+
+gboolean
+_gtk_search_engine_index_is_indexed (GFile    *location,
+                                     gpointer  data)
+{
+  GtkSearchEngineIndex *engine = data;
+  GFile *root;
+  gchar *relative;
+  gboolean indexed;
+  guint i;
+
+  for (i = 0; i < engine->roots->len; i++)
+    {
+      root = g_ptr_array_index (engine->roots, i);
+      if (g_file_equal (location, root))
+        return TRUE;
+
+      relative = g_file_get_relative_path (root, location);
+      if (relative == NULL)
+        continue;
+
+      indexed = !has_hidden_component (relative);
+      g_free (relative);
+
+      if (indexed)
+        return TRUE;
+    }
+
+  return FALSE;
+}
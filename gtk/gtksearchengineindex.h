@@ -0,0 +1,44 @@
+/* gtksearchengineindex.h
+ * Copyright (C) 2016 Red Hat, Inc.
+ *
+ * This library is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Library General Public
+ * License as published by the Free Software Foundation; either
+ * version 2 of the License, or (at your option) any later version.
+ *
+ * This library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Library General Public License for more details.
+ *
+ * You should have received a copy of the GNU Library General Public
+ * License along with this library. If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#ifndef __GTK_SEARCH_ENGINE_INDEX_H__
+#define __GTK_SEARCH_ENGINE_INDEX_H__
+
+#include "gtksearchengine.h"
+
+G_BEGIN_DECLS
+
+#define GTK_TYPE_SEARCH_ENGINE_INDEX		(_gtk_search_engine_index_get_type ())
+#define GTK_SEARCH_ENGINE_INDEX(obj)		(G_TYPE_CHECK_INSTANCE_CAST ((obj), GTK_TYPE_SEARCH_ENGINE_INDEX, GtkSearchEngineIndex))
+#define GTK_SEARCH_ENGINE_INDEX_CLASS(klass)	(G_TYPE_CHECK_CLASS_CAST ((klass), GTK_TYPE_SEARCH_ENGINE_INDEX, GtkSearchEngineIndexClass))
+#define GTK_IS_SEARCH_ENGINE_INDEX(obj)		(G_TYPE_CHECK_INSTANCE_TYPE ((obj), GTK_TYPE_SEARCH_ENGINE_INDEX))
+#define GTK_IS_SEARCH_ENGINE_INDEX_CLASS(klass)	(G_TYPE_CHECK_CLASS_TYPE ((klass), GTK_TYPE_SEARCH_ENGINE_INDEX))
+#define GTK_SEARCH_ENGINE_INDEX_GET_CLASS(obj)	(G_TYPE_INSTANCE_GET_CLASS ((obj), GTK_TYPE_SEARCH_ENGINE_INDEX, GtkSearchEngineIndexClass))
+
+typedef struct _GtkSearchEngineIndex GtkSearchEngineIndex;
+typedef struct _GtkSearchEngineIndexClass GtkSearchEngineIndexClass;
+
+GType            _gtk_search_engine_index_get_type   (void);
+
+GtkSearchEngine* _gtk_search_engine_index_new        (void);
+
+gboolean         _gtk_search_engine_index_is_indexed (GFile    *location,
+                                                      gpointer  data);
+
+G_END_DECLS
+
+#endif /* __GTK_SEARCH_ENGINE_INDEX_H__ */
@@ -23,28 +23,18 @@
 
 #include <gio/gio.h>
 
-#include <gdk/gdk.h>
-
 #include "gtksearchenginesimple.h"
+#include "gtksearchwalkerprivate.h"
 #include "gtkfilesystem.h"
 #include "gtkprivate.h"
 
-#include <string.h>
-
-#define BATCH_SIZE 500
-
 typedef struct
 {
   GtkSearchEngineSimple *engine;
-  GCancellable *cancellable;
-
-  GQueue *directories;
-
-  gint n_processed_files;
-  GList *hits;
-
   GtkQuery *query;
   gboolean recursive;
+
+  GtkSearchWalker *walker;
 } SearchThreadData;
 
 
@@ -79,7 +69,7 @@ gtk_search_engine_simple_dispose (GObject *object)
 
   if (simple->active_search)
     {
-      g_cancellable_cancel (simple->active_search->cancellable);
+      _gtk_search_walker_cancel (simple->active_search->walker);
       simple->active_search = NULL;
     }
 
@@ -88,103 +78,11 @@ gtk_search_engine_simple_dispose (GObject *object)
   G_OBJECT_CLASS (_gtk_search_engine_simple_parent_class)->dispose (object);
 }
 
-static void
-queue_if_local (SearchThreadData *data,
-                GFile            *file)
-{
-  if (file &&
-      !_gtk_file_consider_as_remote (file) &&
-      !g_file_has_uri_scheme (file, "recent"))
-    g_queue_push_tail (data->directories, g_object_ref (file));
-}
-
-static SearchThreadData *
-search_thread_data_new (GtkSearchEngineSimple *engine,
-			GtkQuery              *query)
-{
-  SearchThreadData *data;
-
-  data = g_new0 (SearchThreadData, 1);
-
-  data->engine = g_object_ref (engine);
-  data->directories = g_queue_new ();
-  data->query = g_object_ref (query);
-  data->recursive = _gtk_search_engine_get_recursive (GTK_SEARCH_ENGINE (engine));
-  queue_if_local (data, gtk_query_get_location (query));
-
-  data->cancellable = g_cancellable_new ();
-
-  return data;
-}
-
-static void
-search_thread_data_free (SearchThreadData *data)
-{
-  g_queue_foreach (data->directories, (GFunc)g_object_unref, NULL);
-  g_queue_free (data->directories);
-  g_object_unref (data->cancellable);
-  g_object_unref (data->query);
-  g_object_unref (data->engine);
-
-  g_free (data);
-}
-
-static gboolean
-search_thread_done_idle (gpointer user_data)
-{
-  SearchThreadData *data;
-
-  data = user_data;
-
-  if (!g_cancellable_is_cancelled (data->cancellable))
-    _gtk_search_engine_finished (GTK_SEARCH_ENGINE (data->engine));
-
-  data->engine->active_search = NULL;
-  search_thread_data_free (data);
-
-  return FALSE;
-}
-
-typedef struct
-{
-  GList *hits;
-  SearchThreadData *thread_data;
-} Batch;
-
 static gboolean
-search_thread_add_hits_idle (gpointer user_data)
-{
-  Batch *batch = user_data;
-
-  if (!g_cancellable_is_cancelled (batch->thread_data->cancellable))
-    _gtk_search_engine_hits_added (GTK_SEARCH_ENGINE (batch->thread_data->engine), batch->hits);
-
-  g_list_free_full (batch->hits, (GDestroyNotify)_gtk_search_hit_free);
-  g_free (batch);
-
-  return FALSE;
-}
-
-static void
-send_batch (SearchThreadData *data)
+is_local (GFile *file)
 {
-  Batch *batch;
-
-  data->n_processed_files = 0;
-
-  if (data->hits)
-    {
-      guint id;
-
-      batch = g_new (Batch, 1);
-      batch->hits = data->hits;
-      batch->thread_data = data;
-
-      id = gdk_threads_add_idle (search_thread_add_hits_idle, batch);
-      g_source_set_name_by_id (id, "[gtk+] search_thread_add_hits_idle");
-    }
-
-  data->hits = NULL;
+  return !_gtk_file_consider_as_remote (file) &&
+         !g_file_has_uri_scheme (file, "recent");
 }
 
 static gboolean
@@ -206,91 +104,87 @@ is_indexed (GtkSearchEngineSimple *engine,
   return FALSE;
 }
 
-static void
-visit_directory (GFile *dir, SearchThreadData *data)
+static gboolean
+search_thread_matches (const gchar *display_name,
+                       gpointer     user_data)
 {
-  GFileEnumerator *enumerator;
-  GFileInfo *info;
-  GFile *child;
-  const gchar *display_name;
-
-  enumerator = g_file_enumerate_children (dir,
-                                          G_FILE_ATTRIBUTE_STANDARD_NAME ","
-                                          G_FILE_ATTRIBUTE_STANDARD_DISPLAY_NAME ","
-                                          G_FILE_ATTRIBUTE_STANDARD_TYPE ","
-                                          G_FILE_ATTRIBUTE_STANDARD_IS_HIDDEN ","
-                                          G_FILE_ATTRIBUTE_STANDARD_IS_BACKUP ","
-                                          G_FILE_ATTRIBUTE_STANDARD_SIZE ","
-                                          G_FILE_ATTRIBUTE_STANDARD_CONTENT_TYPE ","
-                                          G_FILE_ATTRIBUTE_STANDARD_TARGET_URI ","
-                                          G_FILE_ATTRIBUTE_TIME_MODIFIED ","
-                                          G_FILE_ATTRIBUTE_TIME_ACCESS ","
-                                          G_FILE_ATTRIBUTE_ACCESS_CAN_RENAME ","
-                                          G_FILE_ATTRIBUTE_ACCESS_CAN_TRASH ","
-                                          G_FILE_ATTRIBUTE_ACCESS_CAN_DELETE,
-                                          G_FILE_QUERY_INFO_NOFOLLOW_SYMLINKS,
-                                          data->cancellable, NULL);
-  if (enumerator == NULL)
-    return;
+  SearchThreadData *data = user_data;
 
-  while (g_file_enumerator_iterate (enumerator, &info, &child, data->cancellable, NULL))
-    {
-      if (info == NULL)
-        break;
+  return gtk_query_matches_string (data->query, display_name);
+}
 
-      display_name = g_file_info_get_display_name (info);
-      if (display_name == NULL)
-        continue;
+static gboolean
+search_thread_descend (GFile    *directory,
+                       gpointer  user_data)
+{
+  SearchThreadData *data = user_data;
 
-      if (g_file_info_get_is_hidden (info))
-        continue;
+  return data->recursive &&
+         !is_indexed (data->engine, directory) &&
+         is_local (directory);
+}
 
-      if (gtk_query_matches_string (data->query, display_name))
-        {
-          GtkSearchHit *hit;
+static void
+search_thread_hits (GList    *hits,
+                    gpointer  user_data)
+{
+  SearchThreadData *data = user_data;
 
-          hit = g_new (GtkSearchHit, 1);
-          hit->file = g_object_ref (child);
-          hit->info = g_object_ref (info);
-          data->hits = g_list_prepend (data->hits, hit);
-        }
+  _gtk_search_engine_hits_added (GTK_SEARCH_ENGINE (data->engine), hits);
 
-      data->n_processed_files++;
-      if (data->n_processed_files > BATCH_SIZE)
-        send_batch (data);
+  g_list_free_full (hits, (GDestroyNotify)_gtk_search_hit_free);
+}
 
-      if (data->recursive &&
-          g_file_info_get_file_type (info) == G_FILE_TYPE_DIRECTORY &&
-          !is_indexed (data->engine, child))
-        queue_if_local (data, child);
-    }
+static void
+search_thread_done (gpointer user_data)
+{
+  SearchThreadData *data = user_data;
 
-  g_object_unref (enumerator);
+  _gtk_search_engine_finished (GTK_SEARCH_ENGINE (data->engine));
 }
 
-static gpointer
-search_thread_func (gpointer user_data)
+static void
+search_thread_data_free (SearchThreadData *data)
+{
+  if (data->engine->active_search == data)
+    data->engine->active_search = NULL;
+
+  g_object_unref (data->query);
+  g_object_unref (data->engine);
+
+  g_free (data);
+}
+
+static SearchThreadData *
+search_thread_data_new (GtkSearchEngineSimple *engine,
+			GtkQuery              *query)
 {
   SearchThreadData *data;
-  GFile *dir;
-  guint id;
+  GFile *location;
 
-  data = user_data;
+  data = g_new0 (SearchThreadData, 1);
 
-  while (!g_cancellable_is_cancelled (data->cancellable) &&
-         (dir = g_queue_pop_head (data->directories)) != NULL)
-    {
-      visit_directory (dir, data);
-      g_object_unref (dir);
-    }
+  data->engine = g_object_ref (engine);
+  data->query = g_object_ref (query);
+  data->recursive = _gtk_search_engine_get_recursive (GTK_SEARCH_ENGINE (engine));
+
+  /* The query splits its text into words lazily, make sure that
+   * has happened before several threads start matching
+   */
+  gtk_query_matches_string (query, "");
 
-  if (!g_cancellable_is_cancelled (data->cancellable))
-    send_batch (data);
+  data->walker = _gtk_search_walker_new (search_thread_matches,
+                                         search_thread_descend,
+                                         search_thread_hits,
+                                         search_thread_done,
+                                         data,
+                                         (GDestroyNotify) search_thread_data_free);
 
-  id = gdk_threads_add_idle (search_thread_done_idle, data);
-  g_source_set_name_by_id (id, "[gtk+] search_thread_done_idle");
+  location = gtk_query_get_location (query);
+  if (location && is_local (location))
+    _gtk_search_walker_add_directory (data->walker, location);
 
-  return NULL;
+  return data;
 }
 
 static void
@@ -308,10 +202,9 @@ gtk_search_engine_simple_start (GtkSearchEngine *engine)
     return;
 
   data = search_thread_data_new (simple, simple->query);
-
-  g_thread_unref (g_thread_new ("file-search", search_thread_func, data));
-
   simple->active_search = data;
+
+  _gtk_search_walker_start (data->walker, 0);
 }
 
 static void
@@ -323,7 +216,7 @@ gtk_search_engine_simple_stop (GtkSearchEngine *engine)
 
   if (simple->active_search != NULL)
     {
-      g_cancellable_cancel (simple->active_search->cancellable);
+      _gtk_search_walker_cancel (simple->active_search->walker);
       simple->active_search = NULL;
     }
 }
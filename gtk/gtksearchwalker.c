@@ -0,0 +1,559 @@
+/* gtksearchwalker.c
+ * Copyright (C) 2016 Red Hat, Inc.
+ *
+ * This library is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Library General Public
+ * License as published by the Free Software Foundation; either
+ * version 2 of the License, or (at your option) any later version.
+ *
+ * This library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Library General Public License for more details.
+ *
+ * You should have received a copy of the GNU Library General Public
+ * License along with this library. If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include "config.h"
+
+#include "gtksearchwalkerprivate.h"
+#include "gtksearchengine.h"
+
+#include <gdk/gdk.h>
+
+/* GtkSearchWalker looks for matching files below a set of directories
+ * using a pool of threads. Every thread has its own deque of
+ * directories: it pushes the subdirectories it finds to the tail and
+ * takes its next directory from there too, so it works depth first on
+ * a subtree whose directory entries are likely still cached. Threads
+ * that run out of work steal from the heads of the other deques, where
+ * the oldest and usually largest subtrees are.
+ *
+ * Directories are enumerated with the few attributes needed to match
+ * names and find subdirectories. The complete info, which can be a lot
+ * more expensive (the content type may require sniffing the file), is
+ * only queried for matches.
+ *
+ * Matches are collected per thread and handed to the main thread in
+ * batches. Each batch reports the matches closest to the search
+ * location first, so a thread deep down in a large subtree does not
+ * push aside what the others found next to the start.
+ */
+
+#define MAX_THREADS 8
+#define BATCH_SIZE 500
+
+#define WALK_ATTRIBUTES \
+  G_FILE_ATTRIBUTE_STANDARD_NAME "," \
+  G_FILE_ATTRIBUTE_STANDARD_DISPLAY_NAME "," \
+  G_FILE_ATTRIBUTE_STANDARD_TYPE "," \
+  G_FILE_ATTRIBUTE_STANDARD_IS_HIDDEN
+
+#define HIT_ATTRIBUTES \
+  G_FILE_ATTRIBUTE_STANDARD_NAME "," \
+  G_FILE_ATTRIBUTE_STANDARD_DISPLAY_NAME "," \
+  G_FILE_ATTRIBUTE_STANDARD_TYPE "," \
+  G_FILE_ATTRIBUTE_STANDARD_IS_HIDDEN "," \
+  G_FILE_ATTRIBUTE_STANDARD_IS_BACKUP "," \
+  G_FILE_ATTRIBUTE_STANDARD_SIZE "," \
+  G_FILE_ATTRIBUTE_STANDARD_CONTENT_TYPE "," \
+  G_FILE_ATTRIBUTE_STANDARD_TARGET_URI "," \
+  G_FILE_ATTRIBUTE_TIME_MODIFIED "," \
+  G_FILE_ATTRIBUTE_TIME_ACCESS "," \
+  G_FILE_ATTRIBUTE_ACCESS_CAN_RENAME "," \
+  G_FILE_ATTRIBUTE_ACCESS_CAN_TRASH "," \
+  G_FILE_ATTRIBUTE_ACCESS_CAN_DELETE
+
+typedef struct
+{
+  GFile *directory;
+  guint depth;
+} WorkItem;
+
+typedef struct
+{
+  GtkSearchHit *hit;
+  guint depth;
+} PendingHit;
+
+typedef struct
+{
+  GtkSearchWalker *walker;
+  guint index;
+
+  GMutex lock;            /* protects queue */
+  GQueue queue;           /* WorkItem */
+
+  GList *hits;            /* PendingHit, most recent first */
+  guint n_processed_files;
+} Worker;
+
+struct _GtkSearchWalker
+{
+  GtkSearchWalkerMatchFunc match_func;
+  GtkSearchWalkerDescendFunc descend_func;
+  GtkSearchWalkerHitsFunc hits_func;
+  GtkSearchWalkerDoneFunc done_func;
+  gpointer user_data;
+  GDestroyNotify destroy;
+
+  GCancellable *cancellable;
+
+  GQueue directories;     /* added before starting */
+
+  Worker *workers;
+  guint n_workers;
+
+  gint n_outstanding;     /* directories queued or being visited */
+  gint n_running;         /* threads still running */
+
+  GMutex idle_lock;
+  GCond idle_cond;
+  gint n_idle;
+
+  GMutex hits_lock;       /* protects hits and hits_idle_id */
+  GList *hits;            /* PendingHit, most recent first */
+  guint hits_idle_id;
+};
+
+static void
+work_item_free (WorkItem *item)
+{
+  g_object_unref (item->directory);
+  g_slice_free (WorkItem, item);
+}
+
+static void
+pending_hit_free (PendingHit *pending)
+{
+  g_clear_object (&pending->hit->file);
+  g_clear_object (&pending->hit->info);
+  g_free (pending->hit);
+  g_slice_free (PendingHit, pending);
+}
+
+static void
+gtk_search_walker_free (GtkSearchWalker *walker)
+{
+  WorkItem *item;
+  guint i;
+
+  for (i = 0; i < walker->n_workers; i++)
+    {
+      while ((item = g_queue_pop_head (&walker->workers[i].queue)))
+        work_item_free (item);
+      g_mutex_clear (&walker->workers[i].lock);
+    }
+  g_free (walker->workers);
+
+  g_queue_foreach (&walker->directories, (GFunc) g_object_unref, NULL);
+  g_queue_clear (&walker->directories);
+
+  g_list_free_full (walker->hits, (GDestroyNotify) pending_hit_free);
+
+  g_mutex_clear (&walker->idle_lock);
+  g_cond_clear (&walker->idle_cond);
+  g_mutex_clear (&walker->hits_lock);
+
+  g_object_unref (walker->cancellable);
+
+  if (walker->destroy)
+    walker->destroy (walker->user_data);
+
+  g_slice_free (GtkSearchWalker, walker);
+}
+
+static gint
+compare_depth (gconstpointer a,
+               gconstpointer b)
+{
+  const PendingHit *hit_a = a;
+  const PendingHit *hit_b = b;
+
+  return (gint) hit_a->depth - (gint) hit_b->depth;
+}
+
+/* Runs in the main thread */
+static void
+deliver_hits (GtkSearchWalker *walker)
+{
+  GList *pending, *l;
+  GList *hits;
+  PendingHit *hit;
+
+  g_mutex_lock (&walker->hits_lock);
+  pending = walker->hits;
+  walker->hits = NULL;
+  walker->hits_idle_id = 0;
+  g_mutex_unlock (&walker->hits_lock);
+
+  if (pending == NULL)
+    return;
+
+  if (g_cancellable_is_cancelled (walker->cancellable))
+    {
+      g_list_free_full (pending, (GDestroyNotify) pending_hit_free);
+      return;
+    }
+
+  /* g_list_sort() is stable, so hits at the same depth stay in the
+   * order they were found in
+   */
+  pending = g_list_reverse (pending);
+  pending = g_list_sort (pending, compare_depth);
+
+  hits = NULL;
+  for (l = pending; l; l = l->next)
+    {
+      hit = l->data;
+      hits = g_list_prepend (hits, hit->hit);
+      g_slice_free (PendingHit, hit);
+    }
+  g_list_free (pending);
+
+  walker->hits_func (g_list_reverse (hits), walker->user_data);
+}
+
+static gboolean
+hits_idle (gpointer user_data)
+{
+  deliver_hits (user_data);
+
+  return FALSE;
+}
+
+static gboolean
+done_idle (gpointer user_data)
+{
+  GtkSearchWalker *walker = user_data;
+
+  g_mutex_lock (&walker->hits_lock);
+  if (walker->hits_idle_id)
+    {
+      g_source_remove (walker->hits_idle_id);
+      walker->hits_idle_id = 0;
+    }
+  g_mutex_unlock (&walker->hits_lock);
+
+  deliver_hits (walker);
+
+  if (!g_cancellable_is_cancelled (walker->cancellable) && walker->done_func)
+    walker->done_func (walker->user_data);
+
+  gtk_search_walker_free (walker);
+
+  return FALSE;
+}
+
+static void
+flush_hits (Worker *worker)
+{
+  GtkSearchWalker *walker = worker->walker;
+
+  worker->n_processed_files = 0;
+
+  if (worker->hits == NULL)
+    return;
+
+  g_mutex_lock (&walker->hits_lock);
+  walker->hits = g_list_concat (worker->hits, walker->hits);
+  if (walker->hits_idle_id == 0)
+    {
+      walker->hits_idle_id = gdk_threads_add_idle (hits_idle, walker);
+      g_source_set_name_by_id (walker->hits_idle_id, "[gtk+] search_walker_hits_idle");
+    }
+  g_mutex_unlock (&walker->hits_lock);
+
+  worker->hits = NULL;
+}
+
+static void
+add_hit (Worker   *worker,
+         GFile    *file,
+         guint     depth)
+{
+  PendingHit *pending;
+
+  pending = g_slice_new (PendingHit);
+  pending->hit = g_new (GtkSearchHit, 1);
+  pending->hit->file = g_object_ref (file);
+  pending->hit->info = g_file_query_info (file,
+                                          HIT_ATTRIBUTES,
+                                          G_FILE_QUERY_INFO_NOFOLLOW_SYMLINKS,
+                                          worker->walker->cancellable,
+                                          NULL);
+  pending->depth = depth;
+
+  worker->hits = g_list_prepend (worker->hits, pending);
+}
+
+static void
+push_work (Worker *worker,
+           GFile  *directory,
+           guint   depth)
+{
+  GtkSearchWalker *walker = worker->walker;
+  WorkItem *item;
+
+  item = g_slice_new (WorkItem);
+  item->directory = g_object_ref (directory);
+  item->depth = depth;
+
+  g_atomic_int_inc (&walker->n_outstanding);
+
+  g_mutex_lock (&worker->lock);
+  g_queue_push_tail (&worker->queue, item);
+  g_mutex_unlock (&worker->lock);
+
+  if (g_atomic_int_get (&walker->n_idle) > 0)
+    {
+      g_mutex_lock (&walker->idle_lock);
+      g_cond_signal (&walker->idle_cond);
+      g_mutex_unlock (&walker->idle_lock);
+    }
+}
+
+static WorkItem *
+pop_work (Worker *worker)
+{
+  GtkSearchWalker *walker = worker->walker;
+  Worker *victim;
+  WorkItem *item;
+  guint i;
+
+  g_mutex_lock (&worker->lock);
+  item = g_queue_pop_tail (&worker->queue);
+  g_mutex_unlock (&worker->lock);
+
+  for (i = 1; item == NULL && i < walker->n_workers; i++)
+    {
+      victim = &walker->workers[(worker->index + i) % walker->n_workers];
+
+      g_mutex_lock (&victim->lock);
+      item = g_queue_pop_head (&victim->queue);
+      g_mutex_unlock (&victim->lock);
+    }
+
+  return item;
+}
+
+static void
+visit_directory (Worker   *worker,
+                 WorkItem *item)
+{
+  GtkSearchWalker *walker = worker->walker;
+  GFileEnumerator *enumerator;
+  GFileInfo *info;
+  GFile *child;
+  const gchar *display_name;
+
+  enumerator = g_file_enumerate_children (item->directory,
+                                          WALK_ATTRIBUTES,
+                                          G_FILE_QUERY_INFO_NOFOLLOW_SYMLINKS,
+                                          walker->cancellable, NULL);
+  if (enumerator == NULL)
+    return;
+
+  while (g_file_enumerator_iterate (enumerator, &info, &child, walker->cancellable, NULL))
+    {
+      if (info == NULL)
+        break;
+
+      display_name = g_file_info_get_display_name (info);
+      if (display_name == NULL)
+        continue;
+
+      if (g_file_info_get_is_hidden (info))
+        continue;
+
+      if (walker->match_func (display_name, walker->user_data))
+        add_hit (worker, child, item->depth);
+
+      worker->n_processed_files++;
+      if (worker->n_processed_files > BATCH_SIZE)
+        flush_hits (worker);
+
+      if (g_file_info_get_file_type (info) == G_FILE_TYPE_DIRECTORY &&
+          (walker->descend_func == NULL ||
+           walker->descend_func (child, walker->user_data)))
+        push_work (worker, child, item->depth + 1);
+    }
+
+  g_object_unref (enumerator);
+}
+
+static gpointer
+walker_thread_func (gpointer user_data)
+{
+  Worker *worker = user_data;
+  GtkSearchWalker *walker = worker->walker;
+  WorkItem *item;
+  guint id;
+
+  while (!g_cancellable_is_cancelled (walker->cancellable))
+    {
+      item = pop_work (worker);
+      if (item)
+        {
+          visit_directory (worker, item);
+          work_item_free (item);
+
+          if (g_atomic_int_dec_and_test (&walker->n_outstanding))
+            {
+              g_mutex_lock (&walker->idle_lock);
+              g_cond_broadcast (&walker->idle_cond);
+              g_mutex_unlock (&walker->idle_lock);
+            }
+
+          continue;
+        }
+
+      /* Nothing to steal right now, but the directories being visited
+       * by other threads may still produce more work. Pushing work only
+       * signals when somebody is idle, so wake up now and then anyway
+       * to not depend on that race.
+       */
+      g_mutex_lock (&walker->idle_lock);
+      if (g_atomic_int_get (&walker->n_outstanding) == 0)
+        {
+          g_mutex_unlock (&walker->idle_lock);
+          break;
+        }
+      g_atomic_int_inc (&walker->n_idle);
+      g_cond_wait_until (&walker->idle_cond, &walker->idle_lock,
+                         g_get_monotonic_time () + 10 * G_TIME_SPAN_MILLISECOND);
+      g_atomic_int_add (&walker->n_idle, -1);
+      g_mutex_unlock (&walker->idle_lock);
+    }
+
+  flush_hits (worker);
+
+  /* The walker may be freed as soon as the last thread is done */
+  if (g_atomic_int_dec_and_test (&walker->n_running))
+    {
+      id = gdk_threads_add_idle (done_idle, walker);
+      g_source_set_name_by_id (id, "[gtk+] search_walker_done_idle");
+    }
+
+  return NULL;
+}
+
+/*
+ * _gtk_search_walker_new:
+ * @match_func: decides whether a file matches, given its display name
+ * @descend_func: (allow-none): decides whether to look into a subdirectory
+ * @hits_func: receives batches of #GtkSearchHits, and owns them
+ * @done_func: (allow-none): called when the walk is complete
+ * @user_data: data for the callbacks
+ * @destroy: (allow-none): called to free @user_data with the walker
+ *
+ * Creates a walker. @match_func and @descend_func are called from the
+ * walker threads, the other callbacks from the main thread. Once it is
+ * started, the walker frees itself when it is done or cancelled.
+ *
+ * Returns: a new #GtkSearchWalker
+ */
+GtkSearchWalker *
+_gtk_search_walker_new (GtkSearchWalkerMatchFunc    match_func,
+                        GtkSearchWalkerDescendFunc  descend_func,
+                        GtkSearchWalkerHitsFunc     hits_func,
+                        GtkSearchWalkerDoneFunc     done_func,
+                        gpointer                    user_data,
+                        GDestroyNotify              destroy)
+{
+  GtkSearchWalker *walker;
+
+  g_return_val_if_fail (match_func != NULL, NULL);
+  g_return_val_if_fail (hits_func != NULL, NULL);
+
+  walker = g_slice_new0 (GtkSearchWalker);
+
+  walker->match_func = match_func;
+  walker->descend_func = descend_func;
+  walker->hits_func = hits_func;
+  walker->done_func = done_func;
+  walker->user_data = user_data;
+  walker->destroy = destroy;
+
+  walker->cancellable = g_cancellable_new ();
+  g_queue_init (&walker->directories);
+  g_mutex_init (&walker->idle_lock);
+  g_cond_init (&walker->idle_cond);
+  g_mutex_init (&walker->hits_lock);
+
+  return walker;
+}
+
+void
+_gtk_search_walker_add_directory (GtkSearchWalker *walker,
+                                  GFile           *directory)
+{
+  g_return_if_fail (walker->workers == NULL);
+
+  g_queue_push_tail (&walker->directories, g_object_ref (directory));
+}
+
+/*
+ * _gtk_search_walker_start:
+ * @walker: a #GtkSearchWalker
+ * @n_threads: the number of threads to use, or 0 for a default
+ *   based on the number of processors
+ *
+ * Starts looking into the directories that were added.
+ */
+void
+_gtk_search_walker_start (GtkSearchWalker *walker,
+                          guint            n_threads)
+{
+  GFile *directory;
+  guint i, id;
+
+  g_return_if_fail (walker->workers == NULL);
+
+  if (n_threads == 0)
+    n_threads = CLAMP (g_get_num_processors (), 1, MAX_THREADS);
+
+  walker->n_workers = n_threads;
+  walker->workers = g_new0 (Worker, n_threads);
+
+  for (i = 0; i < n_threads; i++)
+    {
+      walker->workers[i].walker = walker;
+      walker->workers[i].index = i;
+      g_mutex_init (&walker->workers[i].lock);
+      g_queue_init (&walker->workers[i].queue);
+    }
+
+  /* Deal the initial directories out to the threads; nothing runs yet */
+  for (i = 0; (directory = g_queue_pop_head (&walker->directories)); i++)
+    {
+      push_work (&walker->workers[i % n_threads], directory, 0);
+      g_object_unref (directory);
+    }
+
+  if (walker->n_outstanding == 0)
+    {
+      walker->n_running = 0;
+      id = gdk_threads_add_idle (done_idle, walker);
+      g_source_set_name_by_id (id, "[gtk+] search_walker_done_idle");
+      return;
+    }
+
+  walker->n_running = n_threads;
+  for (i = 0; i < n_threads; i++)
+    g_thread_unref (g_thread_new ("file-search", walker_thread_func, &walker->workers[i]));
+}
+
+/*
+ * _gtk_search_walker_cancel:
+ * @walker: a #GtkSearchWalker
+ *
+ * Stops the walk. No more callbacks are invoked, apart from the
+ * destroy notify once the threads have finished.
+ */
+void
+_gtk_search_walker_cancel (GtkSearchWalker *walker)
+{
+  g_cancellable_cancel (walker->cancellable);
+}
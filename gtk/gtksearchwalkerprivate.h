@@ -0,0 +1,51 @@
+/* gtksearchwalkerprivate.h
+ * Copyright (C) 2016 Red Hat, Inc.
+ *
+ * This library is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Library General Public
+ * License as published by the Free Software Foundation; either
+ * version 2 of the License, or (at your option) any later version.
+ *
+ * This library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Library General Public License for more details.
+ *
+ * You should have received a copy of the GNU Library General Public
+ * License along with this library. If not, see <http://www.gnu.org/licenses/>.
+ */
+#ifndef __GTK_SEARCH_WALKER_PRIVATE_H__
+#define __GTK_SEARCH_WALKER_PRIVATE_H__
+
+#include <gio/gio.h>
+
+G_BEGIN_DECLS
+
+typedef struct _GtkSearchWalker GtkSearchWalker;
+
+/* Called from the walker threads */
+typedef gboolean (* GtkSearchWalkerMatchFunc)   (const gchar *display_name,
+                                                 gpointer     user_data);
+typedef gboolean (* GtkSearchWalkerDescendFunc) (GFile       *directory,
+                                                 gpointer     user_data);
+
+/* Called from the main thread */
+typedef void     (* GtkSearchWalkerHitsFunc)    (GList       *hits,
+                                                 gpointer     user_data);
+typedef void     (* GtkSearchWalkerDoneFunc)    (gpointer     user_data);
+
+GtkSearchWalker * _gtk_search_walker_new           (GtkSearchWalkerMatchFunc    match_func,
+                                                    GtkSearchWalkerDescendFunc  descend_func,
+                                                    GtkSearchWalkerHitsFunc     hits_func,
+                                                    GtkSearchWalkerDoneFunc     done_func,
+                                                    gpointer                    user_data,
+                                                    GDestroyNotify              destroy);
+void              _gtk_search_walker_add_directory (GtkSearchWalker            *walker,
+                                                    GFile                      *directory);
+void              _gtk_search_walker_start         (GtkSearchWalker            *walker,
+                                                    guint                       n_threads);
+void              _gtk_search_walker_cancel        (GtkSearchWalker            *walker);
+
+G_END_DECLS
+
+#endif /* __GTK_SEARCH_WALKER_PRIVATE_H__ */
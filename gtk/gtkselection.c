@@ -79,6 +79,7 @@
 
 #include "gtkselection.h"
 #include "gtkselectionprivate.h"
+#include "gtkselectioninputstreamprivate.h"
 
 #include <stdarg.h>
 #include <string.h>
@@ -181,6 +182,15 @@ struct _GtkRetrievalInfo
   gint	   offset;		/* Current offset in buffer, -1 indicates
 				   not yet started */
   guint32 notify_time;		/* Timestamp from SelectionNotify */
+
+  /* Set for _gtk_selection_convert_stream(): chunks go to @stream as
+     they arrive instead of being accumulated in @buffer */
+  GtkSelectionInputStream *stream;
+  GtkSelectionStreamFunc stream_func;
+  gpointer stream_data;
+  GDestroyNotify stream_destroy;
+  gboolean stalled;		/* INCR property not deleted yet, because
+				   the reader of @stream is behind */
 };
 
 /* Local Functions */
@@ -193,6 +203,14 @@ static void gtk_selection_retrieval_report  (GtkRetrievalInfo *info,
 					     guchar           *buffer,
 					     gint              length,
 					     guint32           time);
+static void gtk_selection_retrieval_report_stream (GtkRetrievalInfo *info,
+                                                   GdkAtom           type,
+                                                   gint              format,
+                                                   GInputStream     *stream);
+static void gtk_selection_retrieval_finish_stream (GtkRetrievalInfo *info,
+                                                   gboolean          success);
+static void gtk_selection_retrieval_resume (GtkSelectionInputStream *stream,
+                                            gpointer                 data);
 static void gtk_selection_invoke_handler    (GtkWidget        *widget,
 					     GtkSelectionData *data,
 					     guint             time);
@@ -1006,7 +1024,9 @@ gtk_selection_remove_all (GtkWidget *widget)
 {
   GList *tmp_list;
   GList *next;
+  GList *streams = NULL;
   GtkSelectionInfo *selection_info;
+  GtkRetrievalInfo *retrieval_info;
 
   g_return_if_fail (GTK_IS_WIDGET (widget));
 
@@ -1016,15 +1036,24 @@ gtk_selection_remove_all (GtkWidget *widget)
   while (tmp_list)
     {
       next = tmp_list->next;
-      if (((GtkRetrievalInfo *)tmp_list->data)->widget == widget)
+      retrieval_info = tmp_list->data;
+      if (retrieval_info->widget == widget)
 	{
 	  current_retrievals = g_list_remove_link (current_retrievals, 
 						   tmp_list);
 	  /* structure will be freed in timeout */
 	  g_list_free (tmp_list);
+
+          if (retrieval_info->stream)
+            streams = g_list_prepend (streams, retrieval_info);
 	}
       tmp_list = next;
     }
+
+  /* Readers of unfinished streams get an error */
+  for (tmp_list = streams; tmp_list; tmp_list = tmp_list->next)
+    gtk_selection_retrieval_finish_stream (tmp_list->data, FALSE);
+  g_list_free (streams);
   
   /* Disclaim ownership of any selections */
   
@@ -1054,26 +1083,14 @@ gtk_selection_remove_all (GtkWidget *widget)
 }
 
 
-/**
- * gtk_selection_convert:
- * @widget: The widget which acts as requestor
- * @selection: Which selection to get
- * @target: Form of information desired (e.g., STRING)
- * @time_: Time of request (usually of triggering event)
-       In emergency, you could use #GDK_CURRENT_TIME
- * 
- * Requests the contents of a selection. When received, 
- * a “selection-received” signal will be generated.
- * 
- * Returns: %TRUE if requested succeeded. %FALSE if we could not process
- *          request. (e.g., there was already a request in process for
- *          this widget).
- **/
-gboolean
-gtk_selection_convert (GtkWidget *widget, 
-		       GdkAtom	  selection, 
-		       GdkAtom	  target,
-		       guint32	  time_)
+static gboolean
+gtk_selection_retrieval_start (GtkWidget              *widget,
+                               GdkAtom                 selection,
+                               GdkAtom                 target,
+                               guint32                 time_,
+                               GtkSelectionStreamFunc  stream_func,
+                               gpointer                stream_data,
+                               GDestroyNotify          stream_destroy)
 {
   GtkRetrievalInfo *info;
   GList *tmp_list;
@@ -1081,9 +1098,6 @@ gtk_selection_convert (GtkWidget *widget,
   GdkDisplay *display;
   guint id;
   
-  g_return_val_if_fail (GTK_IS_WIDGET (widget), FALSE);
-  g_return_val_if_fail (selection != GDK_NONE, FALSE);
-  
   if (initialize)
     gtk_selection_init ();
   
@@ -1105,7 +1119,7 @@ gtk_selection_convert (GtkWidget *widget,
       tmp_list = tmp_list->next;
     }
   
-  info = g_slice_new (GtkRetrievalInfo);
+  info = g_slice_new0 (GtkRetrievalInfo);
   
   info->widget = widget;
   info->selection = selection;
@@ -1113,6 +1127,17 @@ gtk_selection_convert (GtkWidget *widget,
   info->idle_time = 0;
   info->buffer = NULL;
   info->offset = -1;
+
+  if (stream_func)
+    {
+      info->stream = GTK_SELECTION_INPUT_STREAM (_gtk_selection_input_stream_new ());
+      _gtk_selection_input_stream_set_resume_func (info->stream,
+                                                   gtk_selection_retrieval_resume,
+                                                   info);
+      info->stream_func = stream_func;
+      info->stream_data = stream_data;
+      info->stream_destroy = stream_destroy;
+    }
   
   /* Check if this process has current owner. If so, call handler
      procedure directly to avoid deadlocks with INCR. */
@@ -1139,13 +1164,42 @@ gtk_selection_convert (GtkWidget *widget,
 	  gtk_selection_invoke_handler (owner_widget, 
 					&selection_data,
 					time_);
-	  
-	  gtk_selection_retrieval_report (info,
-					  selection_data.type, 
-					  selection_data.format,
-					  selection_data.data,
-					  selection_data.length,
-					  time_);
+
+          if (info->stream)
+            {
+              /* A stream supplied by the owner is handed over as is */
+              if (selection_data.stream)
+                gtk_selection_retrieval_report_stream (info,
+                                                       selection_data.type,
+                                                       selection_data.format,
+                                                       selection_data.stream);
+              else if (selection_data.length >= 0)
+                {
+                  _gtk_selection_input_stream_push (info->stream,
+                                                    selection_data.data,
+                                                    selection_data.length);
+                  selection_data.data = NULL;
+                  gtk_selection_retrieval_report_stream (info,
+                                                         selection_data.type,
+                                                         selection_data.format,
+                                                         G_INPUT_STREAM (info->stream));
+                }
+
+              gtk_selection_retrieval_finish_stream (info, selection_data.length >= 0);
+              g_clear_object (&selection_data.stream);
+              g_clear_object (&info->stream);
+            }
+          else
+            {
+              _gtk_selection_data_flush_stream (&selection_data);
+
+              gtk_selection_retrieval_report (info,
+                                              selection_data.type, 
+                                              selection_data.format,
+                                              selection_data.data,
+                                              selection_data.length,
+                                              time_);
+            }
 	  
 	  g_free (selection_data.data);
           selection_data.data = NULL;
@@ -1167,6 +1221,112 @@ gtk_selection_convert (GtkWidget *widget,
   return TRUE;
 }
 
+/**
+ * gtk_selection_convert:
+ * @widget: The widget which acts as requestor
+ * @selection: Which selection to get
+ * @target: Form of information desired (e.g., STRING)
+ * @time_: Time of request (usually of triggering event)
+       In emergency, you could use #GDK_CURRENT_TIME
+ * 
+ * Requests the contents of a selection. When received, 
+ * a “selection-received” signal will be generated.
+ * 
+ * Returns: %TRUE if requested succeeded. %FALSE if we could not process
+ *          request. (e.g., there was already a request in process for
+ *          this widget).
+ **/
+gboolean
+gtk_selection_convert (GtkWidget *widget, 
+		       GdkAtom	  selection, 
+		       GdkAtom	  target,
+		       guint32	  time_)
+{
+  g_return_val_if_fail (GTK_IS_WIDGET (widget), FALSE);
+  g_return_val_if_fail (selection != GDK_NONE, FALSE);
+
+  return gtk_selection_retrieval_start (widget, selection, target, time_,
+                                        NULL, NULL, NULL);
+}
+
+/*
+ * _gtk_selection_convert_stream:
+ * @widget: The widget which acts as requestor
+ * @selection: Which selection to get
+ * @target: Form of information desired (e.g., STRING)
+ * @time_: Time of request
+ * @callback: function to call once the type of the data is known
+ * @user_data: data to pass to @callback and @destroy
+ * @destroy: (allow-none): function to call when the transfer is over
+ *
+ * Like gtk_selection_convert(), but instead of emitting
+ * “selection-received” with the complete data, hands a #GInputStream
+ * to @callback as soon as the first chunk arrives. The data of INCR
+ * transfers is pushed to the stream as it comes in and is never
+ * assembled in one buffer. @callback is called exactly once; @destroy
+ * is called after all data has been received or the transfer failed,
+ * and may destroy @widget.
+ *
+ * Returns: %TRUE if requested succeeded. %FALSE if there was already
+ *     a request in process for this widget.
+ */
+gboolean
+_gtk_selection_convert_stream (GtkWidget              *widget,
+                               GdkAtom                 selection,
+                               GdkAtom                 target,
+                               guint32                 time_,
+                               GtkSelectionStreamFunc  callback,
+                               gpointer                user_data,
+                               GDestroyNotify          destroy)
+{
+  g_return_val_if_fail (GTK_IS_WIDGET (widget), FALSE);
+  g_return_val_if_fail (selection != GDK_NONE, FALSE);
+  g_return_val_if_fail (callback != NULL, FALSE);
+
+  return gtk_selection_retrieval_start (widget, selection, target, time_,
+                                        callback, user_data, destroy);
+}
+
+/*
+ * _gtk_selection_cancel_stream:
+ * @widget: the widget passed to _gtk_selection_convert_stream()
+ *
+ * Stops a retrieval started with _gtk_selection_convert_stream().
+ * Readers of the stream get a %G_IO_ERROR_CANCELLED error, and the
+ * destroy notify is called, which may destroy @widget. Does nothing
+ * if the retrieval has already finished.
+ */
+void
+_gtk_selection_cancel_stream (GtkWidget *widget)
+{
+  GtkRetrievalInfo *info = NULL;
+  GError *error;
+  GList *tmp_list;
+
+  g_return_if_fail (GTK_IS_WIDGET (widget));
+
+  for (tmp_list = current_retrievals; tmp_list; tmp_list = tmp_list->next)
+    {
+      info = tmp_list->data;
+      if (info->widget == widget && info->stream)
+        break;
+    }
+
+  if (!tmp_list)
+    return;
+
+  /* Info structure will be freed in timeout */
+  current_retrievals = g_list_remove_link (current_retrievals, tmp_list);
+  g_list_free (tmp_list);
+
+  error = g_error_new_literal (G_IO_ERROR, G_IO_ERROR_CANCELLED,
+                               _("Operation was cancelled"));
+  _gtk_selection_input_stream_complete (info->stream, error);
+  g_error_free (error);
+
+  gtk_selection_retrieval_finish_stream (info, FALSE);
+}
+
 /**
  * gtk_selection_data_get_selection:
  * @selection_data: a pointer to a #GtkSelectionData-struct.
@@ -1338,6 +1498,7 @@ gtk_selection_data_set (GtkSelectionData *selection_data,
   g_return_if_fail (selection_data != NULL);
 
   g_free (selection_data->data);
+  g_clear_object (&selection_data->stream);
   
   selection_data->type = type;
   selection_data->format = format;
@@ -1361,6 +1522,113 @@ gtk_selection_data_set (GtkSelectionData *selection_data,
   selection_data->length = length;
 }
 
+/**
+ * gtk_selection_data_set_stream:
+ * @selection_data: a pointer to a #GtkSelectionData-struct.
+ * @type: the type of selection data
+ * @format: format (number of bits in a unit)
+ * @stream: a #GInputStream providing the data
+ *
+ * Stores a stream as the contents of the selection, instead of a
+ * buffer as gtk_selection_data_set() does. This is meant for large
+ * data supplied from a #GtkWidget::selection-get handler or a
+ * #GtkClipboardGetFunc: on X11, @stream is read and sent a chunk at
+ * a time as the requestor asks for more, using the INCR protocol, so
+ * the data never has to be in memory as a whole. Requestors in the
+ * same process that use gtk_clipboard_read_stream_async() get
+ * @stream itself.
+ *
+ * @stream is read synchronously in the main thread, so it should not
+ * block for long; a file or memory stream is a good fit. Where the
+ * data can not be sent incrementally, @stream is read completely
+ * before sending it.
+ *
+ * Since: 3.22
+ **/
+void
+gtk_selection_data_set_stream (GtkSelectionData *selection_data,
+                               GdkAtom           type,
+                               gint              format,
+                               GInputStream     *stream)
+{
+  g_return_if_fail (selection_data != NULL);
+  g_return_if_fail (G_IS_INPUT_STREAM (stream));
+
+  g_free (selection_data->data);
+
+  selection_data->type = type;
+  selection_data->format = format;
+  selection_data->data = NULL;
+  selection_data->length = 0;
+  g_set_object (&selection_data->stream, stream);
+}
+
+/* Replaces the data of @selection_data with the next at most
+ * @max_size bytes of its stream. The stream is dropped once it
+ * is exhausted or reading it fails.
+ */
+static void
+gtk_selection_data_read_chunk (GtkSelectionData *selection_data,
+                               gsize             max_size)
+{
+  GByteArray *array;
+  GError *error = NULL;
+  gsize len, size;
+  gssize n;
+
+  max_size -= max_size % gtk_selection_bytes_per_item (selection_data->format);
+
+  array = g_byte_array_new ();
+  while (array->len < max_size)
+    {
+      len = array->len;
+      size = MIN (max_size - len, 65536);
+
+      g_byte_array_set_size (array, len + size);
+      n = g_input_stream_read (selection_data->stream,
+                               array->data + len, size,
+                               NULL, &error);
+      g_byte_array_set_size (array, len + MAX (n, 0));
+
+      if (n <= 0)
+        {
+          if (error)
+            {
+              g_warning ("Error reading selection data: %s", error->message);
+              g_error_free (error);
+            }
+
+          g_clear_object (&selection_data->stream);
+          break;
+        }
+    }
+
+  g_free (selection_data->data);
+  selection_data->length = array->len;
+
+  /* Keep the guaranteed null termination */
+  g_byte_array_append (array, (const guint8 *) "", 1);
+  selection_data->data = g_byte_array_free (array, FALSE);
+}
+
+/*
+ * _gtk_selection_data_flush_stream:
+ * @selection_data: a pointer to a #GtkSelectionData-struct.
+ *
+ * Reads the stream set with gtk_selection_data_set_stream(), if any,
+ * into the data of @selection_data, for the places that can only
+ * transfer a complete buffer.
+ */
+void
+_gtk_selection_data_flush_stream (GtkSelectionData *selection_data)
+{
+  if (selection_data->stream == NULL)
+    return;
+
+  gtk_selection_data_read_chunk (selection_data, G_MAXINT);
+  g_clear_object (&selection_data->stream);
+}
+
 static gboolean
 selection_set_string (GtkSelectionData *selection_data,
 		      const gchar      *str,
@@ -2442,6 +2710,7 @@ _gtk_selection_request (GtkWidget *widget,
       data.data = NULL;
       data.length = -1;
       data.display = gtk_widget_get_display (widget);
+      data.stream = NULL;
       
 #ifdef DEBUG_SELECTION
       g_message ("Selection %ld, target %ld (%s) requested by 0x%x (property = %ld)",
@@ -2455,14 +2724,20 @@ _gtk_selection_request (GtkWidget *widget,
       if (data.length < 0)
 	{
 	  info->conversions[i].property = GDK_NONE;
+	  info->conversions[i].offset = -1;
 	  continue;
 	}
       
       g_return_val_if_fail ((data.format >= 8) && (data.format % 8 == 0), FALSE);
+
+      /* Data supplied as a stream is read one chunk at a time, and
+         only needs INCR if it doesn't fit into the first chunk */
+      if (data.stream)
+        gtk_selection_data_read_chunk (&data, selection_max_size);
       
       items = data.length / gtk_selection_bytes_per_item (data.format);
       
-      if (data.length > selection_max_size)
+      if (data.stream || data.length > selection_max_size)
 	{
 	  /* Sending via INCR */
 #ifdef DEBUG_SELECTION
@@ -2635,6 +2910,16 @@ _gtk_selection_incr_event (GdkWindow	   *window,
 	  int bytes_per_item;
 	  
 	  info->idle_time = 0;
+
+	  if (info->conversions[i].offset == -2 &&
+	      info->conversions[i].data.stream != NULL)
+	    {
+	      /* The previous chunk of a stream is sent, get the next */
+	      gtk_selection_data_read_chunk (&info->conversions[i].data,
+					     selection_max_size);
+	      if (info->conversions[i].data.length > 0)
+		info->conversions[i].offset = 0;
+	    }
 	  
 	  if (info->conversions[i].offset == -2) /* only the last 0-length
 						    piece*/
@@ -2713,6 +2998,7 @@ gtk_selection_incr_timeout (GtkIncrInfo *info)
 {
   GList *tmp_list;
   gboolean retval;
+  gint i;
 
   /* Determine if retrieval has finished by checking if it still in
      list of pending retrievals */
@@ -2733,6 +3019,15 @@ gtk_selection_incr_timeout (GtkIncrInfo *info)
 	  current_incrs = g_list_remove_link (current_incrs, tmp_list);
 	  g_list_free (tmp_list);
 	}
+
+      for (i = 0; i < info->num_conversions; i++)
+        {
+          if (info->conversions[i].offset != -1)
+            {
+              g_free (info->conversions[i].data.data);
+              g_clear_object (&info->conversions[i].data.stream);
+            }
+        }
       
       g_free (info->conversions);
       /* FIXME: we should check if requestor window is still in use,
@@ -2807,8 +3102,11 @@ _gtk_selection_notify (GtkWidget	 *widget,
       current_retrievals = g_list_remove_link (current_retrievals, tmp_list);
       g_list_free (tmp_list);
       /* structure will be freed in timeout */
-      gtk_selection_retrieval_report (info,
-				      GDK_NONE, 0, NULL, -1, event->time);
+      if (info->stream)
+        gtk_selection_retrieval_finish_stream (info, FALSE);
+      else
+        gtk_selection_retrieval_report (info,
+                                        GDK_NONE, 0, NULL, -1, event->time);
       
       return TRUE;
     }
@@ -2832,9 +3130,22 @@ _gtk_selection_notify (GtkWidget	 *widget,
       g_list_free (tmp_list);
       
       info->offset = length;
-      gtk_selection_retrieval_report (info,
-				      type, format, 
-				      buffer, length, event->time);
+      if (info->stream)
+        {
+          /* Finishing may destroy the widget, so clean up first */
+          gdk_property_delete (window, event->property);
+
+          _gtk_selection_input_stream_push (info->stream, buffer, length);
+          gtk_selection_retrieval_report_stream (info, type, format,
+                                                 G_INPUT_STREAM (info->stream));
+          gtk_selection_retrieval_finish_stream (info, TRUE);
+
+          return TRUE;
+        }
+      else
+        gtk_selection_retrieval_report (info,
+                                        type, format, 
+                                        buffer, length, event->time);
     }
 
   gdk_property_delete (window, event->property);
@@ -2904,6 +3215,23 @@ _gtk_selection_property_notify (GtkWidget	*widget,
   window = gtk_widget_get_window (widget);
   length = gdk_selection_property_get (window, &new_buffer,
 				       &type, &format);
+
+  if (info->stream && length > 0 && type != GDK_NONE)
+    {
+      /* Deleting the property asks the owner for the next portion,
+         so wait with that until the reader catches up */
+      info->offset += length;
+      if (_gtk_selection_input_stream_push (info->stream, new_buffer, length))
+        gdk_property_delete (window, event->atom);
+      else
+        info->stalled = TRUE;
+
+      gtk_selection_retrieval_report_stream (info, type, format,
+                                             G_INPUT_STREAM (info->stream));
+
+      return TRUE;
+    }
+
   gdk_property_delete (window, event->atom);
 
   /* We could do a lot better efficiency-wise by paying attention to
@@ -2916,11 +3244,20 @@ _gtk_selection_property_notify (GtkWidget	*widget,
       /* Info structure will be freed in timeout */
       current_retrievals = g_list_remove_link (current_retrievals, tmp_list);
       g_list_free (tmp_list);
-      gtk_selection_retrieval_report (info,
-				      type, format, 
-				      (type == GDK_NONE) ?  NULL : info->buffer,
-				      (type == GDK_NONE) ?  -1 : info->offset,
-				      info->notify_time);
+      if (info->stream)
+        {
+          g_free (new_buffer);
+          if (type != GDK_NONE)
+            gtk_selection_retrieval_report_stream (info, type, format,
+                                                   G_INPUT_STREAM (info->stream));
+          gtk_selection_retrieval_finish_stream (info, type != GDK_NONE);
+        }
+      else
+        gtk_selection_retrieval_report (info,
+                                        type, format, 
+                                        (type == GDK_NONE) ?  NULL : info->buffer,
+                                        (type == GDK_NONE) ?  -1 : info->offset,
+                                        info->notify_time);
     }
   else				/* append on newly arrived data */
     {
@@ -2983,17 +3320,24 @@ gtk_selection_retrieval_timeout (GtkRetrievalInfo *info)
 	{
 	  current_retrievals = g_list_remove_link (current_retrievals, tmp_list);
 	  g_list_free (tmp_list);
-	  gtk_selection_retrieval_report (info, GDK_NONE, 0, NULL, -1, GDK_CURRENT_TIME);
+          if (info->stream)
+            gtk_selection_retrieval_finish_stream (info, FALSE);
+          else
+            gtk_selection_retrieval_report (info, GDK_NONE, 0, NULL, -1, GDK_CURRENT_TIME);
 	}
       
       g_free (info->buffer);
+      g_clear_object (&info->stream);
       g_slice_free (GtkRetrievalInfo, info);
       
       retval =  FALSE;		/* remove timeout */
     }
   else
     {
-      info->idle_time++;
+      /* Waiting for our own reader doesn't count, unless nobody
+         but us holds on to the stream anymore */
+      if (!info->stalled || G_OBJECT (info->stream)->ref_count == 1)
+        info->idle_time++;
       
       retval =  TRUE;		/* timeout will happen again */
     }
@@ -3027,12 +3371,101 @@ gtk_selection_retrieval_report (GtkRetrievalInfo *info,
   data.length = length;
   data.data = buffer;
   data.display = gtk_widget_get_display (info->widget);
+  data.stream = NULL;
   
   g_signal_emit_by_name (info->widget,
 			 "selection-received", 
 			 &data, time);
 }
 
+/*************************************************************
+ * gtk_selection_retrieval_report_stream:
+ *     Hands the stream of a _gtk_selection_convert_stream()
+ *     retrieval to its callback, once the type of the data is
+ *     known. Only the first call has an effect.
+ *   arguments:
+ *     info:	  information about the retrieval
+ *     stream:	  stream delivering the data (NULL => error)
+ *   results:
+ *************************************************************/
+
+static void
+gtk_selection_retrieval_report_stream (GtkRetrievalInfo *info,
+                                       GdkAtom           type,
+                                       gint              format,
+                                       GInputStream     *stream)
+{
+  GtkSelectionStreamFunc func = info->stream_func;
+
+  if (func == NULL)
+    return;
+
+  info->stream_func = NULL;
+  func (info->widget, type, format, stream, info->stream_data);
+}
+
+/*************************************************************
+ * gtk_selection_retrieval_resume:
+ *     Called when the reader of a stalled INCR retrieval has
+ *     caught up; asks the owner for the next portion.
+ *   arguments:
+ *     stream:	  the stream of the retrieval
+ *     data:	  information about the retrieval
+ *   results:
+ *************************************************************/
+
+static void
+gtk_selection_retrieval_resume (GtkSelectionInputStream *stream,
+                                gpointer                 data)
+{
+  GtkRetrievalInfo *info = data;
+
+  if (!info->stalled)
+    return;
+
+  info->stalled = FALSE;
+  info->idle_time = 0;
+  gdk_property_delete (gtk_widget_get_window (info->widget),
+                       gdk_atom_intern_static_string ("GDK_SELECTION"));
+}
+
+/*************************************************************
+ * gtk_selection_retrieval_finish_stream:
+ *     Ends the stream of a _gtk_selection_convert_stream()
+ *     retrieval and calls its destroy notify, which may
+ *     destroy the requesting widget.
+ *   arguments:
+ *     info:	  information about the retrieval
+ *     success:	  whether all data was received
+ *   results:
+ *************************************************************/
+
+static void
+gtk_selection_retrieval_finish_stream (GtkRetrievalInfo *info,
+                                       gboolean          success)
+{
+  GDestroyNotify destroy;
+
+  if (success)
+    _gtk_selection_input_stream_complete (info->stream, NULL);
+  else
+    {
+      GError *error;
+
+      error = g_error_new_literal (G_IO_ERROR, G_IO_ERROR_FAILED,
+                                   _("Could not retrieve the selection"));
+      _gtk_selection_input_stream_complete (info->stream, error);
+      g_error_free (error);
+
+      gtk_selection_retrieval_report_stream (info, GDK_NONE, 0, NULL);
+    }
+
+  destroy = info->stream_destroy;
+  info->stream_destroy = NULL;
+  if (destroy)
+    destroy (info->stream_data);
+}
+
 /*************************************************************
  * gtk_selection_invoke_handler:
  *     Finds and invokes handler for specified
@@ -3190,6 +3623,9 @@ gtk_selection_data_copy (const GtkSelectionData *data)
       new_data->data = g_malloc (data->length + 1);
       memcpy (new_data->data, data->data, data->length + 1);
     }
+
+  if (data->stream)
+    g_object_ref (data->stream);
   
   return new_data;
 }
@@ -3207,6 +3643,7 @@ gtk_selection_data_free (GtkSelectionData *data)
   g_return_if_fail (data != NULL);
   
   g_free (data->data);
+  g_clear_object (&data->stream);
   
   g_slice_free (GtkSelectionData, data);
 }
@@ -215,6 +215,11 @@ void     gtk_selection_data_set      (GtkSelectionData     *selection_data,
                                       gint                  format,
                                       const guchar         *data,
                                       gint                  length);
+GDK_AVAILABLE_IN_3_22
+void     gtk_selection_data_set_stream (GtkSelectionData   *selection_data,
+                                        GdkAtom             type,
+                                        gint                format,
+                                        GInputStream       *stream);
 GDK_AVAILABLE_IN_ALL
 gboolean gtk_selection_data_set_text (GtkSelectionData     *selection_data,
                                       const gchar          *str,
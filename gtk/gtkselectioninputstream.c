@@ -0,0 +1,416 @@
+/* gtkselectioninputstream.c
+ * Copyright (C) 2016 Red Hat, Inc.
+ *
+ * This library is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Library General Public
+ * License as published by the Free Software Foundation; either
+ * version 2 of the License, or (at your option) any later version.
+ *
+ * This library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Library General Public License for more details.
+ *
+ * You should have received a copy of the GNU Library General Public
+ * License along with this library. If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include "config.h"
+
+#include "gtkselectioninputstreamprivate.h"
+
+#include <string.h>
+
+/* GtkSelectionInputStream is the consumer end of a selection transfer.
+ * The selection code pushes the chunks it receives from the owner
+ * (e.g. the pieces of an INCR transfer on X11) as they arrive, and
+ * readers get them without the whole payload ever being assembled in
+ * one buffer. Chunks arrive from the main loop, so the stream is meant
+ * to be read asynchronously from the main thread; a synchronous read
+ * iterates the default main context until data is available.
+ *
+ * Readers that fall behind would otherwise make the stream buffer
+ * the whole payload after all. Once more than MAX_QUEUED_SIZE bytes
+ * are waiting, _gtk_selection_input_stream_push() asks the selection
+ * code to hold off the owner, and the resume function is called from
+ * the read path when the queue has drained below that again.
+ */
+
+#define MAX_QUEUED_SIZE (1024 * 1024)
+
+struct _GtkSelectionInputStream
+{
+  GInputStream parent_instance;
+
+  GQueue chunks;          /* GBytes, in the order they arrived */
+  gsize offset;           /* bytes of the first chunk already read */
+  gsize queued;           /* bytes not read yet */
+  guint complete : 1;
+  guint full     : 1;     /* the owner was asked to wait */
+  GError *error;
+
+  GTask *pending;         /* a read waiting for more data */
+  guchar *pending_buffer;
+  gsize pending_count;
+  GSource *cancel_source;
+
+  GtkSelectionInputStreamResumeFunc resume_func;
+  gpointer resume_data;
+};
+
+G_DEFINE_TYPE (GtkSelectionInputStream, _gtk_selection_input_stream, G_TYPE_INPUT_STREAM)
+
+static gboolean
+has_data (GtkSelectionInputStream *stream)
+{
+  return !g_queue_is_empty (&stream->chunks) || stream->complete;
+}
+
+static void
+clear_chunks (GtkSelectionInputStream *stream)
+{
+  GBytes *bytes;
+
+  while ((bytes = g_queue_pop_head (&stream->chunks)))
+    g_bytes_unref (bytes);
+
+  stream->offset = 0;
+  stream->queued = 0;
+}
+
+static void
+maybe_resume (GtkSelectionInputStream *stream)
+{
+  if (!stream->full || stream->queued >= MAX_QUEUED_SIZE)
+    return;
+
+  stream->full = FALSE;
+  if (stream->resume_func)
+    stream->resume_func (stream, stream->resume_data);
+}
+
+/* Returns the number of bytes copied to @buffer, 0 at the end of
+ * the data, or -1 if the transfer failed.
+ */
+static gssize
+read_available (GtkSelectionInputStream  *stream,
+                guchar                   *buffer,
+                gsize                     count,
+                GError                  **error)
+{
+  GBytes *bytes;
+  const guchar *data;
+  gsize size, n, done;
+
+  if (g_queue_is_empty (&stream->chunks) && stream->error)
+    {
+      g_propagate_error (error, g_error_copy (stream->error));
+      return -1;
+    }
+
+  done = 0;
+  while (done < count && !g_queue_is_empty (&stream->chunks))
+    {
+      bytes = g_queue_peek_head (&stream->chunks);
+      data = g_bytes_get_data (bytes, &size);
+
+      n = MIN (count - done, size - stream->offset);
+      memcpy (buffer + done, data + stream->offset, n);
+      done += n;
+      stream->offset += n;
+      stream->queued -= n;
+
+      if (stream->offset == size)
+        {
+          g_bytes_unref (g_queue_pop_head (&stream->chunks));
+          stream->offset = 0;
+        }
+    }
+
+  maybe_resume (stream);
+
+  return done;
+}
+
+static void
+finish_pending_read (GtkSelectionInputStream *stream)
+{
+  GError *error = NULL;
+  GTask *task;
+  gssize n;
+
+  if (stream->pending == NULL || !has_data (stream))
+    return;
+
+  task = stream->pending;
+  stream->pending = NULL;
+
+  if (stream->cancel_source)
+    {
+      g_source_destroy (stream->cancel_source);
+      g_source_unref (stream->cancel_source);
+      stream->cancel_source = NULL;
+    }
+
+  n = read_available (stream, stream->pending_buffer, stream->pending_count, &error);
+  if (n < 0)
+    g_task_return_error (task, error);
+  else
+    g_task_return_int (task, n);
+
+  g_object_unref (task);
+}
+
+static gboolean
+read_cancelled (GCancellable *cancellable,
+                gpointer      data)
+{
+  GtkSelectionInputStream *stream = data;
+  GTask *task;
+
+  task = stream->pending;
+  stream->pending = NULL;
+
+  g_source_unref (stream->cancel_source);
+  stream->cancel_source = NULL;
+
+  g_task_return_error_if_cancelled (task);
+  g_object_unref (task);
+
+  return G_SOURCE_REMOVE;
+}
+
+static gssize
+gtk_selection_input_stream_read (GInputStream  *input,
+                                 void          *buffer,
+                                 gsize          count,
+                                 GCancellable  *cancellable,
+                                 GError       **error)
+{
+  GtkSelectionInputStream *stream = GTK_SELECTION_INPUT_STREAM (input);
+
+  while (!has_data (stream))
+    {
+      if (g_cancellable_set_error_if_cancelled (cancellable, error))
+        return -1;
+
+      g_main_context_iteration (NULL, TRUE);
+    }
+
+  return read_available (stream, buffer, count, error);
+}
+
+static void
+gtk_selection_input_stream_read_async (GInputStream        *input,
+                                       void                *buffer,
+                                       gsize                count,
+                                       int                  io_priority,
+                                       GCancellable        *cancellable,
+                                       GAsyncReadyCallback  callback,
+                                       gpointer             user_data)
+{
+  GtkSelectionInputStream *stream = GTK_SELECTION_INPUT_STREAM (input);
+  GTask *task;
+
+  task = g_task_new (stream, cancellable, callback, user_data);
+  g_task_set_source_tag (task, gtk_selection_input_stream_read_async);
+  g_task_set_priority (task, io_priority);
+
+  stream->pending = task;
+  stream->pending_buffer = buffer;
+  stream->pending_count = count;
+
+  if (has_data (stream))
+    {
+      finish_pending_read (stream);
+      return;
+    }
+
+  if (cancellable)
+    {
+      stream->cancel_source = g_cancellable_source_new (cancellable);
+      g_source_set_callback (stream->cancel_source,
+                             (GSourceFunc) read_cancelled, stream, NULL);
+      g_source_attach (stream->cancel_source, g_main_context_get_thread_default ());
+    }
+}
+
+static gssize
+gtk_selection_input_stream_read_finish (GInputStream  *input,
+                                        GAsyncResult  *result,
+                                        GError       **error)
+{
+  g_return_val_if_fail (g_task_is_valid (result, input), -1);
+
+  return g_task_propagate_int (G_TASK (result), error);
+}
+
+static gboolean
+gtk_selection_input_stream_close (GInputStream  *input,
+                                  GCancellable  *cancellable,
+                                  GError       **error)
+{
+  GtkSelectionInputStream *stream = GTK_SELECTION_INPUT_STREAM (input);
+
+  /* Whatever still arrives is dropped */
+  clear_chunks (stream);
+  stream->complete = TRUE;
+  maybe_resume (stream);
+
+  return TRUE;
+}
+
+/* The default implementation closes in a thread, which would race
+ * with the main loop pushing data, so close right away instead.
+ */
+static void
+gtk_selection_input_stream_close_async (GInputStream        *input,
+                                        int                  io_priority,
+                                        GCancellable        *cancellable,
+                                        GAsyncReadyCallback  callback,
+                                        gpointer             user_data)
+{
+  GTask *task;
+
+  task = g_task_new (input, cancellable, callback, user_data);
+  g_task_set_source_tag (task, gtk_selection_input_stream_close_async);
+  g_task_set_priority (task, io_priority);
+
+  gtk_selection_input_stream_close (input, cancellable, NULL);
+  g_task_return_boolean (task, TRUE);
+  g_object_unref (task);
+}
+
+static gboolean
+gtk_selection_input_stream_close_finish (GInputStream  *input,
+                                         GAsyncResult  *result,
+                                         GError       **error)
+{
+  g_return_val_if_fail (g_task_is_valid (result, input), FALSE);
+
+  return g_task_propagate_boolean (G_TASK (result), error);
+}
+
+static void
+gtk_selection_input_stream_finalize (GObject *object)
+{
+  GtkSelectionInputStream *stream = GTK_SELECTION_INPUT_STREAM (object);
+
+  clear_chunks (stream);
+  g_clear_error (&stream->error);
+
+  G_OBJECT_CLASS (_gtk_selection_input_stream_parent_class)->finalize (object);
+}
+
+static void
+_gtk_selection_input_stream_class_init (GtkSelectionInputStreamClass *klass)
+{
+  GObjectClass *object_class = G_OBJECT_CLASS (klass);
+  GInputStreamClass *stream_class = G_INPUT_STREAM_CLASS (klass);
+
+  object_class->finalize = gtk_selection_input_stream_finalize;
+
+  stream_class->read_fn = gtk_selection_input_stream_read;
+  stream_class->read_async = gtk_selection_input_stream_read_async;
+  stream_class->read_finish = gtk_selection_input_stream_read_finish;
+  stream_class->close_fn = gtk_selection_input_stream_close;
+  stream_class->close_async = gtk_selection_input_stream_close_async;
+  stream_class->close_finish = gtk_selection_input_stream_close_finish;
+}
+
+static void
+_gtk_selection_input_stream_init (GtkSelectionInputStream *stream)
+{
+  g_queue_init (&stream->chunks);
+}
+
+GInputStream *
+_gtk_selection_input_stream_new (void)
+{
+  return g_object_new (GTK_TYPE_SELECTION_INPUT_STREAM, NULL);
+}
+
+/*
+ * _gtk_selection_input_stream_set_resume_func:
+ * @stream: a #GtkSelectionInputStream
+ * @func: (allow-none): function to call when the stream wants more data
+ * @data: data to pass to @func
+ *
+ * Sets the function that is called when the reader has caught up
+ * after _gtk_selection_input_stream_push() returned %FALSE.
+ */
+void
+_gtk_selection_input_stream_set_resume_func (GtkSelectionInputStream           *stream,
+                                             GtkSelectionInputStreamResumeFunc  func,
+                                             gpointer                           data)
+{
+  g_return_if_fail (GTK_IS_SELECTION_INPUT_STREAM (stream));
+
+  stream->resume_func = func;
+  stream->resume_data = data;
+}
+
+/*
+ * _gtk_selection_input_stream_push:
+ * @stream: a #GtkSelectionInputStream
+ * @data: (transfer full): a chunk of data, allocated with g_malloc()
+ * @length: the length of @data
+ *
+ * Appends a chunk of the transfer to the stream, and wakes up a
+ * pending read.
+ *
+ * Returns: %TRUE if the stream is ready for more data, %FALSE if
+ *     the sender should wait until the resume function is called
+ */
+gboolean
+_gtk_selection_input_stream_push (GtkSelectionInputStream *stream,
+                                  guchar                  *data,
+                                  gsize                    length)
+{
+  g_return_val_if_fail (GTK_IS_SELECTION_INPUT_STREAM (stream), TRUE);
+
+  if (length == 0 || stream->complete)
+    {
+      g_free (data);
+      return TRUE;
+    }
+
+  g_queue_push_tail (&stream->chunks, g_bytes_new_take (data, length));
+  stream->queued += length;
+
+  finish_pending_read (stream);
+
+  if (stream->queued >= MAX_QUEUED_SIZE)
+    stream->full = TRUE;
+
+  return !stream->full;
+}
+
+/*
+ * _gtk_selection_input_stream_complete:
+ * @stream: a #GtkSelectionInputStream
+ * @error: (allow-none): the reason the transfer failed, or %NULL
+ *
+ * Marks the end of the transfer. Readers get the data pushed so far,
+ * followed by the end of the stream or by @error.
+ */
+void
+_gtk_selection_input_stream_complete (GtkSelectionInputStream *stream,
+                                      const GError            *error)
+{
+  g_return_if_fail (GTK_IS_SELECTION_INPUT_STREAM (stream));
+
+  if (stream->complete)
+    return;
+
+  stream->complete = TRUE;
+  if (error)
+    stream->error = g_error_copy (error);
+
+  /* nothing is going to be sent anymore */
+  stream->full = FALSE;
+  stream->resume_func = NULL;
+  stream->resume_data = NULL;
+
+  finish_pending_read (stream);
+}
@@ -0,0 +1,57 @@
+/* gtkselectioninputstreamprivate.h
+ * Copyright (C) 2016 Red Hat, Inc.
+ *
+ * This library is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Library General Public
+ * License as published by the Free Software Foundation; either
+ * version 2 of the License, or (at your option) any later version.
+ *
+ * This library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Library General Public License for more details.
+ *
+ * You should have received a copy of the GNU Library General Public
+ * License along with this library. If not, see <http://www.gnu.org/licenses/>.
+ */
+#ifndef __GTK_SELECTION_INPUT_STREAM_PRIVATE_H__
+#define __GTK_SELECTION_INPUT_STREAM_PRIVATE_H__
+
+#include <gio/gio.h>
+
+G_BEGIN_DECLS
+
+#define GTK_TYPE_SELECTION_INPUT_STREAM         (_gtk_selection_input_stream_get_type ())
+#define GTK_SELECTION_INPUT_STREAM(o)           (G_TYPE_CHECK_INSTANCE_CAST ((o), GTK_TYPE_SELECTION_INPUT_STREAM, GtkSelectionInputStream))
+#define GTK_SELECTION_INPUT_STREAM_CLASS(c)     (G_TYPE_CHECK_CLASS_CAST ((c), GTK_TYPE_SELECTION_INPUT_STREAM, GtkSelectionInputStreamClass))
+#define GTK_IS_SELECTION_INPUT_STREAM(o)        (G_TYPE_CHECK_INSTANCE_TYPE ((o), GTK_TYPE_SELECTION_INPUT_STREAM))
+#define GTK_IS_SELECTION_INPUT_STREAM_CLASS(c)  (G_TYPE_CHECK_CLASS_TYPE ((c), GTK_TYPE_SELECTION_INPUT_STREAM))
+#define GTK_SELECTION_INPUT_STREAM_GET_CLASS(o) (G_TYPE_INSTANCE_GET_CLASS ((o), GTK_TYPE_SELECTION_INPUT_STREAM, GtkSelectionInputStreamClass))
+
+typedef struct _GtkSelectionInputStream GtkSelectionInputStream;
+typedef struct _GtkSelectionInputStreamClass GtkSelectionInputStreamClass;
+
+struct _GtkSelectionInputStreamClass
+{
+  GInputStreamClass parent_class;
+};
+
+typedef void (* GtkSelectionInputStreamResumeFunc) (GtkSelectionInputStream *stream,
+                                                    gpointer                 data);
+
+GType          _gtk_selection_input_stream_get_type (void) G_GNUC_CONST;
+
+GInputStream * _gtk_selection_input_stream_new      (void);
+
+void           _gtk_selection_input_stream_set_resume_func (GtkSelectionInputStream           *stream,
+                                                            GtkSelectionInputStreamResumeFunc  func,
+                                                            gpointer                           data);
+gboolean       _gtk_selection_input_stream_push     (GtkSelectionInputStream *stream,
+                                                     guchar                  *data,
+                                                     gsize                    length);
+void           _gtk_selection_input_stream_complete (GtkSelectionInputStream *stream,
+                                                     const GError            *error);
+
+G_END_DECLS
+
+#endif /* __GTK_SELECTION_INPUT_STREAM_PRIVATE_H__ */
@@ -45,6 +45,7 @@ struct _GtkSelectionData
   guchar       *data;
   gint          length;
   GdkDisplay   *display;
+  GInputStream *stream;
 };
 
 struct _GtkTargetList
@@ -54,6 +55,31 @@ struct _GtkTargetList
   guint ref_count;
  };
 
+/*
+ * GtkSelectionStreamFunc:
+ * @widget: the widget that requested the selection
+ * @type: the type of the data, or %GDK_NONE if the request failed
+ * @format: the format of the data
+ * @stream: (allow-none): a stream delivering the data, or %NULL if
+ *     the request failed
+ * @user_data: the data passed to _gtk_selection_convert_stream()
+ */
+typedef void (* GtkSelectionStreamFunc) (GtkWidget    *widget,
+                                         GdkAtom       type,
+                                         gint          format,
+                                         GInputStream *stream,
+                                         gpointer      user_data);
+
+gboolean _gtk_selection_convert_stream  (GtkWidget              *widget,
+                                         GdkAtom                 selection,
+                                         GdkAtom                 target,
+                                         guint32                 time_,
+                                         GtkSelectionStreamFunc  callback,
+                                         gpointer                user_data,
+                                         GDestroyNotify          destroy);
+void     _gtk_selection_cancel_stream   (GtkWidget              *widget);
+void     _gtk_selection_data_flush_stream (GtkSelectionData    *selection_data);
+
 gboolean _gtk_selection_clear           (GtkWidget         *widget,
                                          GdkEventSelection *event);
 gboolean _gtk_selection_request         (GtkWidget         *widget,
@@ -26,6 +26,7 @@
 #include "gtkdebug.h"
 #include "gtkintl.h"
 #include "gtkprivate.h"
+#include "gtkprofilerprivate.h"
 #include "gtksizegroup-private.h"
 #include "gtksizerequestcacheprivate.h"
 #include "gtkwidgetprivate.h"
@@ -148,6 +149,7 @@ gtk_widget_query_size_for_orientation (GtkWidget        *widget,
   gint min_baseline = -1;
   gint nat_baseline = -1;
   gboolean found_in_cache;
+  gint64 profiler_start;
 
   gtk_widget_ensure_resize (widget);
 
@@ -163,12 +165,16 @@ gtk_widget_query_size_for_orientation (GtkWidget        *widget,
 						   &min_baseline,
 						   &nat_baseline);
 
+  _gtk_size_request_cache_record (G_OBJECT_TYPE (widget), found_in_cache);
+
   widget_class = GTK_WIDGET_GET_CLASS (widget);
   
   if (!found_in_cache)
     {
       gint adjusted_min, adjusted_natural, adjusted_for_size = for_size;
 
+      profiler_start = _gtk_profiler_begin ();
+
       G_GNUC_BEGIN_IGNORE_DEPRECATIONS;
       gtk_widget_ensure_style (widget);
       G_GNUC_END_IGNORE_DEPRECATIONS;
@@ -324,6 +330,8 @@ gtk_widget_query_size_for_orientation (GtkWidget        *widget,
                                       nat_size,
 				      min_baseline,
 				      nat_baseline);
+
+      _gtk_profiler_end (widget, GTK_PROFILER_MEASURE, profiler_start);
     }
 
   if (minimum_size)
@@ -25,48 +25,93 @@
 
 #include <string.h>
 
+typedef struct {
+  guint hits;
+  guint misses;
+} SizeRequestStatistics;
+
+static GHashTable *statistics = NULL;
+static gboolean record_statistics = FALSE;
+
 void
 _gtk_size_request_cache_init (SizeRequestCache *cache)
 {
   memset (cache, 0, sizeof (SizeRequestCache));
 }
 
-static void
-free_sizes_x (SizeRequestX **sizes)
+void
+_gtk_size_request_cache_free (SizeRequestCache *cache)
 {
-  gint i;
-
-  for (i = 0; i < GTK_SIZE_REQUEST_CACHED_SIZES && sizes[i] != NULL; i++)
-    g_slice_free (SizeRequestX, sizes[i]);
-
-  g_slice_free1 (sizeof (SizeRequestY *) * GTK_SIZE_REQUEST_CACHED_SIZES, sizes);
+  g_free (cache->requests_x);
+  g_free (cache->requests_y);
 }
 
-static void
-free_sizes_y (SizeRequestY **sizes)
+/* Clearing keeps the allocated entries (and thus the size the
+ * cache has grown to), since the widget is about to be measured
+ * again anyway.
+ */
+void
+_gtk_size_request_cache_clear (SizeRequestCache *cache)
 {
-  gint i;
+  guint i;
 
-  for (i = 0; i < GTK_SIZE_REQUEST_CACHED_SIZES && sizes[i] != NULL; i++)
-    g_slice_free (SizeRequestY, sizes[i]);
+  cache->request_mode_valid = FALSE;
 
-  g_slice_free1 (sizeof (SizeRequestY *) * GTK_SIZE_REQUEST_CACHED_SIZES, sizes);
+  for (i = 0; i < G_N_ELEMENTS (cache->flags); i++)
+    {
+      cache->flags[i].n_cached_requests = 0;
+      cache->flags[i].last_cached_request = 0;
+      cache->flags[i].evicted = FALSE;
+      cache->flags[i].cached_size_valid = FALSE;
+    }
 }
 
-void
-_gtk_size_request_cache_free (SizeRequestCache *cache)
+/* Returns the index of the entry to store a newly computed size in,
+ * the returned entry will immediately be used to cache the new
+ * computed size so we go ahead and increment the last_cached_request
+ * right away.
+ *
+ * Once every entry has been evicted in turn the widget is thrashing
+ * its cache, so we grow it instead of evicting again.
+ */
+static guint
+pull_cached_request (SizeRequestCache *cache,
+                     GtkOrientation    orientation,
+                     gpointer         *requests,
+                     gsize             request_size)
 {
-  if (cache->requests_x)
-    free_sizes_x (cache->requests_x);
-  if (cache->requests_y)
-    free_sizes_y (cache->requests_y);
-}
+  guint n_sizes, n_allocated;
 
-void
-_gtk_size_request_cache_clear (SizeRequestCache *cache)
-{
-  _gtk_size_request_cache_free (cache);
-  _gtk_size_request_cache_init (cache);
+  n_sizes = cache->flags[orientation].n_cached_requests;
+  n_allocated = cache->flags[orientation].n_allocated_requests;
+
+  if (n_sizes < n_allocated)
+    {
+      cache->flags[orientation].n_cached_requests++;
+      cache->flags[orientation].last_cached_request = n_sizes;
+    }
+  else if (n_allocated < GTK_SIZE_REQUEST_MAX_CACHED_SIZES &&
+           (n_allocated == 0 ||
+            (cache->flags[orientation].evicted &&
+             cache->flags[orientation].last_cached_request == n_allocated - 1)))
+    {
+      n_allocated = MIN (n_allocated + GTK_SIZE_REQUEST_CACHED_SIZES,
+                         GTK_SIZE_REQUEST_MAX_CACHED_SIZES);
+      *requests = g_realloc (*requests, request_size * n_allocated);
+
+      cache->flags[orientation].n_allocated_requests = n_allocated;
+      cache->flags[orientation].evicted = FALSE;
+      cache->flags[orientation].n_cached_requests++;
+      cache->flags[orientation].last_cached_request = n_sizes;
+    }
+  else
+    {
+      if (++cache->flags[orientation].last_cached_request == n_allocated)
+        cache->flags[orientation].last_cached_request = 0;
+      cache->flags[orientation].evicted = TRUE;
+    }
+
+  return cache->flags[orientation].last_cached_request;
 }
 
 void
@@ -115,42 +160,26 @@ _gtk_size_request_cache_commit (SizeRequestCache *cache,
 
   if (orientation == GTK_ORIENTATION_HORIZONTAL)
     {
-      SizeRequestX **cached_sizes;
-      SizeRequestX  *cached_size;
+      SizeRequestX *cached_sizes;
+      SizeRequestX *cached_size;
       cached_sizes = cache->requests_x;
 
       for (i = 0; i < n_sizes; i++)
 	{
-	  if (cached_sizes[i]->cached_size.minimum_size == minimum_size &&
-	      cached_sizes[i]->cached_size.natural_size == natural_size)
+	  if (cached_sizes[i].cached_size.minimum_size == minimum_size &&
+	      cached_sizes[i].cached_size.natural_size == natural_size)
 	    {
-	      cached_sizes[i]->lower_for_size = MIN (cached_sizes[i]->lower_for_size, for_size);
-	      cached_sizes[i]->upper_for_size = MAX (cached_sizes[i]->upper_for_size, for_size);
+	      cached_sizes[i].lower_for_size = MIN (cached_sizes[i].lower_for_size, for_size);
+	      cached_sizes[i].upper_for_size = MAX (cached_sizes[i].upper_for_size, for_size);
 	      return;
 	    }
 	}
 
-      /* If not found, pull a new size from the cache, the returned size cache
-       * will immediately be used to cache the new computed size so we go ahead
-       * and increment the last_cached_request right away */
-      if (n_sizes < GTK_SIZE_REQUEST_CACHED_SIZES)
-	{
-	  cache->flags[orientation].n_cached_requests++;
-	  cache->flags[orientation].last_cached_request = cache->flags[orientation].n_cached_requests - 1;
-	}
-      else
-	{
-	  if (++cache->flags[orientation].last_cached_request == GTK_SIZE_REQUEST_CACHED_SIZES)
-	    cache->flags[orientation].last_cached_request = 0;
-	}
+      /* If not found, pull a new size from the cache */
+      i = pull_cached_request (cache, orientation,
+                               (gpointer *) &cache->requests_x, sizeof (SizeRequestX));
 
-      if (cache->requests_x == NULL)
-	cache->requests_x = g_slice_alloc0 (sizeof (SizeRequestX *) * GTK_SIZE_REQUEST_CACHED_SIZES);
-
-      if (cache->requests_x[cache->flags[orientation].last_cached_request] == NULL)
-	cache->requests_x[cache->flags[orientation].last_cached_request] = g_slice_new (SizeRequestX);
-
-      cached_size = cache->requests_x[cache->flags[orientation].last_cached_request];
+      cached_size = &cache->requests_x[i];
       cached_size->lower_for_size = for_size;
       cached_size->upper_for_size = for_size;
       cached_size->cached_size.minimum_size = minimum_size;
@@ -158,44 +187,28 @@ _gtk_size_request_cache_commit (SizeRequestCache *cache,
     }
   else
     {
-      SizeRequestY **cached_sizes;
-      SizeRequestY  *cached_size;
+      SizeRequestY *cached_sizes;
+      SizeRequestY *cached_size;
       cached_sizes = cache->requests_y;
 
       for (i = 0; i < n_sizes; i++)
 	{
-	  if (cached_sizes[i]->cached_size.minimum_size == minimum_size &&
-	      cached_sizes[i]->cached_size.natural_size == natural_size &&
-	      cached_sizes[i]->cached_size.minimum_baseline == minimum_baseline &&
-	      cached_sizes[i]->cached_size.natural_baseline == natural_baseline)
+	  if (cached_sizes[i].cached_size.minimum_size == minimum_size &&
+	      cached_sizes[i].cached_size.natural_size == natural_size &&
+	      cached_sizes[i].cached_size.minimum_baseline == minimum_baseline &&
+	      cached_sizes[i].cached_size.natural_baseline == natural_baseline)
 	    {
-	      cached_sizes[i]->lower_for_size = MIN (cached_sizes[i]->lower_for_size, for_size);
-	      cached_sizes[i]->upper_for_size = MAX (cached_sizes[i]->upper_for_size, for_size);
+	      cached_sizes[i].lower_for_size = MIN (cached_sizes[i].lower_for_size, for_size);
+	      cached_sizes[i].upper_for_size = MAX (cached_sizes[i].upper_for_size, for_size);
 	      return;
 	    }
 	}
 
-      /* If not found, pull a new size from the cache, the returned size cache
-       * will immediately be used to cache the new computed size so we go ahead
-       * and increment the last_cached_request right away */
-      if (n_sizes < GTK_SIZE_REQUEST_CACHED_SIZES)
-	{
-	  cache->flags[orientation].n_cached_requests++;
-	  cache->flags[orientation].last_cached_request = cache->flags[orientation].n_cached_requests - 1;
-	}
-      else
-	{
-	  if (++cache->flags[orientation].last_cached_request == GTK_SIZE_REQUEST_CACHED_SIZES)
-	    cache->flags[orientation].last_cached_request = 0;
-	}
-
-      if (cache->requests_y == NULL)
-	cache->requests_y = g_slice_alloc0 (sizeof (SizeRequestY *) * GTK_SIZE_REQUEST_CACHED_SIZES);
-
-      if (cache->requests_y[cache->flags[orientation].last_cached_request] == NULL)
-	cache->requests_y[cache->flags[orientation].last_cached_request] = g_slice_new (SizeRequestY);
+      /* If not found, pull a new size from the cache */
+      i = pull_cached_request (cache, orientation,
+                               (gpointer *) &cache->requests_y, sizeof (SizeRequestY));
 
-      cached_size = cache->requests_y[cache->flags[orientation].last_cached_request];
+      cached_size = &cache->requests_y[i];
       cached_size->lower_for_size = for_size;
       cached_size->upper_for_size = for_size;
       cached_size->cached_size.minimum_size = minimum_size;
@@ -235,7 +248,7 @@ _gtk_size_request_cache_lookup (SizeRequestCache *cache,
 	  /* Search for an already cached size */
 	  for (i = 0; i < cache->flags[orientation].n_cached_requests; i++)
 	    {
-	      SizeRequestX *cur = cache->requests_x[i];
+	      SizeRequestX *cur = &cache->requests_x[i];
 
 	      if (cur->lower_for_size <= for_size &&
 		  cur->upper_for_size >= for_size)
@@ -273,7 +286,7 @@ _gtk_size_request_cache_lookup (SizeRequestCache *cache,
 	  /* Search for an already cached size */
 	  for (i = 0; i < cache->flags[orientation].n_cached_requests; i++)
 	    {
-	      SizeRequestY *cur = cache->requests_y[i];
+	      SizeRequestY *cur = &cache->requests_y[i];
 
 	      if (cur->lower_for_size <= for_size &&
 		  cur->upper_for_size >= for_size)
@@ -297,3 +310,57 @@ _gtk_size_request_cache_lookup (SizeRequestCache *cache,
     }
 }
 
+
+static void
+size_request_statistics_free (gpointer data)
+{
+  g_slice_free (SizeRequestStatistics, data);
+}
+
+/* Per-type hit and miss counters, shown by the inspector.
+ * Nothing is recorded unless the inspector asked for it.
+ */
+void
+_gtk_size_request_cache_set_record_statistics (gboolean record)
+{
+  record_statistics = record;
+
+  if (record && statistics == NULL)
+    statistics = g_hash_table_new_full (NULL, NULL, NULL, size_request_statistics_free);
+}
+
+void
+_gtk_size_request_cache_record (GType    type,
+                                gboolean hit)
+{
+  SizeRequestStatistics *stats;
+
+  if (G_LIKELY (!record_statistics))
+    return;
+
+  stats = g_hash_table_lookup (statistics, GSIZE_TO_POINTER (type));
+  if (stats == NULL)
+    {
+      stats = g_slice_new0 (SizeRequestStatistics);
+      g_hash_table_insert (statistics, GSIZE_TO_POINTER (type), stats);
+    }
+
+  if (hit)
+    stats->hits++;
+  else
+    stats->misses++;
+}
+
+void
+_gtk_size_request_cache_get_statistics (GType  type,
+                                        guint *hits,
+                                        guint *misses)
+{
+  SizeRequestStatistics *stats = NULL;
+
+  if (statistics)
+    stats = g_hash_table_lookup (statistics, GSIZE_TO_POINTER (type));
+
+  *hits = stats ? stats->hits : 0;
+  *misses = stats ? stats->misses : 0;
+}
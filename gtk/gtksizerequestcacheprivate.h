@@ -25,7 +25,7 @@
 #ifndef __GTK_SIZE_REQUEST_CACHE_PRIVATE_H__
 #define __GTK_SIZE_REQUEST_CACHE_PRIVATE_H__
 
-#include <glib.h>
+#include <glib-object.h>
 #include <gtk/gtkenums.h>
 
 G_BEGIN_DECLS
@@ -35,8 +35,17 @@ G_BEGIN_DECLS
  * for a said widget to have, if a label can
  * only wrap to 3 lines, only 3 caches will
  * ever be allocated for it.
+ *
+ * Widgets start out with room for
+ * GTK_SIZE_REQUEST_CACHED_SIZES entries per
+ * orientation. A widget that evicts its whole
+ * cache (e.g. a wrapping label measured at many
+ * widths while a pane is dragged) gets its cache
+ * grown by that amount, up to
+ * GTK_SIZE_REQUEST_MAX_CACHED_SIZES entries.
  */
-#define GTK_SIZE_REQUEST_CACHED_SIZES   (5)
+#define GTK_SIZE_REQUEST_CACHED_SIZES     (5)
+#define GTK_SIZE_REQUEST_MAX_CACHED_SIZES (20)
 
 typedef struct {
   gint minimum_size;
@@ -65,8 +74,8 @@ typedef struct
 } SizeRequestY;
 
 typedef struct {
-  SizeRequestX **requests_x;
-  SizeRequestY **requests_y;
+  SizeRequestX *requests_x;
+  SizeRequestY *requests_y;
 
   CachedSizeX  cached_size_x;
   CachedSizeY  cached_size_y;
@@ -74,9 +83,11 @@ typedef struct {
   GtkSizeRequestMode request_mode   : 3;
   guint       request_mode_valid    : 1;
   struct {
-    guint       n_cached_requests   : 3;
-    guint       last_cached_request : 3;
-    guint       cached_size_valid   : 1;
+    guint       n_cached_requests    : 5;
+    guint       last_cached_request  : 5;
+    guint       n_allocated_requests : 5;
+    guint       evicted              : 1;
+    guint       cached_size_valid    : 1;
   }           flags[2];
 } SizeRequestCache;
 
@@ -99,6 +110,13 @@ gboolean        _gtk_size_request_cache_lookup                  (SizeRequestCach
                                                                  gint                   *minimum_baseline,
                                                                  gint                   *natural_baseline);
 
+void            _gtk_size_request_cache_set_record_statistics   (gboolean                record);
+void            _gtk_size_request_cache_record                  (GType                   type,
+                                                                 gboolean                hit);
+void            _gtk_size_request_cache_get_statistics          (GType                   type,
+                                                                 guint                  *hits,
+                                                                 guint                  *misses);
+
 G_END_DECLS
 
 #endif /* __GTK_SIZE_REQUEST_CACHE_PRIVATE_H__ */
@@ -143,6 +143,10 @@ typedef struct {
   GtkStackChildInfo *last_visible_child;
   cairo_surface_t *last_visible_surface;
   GtkAllocation last_visible_surface_allocation;
+  cairo_surface_t *visible_child_surface;
+  GtkAllocation visible_child_surface_clip;
+  guint visible_child_draw_serial;
+  gboolean visible_child_live;
   gdouble transition_pos;
   guint tick_id;
   gint64 start_time;
@@ -237,6 +241,7 @@ gtk_stack_finalize (GObject *obj)
 
   if (priv->last_visible_surface != NULL)
     cairo_surface_destroy (priv->last_visible_surface);
+  g_clear_pointer (&priv->visible_child_surface, cairo_surface_destroy);
 
   g_clear_object (&priv->gadget);
 
@@ -923,6 +928,7 @@ gtk_stack_set_transition_position (GtkStack *stack,
           cairo_surface_destroy (priv->last_visible_surface);
           priv->last_visible_surface = NULL;
         }
+      g_clear_pointer (&priv->visible_child_surface, cairo_surface_destroy);
 
       if (priv->last_visible_child != NULL)
         {
@@ -1115,6 +1121,8 @@ set_visible_child (GtkStack               *stack,
   if (priv->last_visible_surface != NULL)
     cairo_surface_destroy (priv->last_visible_surface);
   priv->last_visible_surface = NULL;
+  g_clear_pointer (&priv->visible_child_surface, cairo_surface_destroy);
+  priv->visible_child_live = FALSE;
 
   if (priv->visible_child && priv->visible_child->widget)
     {
@@ -1956,6 +1964,100 @@ gtk_stack_compute_expand (GtkWidget *widget,
   *vexpand_p = vexpand;
 }
 
+/* During a transition, the incoming child is drawn once into
+ * visible_child_surface at its final allocation, covering its clip, and
+ * every frame is composited from that and last_visible_surface. As soon
+ * as the child queues a redraw or gets a new allocation, its draw serial
+ * changes and we go back to drawing it live until the transition ends.
+ */
+static void
+gtk_stack_update_visible_child_surface (GtkStack *stack)
+{
+  GtkStackPrivate *priv = gtk_stack_get_instance_private (stack);
+  GtkWidget *child = priv->visible_child->widget;
+  GtkAllocation allocation;
+  cairo_t *cr;
+
+  if (priv->visible_child_live)
+    return;
+
+  if (priv->visible_child_surface != NULL)
+    {
+      if (priv->visible_child_draw_serial == _gtk_widget_get_draw_serial (child))
+        return;
+
+      g_clear_pointer (&priv->visible_child_surface, cairo_surface_destroy);
+      priv->visible_child_live = TRUE;
+      return;
+    }
+
+  /* Child windows and native windows are drawn on their own, we can't
+   * stand in for them
+   */
+  if (!gtk_widget_is_drawable (child) ||
+      _gtk_widget_has_output_windows (child) ||
+      gdk_window_has_native (gtk_widget_get_window (child)))
+    {
+      priv->visible_child_live = TRUE;
+      return;
+    }
+
+  gtk_widget_get_allocation (child, &allocation);
+  gtk_widget_get_clip (child, &priv->visible_child_surface_clip);
+  priv->visible_child_surface =
+    gdk_window_create_similar_surface (gtk_widget_get_window (GTK_WIDGET (stack)),
+                                       CAIRO_CONTENT_COLOR_ALPHA,
+                                       priv->visible_child_surface_clip.width,
+                                       priv->visible_child_surface_clip.height);
+  cr = cairo_create (priv->visible_child_surface);
+  cairo_translate (cr,
+                   allocation.x - priv->visible_child_surface_clip.x,
+                   allocation.y - priv->visible_child_surface_clip.y);
+  gtk_widget_draw (child, cr);
+  cairo_destroy (cr);
+
+  priv->visible_child_draw_serial = _gtk_widget_get_draw_serial (child);
+}
+
+static void
+gtk_stack_draw_visible_child (GtkStack *stack,
+                              cairo_t  *cr)
+{
+  GtkStackPrivate *priv = gtk_stack_get_instance_private (stack);
+  GtkWidget *child = priv->visible_child->widget;
+  GdkWindow *window, *w;
+  int x, y;
+
+  if (priv->visible_child_surface == NULL)
+    {
+      gtk_container_propagate_draw (GTK_CONTAINER (stack), child, cr);
+      return;
+    }
+
+  /* Put it where gtk_container_propagate_draw() would draw the child */
+  x = y = 0;
+  window = gtk_widget_get_window (GTK_WIDGET (stack));
+  for (w = gtk_widget_get_window (child); w && w != window; w = gdk_window_get_parent (w))
+    {
+      int wx, wy;
+      gdk_window_get_position (w, &wx, &wy);
+      x += wx;
+      y += wy;
+    }
+
+  if (w == NULL)
+    x = y = 0;
+
+  /* The child has no window of its own, or we would draw it live */
+  x += priv->visible_child_surface_clip.x;
+  y += priv->visible_child_surface_clip.y;
+
+  cairo_save (cr);
+  cairo_set_source_surface (cr, priv->visible_child_surface, x, y);
+  cairo_paint (cr);
+  cairo_restore (cr);
+}
+
 static void
 gtk_stack_draw_crossfade (GtkWidget *widget,
                           cairo_t   *cr)
@@ -1964,9 +2066,7 @@ gtk_stack_draw_crossfade (GtkWidget *widget,
   GtkStackPrivate *priv = gtk_stack_get_instance_private (stack);
 
   cairo_push_group (cr);
-  gtk_container_propagate_draw (GTK_CONTAINER (stack),
-                                priv->visible_child->widget,
-                                cr);
+  gtk_stack_draw_visible_child (stack, cr);
   cairo_save (cr);
 
   /* Multiply alpha by transition pos */
@@ -2035,9 +2135,7 @@ gtk_stack_draw_under (GtkWidget *widget,
   cairo_rectangle (cr, x, y, width, height);
   cairo_clip (cr);
 
-  gtk_container_propagate_draw (GTK_CONTAINER (stack),
-                                priv->visible_child->widget,
-                                cr);
+  gtk_stack_draw_visible_child (stack, cr);
 
   cairo_restore (cr);
 
@@ -2110,9 +2208,7 @@ gtk_stack_draw_slide (GtkWidget *widget,
      }
 
   if (gtk_cairo_should_draw_window (cr, priv->bin_window))
-    gtk_container_propagate_draw (GTK_CONTAINER (stack),
-                                  priv->visible_child->widget,
-                                  cr);
+    gtk_stack_draw_visible_child (stack, cr);
 }
 
 static gboolean
@@ -2175,6 +2271,8 @@ gtk_stack_render (GtkCssGadget *gadget,
               cairo_destroy (pattern_cr);
             }
 
+          gtk_stack_update_visible_child_surface (stack);
+
           cairo_rectangle (cr,
                            0, 0,
                            gtk_widget_get_allocated_width (widget),
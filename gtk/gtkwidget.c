@@ -51,6 +51,7 @@
 #include "gtkcontainerprivate.h"
 #include "gtkbindings.h"
 #include "gtkprivate.h"
+#include "gtkprofilerprivate.h"
 #include "gtkaccessible.h"
 #include "gtktooltipprivate.h"
 #include "gtkinvisible.h"
@@ -4552,6 +4553,122 @@ gtk_widget_new (GType        type,
   return widget;
 }
 
+/* Retained rendering
+ *
+ * If GTK_RENDER_CACHE is set in the environment, the drawing of every
+ * widget is recorded in a cairo recording surface and replayed on later
+ * exposes, as long as nothing about the widget changed. Queueing a draw,
+ * a style change or a new allocation drops the recording of the widget
+ * and all its ancestors, since theirs contain it.
+ *
+ * Widgets that have a GdkWindow or register child windows that show
+ * output, themselves or anywhere below them, are not cached. Those
+ * windows are exposed and invalidated without going through the widget.
+ *
+ * The same walk bumps the draw serial, which lets containers like
+ * GtkStack tell whether an image they took of a child is still current.
+ */
+static gboolean
+gtk_widget_render_cache_enabled (void)
+{
+  static int enabled = -1;
+
+  if (enabled < 0)
+    enabled = gtk_get_env_flag ("GTK_RENDER_CACHE");
+
+  return enabled;
+}
+
+/* Containers index the clips of their children for drawing, see
+ * gtk_container_draw().
+ */
+static void
+gtk_widget_invalidate_parent_draw_index (GtkWidget *widget)
+{
+  GtkWidget *parent = widget->priv->parent;
+
+  if (parent != NULL && GTK_IS_CONTAINER (parent))
+    _gtk_container_invalidate_draw_index (GTK_CONTAINER (parent));
+}
+
+static void
+gtk_widget_invalidate_render_cache (GtkWidget *widget)
+{
+  GtkWidget *w;
+
+  for (w = widget; w != NULL; w = w->priv->parent)
+    {
+      g_clear_pointer (&w->priv->render_cache, cairo_surface_destroy);
+      w->priv->draw_serial++;
+    }
+}
+
+static void
+invalidate_child_render_cache (GtkWidget *child,
+                               gpointer   data);
+
+/* Drops the recordings of the descendants of @widget that intersect
+ * @region, given in the coordinates of @widget's window, or of all of
+ * them if it is %NULL. Queueing a draw on a container is how a full
+ * repaint is forced, and their contents may have changed without them
+ * queueing a draw themselves.
+ *
+ * Their draw serials are left alone. A container animating itself
+ * queues draws all the time, and images of its children stay valid.
+ */
+static void
+gtk_widget_invalidate_child_render_caches (GtkWidget            *widget,
+                                           const cairo_region_t *region)
+{
+  if (GTK_IS_CONTAINER (widget))
+    gtk_container_forall (GTK_CONTAINER (widget),
+                          invalidate_child_render_cache,
+                          (gpointer) region);
+}
+
+static void
+invalidate_child_render_cache (GtkWidget *child,
+                               gpointer   data)
+{
+  const cairo_region_t *region = data;
+  GtkWidgetPrivate *priv = child->priv;
+
+  if (region != NULL &&
+      cairo_region_contains_rectangle (region, &priv->clip) == CAIRO_REGION_OVERLAP_OUT)
+    return;
+
+  g_clear_pointer (&priv->render_cache, cairo_surface_destroy);
+
+  /* Below a window, coordinates are relative to it */
+  gtk_widget_invalidate_child_render_caches (child,
+                                             _gtk_widget_get_has_window (child) ? NULL : region);
+}
+
+/* Child windows are exposed on their own, and what is drawn into them
+ * never shows up in a recording or an image of the widget. Every
+ * widget counts the ones registered by it and its descendants, so the
+ * caches can tell without walking the tree.
+ */
+static gboolean
+is_output_child_window (GdkWindow *window)
+{
+  return gdk_window_get_window_type (window) == GDK_WINDOW_CHILD &&
+         !gdk_window_is_input_only (window);
+}
+
+static void
+gtk_widget_add_output_windows (GtkWidget *widget,
+                               gint       n_windows)
+{
+  GtkWidget *w;
+
+  for (w = widget; w != NULL; w = w->priv->parent)
+    w->priv->n_output_windows += n_windows;
+}
+
+static void
+gtk_widget_clear_opacity_group (GtkWidget *widget);
+
 static inline void
 gtk_widget_queue_draw_child (GtkWidget *widget)
 {
@@ -4636,6 +4753,12 @@ gtk_widget_unparent (GtkWidget *widget)
    */
   priv->child_visible = TRUE;
 
+  gtk_widget_invalidate_parent_draw_index (widget);
+
+  /* Still realized if it is being reparented */
+  if (priv->n_output_windows > 0)
+    gtk_widget_add_output_windows (priv->parent, - (gint) priv->n_output_windows);
+
   old_parent = priv->parent;
   priv->parent = NULL;
 
@@ -4984,6 +5107,8 @@ gtk_widget_map (GtkWidget *widget)
 
       if (!_gtk_widget_get_has_window (widget))
         gdk_window_invalidate_rect (priv->window, &priv->clip, FALSE);
+      gtk_widget_invalidate_render_cache (widget);
+      gtk_widget_invalidate_parent_draw_index (widget);
 
       gtk_widget_pop_verify_invariants (widget);
     }
@@ -5012,6 +5137,9 @@ gtk_widget_unmap (GtkWidget *widget)
 
       if (!_gtk_widget_get_has_window (widget))
 	gdk_window_invalidate_rect (priv->window, &priv->clip, FALSE);
+      gtk_widget_invalidate_render_cache (widget);
+      gtk_widget_invalidate_parent_draw_index (widget);
+      gtk_widget_clear_opacity_group (widget);
       _gtk_tooltip_hide (widget);
 
       g_signal_emit (widget, widget_signals[UNMAP], 0);
@@ -5560,6 +5688,25 @@ gtk_widget_queue_draw_region (GtkWidget            *widget,
 
   g_return_if_fail (GTK_IS_WIDGET (widget));
 
+  gtk_widget_invalidate_render_cache (widget);
+
+  if (gtk_widget_render_cache_enabled ())
+    {
+      if (_gtk_widget_get_has_window (widget))
+        gtk_widget_invalidate_child_render_caches (widget, region);
+      else
+        {
+          cairo_region_t *window_region;
+
+          window_region = cairo_region_copy (region);
+          cairo_region_translate (window_region,
+                                  widget->priv->allocation.x,
+                                  widget->priv->allocation.y);
+          gtk_widget_invalidate_child_render_caches (widget, window_region);
+          cairo_region_destroy (window_region);
+        }
+    }
+
   if (!_gtk_widget_get_realized (widget))
     return;
 
@@ -5948,6 +6095,7 @@ gtk_widget_size_allocate_with_baseline (GtkWidget     *widget,
   gint natural_width, natural_height, dummy;
   gint min_width, min_height;
   gint old_baseline;
+  gint64 profiler_start;
 
   priv = widget->priv;
 
@@ -6100,10 +6248,12 @@ gtk_widget_size_allocate_with_baseline (GtkWidget     *widget,
     goto out;
 
   priv->allocated_baseline = baseline;
+  profiler_start = _gtk_profiler_begin ();
   if (g_signal_has_handler_pending (widget, widget_signals[SIZE_ALLOCATE], 0, FALSE))
     g_signal_emit (widget, widget_signals[SIZE_ALLOCATE], 0, &real_allocation);
   else
     GTK_WIDGET_GET_CLASS (widget)->size_allocate (widget, &real_allocation);
+  _gtk_profiler_end (widget, GTK_PROFILER_ALLOCATE, profiler_start);
 
   /* Size allocation is god... after consulting god, no further requests or allocations are needed */
 #ifdef G_ENABLE_DEBUG
@@ -6122,6 +6272,13 @@ gtk_widget_size_allocate_with_baseline (GtkWidget     *widget,
   position_changed |= (old_clip.x != priv->clip.x ||
                       old_clip.y != priv->clip.y);
 
+  if (alloc_needed || size_changed || position_changed || baseline_changed)
+    gtk_widget_invalidate_render_cache (widget);
+
+  /* Children may have been reordered */
+  if (alloc_needed && GTK_IS_CONTAINER (widget))
+    _gtk_container_invalidate_draw_index (GTK_CONTAINER (widget));
+
   if (_gtk_widget_get_mapped (widget) && priv->redraw_on_alloc)
     {
       if (!_gtk_widget_get_has_window (widget) && position_changed)
@@ -6938,6 +7095,316 @@ gtk_cairo_should_draw_window (cairo_t *cr,
   return event_window == window;
 }
 
+static void
+gtk_widget_emit_draw (GtkWidget *widget,
+                      cairo_t   *cr)
+{
+  gboolean result;
+
+  if (g_signal_has_handler_pending (widget, widget_signals[DRAW], 0, FALSE))
+    {
+      g_signal_emit (widget, widget_signals[DRAW],
+                     0, cr,
+                     &result);
+    }
+  else if (GTK_WIDGET_GET_CLASS (widget)->draw)
+    {
+      cairo_save (cr);
+      GTK_WIDGET_GET_CLASS (widget)->draw (widget, cr);
+      cairo_restore (cr);
+    }
+}
+
+static void
+gtk_widget_draw_cached (GtkWidget *widget,
+                        cairo_t   *cr)
+{
+  GtkWidgetPrivate *priv = widget->priv;
+  cairo_surface_t *surface;
+  cairo_rectangle_t extents;
+  double x_scale, y_scale;
+  cairo_t *record;
+
+  if (priv->render_cache)
+    {
+      _gtk_profiler_count_cache (GTK_PROFILER_CACHE_RENDER, TRUE);
+      surface = cairo_surface_reference (priv->render_cache);
+    }
+  else if (_gtk_widget_is_toplevel (widget) ||
+           _gtk_widget_has_output_windows (widget))
+    {
+      _gtk_profiler_count_cache (GTK_PROFILER_CACHE_RENDER, FALSE);
+      gtk_widget_emit_draw (widget, cr);
+      return;
+    }
+  else
+    {
+      _gtk_profiler_count_cache (GTK_PROFILER_CACHE_RENDER, FALSE);
+
+      /* So that things drawn at device resolution, like blurs, stay sharp.
+       * The extents of a recording surface are in device units.
+       */
+      cairo_surface_get_device_scale (cairo_get_target (cr), &x_scale, &y_scale);
+
+      extents.x = (priv->clip.x - priv->allocation.x) * x_scale;
+      extents.y = (priv->clip.y - priv->allocation.y) * y_scale;
+      extents.width = priv->clip.width * x_scale;
+      extents.height = priv->clip.height * y_scale;
+
+      surface = cairo_recording_surface_create (CAIRO_CONTENT_COLOR_ALPHA, &extents);
+      cairo_surface_set_device_scale (surface, x_scale, y_scale);
+
+      /* If the widget queues a draw while drawing, the recording
+       * is dropped again, but still used for this frame.
+       */
+      priv->render_cache = cairo_surface_reference (surface);
+
+      record = cairo_create (surface);
+      gtk_widget_emit_draw (widget, record);
+      cairo_destroy (record);
+    }
+
+  cairo_save (cr);
+  cairo_set_source_surface (cr, surface, 0, 0);
+  cairo_paint (cr);
+  cairo_restore (cr);
+
+  cairo_surface_destroy (surface);
+}
+
+static void
+gtk_widget_draw_contents (GtkWidget *widget,
+                          cairo_t   *cr)
+{
+  gint64 profiler_start;
+
+  profiler_start = _gtk_profiler_begin ();
+
+  if (gtk_widget_render_cache_enabled ())
+    gtk_widget_draw_cached (widget, cr);
+  else
+    gtk_widget_emit_draw (widget, cr);
+
+  _gtk_profiler_end (widget, GTK_PROFILER_DRAW, profiler_start);
+
+#ifdef G_ENABLE_DEBUG
+  if (GTK_DISPLAY_DEBUG_CHECK (gtk_widget_get_display (widget), BASELINES))
+    {
+      gint baseline = gtk_widget_get_allocated_baseline (widget);
+      gint width = gtk_widget_get_allocated_width (widget);
+
+      if (baseline != -1)
+        {
+          cairo_save (cr);
+          cairo_new_path (cr);
+          cairo_move_to (cr, 0, baseline+0.5);
+          cairo_line_to (cr, width, baseline+0.5);
+          cairo_set_line_width (cr, 1.0);
+          cairo_set_source_rgba (cr, 1.0, 0, 0, 0.25);
+          cairo_stroke (cr);
+          cairo_restore (cr);
+        }
+    }
+  if (GTK_DISPLAY_DEBUG_CHECK (gtk_widget_get_display (widget), RESIZE) &&
+      widget->priv->highlight_resize)
+    {
+      GtkAllocation alloc;
+      gtk_widget_get_allocation (widget, &alloc);
+
+      cairo_rectangle (cr, 0, 0, alloc.width, alloc.height);
+      cairo_set_source_rgba (cr, 1, 0, 0, 0.2);
+      cairo_fill (cr);
+
+      gtk_widget_queue_draw (widget);
+
+      widget->priv->highlight_resize = FALSE;
+
+    }
+#endif
+}
+
+/* Opacity groups
+ *
+ * A widget with an opacity below 1 is drawn into a group and painted
+ * with alpha. If GTK_RENDER_CACHE is set and the opacity of the widget
+ * is animating, instead of pushing a new cairo group every frame, we
+ * keep the widget drawn at full opacity in an image surface and only
+ * redraw it when its draw serial changes, so that fading a widget in or
+ * out is a single paint per frame. Once the opacity stayed the same for
+ * a while, the surface is dropped again from a timeout, or when the
+ * widget is unmapped or unrealized. Surfaces that are no longer needed
+ * go to a small pool, to be reused by the next widget of the same size.
+ */
+#define OPACITY_GROUP_POOL_SIZE 4
+#define OPACITY_GROUP_TIMEOUT (250 * G_TIME_SPAN_MILLISECOND)
+
+static GSList *opacity_group_pool = NULL;
+
+static cairo_surface_t *
+opacity_group_acquire (GdkWindow *window,
+                       int        width,
+                       int        height)
+{
+  cairo_surface_t *surface;
+  double x_scale, y_scale;
+  int scale;
+  GSList *l;
+
+  scale = gdk_window_get_scale_factor (window);
+
+  for (l = opacity_group_pool; l; l = l->next)
+    {
+      surface = l->data;
+      cairo_surface_get_device_scale (surface, &x_scale, &y_scale);
+      if (cairo_image_surface_get_width (surface) == width * scale &&
+          cairo_image_surface_get_height (surface) == height * scale &&
+          x_scale == scale)
+        {
+          opacity_group_pool = g_slist_delete_link (opacity_group_pool, l);
+          return surface;
+        }
+    }
+
+  return gdk_window_create_similar_image_surface (window,
+                                                  CAIRO_FORMAT_ARGB32,
+                                                  width * scale, height * scale,
+                                                  scale);
+}
+
+static void
+opacity_group_release (cairo_surface_t *surface)
+{
+  GSList *last;
+
+  opacity_group_pool = g_slist_prepend (opacity_group_pool, surface);
+
+  if (g_slist_length (opacity_group_pool) > OPACITY_GROUP_POOL_SIZE)
+    {
+      last = g_slist_last (opacity_group_pool);
+      cairo_surface_destroy (last->data);
+      opacity_group_pool = g_slist_delete_link (opacity_group_pool, last);
+    }
+}
+
+static void
+gtk_widget_clear_opacity_group (GtkWidget *widget)
+{
+  GtkWidgetPrivate *priv = widget->priv;
+
+  if (priv->opacity_group_timeout_id)
+    {
+      g_source_remove (priv->opacity_group_timeout_id);
+      priv->opacity_group_timeout_id = 0;
+    }
+
+  if (priv->opacity_group)
+    {
+      opacity_group_release (priv->opacity_group);
+      priv->opacity_group = NULL;
+    }
+}
+
+static gboolean
+opacity_group_timeout (gpointer data)
+{
+  GtkWidget *widget = data;
+  GtkWidgetPrivate *priv = widget->priv;
+
+  if (g_get_monotonic_time () - priv->opacity_change_time <= OPACITY_GROUP_TIMEOUT)
+    return G_SOURCE_CONTINUE;
+
+  priv->opacity_group_timeout_id = 0;
+  gtk_widget_clear_opacity_group (widget);
+
+  return G_SOURCE_REMOVE;
+}
+
+static gboolean
+gtk_widget_draw_opacity_group (GtkWidget *widget,
+                               cairo_t   *cr)
+{
+  GtkWidgetPrivate *priv = widget->priv;
+  cairo_surface_t *target;
+  cairo_matrix_t matrix;
+  double x_scale, y_scale;
+  int scale;
+  cairo_t *group_cr;
+
+  if (!gtk_widget_render_cache_enabled () ||
+      g_get_monotonic_time () - priv->opacity_change_time > OPACITY_GROUP_TIMEOUT ||
+      _gtk_widget_is_toplevel (widget) ||
+      _gtk_widget_has_output_windows (widget))
+    {
+      gtk_widget_clear_opacity_group (widget);
+      return FALSE;
+    }
+
+  /* Only reuse pixels when they end up on the same pixels again */
+  target = cairo_get_target (cr);
+  switch ((int) cairo_surface_get_type (target))
+    {
+    case CAIRO_SURFACE_TYPE_PDF:
+    case CAIRO_SURFACE_TYPE_PS:
+    case CAIRO_SURFACE_TYPE_SVG:
+      return FALSE;
+    default:
+      break;
+    }
+
+  scale = gdk_window_get_scale_factor (priv->window);
+  cairo_surface_get_device_scale (target, &x_scale, &y_scale);
+  cairo_get_matrix (cr, &matrix);
+  if (x_scale != scale || y_scale != scale ||
+      matrix.xx != 1.0 || matrix.yy != 1.0 ||
+      matrix.xy != 0.0 || matrix.yx != 0.0 ||
+      matrix.x0 != floor (matrix.x0) || matrix.y0 != floor (matrix.y0))
+    return FALSE;
+
+  if (priv->opacity_group &&
+      (cairo_image_surface_get_width (priv->opacity_group) != priv->clip.width * scale ||
+       cairo_image_surface_get_height (priv->opacity_group) != priv->clip.height * scale))
+    gtk_widget_clear_opacity_group (widget);
+
+  if (priv->opacity_group == NULL ||
+      priv->opacity_group_serial != priv->draw_serial)
+    {
+      if (priv->opacity_group == NULL)
+        {
+          priv->opacity_group = opacity_group_acquire (priv->window,
+                                                       priv->clip.width,
+                                                       priv->clip.height);
+          priv->opacity_group_timeout_id =
+            gdk_threads_add_timeout (OPACITY_GROUP_TIMEOUT / G_TIME_SPAN_MILLISECOND,
+                                     opacity_group_timeout, widget);
+          g_source_set_name_by_id (priv->opacity_group_timeout_id,
+                                   "[gtk+] opacity_group_timeout");
+        }
+
+      /* Taken first, so a draw queued while drawing is not lost */
+      priv->opacity_group_serial = priv->draw_serial;
+
+      group_cr = cairo_create (priv->opacity_group);
+      cairo_set_operator (group_cr, CAIRO_OPERATOR_CLEAR);
+      cairo_paint (group_cr);
+      cairo_set_operator (group_cr, CAIRO_OPERATOR_OVER);
+      cairo_translate (group_cr,
+                       priv->allocation.x - priv->clip.x,
+                       priv->allocation.y - priv->clip.y);
+      gtk_widget_draw_contents (widget, group_cr);
+      cairo_destroy (group_cr);
+    }
+
+  cairo_save (cr);
+  cairo_set_source_surface (cr, priv->opacity_group,
+                            priv->clip.x - priv->allocation.x,
+                            priv->clip.y - priv->allocation.y);
+  cairo_set_operator (cr, CAIRO_OPERATOR_OVER);
+  cairo_paint_with_alpha (cr, priv->alpha / 255.0);
+  cairo_restore (cr);
+
+  return TRUE;
+}
+
 void
 gtk_widget_draw_internal (GtkWidget *widget,
                           cairo_t   *cr,
@@ -6959,7 +7426,6 @@ gtk_widget_draw_internal (GtkWidget *widget,
   if (gdk_cairo_get_clip_rectangle (cr, NULL))
     {
       GdkWindow *event_window;
-      gboolean result;
       gboolean push_group;
 
       event_window = gtk_cairo_get_event_window (cr);
@@ -6971,59 +7437,15 @@ gtk_widget_draw_internal (GtkWidget *widget,
         (!_gtk_widget_is_toplevel (widget) ||
          gtk_widget_get_visual (widget) == gdk_screen_get_rgba_visual (gtk_widget_get_screen (widget)));
 
-      if (push_group)
-        cairo_push_group (cr);
-
-      if (g_signal_has_handler_pending (widget, widget_signals[DRAW], 0, FALSE))
+      if (!push_group)
         {
-          g_signal_emit (widget, widget_signals[DRAW],
-                         0, cr,
-                         &result);
+          gtk_widget_clear_opacity_group (widget);
+          gtk_widget_draw_contents (widget, cr);
         }
-      else if (GTK_WIDGET_GET_CLASS (widget)->draw)
-        {
-          cairo_save (cr);
-          GTK_WIDGET_GET_CLASS (widget)->draw (widget, cr);
-          cairo_restore (cr);
-        }
-
-#ifdef G_ENABLE_DEBUG
-      if (GTK_DISPLAY_DEBUG_CHECK (gtk_widget_get_display (widget), BASELINES))
-	{
-	  gint baseline = gtk_widget_get_allocated_baseline (widget);
-	  gint width = gtk_widget_get_allocated_width (widget);
-
-	  if (baseline != -1)
-	    {
-	      cairo_save (cr);
-	      cairo_new_path (cr);
-	      cairo_move_to (cr, 0, baseline+0.5);
-	      cairo_line_to (cr, width, baseline+0.5);
-	      cairo_set_line_width (cr, 1.0);
-	      cairo_set_source_rgba (cr, 1.0, 0, 0, 0.25);
-	      cairo_stroke (cr);
-	      cairo_restore (cr);
-	    }
-	}
-      if (GTK_DISPLAY_DEBUG_CHECK (gtk_widget_get_display (widget), RESIZE) &&
-          widget->priv->highlight_resize)
-        {
-          GtkAllocation alloc;
-          gtk_widget_get_allocation (widget, &alloc);
-
-          cairo_rectangle (cr, 0, 0, alloc.width, alloc.height);
-          cairo_set_source_rgba (cr, 1, 0, 0, 0.2);
-          cairo_fill (cr);
-
-          gtk_widget_queue_draw (widget);
-
-          widget->priv->highlight_resize = FALSE;
-
-        }
-#endif
-
-      if (push_group)
+      else if (!gtk_widget_draw_opacity_group (widget, cr))
         {
+          cairo_push_group (cr);
+          gtk_widget_draw_contents (widget, cr);
           cairo_pop_group_to_source (cr);
           cairo_set_operator (cr, CAIRO_OPERATOR_OVER);
           cairo_paint_with_alpha (cr, widget->priv->alpha / 255.0);
@@ -9500,6 +9922,10 @@ gtk_widget_set_parent (GtkWidget *widget,
   gtk_widget_push_verify_invariants (widget);
 
   priv->parent = parent;
+  gtk_widget_invalidate_parent_draw_index (widget);
+
+  if (priv->n_output_windows > 0)
+    gtk_widget_add_output_windows (parent, priv->n_output_windows);
 
   parent_flags = _gtk_widget_get_state_flags (parent);
 
@@ -12253,6 +12679,8 @@ gtk_widget_finalize (GObject *object)
     g_object_unref (priv->context);
 
   _gtk_size_request_cache_free (&priv->requests);
+  g_clear_pointer (&priv->render_cache, cairo_surface_destroy);
+  gtk_widget_clear_opacity_group (widget);
 
   for (l = priv->event_controllers; l; l = l->next)
     {
@@ -12382,6 +12810,7 @@ gtk_widget_real_unrealize (GtkWidget *widget)
       priv->window = NULL;
     }
 
+  gtk_widget_clear_opacity_group (widget);
   gtk_selection_remove_all (widget);
 
   gtk_widget_set_realized (widget, FALSE);
@@ -15525,6 +15954,9 @@ gtk_widget_set_clip (GtkWidget           *widget,
     }
 #endif /* G_ENABLE_DEBUG */
 
+  if (!gdk_rectangle_equal (&priv->clip, clip))
+    gtk_widget_invalidate_parent_draw_index (widget);
+
   priv->clip = *clip;
 
   while (priv->parent &&
@@ -15541,6 +15973,7 @@ gtk_widget_set_clip (GtkWidget           *widget,
         break;
 
       parent_priv->clip = union_rect;
+      gtk_widget_invalidate_parent_draw_index (priv->parent);
       priv = parent_priv;
     }
 }
@@ -15710,6 +16143,9 @@ gtk_widget_set_allocation (GtkWidget           *widget,
 
   priv = widget->priv;
 
+  if (!gdk_rectangle_equal (&priv->clip, allocation))
+    gtk_widget_invalidate_parent_draw_index (widget);
+
   priv->allocation = *allocation;
   priv->clip = *allocation;
 }
@@ -15872,6 +16308,9 @@ gtk_widget_register_window (GtkWidget    *widget,
 
   gdk_window_set_user_data (window, widget);
   priv->registered_windows = g_list_prepend (priv->registered_windows, window);
+
+  if (is_output_child_window (window))
+    gtk_widget_add_output_windows (widget, 1);
 }
 
 /**
@@ -15900,6 +16339,11 @@ gtk_widget_unregister_window (GtkWidget    *widget,
   gdk_window_get_user_data (window, &user_data);
   g_assert (user_data == widget);
   gdk_window_set_user_data (window, NULL);
+
+  if (g_list_find (priv->registered_windows, window) &&
+      is_output_child_window (window))
+    gtk_widget_add_output_windows (widget, -1);
+
   priv->registered_windows = g_list_remove (priv->registered_windows, window);
 }
 
@@ -15996,13 +16440,21 @@ gtk_widget_update_alpha (GtkWidget *widget)
 
   priv->alpha = alpha;
 
+  /* For opacity groups, which are only kept while fading */
+  if (_gtk_widget_get_mapped (widget))
+    priv->opacity_change_time = g_get_monotonic_time ();
+
   if (_gtk_widget_get_realized (widget))
     {
       if (_gtk_widget_is_toplevel (widget) &&
           gtk_widget_get_visual (widget) != gdk_screen_get_rgba_visual (gtk_widget_get_screen (widget)))
 	gdk_window_set_opacity (priv->window, priv->alpha / 255.0);
 
-      gtk_widget_queue_draw (widget);
+      /* Only how we are composited changed, not what we draw */
+      if (!_gtk_widget_get_has_window (widget) && priv->parent)
+        gtk_widget_queue_draw_child (widget);
+      else
+        gtk_widget_queue_draw (widget);
     }
 }
 
@@ -16515,9 +16967,54 @@ gtk_widget_class_get_css_name (GtkWidgetClass *widget_class)
   return widget_class->priv->css_name;
 }
 
+/* Whether @change may change what the widget draws, as opposed to only
+ * how it is composited. Properties that affect nothing, like engine,
+ * still count, since widgets may draw based on them.
+ */
+static gboolean
+style_change_affects_contents (GtkCssStyleChange *change)
+{
+  guint i;
+
+  for (i = 0; i < GTK_CSS_PROPERTY_N_PROPERTIES; i++)
+    {
+      switch (i)
+        {
+        case GTK_CSS_PROPERTY_OPACITY:
+        case GTK_CSS_PROPERTY_TRANSITION_PROPERTY:
+        case GTK_CSS_PROPERTY_TRANSITION_DURATION:
+        case GTK_CSS_PROPERTY_TRANSITION_TIMING_FUNCTION:
+        case GTK_CSS_PROPERTY_TRANSITION_DELAY:
+        case GTK_CSS_PROPERTY_ANIMATION_NAME:
+        case GTK_CSS_PROPERTY_ANIMATION_DURATION:
+        case GTK_CSS_PROPERTY_ANIMATION_TIMING_FUNCTION:
+        case GTK_CSS_PROPERTY_ANIMATION_ITERATION_COUNT:
+        case GTK_CSS_PROPERTY_ANIMATION_DIRECTION:
+        case GTK_CSS_PROPERTY_ANIMATION_PLAY_STATE:
+        case GTK_CSS_PROPERTY_ANIMATION_DELAY:
+        case GTK_CSS_PROPERTY_ANIMATION_FILL_MODE:
+          break;
+
+        default:
+          if (gtk_css_style_change_changes_property (change, i))
+            return TRUE;
+          break;
+        }
+    }
+
+  return FALSE;
+}
+
 void
 _gtk_widget_style_context_invalidated (GtkWidget *widget)
 {
+  GtkCssStyleChange *change = NULL;
+
+  if (widget->priv->context)
+    change = gtk_style_context_get_change (widget->priv->context);
+  if (change == NULL || style_change_affects_contents (change))
+    gtk_widget_invalidate_render_cache (widget);
+
   if (_gtk_widget_get_realized (widget))
     g_signal_emit (widget, widget_signals[STYLE_UPDATED], 0);
   else
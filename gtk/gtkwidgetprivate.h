@@ -143,6 +143,20 @@ struct _GtkWidgetPrivate
   GtkAllocation clip;
   gint allocated_baseline;
 
+  /* What the widget drew last time, if GTK_RENDER_CACHE is set */
+  cairo_surface_t *render_cache;
+  /* Bumped whenever the widget or a descendant needs redrawing */
+  guint draw_serial;
+  /* The widget drawn at full opacity, while its opacity is animating */
+  cairo_surface_t *opacity_group;
+  guint opacity_group_serial;
+  guint opacity_group_timeout_id;
+  gint64 opacity_change_time;
+  /* Registered child windows that show output, of the widget and
+   * all its descendants
+   */
+  guint n_output_windows;
+
   /* The widget's requested sizes */
   SizeRequestCache requests;
 
@@ -397,6 +411,18 @@ _gtk_widget_get_window (GtkWidget *widget)
   return widget->priv->window;
 }
 
+static inline guint
+_gtk_widget_get_draw_serial (GtkWidget *widget)
+{
+  return widget->priv->draw_serial;
+}
+
+static inline gboolean
+_gtk_widget_has_output_windows (GtkWidget *widget)
+{
+  return _gtk_widget_get_has_window (widget) || widget->priv->n_output_windows > 0;
+}
+
 static inline void
 _gtk_widget_get_allocation (GtkWidget     *widget,
                             GtkAllocation *allocation)
@@ -11772,21 +11772,35 @@ gtk_window_activate_key (GtkWindow   *window,
 
   if (key_hash)
     {
-      GSList *tmp_list;
-      GSList *entries = _gtk_key_hash_lookup (key_hash,
-					      event->hardware_keycode,
-					      event->state,
-					      gtk_accelerator_get_default_mod_mask (),
-					      event->group);
+      gpointer stack_entries[16];
+      gpointer *entries = stack_entries;
+      guint n_entries, i;
+
+      n_entries = _gtk_key_hash_lookup (key_hash,
+                                        event->hardware_keycode,
+                                        event->state,
+                                        gtk_accelerator_get_default_mod_mask (),
+                                        event->group,
+                                        entries, G_N_ELEMENTS (stack_entries));
+      if (n_entries > G_N_ELEMENTS (stack_entries))
+        {
+          entries = g_new (gpointer, n_entries);
+          _gtk_key_hash_lookup (key_hash,
+                                event->hardware_keycode,
+                                event->state,
+                                gtk_accelerator_get_default_mod_mask (),
+                                event->group,
+                                entries, n_entries);
+        }
 
       g_object_get (gtk_widget_get_settings (GTK_WIDGET (window)),
                     "gtk-enable-mnemonics", &enable_mnemonics,
                     "gtk-enable-accels", &enable_accels,
                     NULL);
 
-      for (tmp_list = entries; tmp_list; tmp_list = tmp_list->next)
+      for (i = 0; i < n_entries; i++)
 	{
-	  GtkWindowKeyEntry *entry = tmp_list->data;
+	  GtkWindowKeyEntry *entry = entries[i];
 	  if (entry->is_mnemonic)
             {
               if( enable_mnemonics)
@@ -11804,7 +11818,8 @@ gtk_window_activate_key (GtkWindow   *window,
             }
 	}
 
-      g_slist_free (entries);
+      if (entries != stack_entries)
+        g_free (entries);
     }
 
   if (found_entry)
@@ -37,6 +37,7 @@
 #include "misc-info.h"
 #include "object-hierarchy.h"
 #include "object-tree.h"
+#include "performance.h"
 #include "prop-list.h"
 #include "resource-list.h"
 #include "selector.h"
@@ -70,6 +71,7 @@ gtk_inspector_init (void)
   g_type_ensure (GTK_TYPE_INSPECTOR_MISC_INFO);
   g_type_ensure (GTK_TYPE_INSPECTOR_OBJECT_HIERARCHY);
   g_type_ensure (GTK_TYPE_INSPECTOR_OBJECT_TREE);
+  g_type_ensure (GTK_TYPE_INSPECTOR_PERFORMANCE);
   g_type_ensure (GTK_TYPE_INSPECTOR_PROP_LIST);
   g_type_ensure (GTK_TYPE_INSPECTOR_RESOURCE_LIST);
   g_type_ensure (GTK_TYPE_INSPECTOR_SELECTOR);
@@ -0,0 +1,683 @@
+/*
+ * Copyright (c) 2016 Red Hat, Inc.
+ *
+ * This library is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public
+ * License as published by the Free Software Foundation; either
+ * version 2 of the License, or (at your option) any later version.
+ *
+ * This library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with this library. If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include "config.h"
+#include <glib/gi18n-lib.h>
+
+#include "performance.h"
+#include "window.h"
+
+#include "gtkcelllayout.h"
+#include "gtkdrawingarea.h"
+#include "gtkfilechooserdialog.h"
+#include "gtklabel.h"
+#include "gtkliststore.h"
+#include "gtkmessagedialog.h"
+#include "gtktogglebutton.h"
+#include "gtkprofilerprivate.h"
+
+/* The timeline shows one row per nesting level: frames, their
+ * phases, and then the widget operations that ran in them.
+ */
+#define ROW_HEIGHT 16
+#define USEC_PER_PIXEL 20
+#define MAX_TIMELINE_WIDTH 30000
+
+enum
+{
+  PROP_0,
+  PROP_BUTTON,
+  PROP_SAVE_BUTTON
+};
+
+enum
+{
+  COLUMN_WIDGET_NAME,
+  COLUMN_MEASURE,
+  COLUMN_ALLOCATE,
+  COLUMN_DRAW_SELF,
+  COLUMN_DRAW_TOTAL,
+  COLUMN_DRAWS
+};
+
+enum
+{
+  COLUMN_NODE_NAME,
+  COLUMN_NODE_UPDATES,
+  COLUMN_NODE_CACHE_HITS
+};
+
+struct _GtkInspectorPerformancePrivate
+{
+  GtkWidget *button;
+  GtkWidget *save_button;
+  GtkWidget *frames_label;
+  GtkWidget *update_label;
+  GtkWidget *layout_label;
+  GtkWidget *paint_label;
+  GtkWidget *pixel_cache_label;
+  GtkWidget *style_cache_label;
+  GtkWidget *render_cache_label;
+  GtkWidget *timeline;
+  GtkListStore *widget_model;
+  GtkListStore *node_model;
+  GtkTreeViewColumn *measure_column;
+  GtkCellRenderer *measure_renderer;
+  GtkTreeViewColumn *allocate_column;
+  GtkCellRenderer *allocate_renderer;
+  GtkTreeViewColumn *draw_self_column;
+  GtkCellRenderer *draw_self_renderer;
+  GtkTreeViewColumn *draw_total_column;
+  GtkCellRenderer *draw_total_renderer;
+  guint update_source_id;
+  gint64 timeline_start;
+  gint64 usec_per_pixel;
+};
+
+G_DEFINE_TYPE_WITH_PRIVATE (GtkInspectorPerformance, gtk_inspector_performance, GTK_TYPE_BOX)
+
+static const GdkRGBA operation_colors[GTK_PROFILER_N_OPERATIONS] = {
+  { 0.53, 0.53, 0.53, 1 }, /* frame */
+  { 0.45, 0.62, 0.81, 1 }, /* update */
+  { 0.68, 0.50, 0.66, 1 }, /* layout */
+  { 0.54, 0.89, 0.20, 1 }, /* paint */
+  { 0.99, 0.69, 0.24, 1 }, /* measure */
+  { 0.94, 0.16, 0.16, 1 }, /* allocate */
+  { 0.20, 0.64, 0.64, 1 }  /* draw */
+};
+
+static void
+watch_toplevels (void)
+{
+  GList *toplevels, *l;
+  GdkFrameClock *clock;
+
+  toplevels = gtk_window_list_toplevels ();
+  for (l = toplevels; l; l = l->next)
+    {
+      if (GTK_INSPECTOR_IS_WINDOW (l->data))
+        continue;
+
+      clock = gtk_widget_get_frame_clock (l->data);
+      if (clock)
+        _gtk_profiler_watch_frame_clock (clock);
+    }
+  g_list_free (toplevels);
+}
+
+static void
+set_cache_label (GtkWidget        *label,
+                 GtkProfilerCache  cache)
+{
+  guint hits, misses;
+  gchar *text;
+
+  _gtk_profiler_get_cache_statistics (cache, &hits, &misses);
+
+  if (hits + misses == 0)
+    text = g_strdup ("—");
+  else
+    text = g_strdup_printf (_("%.1f%% (%u of %u)"),
+                            100.0 * hits / (hits + misses), hits, hits + misses);
+
+  gtk_label_set_text (GTK_LABEL (label), text);
+  g_free (text);
+}
+
+static void
+set_phase_label (GtkWidget *label,
+                 gint64     total,
+                 guint      n_frames)
+{
+  gchar *text;
+
+  if (n_frames == 0)
+    text = g_strdup ("—");
+  else
+    text = g_strdup_printf (_("%.2f ms per frame"), total / 1000.0 / n_frames);
+
+  gtk_label_set_text (GTK_LABEL (label), text);
+  g_free (text);
+}
+
+static void
+update_summary (GtkInspectorPerformance *pl)
+{
+  const GtkProfilerEvent *events;
+  gint64 totals[GTK_PROFILER_N_OPERATIONS] = { 0, };
+  gint64 start, end;
+  guint n_events, n_frames, max_depth;
+  guint i;
+  gchar *text;
+
+  events = _gtk_profiler_get_events (&n_events);
+
+  n_frames = 0;
+  max_depth = 0;
+  start = G_MAXINT64;
+  end = 0;
+
+  for (i = 0; i < n_events; i++)
+    {
+      if (events[i].operation == GTK_PROFILER_FRAME)
+        n_frames++;
+      if (events[i].depth <= 1)
+        totals[events[i].operation] += events[i].end - events[i].start;
+
+      start = MIN (start, events[i].start);
+      end = MAX (end, events[i].end);
+      max_depth = MAX (max_depth, events[i].depth);
+    }
+
+  if (n_frames > 0)
+    text = g_strdup_printf (_("%u, %.2f ms on average"),
+                            n_frames, totals[GTK_PROFILER_FRAME] / 1000.0 / n_frames);
+  else
+    text = g_strdup ("0");
+  gtk_label_set_text (GTK_LABEL (pl->priv->frames_label), text);
+  g_free (text);
+
+  set_phase_label (pl->priv->update_label, totals[GTK_PROFILER_UPDATE], n_frames);
+  set_phase_label (pl->priv->layout_label, totals[GTK_PROFILER_LAYOUT], n_frames);
+  set_phase_label (pl->priv->paint_label, totals[GTK_PROFILER_PAINT], n_frames);
+
+  set_cache_label (pl->priv->pixel_cache_label, GTK_PROFILER_CACHE_PIXEL);
+  set_cache_label (pl->priv->style_cache_label, GTK_PROFILER_CACHE_STYLE);
+  set_cache_label (pl->priv->render_cache_label, GTK_PROFILER_CACHE_RENDER);
+
+  if (n_events == 0)
+    {
+      pl->priv->timeline_start = 0;
+      gtk_widget_set_size_request (pl->priv->timeline, -1, -1);
+    }
+  else
+    {
+      pl->priv->timeline_start = start;
+      pl->priv->usec_per_pixel = MAX (USEC_PER_PIXEL, (end - start) / MAX_TIMELINE_WIDTH + 1);
+      gtk_widget_set_size_request (pl->priv->timeline,
+                                   (end - start) / pl->priv->usec_per_pixel + 1,
+                                   (max_depth + 1) * ROW_HEIGHT);
+    }
+
+  gtk_widget_queue_draw (pl->priv->timeline);
+  gtk_widget_set_sensitive (pl->priv->save_button,
+                            n_events > 0 && !_gtk_profiler_get_recording ());
+}
+
+static void
+update_lists (GtkInspectorPerformance *pl)
+{
+  GPtrArray *stats;
+  guint i;
+
+  gtk_list_store_clear (pl->priv->widget_model);
+
+  stats = _gtk_profiler_get_widget_stats ();
+  for (i = 0; i < stats->len; i++)
+    {
+      GtkProfilerWidgetStats *ws = g_ptr_array_index (stats, i);
+
+      gtk_list_store_insert_with_values (pl->priv->widget_model, NULL, -1,
+                                         COLUMN_WIDGET_NAME, ws->name,
+                                         COLUMN_MEASURE, ws->self_time[GTK_PROFILER_MEASURE] / 1000.0,
+                                         COLUMN_ALLOCATE, ws->self_time[GTK_PROFILER_ALLOCATE] / 1000.0,
+                                         COLUMN_DRAW_SELF, ws->self_time[GTK_PROFILER_DRAW] / 1000.0,
+                                         COLUMN_DRAW_TOTAL, ws->total_time[GTK_PROFILER_DRAW] / 1000.0,
+                                         COLUMN_DRAWS, ws->count[GTK_PROFILER_DRAW],
+                                         -1);
+    }
+  g_ptr_array_unref (stats);
+
+  gtk_list_store_clear (pl->priv->node_model);
+
+  stats = _gtk_profiler_get_node_stats ();
+  for (i = 0; i < stats->len; i++)
+    {
+      GtkProfilerNodeStats *ns = g_ptr_array_index (stats, i);
+
+      gtk_list_store_insert_with_values (pl->priv->node_model, NULL, -1,
+                                         COLUMN_NODE_NAME, ns->name,
+                                         COLUMN_NODE_UPDATES, ns->recomputed,
+                                         COLUMN_NODE_CACHE_HITS, ns->cache_hits,
+                                         -1);
+    }
+  g_ptr_array_unref (stats);
+}
+
+static gboolean
+update_data (gpointer data)
+{
+  GtkInspectorPerformance *pl = data;
+
+  /* Pick up windows that were mapped since the last update */
+  watch_toplevels ();
+
+  update_summary (pl);
+  update_lists (pl);
+
+  return TRUE;
+}
+
+static void
+toggle_record (GtkToggleButton         *button,
+               GtkInspectorPerformance *pl)
+{
+  if (gtk_toggle_button_get_active (button) == (pl->priv->update_source_id != 0))
+    return;
+
+  _gtk_profiler_set_recording (gtk_toggle_button_get_active (button));
+
+  if (gtk_toggle_button_get_active (button))
+    {
+      pl->priv->update_source_id = gdk_threads_add_timeout_seconds (1,
+                                                                    update_data,
+                                                                    pl);
+      update_data (pl);
+    }
+  else
+    {
+      g_source_remove (pl->priv->update_source_id);
+      pl->priv->update_source_id = 0;
+      update_summary (pl);
+      update_lists (pl);
+    }
+}
+
+static gboolean
+draw_timeline (GtkWidget               *widget,
+               cairo_t                 *cr,
+               GtkInspectorPerformance *pl)
+{
+  const GtkProfilerEvent *events;
+  PangoLayout *layout;
+  GdkRectangle clip;
+  gint64 clip_start, clip_end;
+  guint n_events, i;
+
+  events = _gtk_profiler_get_events (&n_events);
+  if (n_events == 0 || !gdk_cairo_get_clip_rectangle (cr, &clip))
+    return FALSE;
+
+  clip_start = pl->priv->timeline_start + (gint64) clip.x * pl->priv->usec_per_pixel;
+  clip_end = pl->priv->timeline_start + (gint64) (clip.x + clip.width) * pl->priv->usec_per_pixel;
+
+  layout = gtk_widget_create_pango_layout (widget, NULL);
+
+  for (i = 0; i < n_events; i++)
+    {
+      const GtkProfilerEvent *event = &events[i];
+      double x, y, width;
+
+      if (event->end < clip_start || event->start > clip_end)
+        continue;
+
+      x = (double) (event->start - pl->priv->timeline_start) / pl->priv->usec_per_pixel;
+      width = MAX (1.0, (double) (event->end - event->start) / pl->priv->usec_per_pixel);
+      y = event->depth * ROW_HEIGHT;
+
+      gdk_cairo_set_source_rgba (cr, &operation_colors[event->operation]);
+      cairo_rectangle (cr, x, y, width, ROW_HEIGHT - 1);
+      cairo_fill (cr);
+
+      if (width > 40)
+        {
+          pango_layout_set_text (layout, event->name, -1);
+          cairo_save (cr);
+          cairo_rectangle (cr, x, y, width, ROW_HEIGHT - 1);
+          cairo_clip (cr);
+          cairo_move_to (cr, x + 2, y);
+          cairo_set_source_rgb (cr, 0, 0, 0);
+          pango_cairo_show_layout (cr, layout);
+          cairo_restore (cr);
+        }
+    }
+
+  g_object_unref (layout);
+
+  return FALSE;
+}
+
+static gboolean
+query_timeline_tooltip (GtkWidget               *widget,
+                        gint                     x,
+                        gint                     y,
+                        gboolean                 keyboard_mode,
+                        GtkTooltip              *tooltip,
+                        GtkInspectorPerformance *pl)
+{
+  const GtkProfilerEvent *events;
+  guint n_events, depth, i;
+  gint64 time;
+  gchar *text;
+
+  events = _gtk_profiler_get_events (&n_events);
+  depth = y / ROW_HEIGHT;
+  time = pl->priv->timeline_start + (gint64) x * pl->priv->usec_per_pixel;
+
+  for (i = 0; i < n_events; i++)
+    {
+      if (events[i].depth == depth &&
+          events[i].start <= time &&
+          events[i].end >= time)
+        {
+          if (events[i].depth < 2)
+            text = g_strdup_printf ("%s: %.3f ms",
+                                    events[i].name,
+                                    (events[i].end - events[i].start) / 1000.0);
+          else
+            text = g_strdup_printf ("%s %s: %.3f ms",
+                                    events[i].name,
+                                    _gtk_profiler_operation_get_name (events[i].operation),
+                                    (events[i].end - events[i].start) / 1000.0);
+          gtk_tooltip_set_text (tooltip, text);
+          g_free (text);
+
+          return TRUE;
+        }
+    }
+
+  return FALSE;
+}
+
+static void
+append_json_string (GString     *s,
+                    const gchar *str)
+{
+  const gchar *p;
+
+  g_string_append_c (s, '"');
+  for (p = str; *p; p++)
+    {
+      switch (*p)
+        {
+        case '"':
+          g_string_append (s, "\\\"");
+          break;
+        case '\\':
+          g_string_append (s, "\\\\");
+          break;
+        case '\n':
+          g_string_append (s, "\\n");
+          break;
+        case '\t':
+          g_string_append (s, "\\t");
+          break;
+        default:
+          /* UTF-8 passes through, other control characters
+           * need the \u form
+           */
+          if ((guchar) *p < 0x20)
+            g_string_append_printf (s, "\\u%04x", (guchar) *p);
+          else
+            g_string_append_c (s, *p);
+          break;
+        }
+    }
+  g_string_append_c (s, '"');
+}
+
+/* Captures are saved in the trace event format, which can be
+ * loaded into the Chromium trace viewer and similar tools.
+ */
+static gboolean
+save_capture (const gchar  *filename,
+              GError      **error)
+{
+  const GtkProfilerEvent *events;
+  GString *s;
+  guint n_events, i;
+  gboolean result;
+
+  events = _gtk_profiler_get_events (&n_events);
+
+  s = g_string_new ("{\"traceEvents\":[\n");
+  for (i = 0; i < n_events; i++)
+    {
+      g_string_append (s, i > 0 ? ",{\"name\":" : "{\"name\":");
+      append_json_string (s, events[i].name);
+      g_string_append (s, ",\"cat\":");
+      append_json_string (s, _gtk_profiler_operation_get_name (events[i].operation));
+      g_string_append_printf (s,
+                              ",\"ph\":\"X\","
+                              "\"ts\":%" G_GINT64_FORMAT ",\"dur\":%" G_GINT64_FORMAT ","
+                              "\"pid\":1,\"tid\":1}\n",
+                              events[i].start,
+                              events[i].end - events[i].start);
+    }
+  g_string_append (s, "]}\n");
+
+  result = g_file_set_contents (filename, s->str, s->len, error);
+  g_string_free (s, TRUE);
+
+  return result;
+}
+
+static void
+save_response (GtkWidget               *dialog,
+               gint                     response,
+               GtkInspectorPerformance *pl)
+{
+  gtk_widget_hide (dialog);
+
+  if (response == GTK_RESPONSE_ACCEPT)
+    {
+      gchar *filename;
+      GError *error = NULL;
+
+      filename = gtk_file_chooser_get_filename (GTK_FILE_CHOOSER (dialog));
+      if (!save_capture (filename, &error))
+        {
+          GtkWidget *message_dialog;
+
+          message_dialog = gtk_message_dialog_new (GTK_WINDOW (gtk_widget_get_toplevel (GTK_WIDGET (pl))),
+                                                   GTK_DIALOG_MODAL|GTK_DIALOG_DESTROY_WITH_PARENT,
+                                                   GTK_MESSAGE_INFO,
+                                                   GTK_BUTTONS_OK,
+                                                   _("Saving the capture failed"));
+          gtk_message_dialog_format_secondary_text (GTK_MESSAGE_DIALOG (message_dialog),
+                                                    "%s", error->message);
+          g_signal_connect (message_dialog, "response", G_CALLBACK (gtk_widget_destroy), NULL);
+          gtk_widget_show (message_dialog);
+          g_error_free (error);
+        }
+      g_free (filename);
+    }
+
+  gtk_widget_destroy (dialog);
+}
+
+static void
+save_clicked (GtkButton               *button,
+              GtkInspectorPerformance *pl)
+{
+  GtkWidget *dialog;
+
+  dialog = gtk_file_chooser_dialog_new ("",
+                                        GTK_WINDOW (gtk_widget_get_toplevel (GTK_WIDGET (pl))),
+                                        GTK_FILE_CHOOSER_ACTION_SAVE,
+                                        _("_Cancel"), GTK_RESPONSE_CANCEL,
+                                        _("_Save"), GTK_RESPONSE_ACCEPT,
+                                        NULL);
+  gtk_file_chooser_set_current_name (GTK_FILE_CHOOSER (dialog), "gtk-capture.json");
+  gtk_file_chooser_set_do_overwrite_confirmation (GTK_FILE_CHOOSER (dialog), TRUE);
+  gtk_window_set_modal (GTK_WINDOW (dialog), TRUE);
+  gtk_dialog_set_default_response (GTK_DIALOG (dialog), GTK_RESPONSE_ACCEPT);
+  g_signal_connect (dialog, "response", G_CALLBACK (save_response), pl);
+  gtk_widget_show (dialog);
+}
+
+static void
+cell_data_msec (GtkCellLayout   *layout,
+                GtkCellRenderer *cell,
+                GtkTreeModel    *model,
+                GtkTreeIter     *iter,
+                gpointer         data)
+{
+  gint column;
+  gdouble msec;
+  gchar *text;
+
+  column = GPOINTER_TO_INT (data);
+
+  gtk_tree_model_get (model, iter, column, &msec, -1);
+
+  text = g_strdup_printf ("%.2f", msec);
+  g_object_set (cell, "text", text, NULL);
+  g_free (text);
+}
+
+static void
+gtk_inspector_performance_init (GtkInspectorPerformance *pl)
+{
+  pl->priv = gtk_inspector_performance_get_instance_private (pl);
+  pl->priv->usec_per_pixel = USEC_PER_PIXEL;
+  gtk_widget_init_template (GTK_WIDGET (pl));
+  gtk_cell_layout_set_cell_data_func (GTK_CELL_LAYOUT (pl->priv->measure_column),
+                                      pl->priv->measure_renderer,
+                                      cell_data_msec,
+                                      GINT_TO_POINTER (COLUMN_MEASURE), NULL);
+  gtk_cell_layout_set_cell_data_func (GTK_CELL_LAYOUT (pl->priv->allocate_column),
+                                      pl->priv->allocate_renderer,
+                                      cell_data_msec,
+                                      GINT_TO_POINTER (COLUMN_ALLOCATE), NULL);
+  gtk_cell_layout_set_cell_data_func (GTK_CELL_LAYOUT (pl->priv->draw_self_column),
+                                      pl->priv->draw_self_renderer,
+                                      cell_data_msec,
+                                      GINT_TO_POINTER (COLUMN_DRAW_SELF), NULL);
+  gtk_cell_layout_set_cell_data_func (GTK_CELL_LAYOUT (pl->priv->draw_total_column),
+                                      pl->priv->draw_total_renderer,
+                                      cell_data_msec,
+                                      GINT_TO_POINTER (COLUMN_DRAW_TOTAL), NULL);
+}
+
+static void
+constructed (GObject *object)
+{
+  GtkInspectorPerformance *pl = GTK_INSPECTOR_PERFORMANCE (object);
+
+  g_signal_connect (pl->priv->button, "toggled",
+                    G_CALLBACK (toggle_record), pl);
+  g_signal_connect (pl->priv->save_button, "clicked",
+                    G_CALLBACK (save_clicked), pl);
+
+  update_summary (pl);
+}
+
+static void
+finalize (GObject *object)
+{
+  GtkInspectorPerformance *pl = GTK_INSPECTOR_PERFORMANCE (object);
+
+  if (pl->priv->update_source_id)
+    {
+      g_source_remove (pl->priv->update_source_id);
+      _gtk_profiler_set_recording (FALSE);
+    }
+
+  G_OBJECT_CLASS (gtk_inspector_performance_parent_class)->finalize (object);
+}
+
+static void
+get_property (GObject    *object,
+              guint       param_id,
+              GValue     *value,
+              GParamSpec *pspec)
+{
+  GtkInspectorPerformance *pl = GTK_INSPECTOR_PERFORMANCE (object);
+
+  switch (param_id)
+    {
+    case PROP_BUTTON:
+      g_value_set_object (value, pl->priv->button);
+      break;
+
+    case PROP_SAVE_BUTTON:
+      g_value_set_object (value, pl->priv->save_button);
+      break;
+
+    default:
+      G_OBJECT_WARN_INVALID_PROPERTY_ID (object, param_id, pspec);
+      break;
+    }
+}
+
+static void
+set_property (GObject      *object,
+              guint         param_id,
+              const GValue *value,
+              GParamSpec   *pspec)
+{
+  GtkInspectorPerformance *pl = GTK_INSPECTOR_PERFORMANCE (object);
+
+  switch (param_id)
+    {
+    case PROP_BUTTON:
+      pl->priv->button = g_value_get_object (value);
+      break;
+
+    case PROP_SAVE_BUTTON:
+      pl->priv->save_button = g_value_get_object (value);
+      break;
+
+    default:
+      G_OBJECT_WARN_INVALID_PROPERTY_ID (object, param_id, pspec);
+      break;
+    }
+}
+
+static void
+gtk_inspector_performance_class_init (GtkInspectorPerformanceClass *klass)
+{
+  GObjectClass *object_class = G_OBJECT_CLASS (klass);
+  GtkWidgetClass *widget_class = GTK_WIDGET_CLASS (klass);
+
+  object_class->get_property = get_property;
+  object_class->set_property = set_property;
+  object_class->constructed = constructed;
+  object_class->finalize = finalize;
+
+  g_object_class_install_property (object_class, PROP_BUTTON,
+      g_param_spec_object ("button", NULL, NULL,
+                           GTK_TYPE_WIDGET, G_PARAM_READWRITE | G_PARAM_CONSTRUCT_ONLY));
+  g_object_class_install_property (object_class, PROP_SAVE_BUTTON,
+      g_param_spec_object ("save-button", NULL, NULL,
+                           GTK_TYPE_WIDGET, G_PARAM_READWRITE | G_PARAM_CONSTRUCT_ONLY));
+
+  gtk_widget_class_set_template_from_resource (widget_class, "/org/gtk/libgtk/inspector/performance.ui");
+  gtk_widget_class_bind_template_child_private (widget_class, GtkInspectorPerformance, frames_label);
+  gtk_widget_class_bind_template_child_private (widget_class, GtkInspectorPerformance, update_label);
+  gtk_widget_class_bind_template_child_private (widget_class, GtkInspectorPerformance, layout_label);
+  gtk_widget_class_bind_template_child_private (widget_class, GtkInspectorPerformance, paint_label);
+  gtk_widget_class_bind_template_child_private (widget_class, GtkInspectorPerformance, pixel_cache_label);
+  gtk_widget_class_bind_template_child_private (widget_class, GtkInspectorPerformance, style_cache_label);
+  gtk_widget_class_bind_template_child_private (widget_class, GtkInspectorPerformance, render_cache_label);
+  gtk_widget_class_bind_template_child_private (widget_class, GtkInspectorPerformance, timeline);
+  gtk_widget_class_bind_template_child_private (widget_class, GtkInspectorPerformance, widget_model);
+  gtk_widget_class_bind_template_child_private (widget_class, GtkInspectorPerformance, node_model);
+  gtk_widget_class_bind_template_child_private (widget_class, GtkInspectorPerformance, measure_column);
+  gtk_widget_class_bind_template_child_private (widget_class, GtkInspectorPerformance, measure_renderer);
+  gtk_widget_class_bind_template_child_private (widget_class, GtkInspectorPerformance, allocate_column);
+  gtk_widget_class_bind_template_child_private (widget_class, GtkInspectorPerformance, allocate_renderer);
+  gtk_widget_class_bind_template_child_private (widget_class, GtkInspectorPerformance, draw_self_column);
+  gtk_widget_class_bind_template_child_private (widget_class, GtkInspectorPerformance, draw_self_renderer);
+  gtk_widget_class_bind_template_child_private (widget_class, GtkInspectorPerformance, draw_total_column);
+  gtk_widget_class_bind_template_child_private (widget_class, GtkInspectorPerformance, draw_total_renderer);
+  gtk_widget_class_bind_template_callback (widget_class, draw_timeline);
+  gtk_widget_class_bind_template_callback (widget_class, query_timeline_tooltip);
+}
+
+// vim: set et sw=2 ts=2:
@@ -0,0 +1,16 @@
+N_("Frames");
+N_("Update");
+N_("Layout");
+N_("Paint");
+N_("Pixel Cache Hits");
+N_("Style Cache Hits");
+N_("Render Cache Hits");
+N_("Widget");
+N_("Measure");
+N_("Allocate");
+N_("Draw");
+N_("Draw with Children");
+N_("Draws");
+N_("CSS Node");
+N_("Style Updates");
+N_("Cache Hits");
@@ -26,6 +26,7 @@
 #include "gtkcellrenderertext.h"
 #include "gtkcelllayout.h"
 #include "gtksearchbar.h"
+#include "gtksizerequestcacheprivate.h"
 
 enum
 {
@@ -70,7 +71,9 @@ enum
   COLUMN_SELF2,
   COLUMN_CUMULATIVE2,
   COLUMN_SELF_DATA,
-  COLUMN_CUMULATIVE_DATA
+  COLUMN_CUMULATIVE_DATA,
+  COLUMN_SIZE_HITS,
+  COLUMN_SIZE_MISSES
 };
 
 G_DEFINE_TYPE_WITH_PRIVATE (GtkInspectorStatistics, gtk_inspector_statistics, GTK_TYPE_BOX)
@@ -80,6 +83,8 @@ add_type_count (GtkInspectorStatistics *sl, GType type)
 {
   gint cumulative;
   gint self;
+  guint size_hits;
+  guint size_misses;
   GType *children;
   guint n_children;
   gint i;
@@ -114,11 +119,15 @@ add_type_count (GtkInspectorStatistics *sl, GType type)
   gtk_graph_data_prepend_value (data->self, self);
   gtk_graph_data_prepend_value (data->cumulative, cumulative);
 
+  _gtk_size_request_cache_get_statistics (type, &size_hits, &size_misses);
+
   gtk_list_store_set (GTK_LIST_STORE (sl->priv->model), &data->treeiter,
                       COLUMN_SELF1, (int) gtk_graph_data_get_value (data->self, 1),
                       COLUMN_CUMULATIVE1, (int) gtk_graph_data_get_value (data->cumulative, 1),
                       COLUMN_SELF2, (int) gtk_graph_data_get_value (data->self, 0),
                       COLUMN_CUMULATIVE2, (int) gtk_graph_data_get_value (data->cumulative, 0),
+                      COLUMN_SIZE_HITS, size_hits,
+                      COLUMN_SIZE_MISSES, size_misses,
                       -1);
   return cumulative;
 }
@@ -152,6 +161,8 @@ toggle_record (GtkToggleButton        *button,
   if (gtk_toggle_button_get_active (button) == (sl->priv->update_source_id != 0))
     return;
 
+  _gtk_size_request_cache_set_record_statistics (gtk_toggle_button_get_active (button));
+
   if (gtk_toggle_button_get_active (button))
     {
       sl->priv->update_source_id = gdk_threads_add_timeout_seconds (1,
@@ -376,7 +387,10 @@ finalize (GObject *object)
   GtkInspectorStatistics *sl = GTK_INSPECTOR_STATISTICS (object);
 
   if (sl->priv->update_source_id)
-    g_source_remove (sl->priv->update_source_id);
+    {
+      g_source_remove (sl->priv->update_source_id);
+      _gtk_size_request_cache_set_record_statistics (FALSE);
+    }
 
   g_hash_table_unref (sl->priv->counts);
 
@@ -3,6 +3,8 @@ N_("Self 1");
 N_("Cumulative 1");
 N_("Self 2");
 N_("Cumulative 2");
+N_("Size Cache Hits");
+N_("Size Cache Misses");
 N_("Self");
 N_("Cumulative");
 N_("Enable statistics with GOBJECT_DEBUG=instance-count");
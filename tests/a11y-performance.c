@@ -0,0 +1,165 @@
+/* -*- mode: C; c-basic-offset: 2; indent-tabs-mode: nil; -*- */
+
+#include <gtk/gtk.h>
+
+/* Measures the cost of model and buffer updates when accessibility is
+ * active. A listener that does nothing but count is attached to the
+ * accessibles, standing in for an assistive technology, and the time
+ * is compared to the same updates without any accessible created.
+ */
+
+#define N_ROWS 20000
+#define N_CHUNKS 2000
+
+static guint n_events;
+
+static void
+count_event (void)
+{
+  n_events++;
+}
+
+static void
+watch_accessible (AtkObject *accessible)
+{
+  const char *signals[] = {
+    "row-inserted",
+    "row-deleted",
+    "children-changed",
+    "model-changed",
+    "text-changed",
+    "text-caret-moved"
+  };
+  guint i;
+
+  for (i = 0; i < G_N_ELEMENTS (signals); i++)
+    {
+      if (g_signal_lookup (signals[i], G_OBJECT_TYPE (accessible)) != 0)
+        g_signal_connect (accessible, signals[i], G_CALLBACK (count_event), NULL);
+    }
+}
+
+static void
+flush_events (void)
+{
+  while (gtk_events_pending ())
+    gtk_main_iteration ();
+}
+
+static double
+run_tree_view (gboolean accessible)
+{
+  GtkWidget *window, *sw, *tree_view;
+  GtkListStore *store;
+  GtkTreeIter iter;
+  GTimer *timer;
+  double msec;
+  int i;
+
+  window = gtk_window_new (GTK_WINDOW_TOPLEVEL);
+  gtk_window_set_default_size (GTK_WINDOW (window), 400, 400);
+  sw = gtk_scrolled_window_new (NULL, NULL);
+  gtk_container_add (GTK_CONTAINER (window), sw);
+
+  store = gtk_list_store_new (2, G_TYPE_STRING, G_TYPE_INT);
+  tree_view = gtk_tree_view_new_with_model (GTK_TREE_MODEL (store));
+  gtk_tree_view_insert_column_with_attributes (GTK_TREE_VIEW (tree_view), -1, "Text",
+                                               gtk_cell_renderer_text_new (),
+                                               "text", 0, NULL);
+  gtk_tree_view_insert_column_with_attributes (GTK_TREE_VIEW (tree_view), -1, "Number",
+                                               gtk_cell_renderer_text_new (),
+                                               "text", 1, NULL);
+  gtk_container_add (GTK_CONTAINER (sw), tree_view);
+
+  if (accessible)
+    watch_accessible (gtk_widget_get_accessible (tree_view));
+
+  gtk_widget_show_all (window);
+  flush_events ();
+
+  timer = g_timer_new ();
+
+  for (i = 0; i < N_ROWS; i++)
+    gtk_list_store_insert_with_values (store, &iter, -1, 0, "Row", 1, i, -1);
+  flush_events ();
+
+  gtk_list_store_clear (store);
+  flush_events ();
+
+  msec = g_timer_elapsed (timer, NULL) * 1000;
+
+  g_timer_destroy (timer);
+  gtk_widget_destroy (window);
+  g_object_unref (store);
+
+  return msec;
+}
+
+static double
+run_text_view (gboolean accessible)
+{
+  GtkWidget *window, *sw, *text_view;
+  GtkTextBuffer *buffer;
+  GTimer *timer;
+  double msec;
+  int i;
+
+  window = gtk_window_new (GTK_WINDOW_TOPLEVEL);
+  gtk_window_set_default_size (GTK_WINDOW (window), 400, 400);
+  sw = gtk_scrolled_window_new (NULL, NULL);
+  gtk_container_add (GTK_CONTAINER (window), sw);
+
+  text_view = gtk_text_view_new ();
+  buffer = gtk_text_view_get_buffer (GTK_TEXT_VIEW (text_view));
+  gtk_container_add (GTK_CONTAINER (sw), text_view);
+
+  if (accessible)
+    watch_accessible (gtk_widget_get_accessible (text_view));
+
+  gtk_widget_show_all (window);
+  flush_events ();
+
+  timer = g_timer_new ();
+
+  /* Like pasting a large document in pieces */
+  for (i = 0; i < N_CHUNKS; i++)
+    gtk_text_buffer_insert_at_cursor (buffer, "The quick brown fox jumps over the lazy dog.\n", -1);
+  flush_events ();
+
+  msec = g_timer_elapsed (timer, NULL) * 1000;
+
+  g_timer_destroy (timer);
+  gtk_widget_destroy (window);
+
+  return msec;
+}
+
+int
+main (int argc, char **argv)
+{
+  double plain, accessible;
+  int i;
+
+  gtk_init (&argc, &argv);
+
+  /* We do everything three times, first two as warmup */
+  for (i = 0; i < 3; i++)
+    {
+      n_events = 0;
+      plain = run_tree_view (FALSE);
+      accessible = run_tree_view (TRUE);
+    }
+  g_print ("tree view, %d rows: %8.2f msec, %8.2f msec with accessibility (%u events)\n",
+           N_ROWS, plain, accessible, n_events);
+
+  for (i = 0; i < 3; i++)
+    {
+      n_events = 0;
+      plain = run_text_view (FALSE);
+      accessible = run_text_view (TRUE);
+    }
+  g_print ("text view, %d inserts: %8.2f msec, %8.2f msec with accessibility (%u events)\n",
+           N_CHUNKS, plain, accessible, n_events);
+
+  return 0;
+}
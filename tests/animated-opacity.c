@@ -0,0 +1,87 @@
+/* -*- mode: C; c-basic-offset: 2; indent-tabs-mode: nil; -*- */
+
+#include <gtk/gtk.h>
+#include <math.h>
+
+#include "frame-stats.h"
+
+/* Fades a grid full of labels in and out by changing its opacity
+ * every frame, so that frame statistics cover the cost of drawing
+ * a large translucent subtree.
+ */
+
+static double fade_time = 2;
+
+static GOptionEntry options[] = {
+  { "time", 't', 0, G_OPTION_ARG_DOUBLE, &fade_time, "Time for a fade in and out", "SECONDS" },
+  { NULL }
+};
+
+static gboolean
+tick_cb (GtkWidget     *widget,
+         GdkFrameClock *frame_clock,
+         gpointer       user_data)
+{
+  static gint64 start_time = 0;
+  gint64 frame_time;
+  double t;
+
+  frame_time = gdk_frame_clock_get_frame_time (frame_clock);
+  if (start_time == 0)
+    start_time = frame_time;
+
+  t = fmod ((frame_time - start_time) / (fade_time * G_USEC_PER_SEC), 1.0);
+  gtk_widget_set_opacity (widget, t < 0.5 ? 1 - 2 * t : 2 * t - 1);
+
+  return G_SOURCE_CONTINUE;
+}
+
+int
+main (int argc, char **argv)
+{
+  GtkWidget *window, *grid, *widget;
+  GtkCssProvider *cssprovider;
+  GError *error = NULL;
+  guint x, y;
+
+  GOptionContext *context = g_option_context_new (NULL);
+  g_option_context_add_main_entries (context, options, NULL);
+  frame_stats_add_options (g_option_context_get_main_group (context));
+  g_option_context_add_group (context,
+                              gtk_get_option_group (TRUE));
+
+  if (!g_option_context_parse (context, &argc, &argv, &error))
+    {
+      g_printerr ("Option parsing failed: %s\n", error->message);
+      return 1;
+    }
+
+  window = gtk_window_new (GTK_WINDOW_TOPLEVEL);
+  g_signal_connect (window, "destroy", gtk_main_quit, NULL);
+  frame_stats_ensure (GTK_WINDOW (window));
+
+  grid = gtk_grid_new ();
+  gtk_widget_add_tick_callback (grid, tick_cb, NULL, NULL);
+  gtk_container_add (GTK_CONTAINER (window), grid);
+
+  cssprovider = gtk_css_provider_new ();
+  gtk_css_provider_load_from_data (cssprovider, "* { padding: 2px; text-shadow: 5px 5px 2px grey; }", -1, NULL);
+
+  for (x = 0; x < 10; x++)
+    {
+      for (y = 0; y < 20; y++)
+        {
+          widget = gtk_label_new ("Hello World");
+          gtk_style_context_add_provider (gtk_widget_get_style_context (widget),
+                                          GTK_STYLE_PROVIDER (cssprovider),
+                                          GTK_STYLE_PROVIDER_PRIORITY_APPLICATION);
+          gtk_grid_attach (GTK_GRID (grid), widget, x, y, 1, 1);
+        }
+    }
+
+  gtk_widget_show_all (window);
+
+  gtk_main ();
+
+  return 0;
+}
@@ -0,0 +1,112 @@
+/* -*- mode: C; c-basic-offset: 2; indent-tabs-mode: nil; -*- */
+
+#include <gtk/gtk.h>
+
+#include "frame-stats.h"
+
+/* Flips a GtkStack back and forth between two pages full of labels,
+ * so that frame statistics cover nothing but stack transitions.
+ */
+
+static double transition_time = 1;
+static char *transition = NULL;
+
+static GOptionEntry options[] = {
+  { "time", 't', 0, G_OPTION_ARG_DOUBLE, &transition_time, "Transition time", "SECONDS" },
+  { "transition", 0, 0, G_OPTION_ARG_STRING, &transition, "Transition type (crossfade, slide, over, under)", "TYPE" },
+  { NULL }
+};
+
+static void
+flip_page (GtkStack *stack)
+{
+  if (gtk_stack_get_transition_running (stack))
+    return;
+
+  if (g_strcmp0 (gtk_stack_get_visible_child_name (stack), "first") == 0)
+    gtk_stack_set_visible_child_name (stack, "second");
+  else
+    gtk_stack_set_visible_child_name (stack, "first");
+}
+
+static GtkWidget *
+create_page (GtkCssProvider *cssprovider,
+             const char     *text)
+{
+  GtkWidget *grid, *widget;
+  guint x, y;
+
+  grid = gtk_grid_new ();
+
+  for (x = 0; x < 10; x++)
+    {
+      for (y = 0; y < 20; y++)
+        {
+          widget = gtk_label_new (text);
+          gtk_style_context_add_provider (gtk_widget_get_style_context (widget),
+                                          GTK_STYLE_PROVIDER (cssprovider),
+                                          GTK_STYLE_PROVIDER_PRIORITY_APPLICATION);
+          gtk_grid_attach (GTK_GRID (grid), widget, x, y, 1, 1);
+        }
+    }
+
+  return grid;
+}
+
+int
+main (int argc, char **argv)
+{
+  GtkWidget *window, *stack;
+  GtkStackTransitionType type;
+  GtkCssProvider *cssprovider;
+  GError *error = NULL;
+
+  GOptionContext *context = g_option_context_new (NULL);
+  g_option_context_add_main_entries (context, options, NULL);
+  frame_stats_add_options (g_option_context_get_main_group (context));
+  g_option_context_add_group (context,
+                              gtk_get_option_group (TRUE));
+
+  if (!g_option_context_parse (context, &argc, &argv, &error))
+    {
+      g_printerr ("Option parsing failed: %s\n", error->message);
+      return 1;
+    }
+
+  if (transition == NULL || g_strcmp0 (transition, "crossfade") == 0)
+    type = GTK_STACK_TRANSITION_TYPE_CROSSFADE;
+  else if (g_strcmp0 (transition, "slide") == 0)
+    type = GTK_STACK_TRANSITION_TYPE_SLIDE_LEFT_RIGHT;
+  else if (g_strcmp0 (transition, "over") == 0)
+    type = GTK_STACK_TRANSITION_TYPE_OVER_LEFT_RIGHT;
+  else if (g_strcmp0 (transition, "under") == 0)
+    type = GTK_STACK_TRANSITION_TYPE_UNDER_UP;
+  else
+    {
+      g_printerr ("Unknown transition type: %s\n", transition);
+      return 1;
+    }
+
+  window = gtk_window_new (GTK_WINDOW_TOPLEVEL);
+  g_signal_connect (window, "destroy", gtk_main_quit, NULL);
+  frame_stats_ensure (GTK_WINDOW (window));
+
+  stack = gtk_stack_new ();
+  gtk_stack_set_transition_type (GTK_STACK (stack), type);
+  gtk_stack_set_transition_duration (GTK_STACK (stack), transition_time * 1000);
+  g_signal_connect_after (stack, "map", G_CALLBACK (flip_page), NULL);
+  g_signal_connect_after (stack, "notify::transition-running", G_CALLBACK (flip_page), NULL);
+  gtk_container_add (GTK_CONTAINER (window), stack);
+
+  cssprovider = gtk_css_provider_new ();
+  gtk_css_provider_load_from_data (cssprovider, "* { padding: 2px; text-shadow: 5px 5px 2px grey; }", -1, NULL);
+
+  gtk_stack_add_named (GTK_STACK (stack), create_page (cssprovider, "Hello World"), "first");
+  gtk_stack_add_named (GTK_STACK (stack), create_page (cssprovider, "Goodbye World"), "second");
+
+  gtk_widget_show_all (window);
+
+  gtk_main ();
+
+  return 0;
+}
@@ -0,0 +1,108 @@
+/* -*- mode: C; c-basic-offset: 2; indent-tabs-mode: nil; -*- */
+
+#include <gtk/gtk.h>
+
+/* Measures how long it takes to redraw a caret-sized area of a grid
+ * with many children, like it happens when a cursor blinks in one of
+ * them.
+ */
+
+static int rows = 100;
+static int columns = 100;
+static int draws = 1000;
+
+static GOptionEntry options[] = {
+  { "rows", 'r', 0, G_OPTION_ARG_INT, &rows, "Number of rows", "ROWS" },
+  { "columns", 'c', 0, G_OPTION_ARG_INT, &columns, "Number of columns", "COLUMNS" },
+  { "draws", 'n', 0, G_OPTION_ARG_INT, &draws, "Number of draws to time", "DRAWS" },
+  { NULL }
+};
+
+static GtkWidget *
+create_grid (void)
+{
+  GtkWidget *grid, *child;
+  int i, j;
+
+  grid = gtk_grid_new ();
+
+  for (i = 0; i < rows; i++)
+    for (j = 0; j < columns; j++)
+      {
+        char *text = g_strdup_printf ("%d.%d", i, j);
+
+        child = gtk_label_new (text);
+        gtk_grid_attach (GTK_GRID (grid), child, j, i, 1, 1);
+        g_free (text);
+      }
+
+  return grid;
+}
+
+int
+main (int argc, char **argv)
+{
+  GtkWidget *window, *grid;
+  GOptionContext *context;
+  GError *error = NULL;
+  cairo_surface_t *surface;
+  cairo_t *cr;
+  GTimer *timer;
+  double msec;
+  int width, height;
+  int i, j;
+
+  context = g_option_context_new (NULL);
+  g_option_context_add_main_entries (context, options, NULL);
+  g_option_context_add_group (context, gtk_get_option_group (TRUE));
+  if (!g_option_context_parse (context, &argc, &argv, &error))
+    {
+      g_printerr ("Option parsing failed: %s\n", error->message);
+      return 1;
+    }
+  g_option_context_free (context);
+
+  window = gtk_offscreen_window_new ();
+  grid = create_grid ();
+  gtk_container_add (GTK_CONTAINER (window), grid);
+  gtk_widget_show_all (window);
+
+  while (gtk_events_pending ())
+    gtk_main_iteration ();
+
+  width = gtk_widget_get_allocated_width (grid);
+  height = gtk_widget_get_allocated_height (grid);
+  surface = cairo_image_surface_create (CAIRO_FORMAT_ARGB32, width, height);
+
+  timer = g_timer_new ();
+
+  /* We do everything three times, first two as warmup */
+  for (i = 0; i < 3; i++)
+    {
+      g_timer_start (timer);
+
+      for (j = 0; j < draws; j++)
+        {
+          cr = cairo_create (surface);
+          cairo_rectangle (cr,
+                           g_random_int_range (0, MAX (width - 2, 1)),
+                           g_random_int_range (0, MAX (height - 16, 1)),
+                           2, 16);
+          cairo_clip (cr);
+          gtk_widget_draw (grid, cr);
+          cairo_destroy (cr);
+        }
+
+      msec = g_timer_elapsed (timer, NULL) * 1000;
+
+      if (i == 2)
+        g_print ("%d caret-sized draws of %d children: %.2f msec, %.2f usec/draw\n",
+                 draws, rows * columns, msec, msec * 1000 / draws);
+    }
+
+  g_timer_destroy (timer);
+  cairo_surface_destroy (surface);
+  gtk_widget_destroy (window);
+
+  return 0;
+}
@@ -0,0 +1,151 @@
+/* -*- mode: C; c-basic-offset: 2; indent-tabs-mode: nil; -*- */
+
+#include <gtk/gtk.h>
+
+/* Measures how long it takes to restyle a large widget tree after
+ * the style information changed, like it happens on theme switches.
+ * Like a full theme, the style sheet has many rulesets that match
+ * every label.
+ */
+
+static int depth = 8;
+static int width = 2500;
+static int rules = 200;
+
+static GOptionEntry options[] = {
+  { "depth", 'd', 0, G_OPTION_ARG_INT, &depth, "Nesting depth of the tree", "DEPTH" },
+  { "width", 'w', 0, G_OPTION_ARG_INT, &width, "Number of leaves per level", "WIDTH" },
+  { "rules", 'r', 0, G_OPTION_ARG_INT, &rules, "Number of rulesets matching each label", "RULES" },
+  { NULL }
+};
+
+static const char *css[] = {
+  "label { color: black; padding: 1px; }\n"
+  "box > label:first-child { color: red; }\n"
+  ".level label { margin: 2px; }\n",
+  "label { color: blue; padding: 2px; }\n"
+  "box > label:last-child { color: green; }\n"
+  ".level label { margin: 1px; }\n"
+};
+
+static char *
+create_css (int variant)
+{
+  GString *string;
+  int i;
+
+  string = g_string_new (css[variant]);
+
+  for (i = 0; i < rules; i++)
+    g_string_append_printf (string,
+                            "box label:not(.rule%d) { min-height: %dpx; }\n",
+                            i, (i + variant) % 4);
+
+  return g_string_free (string, FALSE);
+}
+
+static GtkWidget *
+create_tree (void)
+{
+  GtkWidget *root, *box, *child;
+  int i, j;
+
+  root = box = gtk_box_new (GTK_ORIENTATION_VERTICAL, 0);
+
+  for (i = 0; i < depth; i++)
+    {
+      for (j = 0; j < width / depth; j++)
+        {
+          char *text = g_strdup_printf ("%d.%d", i, j);
+
+          child = gtk_label_new (text);
+          if (j % 3 == 0)
+            gtk_style_context_add_class (gtk_widget_get_style_context (child), "odd");
+          gtk_container_add (GTK_CONTAINER (box), child);
+          g_free (text);
+        }
+
+      child = gtk_box_new (i % 2 ? GTK_ORIENTATION_VERTICAL : GTK_ORIENTATION_HORIZONTAL, 0);
+      gtk_style_context_add_class (gtk_widget_get_style_context (child), "level");
+      gtk_container_add (GTK_CONTAINER (box), child);
+      box = child;
+    }
+
+  return root;
+}
+
+static void
+restyle_widget (GtkWidget *widget,
+                gpointer   data)
+{
+  GdkRGBA color;
+
+  /* Querying a property makes the style context validate the node */
+  gtk_style_context_get_color (gtk_widget_get_style_context (widget),
+                               gtk_widget_get_state_flags (widget),
+                               &color);
+  (*(guint *) data)++;
+
+  if (GTK_IS_CONTAINER (widget))
+    gtk_container_forall (GTK_CONTAINER (widget), restyle_widget, data);
+}
+
+int
+main (int argc, char **argv)
+{
+  GtkCssProvider *provider;
+  GtkWidget *window;
+  GOptionContext *context;
+  GError *error = NULL;
+  GTimer *timer;
+  double msec;
+  guint n_widgets;
+  char *data[2];
+  int i;
+
+  context = g_option_context_new (NULL);
+  g_option_context_add_main_entries (context, options, NULL);
+  g_option_context_add_group (context, gtk_get_option_group (TRUE));
+  if (!g_option_context_parse (context, &argc, &argv, &error))
+    {
+      g_printerr ("Option parsing failed: %s\n", error->message);
+      return 1;
+    }
+  g_option_context_free (context);
+
+  provider = gtk_css_provider_new ();
+  gtk_style_context_add_provider_for_screen (gdk_screen_get_default (),
+                                             GTK_STYLE_PROVIDER (provider),
+                                             GTK_STYLE_PROVIDER_PRIORITY_APPLICATION);
+
+  window = gtk_window_new (GTK_WINDOW_TOPLEVEL);
+  gtk_container_add (GTK_CONTAINER (window), create_tree ());
+
+  data[0] = create_css (0);
+  data[1] = create_css (1);
+
+  timer = g_timer_new ();
+
+  /* We do everything three times, first two as warmup */
+  for (i = 0; i < 3; i++)
+    {
+      gtk_css_provider_load_from_data (provider, data[i % 2], -1, NULL);
+
+      n_widgets = 0;
+      g_timer_start (timer);
+      restyle_widget (window, &n_widgets);
+      msec = g_timer_elapsed (timer, NULL) * 1000;
+
+      if (i == 2)
+        g_print ("Restyled %u widgets (depth %d, %d rulesets): %.2f msec, %.2f usec/widget\n",
+                 n_widgets, depth, rules, msec, msec * 1000 / n_widgets);
+    }
+
+  g_timer_destroy (timer);
+  g_free (data[0]);
+  g_free (data[1]);
+  gtk_widget_destroy (window);
+  g_object_unref (provider);
+
+  return 0;
+}
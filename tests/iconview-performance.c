@@ -0,0 +1,115 @@
+/* -*- mode: C; c-basic-offset: 2; indent-tabs-mode: nil; -*- */
+
+#include <gtk/gtk.h>
+
+/* Measures how drawing and hit testing in GtkIconView scale with the
+ * number of items in the model.
+ */
+
+#define N_DRAWS 50
+#define N_HITS 10000
+
+static GtkListStore *
+create_model (int n_items)
+{
+  GtkListStore *store;
+  GtkTreeIter iter;
+  char text[32];
+  int i;
+
+  store = gtk_list_store_new (1, G_TYPE_STRING);
+
+  for (i = 0; i < n_items; i++)
+    {
+      g_snprintf (text, sizeof (text), "Item %d", i);
+      gtk_list_store_insert_with_values (store, &iter, -1, 0, text, -1);
+    }
+
+  return store;
+}
+
+static void
+run_benchmark (int n_items)
+{
+  GtkWidget *window, *sw, *icon_view;
+  GtkListStore *store;
+  GtkAdjustment *vadjustment;
+  cairo_surface_t *surface;
+  cairo_t *cr;
+  GTimer *timer;
+  double layout_msec, draw_msec, hit_msec;
+  int width, height;
+  int i;
+
+  window = gtk_window_new (GTK_WINDOW_TOPLEVEL);
+  gtk_window_set_default_size (GTK_WINDOW (window), 800, 600);
+  sw = gtk_scrolled_window_new (NULL, NULL);
+  gtk_container_add (GTK_CONTAINER (window), sw);
+
+  store = create_model (n_items);
+  icon_view = gtk_icon_view_new ();
+  gtk_icon_view_set_text_column (GTK_ICON_VIEW (icon_view), 0);
+  gtk_container_add (GTK_CONTAINER (sw), icon_view);
+
+  timer = g_timer_new ();
+
+  gtk_widget_show_all (window);
+  g_timer_start (timer);
+  gtk_icon_view_set_model (GTK_ICON_VIEW (icon_view), GTK_TREE_MODEL (store));
+  while (gtk_events_pending ())
+    gtk_main_iteration ();
+  layout_msec = g_timer_elapsed (timer, NULL) * 1000;
+
+  width = gtk_widget_get_allocated_width (icon_view);
+  height = gtk_widget_get_allocated_height (icon_view);
+  surface = cairo_image_surface_create (CAIRO_FORMAT_ARGB32, width, height);
+  cr = cairo_create (surface);
+  vadjustment = gtk_scrollable_get_vadjustment (GTK_SCROLLABLE (icon_view));
+
+  g_timer_start (timer);
+  for (i = 0; i < N_DRAWS; i++)
+    {
+      /* Draw pages spread over the whole view */
+      gtk_adjustment_set_value (vadjustment,
+                                (gtk_adjustment_get_upper (vadjustment) - height) * i / N_DRAWS);
+      cairo_save (cr);
+      gtk_widget_draw (icon_view, cr);
+      cairo_restore (cr);
+    }
+  draw_msec = g_timer_elapsed (timer, NULL) * 1000;
+
+  g_timer_start (timer);
+  for (i = 0; i < N_HITS; i++)
+    {
+      GtkTreePath *path;
+
+      path = gtk_icon_view_get_path_at_pos (GTK_ICON_VIEW (icon_view),
+                                            g_random_int_range (0, width),
+                                            g_random_int_range (0, height));
+      if (path)
+        gtk_tree_path_free (path);
+    }
+  hit_msec = g_timer_elapsed (timer, NULL) * 1000;
+
+  g_print ("%6d items: layout %8.2f msec, draw %6.3f msec/frame, hit test %6.3f usec/query\n",
+           n_items, layout_msec, draw_msec / N_DRAWS, hit_msec * 1000 / N_HITS);
+
+  g_timer_destroy (timer);
+  cairo_destroy (cr);
+  cairo_surface_destroy (surface);
+  gtk_widget_destroy (window);
+  g_object_unref (store);
+}
+
+int
+main (int argc, char **argv)
+{
+  int n_items;
+
+  gtk_init (&argc, &argv);
+
+  for (n_items = 1000; n_items <= 100000; n_items *= 10)
+    run_benchmark (n_items);
+
+  return 0;
+}
@@ -0,0 +1,134 @@
+/* -*- mode: C; c-basic-offset: 2; indent-tabs-mode: nil; -*- */
+
+#include <gtk/gtk.h>
+
+/* Measures how fast key events are dispatched through a large
+ * binding set, which is what gtk_bindings_activate_event() does
+ * for every key press that reaches a widget.
+ */
+
+#define N_BINDINGS 2000
+#define N_EVENTS 100000
+
+static const GdkModifierType modifier_combos[] = {
+  0,
+  GDK_CONTROL_MASK,
+  GDK_SHIFT_MASK,
+  GDK_MOD1_MASK,
+  GDK_CONTROL_MASK | GDK_SHIFT_MASK,
+  GDK_CONTROL_MASK | GDK_MOD1_MASK,
+  GDK_SUPER_MASK,
+  GDK_CONTROL_MASK | GDK_SUPER_MASK
+};
+
+static void
+add_bindings (GtkBindingSet *set)
+{
+  guint keyval;
+  gint i;
+
+  for (i = 0; i < N_BINDINGS; i++)
+    {
+      keyval = GDK_KEY_a + i % 26;
+      if (i / 26 % 2)
+        keyval = GDK_KEY_F1 + i % 12;
+
+      gtk_binding_entry_add_signal (set,
+                                    keyval,
+                                    modifier_combos[(i / 52) % G_N_ELEMENTS (modifier_combos)],
+                                    "keynav-failed", 1,
+                                    GTK_TYPE_DIRECTION_TYPE, GTK_DIR_UP);
+    }
+}
+
+static gboolean
+fill_event (GdkEventKey *event,
+            GdkWindow   *window,
+            guint        keyval,
+            guint        state)
+{
+  GdkKeymap *keymap;
+  GdkKeymapKey *keys;
+  gint n_keys;
+
+  keymap = gdk_keymap_get_for_display (gdk_window_get_display (window));
+  if (!gdk_keymap_get_entries_for_keyval (keymap, keyval, &keys, &n_keys))
+    return FALSE;
+
+  memset (event, 0, sizeof (GdkEventKey));
+  event->type = GDK_KEY_PRESS;
+  event->window = window;
+  event->keyval = keyval;
+  event->state = state;
+  event->hardware_keycode = keys[0].keycode;
+  event->group = keys[0].group;
+
+  g_free (keys);
+
+  return TRUE;
+}
+
+int
+main (int argc, char **argv)
+{
+  GtkWidget *window;
+  GtkWidget *widget;
+  GtkBindingSet *set;
+  GdkEventKey events[64];
+  GTimer *timer;
+  guint n_events;
+  guint handled;
+  double msec;
+  int i, j;
+
+  gtk_init (&argc, &argv);
+
+  window = gtk_window_new (GTK_WINDOW_TOPLEVEL);
+  widget = gtk_label_new ("");
+  gtk_container_add (GTK_CONTAINER (window), widget);
+  gtk_widget_realize (window);
+
+  set = gtk_binding_set_by_class (GTK_LABEL_GET_CLASS (widget));
+  add_bindings (set);
+
+  n_events = 0;
+  for (i = 0; n_events < G_N_ELEMENTS (events); i++)
+    {
+      guint keyval = (i % 2) ? GDK_KEY_F1 + i % 12 : GDK_KEY_a + i % 26;
+      guint state = modifier_combos[i % G_N_ELEMENTS (modifier_combos)];
+
+      if (fill_event (&events[n_events], gtk_widget_get_window (window), keyval, state))
+        n_events++;
+      else if (i > 1000)
+        break;
+    }
+
+  if (n_events == 0)
+    {
+      g_printerr ("No keys available in the current keymap\n");
+      return 1;
+    }
+
+  timer = g_timer_new ();
+
+  /* We do everything three times, first two as warmup */
+  for (j = 0; j < 3; j++)
+    {
+      handled = 0;
+      g_timer_start (timer);
+      for (i = 0; i < N_EVENTS; i++)
+        {
+          if (gtk_bindings_activate_event (G_OBJECT (widget), &events[i % n_events]))
+            handled++;
+        }
+      msec = g_timer_elapsed (timer, NULL) * 1000;
+      if (j == 2)
+        g_print ("%d bindings, %d events (%u handled): %.2f msec, %.2f usec/event\n",
+                 N_BINDINGS, N_EVENTS, handled, msec, msec * 1000 / N_EVENTS);
+    }
+
+  g_timer_destroy (timer);
+  gtk_widget_destroy (window);
+
+  return 0;
+}
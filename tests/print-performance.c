@@ -0,0 +1,133 @@
+/* -*- mode: C; c-basic-offset: 2; indent-tabs-mode: nil; -*- */
+
+#include <gtk/gtk.h>
+#include <glib/gstdio.h>
+#include <math.h>
+
+/* Measures how long it takes to print a long document to the test
+ * print backend, with pages rendered one at a time in the main thread
+ * and with GtkPrintOperation:parallel-rendering. The draw-page handler
+ * only uses its own print context, so it is safe to run in threads.
+ */
+
+#define N_PAGES 500
+#define N_LINES 60
+
+static void
+draw_page (GtkPrintOperation *operation,
+           GtkPrintContext   *context,
+           gint               page_nr)
+{
+  cairo_t *cr;
+  PangoLayout *layout;
+  PangoFontDescription *desc;
+  gdouble width;
+  gchar *text;
+  int i, j;
+
+  cr = gtk_print_context_get_cairo_context (context);
+  width = gtk_print_context_get_width (context);
+
+  layout = gtk_print_context_create_pango_layout (context);
+  desc = pango_font_description_from_string ("sans 8");
+  pango_layout_set_font_description (layout, desc);
+  pango_font_description_free (desc);
+  pango_layout_set_width (layout, width * PANGO_SCALE);
+
+  for (i = 0; i < N_LINES; i++)
+    {
+      text = g_strdup_printf ("Page %d, row %d: %08x %08x %08x",
+                              page_nr, i,
+                              page_nr * 2654435761u, i * 7919, page_nr ^ i);
+      pango_layout_set_text (layout, text, -1);
+      g_free (text);
+
+      cairo_move_to (cr, 0, i * 12);
+      pango_cairo_show_layout (cr, layout);
+    }
+
+  g_object_unref (layout);
+
+  /* A chart, to have some geometry next to the text */
+  cairo_set_line_width (cr, 0.5);
+  cairo_move_to (cr, 0, N_LINES * 12 + 50);
+  for (j = 0; j < 2000; j++)
+    cairo_line_to (cr,
+                   width * j / 2000.0,
+                   N_LINES * 12 + 50 + 40 * sin ((page_nr + j) / 30.0));
+  cairo_stroke (cr);
+}
+
+static double
+run_print (const gchar *filename,
+           gboolean     parallel)
+{
+  GtkPrintOperation *operation;
+  GtkPrintSettings *settings;
+  GtkPrintOperationResult result;
+  GError *error = NULL;
+  GTimer *timer;
+  gchar *uri;
+  double msec;
+
+  uri = g_filename_to_uri (filename, NULL, NULL);
+  settings = gtk_print_settings_new ();
+  gtk_print_settings_set_printer (settings, "Print to Test Printer 0");
+  gtk_print_settings_set (settings, GTK_PRINT_SETTINGS_OUTPUT_URI, uri);
+  gtk_print_settings_set (settings, GTK_PRINT_SETTINGS_OUTPUT_FILE_FORMAT, "pdf");
+  g_free (uri);
+
+  operation = gtk_print_operation_new ();
+  gtk_print_operation_set_print_settings (operation, settings);
+  gtk_print_operation_set_n_pages (operation, N_PAGES);
+  gtk_print_operation_set_unit (operation, GTK_UNIT_POINTS);
+  gtk_print_operation_set_parallel_rendering (operation, parallel);
+  g_signal_connect (operation, "draw-page", G_CALLBACK (draw_page), NULL);
+
+  timer = g_timer_new ();
+  result = gtk_print_operation_run (operation,
+                                    GTK_PRINT_OPERATION_ACTION_PRINT,
+                                    NULL, &error);
+  msec = g_timer_elapsed (timer, NULL) * 1000;
+  g_timer_destroy (timer);
+
+  if (result == GTK_PRINT_OPERATION_RESULT_ERROR)
+    {
+      g_printerr ("%s\n", error->message);
+      g_error_free (error);
+    }
+
+  g_object_unref (operation);
+  g_object_unref (settings);
+
+  return msec;
+}
+
+int
+main (int argc, char **argv)
+{
+  gchar *filename;
+  double serial, parallel;
+  int i;
+
+  gtk_init (&argc, &argv);
+
+  g_object_set (gtk_settings_get_default (), "gtk-print-backends", "test", NULL);
+
+  filename = g_build_filename (g_get_tmp_dir (), "print-performance.pdf", NULL);
+
+  /* We do everything three times, first two as warmup */
+  for (i = 0; i < 3; i++)
+    {
+      serial = run_print (filename, FALSE);
+      parallel = run_print (filename, TRUE);
+    }
+
+  g_print ("%d pages, serial: %g ms, parallel: %g ms (%u processors)\n",
+           N_PAGES, serial, parallel, g_get_num_processors ());
+
+  g_unlink (filename);
+  g_free (filename);
+
+  return 0;
+}
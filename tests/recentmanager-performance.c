@@ -0,0 +1,177 @@
+/* -*- mode: C; c-basic-offset: 2; indent-tabs-mode: nil; -*- */
+
+#include <gtk/gtk.h>
+#include <glib/gstdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+
+/* Measures adding and looking up recently used items from several
+ * processes sharing one list, as happens when many applications on
+ * a desktop register the files they open. Each process adds its
+ * share of the items in batches, letting the manager write after
+ * every batch, then looks all of them up. Since the manager waits a
+ * bit before writing, the processes report the CPU time they used
+ * rather than the wall clock time.
+ */
+
+#define N_PROCESSES 4
+#define N_ITEMS 10000
+#define BATCH_SIZE 100
+
+static void
+quit_loop (GtkRecentManager *manager,
+           gpointer          data)
+{
+  g_main_loop_quit (data);
+}
+
+static void
+wait_for_write (GtkRecentManager *manager)
+{
+  GMainLoop *loop;
+  gulong id;
+
+  loop = g_main_loop_new (NULL, FALSE);
+  id = g_signal_connect (manager, "changed", G_CALLBACK (quit_loop), loop);
+  g_main_loop_run (loop);
+  g_signal_handler_disconnect (manager, id);
+  g_main_loop_unref (loop);
+}
+
+static int
+run_child (const gchar *filename,
+           int          n)
+{
+  GtkRecentManager *manager;
+  GtkRecentData data = { NULL, };
+  GtkRecentInfo *info;
+  clock_t start;
+  double add_msec, lookup_msec;
+  gchar *uri;
+  int i;
+
+  manager = g_object_new (GTK_TYPE_RECENT_MANAGER, "filename", filename, NULL);
+
+  data.mime_type = "text/plain";
+  data.app_name = "recentmanager-performance";
+  data.app_exec = "recentmanager-performance %u";
+
+  start = clock ();
+
+  for (i = 0; i < N_ITEMS / N_PROCESSES; i++)
+    {
+      uri = g_strdup_printf ("file:///tmp/recent-%d-%d.txt", n, i);
+      gtk_recent_manager_add_full (manager, uri, &data);
+      g_free (uri);
+
+      if ((i + 1) % BATCH_SIZE == 0)
+        wait_for_write (manager);
+    }
+
+  add_msec = (clock () - start) * 1000.0 / CLOCKS_PER_SEC;
+
+  start = clock ();
+
+  for (i = 0; i < N_ITEMS / N_PROCESSES; i++)
+    {
+      uri = g_strdup_printf ("file:///tmp/recent-%d-%d.txt", n, i);
+      info = gtk_recent_manager_lookup_item (manager, uri, NULL);
+      g_assert (info != NULL);
+      gtk_recent_info_unref (info);
+      g_free (uri);
+    }
+
+  lookup_msec = (clock () - start) * 1000.0 / CLOCKS_PER_SEC;
+
+  g_print ("process %d: %d adds: %g ms, lookups: %g ms (CPU)\n",
+           n, N_ITEMS / N_PROCESSES, add_msec, lookup_msec);
+
+  g_object_unref (manager);
+
+  return 0;
+}
+
+static double
+get_all_items (const gchar *filename,
+               int         *n_items)
+{
+  GtkRecentManager *manager;
+  GList *items;
+  GTimer *timer;
+  double msec;
+  int i;
+
+  manager = g_object_new (GTK_TYPE_RECENT_MANAGER, "filename", filename, NULL);
+
+  timer = g_timer_new ();
+
+  /* We do everything three times, first two as warmup */
+  for (i = 0; i < 3; i++)
+    {
+      g_timer_start (timer);
+      items = gtk_recent_manager_get_items (manager);
+      msec = g_timer_elapsed (timer, NULL) * 1000;
+
+      *n_items = g_list_length (items);
+      g_list_free_full (items, (GDestroyNotify) gtk_recent_info_unref);
+    }
+
+  g_timer_destroy (timer);
+  g_object_unref (manager);
+
+  return msec;
+}
+
+int
+main (int argc, char **argv)
+{
+  GSubprocess *children[N_PROCESSES];
+  GError *error = NULL;
+  gchar *filename, *journal, *n;
+  GTimer *timer;
+  double msec;
+  int n_items;
+  int i;
+
+  gtk_init (&argc, &argv);
+
+  if (argc == 4 && strcmp (argv[1], "--child") == 0)
+    return run_child (argv[2], atoi (argv[3]));
+
+  filename = g_build_filename (g_get_tmp_dir (), "recentmanager-performance.xbel", NULL);
+  journal = g_strconcat (filename, ".journal", NULL);
+  g_unlink (filename);
+  g_unlink (journal);
+
+  timer = g_timer_new ();
+
+  for (i = 0; i < N_PROCESSES; i++)
+    {
+      n = g_strdup_printf ("%d", i);
+      children[i] = g_subprocess_new (G_SUBPROCESS_FLAGS_NONE, &error,
+                                      argv[0], "--child", filename, n, NULL);
+      g_assert_no_error (error);
+      g_free (n);
+    }
+
+  for (i = 0; i < N_PROCESSES; i++)
+    {
+      g_subprocess_wait_check (children[i], NULL, &error);
+      g_assert_no_error (error);
+      g_object_unref (children[i]);
+    }
+
+  g_print ("%d processes: %g ms\n", N_PROCESSES, g_timer_elapsed (timer, NULL) * 1000);
+  g_timer_destroy (timer);
+
+  msec = get_all_items (filename, &n_items);
+  g_print ("get_items: %d items, %g ms\n", n_items, msec);
+
+  g_unlink (filename);
+  g_unlink (journal);
+  g_free (filename);
+  g_free (journal);
+
+  return 0;
+}
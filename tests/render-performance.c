@@ -0,0 +1,113 @@
+/* -*- mode: C; c-basic-offset: 2; indent-tabs-mode: nil; -*- */
+
+#include <gtk/gtk.h>
+
+/* Measures how long it takes to repaint a grid of unchanged buttons
+ * styled with gradients and rounded borders, like many themes do.
+ */
+
+static int rows = 30;
+static int columns = 20;
+static int frames = 100;
+
+static GOptionEntry options[] = {
+  { "rows", 'r', 0, G_OPTION_ARG_INT, &rows, "Number of rows of buttons", "ROWS" },
+  { "columns", 'c', 0, G_OPTION_ARG_INT, &columns, "Number of columns of buttons", "COLUMNS" },
+  { "frames", 'f', 0, G_OPTION_ARG_INT, &frames, "Number of frames to draw", "FRAMES" },
+  { NULL }
+};
+
+static const char css[] =
+  "button {\n"
+  "  border: 1px solid #8a8a8a;\n"
+  "  border-radius: 5px;\n"
+  "  background-image: linear-gradient(to bottom, #f4f4f4, #dadada);\n"
+  "}\n"
+  "button:nth-child(odd) {\n"
+  "  background-image: radial-gradient(circle, #fefefe, #cfcfcf 80%);\n"
+  "}\n";
+
+static GtkWidget *
+create_grid (void)
+{
+  GtkWidget *grid, *button;
+  char *label;
+  int i, j;
+
+  grid = gtk_grid_new ();
+
+  for (i = 0; i < rows; i++)
+    for (j = 0; j < columns; j++)
+      {
+        label = g_strdup_printf ("%d.%d", i, j);
+        button = gtk_button_new_with_label (label);
+        gtk_grid_attach (GTK_GRID (grid), button, j, i, 1, 1);
+        g_free (label);
+      }
+
+  return grid;
+}
+
+int
+main (int argc, char **argv)
+{
+  GtkCssProvider *provider;
+  GtkWidget *window;
+  GOptionContext *context;
+  GError *error = NULL;
+  cairo_surface_t *surface;
+  cairo_t *cr;
+  GTimer *timer;
+  double msec;
+  int i, j;
+
+  context = g_option_context_new (NULL);
+  g_option_context_add_main_entries (context, options, NULL);
+  g_option_context_add_group (context, gtk_get_option_group (TRUE));
+  if (!g_option_context_parse (context, &argc, &argv, &error))
+    {
+      g_printerr ("Option parsing failed: %s\n", error->message);
+      return 1;
+    }
+  g_option_context_free (context);
+
+  provider = gtk_css_provider_new ();
+  gtk_css_provider_load_from_data (provider, css, -1, NULL);
+  gtk_style_context_add_provider_for_screen (gdk_screen_get_default (),
+                                             GTK_STYLE_PROVIDER (provider),
+                                             GTK_STYLE_PROVIDER_PRIORITY_APPLICATION);
+
+  window = gtk_offscreen_window_new ();
+  gtk_container_add (GTK_CONTAINER (window), create_grid ());
+  gtk_widget_show_all (window);
+
+  while (gtk_events_pending ())
+    gtk_main_iteration ();
+
+  surface = cairo_image_surface_create (CAIRO_FORMAT_ARGB32,
+                                        gtk_widget_get_allocated_width (window),
+                                        gtk_widget_get_allocated_height (window));
+  cr = cairo_create (surface);
+
+  timer = g_timer_new ();
+
+  /* We do everything three times, first two as warmup */
+  for (i = 0; i < 3; i++)
+    {
+      g_timer_start (timer);
+      for (j = 0; j < frames; j++)
+        gtk_widget_draw (window, cr);
+      msec = g_timer_elapsed (timer, NULL) * 1000;
+    }
+
+  g_print ("%d buttons, %d frames: %.2f msec, %.2f msec/frame\n",
+           rows * columns, frames, msec, msec / frames);
+
+  g_timer_destroy (timer);
+  cairo_destroy (cr);
+  cairo_surface_destroy (surface);
+  gtk_widget_destroy (window);
+  g_object_unref (provider);
+
+  return 0;
+}
@@ -5,6 +5,8 @@
 
 #include "frame-stats.h"
 
+static int events_per_frame = 0;
+
 GtkWidget *
 create_widget_factory_content (void)
 {
@@ -65,7 +67,49 @@ scroll_viewport (GtkWidget     *viewport,
   return TRUE;
 }
 
+/* Feeds bursts of smooth scroll events to the scrolled window, like a
+ * touchpad reporting at a higher rate than the frame rate does.
+ */
+gboolean
+scroll_events (GtkWidget     *scrolled_window,
+               GdkFrameClock *frame_clock,
+               gpointer       user_data)
+{
+  static gint64 start_time;
+  gint64 now = gdk_frame_clock_get_frame_time (frame_clock);
+  gdouble elapsed;
+  GdkDevice *device;
+  GdkEvent *event;
+  int i;
+
+  if (start_time == 0)
+    start_time = now;
+
+  elapsed = (now - start_time) / 1000000.;
+
+  device = gdk_seat_get_pointer (gdk_display_get_default_seat (gtk_widget_get_display (scrolled_window)));
+
+  for (i = 0; i < events_per_frame; i++)
+    {
+      event = gdk_event_new (GDK_SCROLL);
+      event->scroll.window = g_object_ref (gtk_widget_get_window (scrolled_window));
+      event->scroll.send_event = TRUE;
+      event->scroll.time = now / 1000;
+      event->scroll.direction = GDK_SCROLL_SMOOTH;
+      event->scroll.delta_x = 4.0 * cos (elapsed) / events_per_frame;
+      event->scroll.delta_y = 4.0 * -sin (elapsed) / events_per_frame;
+      gdk_event_set_device (event, device);
+      gdk_event_set_source_device (event, device);
+
+      gtk_widget_event (scrolled_window, event);
+      gdk_event_free (event);
+    }
+
+  return TRUE;
+}
+
 static GOptionEntry options[] = {
+  { "scroll-events", 's', 0, G_OPTION_ARG_INT, &events_per_frame, "Scroll with smooth scroll events instead of setting the adjustments", "EVENTS_PER_FRAME" },
   { NULL }
 };
 
@@ -112,10 +156,16 @@ main (int argc, char **argv)
       g_object_unref (content);
     }
 
-  gtk_widget_add_tick_callback (viewport,
-                                scroll_viewport,
-                                NULL,
-                                NULL);
+  if (events_per_frame > 0)
+    gtk_widget_add_tick_callback (scrolled_window,
+                                  scroll_events,
+                                  NULL,
+                                  NULL);
+  else
+    gtk_widget_add_tick_callback (viewport,
+                                  scroll_viewport,
+                                  NULL,
+                                  NULL);
 
   gtk_widget_show_all (window);
   g_signal_connect (window, "destroy",
@@ -0,0 +1,182 @@
+/* -*- mode: C; c-basic-offset: 2; indent-tabs-mode: nil; -*- */
+
+#include <gtk/gtk.h>
+#include <gtk/gtksearchengine.h>
+#include <gtk/gtksearchwalkerprivate.h>
+#include <glib/gstdio.h>
+#include <string.h>
+
+/* Measures how long the file chooser's fallback search takes to walk
+ * a generated directory tree, looking for a name that matches about
+ * one file in ten, with one thread and with the default number of
+ * threads.
+ */
+
+static int depth = 4;
+static int fanout = 6;
+static int files = 30;
+
+static GOptionEntry options[] = {
+  { "depth", 'd', 0, G_OPTION_ARG_INT, &depth, "Depth of the directory tree", "DEPTH" },
+  { "fanout", 'n', 0, G_OPTION_ARG_INT, &fanout, "Subdirectories per directory", "FANOUT" },
+  { "files", 'f', 0, G_OPTION_ARG_INT, &files, "Files per directory", "FILES" },
+  { NULL }
+};
+
+static int
+create_tree (const gchar *path,
+             int          level)
+{
+  gchar *name;
+  int i, n;
+
+  n = 0;
+
+  for (i = 0; i < files; i++)
+    {
+      name = g_strdup_printf ("%s/file-%d.txt", path, i);
+      g_file_set_contents (name, "", 0, NULL);
+      g_free (name);
+      n++;
+    }
+
+  if (level == depth)
+    return n;
+
+  for (i = 0; i < fanout; i++)
+    {
+      name = g_strdup_printf ("%s/dir-%d", path, i);
+      g_mkdir (name, 0700);
+      n += create_tree (name, level + 1) + 1;
+      g_free (name);
+    }
+
+  return n;
+}
+
+static void
+remove_tree (const gchar *path)
+{
+  GDir *dir;
+  const gchar *name;
+  gchar *child;
+
+  dir = g_dir_open (path, 0, NULL);
+  if (dir)
+    {
+      while ((name = g_dir_read_name (dir)))
+        {
+          child = g_build_filename (path, name, NULL);
+          if (g_file_test (child, G_FILE_TEST_IS_DIR))
+            remove_tree (child);
+          else
+            g_unlink (child);
+          g_free (child);
+        }
+      g_dir_close (dir);
+    }
+
+  g_rmdir (path);
+}
+
+static gboolean
+matches (const gchar *display_name,
+         gpointer     user_data)
+{
+  return strstr (display_name, "7") != NULL;
+}
+
+static void
+hits_added (GList    *hits,
+            gpointer  user_data)
+{
+  int *n_hits = user_data;
+  GtkSearchHit *hit;
+  GList *l;
+
+  for (l = hits; l; l = l->next)
+    {
+      hit = l->data;
+      g_object_unref (hit->file);
+      g_clear_object (&hit->info);
+      g_free (hit);
+      (*n_hits)++;
+    }
+
+  g_list_free (hits);
+}
+
+static void
+done (gpointer user_data)
+{
+  gtk_main_quit ();
+}
+
+static double
+run_search (GFile *location,
+            guint  n_threads,
+            int   *n_hits)
+{
+  GtkSearchWalker *walker;
+  GTimer *timer;
+  double msec;
+  int i;
+
+  timer = g_timer_new ();
+
+  /* We do everything three times, first two as warmup */
+  for (i = 0; i < 3; i++)
+    {
+      *n_hits = 0;
+      walker = _gtk_search_walker_new (matches, NULL, hits_added, done, n_hits, NULL);
+      _gtk_search_walker_add_directory (walker, location);
+
+      g_timer_start (timer);
+      _gtk_search_walker_start (walker, n_threads);
+      gtk_main ();
+      msec = g_timer_elapsed (timer, NULL) * 1000;
+    }
+
+  g_timer_destroy (timer);
+
+  return msec;
+}
+
+int
+main (int argc, char **argv)
+{
+  GOptionContext *context;
+  GError *error = NULL;
+  GFile *location;
+  gchar *path;
+  double msec;
+  int n_files, n_hits;
+
+  context = g_option_context_new (NULL);
+  g_option_context_add_main_entries (context, options, NULL);
+  g_option_context_add_group (context, gtk_get_option_group (TRUE));
+  if (!g_option_context_parse (context, &argc, &argv, &error))
+    {
+      g_printerr ("Option parsing failed: %s\n", error->message);
+      return 1;
+    }
+  g_option_context_free (context);
+
+  path = g_dir_make_tmp ("search-performance-XXXXXX", &error);
+  g_assert_no_error (error);
+
+  n_files = create_tree (path, 0);
+  location = g_file_new_for_path (path);
+
+  msec = run_search (location, 1, &n_hits);
+  g_print ("%d files, 1 thread: %d hits, %g ms\n", n_files, n_hits, msec);
+
+  msec = run_search (location, 0, &n_hits);
+  g_print ("%d files, default threads: %d hits, %g ms\n", n_files, n_hits, msec);
+
+  g_object_unref (location);
+  remove_tree (path);
+  g_free (path);
+
+  return 0;
+}
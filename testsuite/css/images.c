@@ -0,0 +1,178 @@
+/*
+ * Copyright (C) 2016 Red Hat Inc.
+ *
+ * This library is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Library General Public
+ * License as published by the Free Software Foundation; either
+ * version 2 of the License, or (at your option) any later version.
+ *
+ * This library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Library General Public License for more details.
+ *
+ * You should have received a copy of the GNU Library General Public
+ * License along with this library. If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include <utime.h>
+#include <glib/gstdio.h>
+#include <gtk/gtk.h>
+
+#define SIZE 4
+
+#define RED  0xffff0000
+#define BLUE 0xff0000ff
+
+static void
+write_image (const gchar *filename,
+             guint32      color,
+             time_t       mtime)
+{
+  struct utimbuf times;
+  GdkPixbuf *pixbuf;
+  GError *error = NULL;
+
+  pixbuf = gdk_pixbuf_new (GDK_COLORSPACE_RGB, TRUE, 8, SIZE, SIZE);
+  gdk_pixbuf_fill (pixbuf, (color << 8) | 0xff);
+  gdk_pixbuf_save (pixbuf, filename, "png", &error, NULL);
+  g_assert_no_error (error);
+  g_object_unref (pixbuf);
+
+  /* Changes are noticed through the file's entity tag, which is
+   * based on the modification time
+   */
+  times.actime = mtime;
+  times.modtime = mtime;
+  g_assert_cmpint (g_utime (filename, &times), ==, 0);
+}
+
+static GtkStyleContext *
+create_context (const gchar *filename)
+{
+  GtkStyleContext *context;
+  GtkCssProvider *provider;
+  GtkWidgetPath *path;
+  GError *error = NULL;
+  gchar *uri, *css;
+
+  uri = g_filename_to_uri (filename, NULL, NULL);
+  css = g_strdup_printf ("* { background-image: url('%s'); }", uri);
+
+  provider = gtk_css_provider_new ();
+  gtk_css_provider_load_from_data (provider, css, -1, &error);
+  g_assert_no_error (error);
+
+  path = gtk_widget_path_new ();
+  gtk_widget_path_append_type (path, GTK_TYPE_WINDOW);
+
+  context = gtk_style_context_new ();
+  gtk_style_context_set_path (context, path);
+  gtk_style_context_add_provider (context,
+                                  GTK_STYLE_PROVIDER (provider),
+                                  GTK_STYLE_PROVIDER_PRIORITY_USER);
+
+  gtk_widget_path_unref (path);
+  g_object_unref (provider);
+  g_free (css);
+  g_free (uri);
+
+  return context;
+}
+
+static guint32
+render_pixel (GtkStyleContext *context)
+{
+  cairo_surface_t *surface;
+  cairo_t *cr;
+  guint32 pixel;
+
+  surface = cairo_image_surface_create (CAIRO_FORMAT_ARGB32, SIZE, SIZE);
+  cr = cairo_create (surface);
+  gtk_render_background (context, cr, 0, 0, SIZE, SIZE);
+  cairo_destroy (cr);
+
+  cairo_surface_flush (surface);
+  pixel = *(guint32 *) (cairo_image_surface_get_data (surface) +
+                        cairo_image_surface_get_stride (surface));
+  cairo_surface_destroy (surface);
+
+  return pixel;
+}
+
+static gboolean
+stop_waiting (gpointer data)
+{
+  gboolean *timed_out = data;
+
+  *timed_out = TRUE;
+
+  return G_SOURCE_REMOVE;
+}
+
+/* The load finishes in the main loop, and makes the provider emit its
+ * changed signal, after which the context computes the style again
+ */
+static guint32
+wait_for_pixel (GtkStyleContext *context,
+                guint32          expected)
+{
+  gboolean timed_out = FALSE;
+  guint32 pixel;
+  guint id;
+
+  id = g_timeout_add_seconds (5, stop_waiting, &timed_out);
+  while ((pixel = render_pixel (context)) != expected && !timed_out)
+    g_main_context_iteration (NULL, TRUE);
+  if (!timed_out)
+    g_source_remove (id);
+
+  return pixel;
+}
+
+static void
+test_async_load (void)
+{
+  GtkStyleContext *context, *context2;
+  gchar *dir, *filename;
+
+  dir = g_dir_make_tmp ("gtk-css-images-XXXXXX", NULL);
+  g_assert (dir != NULL);
+  filename = g_build_filename (dir, "image.png", NULL);
+
+  write_image (filename, RED, 1000000000);
+  context = create_context (filename);
+
+  /* Nothing is drawn until the image has been loaded in a thread */
+  g_assert_cmphex (render_pixel (context), ==, 0);
+  g_assert_cmphex (wait_for_pixel (context, RED), ==, RED);
+
+  /* A new style sheet for the same file gets the new image once the
+   * file changed, even while the old one is still in use
+   */
+  write_image (filename, BLUE, 1000000010);
+  context2 = create_context (filename);
+  g_assert_cmphex (wait_for_pixel (context2, BLUE), ==, BLUE);
+  g_assert_cmphex (render_pixel (context), ==, RED);
+
+  g_object_unref (context2);
+  g_object_unref (context);
+
+  g_remove (filename);
+  g_rmdir (dir);
+  g_free (filename);
+  g_free (dir);
+}
+
+int
+main (int argc, char *argv[])
+{
+  /* Read once, when the first image is computed */
+  g_setenv ("GTK_CSS_ASYNC_IMAGES", "1", TRUE);
+
+  gtk_test_init (&argc, &argv, NULL);
+
+  g_test_add_func ("/css/images/async-load", test_async_load);
+
+  return g_test_run ();
+}
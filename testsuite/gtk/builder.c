@@ -2930,6 +2930,86 @@ test_file_filter (void)
   g_object_unref (builder);
 }
 
+static void
+count_notify (GObject    *object,
+              GParamSpec *pspec,
+              gpointer    data)
+{
+  gint *count = data;
+
+  (*count)++;
+}
+
+static void
+test_deferred (void)
+{
+  GtkBuilder *builder;
+  GObject *obj, *label;
+  GSList *objects;
+  GError *error = NULL;
+  gint notifies = 0;
+  const gchar buffer[] =
+    "<interface>"
+    "  <object class='GtkLabel' id='label1'>"
+    "    <property name='label'>eager</property>"
+    "  </object>"
+    "  <object class='GtkWindow' id='window1' deferred='yes'>"
+    "    <child>"
+    "      <object class='GtkBox' id='box1'>"
+    "        <child>"
+    "          <object class='GtkLabel' id='label2'>"
+    "            <property name='label'>deferred &amp; lazy</property>"
+    "          </object>"
+    "          <packing>"
+    "            <property name='expand'>True</property>"
+    "          </packing>"
+    "        </child>"
+    "      </object>"
+    "    </child>"
+    "  </object>"
+    "</interface>";
+
+  builder = builder_new_from_string (buffer, -1, NULL);
+
+  objects = gtk_builder_get_objects (builder);
+  g_assert_cmpint (g_slist_length (objects), ==, 1);
+  g_slist_free (objects);
+
+  g_signal_connect (builder, "notify", G_CALLBACK (count_notify), &notifies);
+
+  /* Asking for an object inside the deferred object builds all of it */
+  label = gtk_builder_get_object (builder, "label2");
+  g_assert_cmpint (notifies, ==, 0);
+  g_assert (GTK_IS_LABEL (label));
+  g_assert_cmpstr (gtk_label_get_label (GTK_LABEL (label)), ==, "deferred & lazy");
+
+  obj = gtk_builder_get_object (builder, "window1");
+  g_assert (GTK_IS_WINDOW (obj));
+  g_assert (gtk_widget_get_toplevel (GTK_WIDGET (label)) == GTK_WIDGET (obj));
+
+  objects = gtk_builder_get_objects (builder);
+  g_assert_cmpint (g_slist_length (objects), ==, 4);
+  g_slist_free (objects);
+
+  gtk_widget_destroy (GTK_WIDGET (obj));
+  g_object_unref (builder);
+
+  /* The ids inside deferred objects are taken right away */
+  builder = gtk_builder_new ();
+  gtk_builder_add_from_string (builder,
+                               "<interface>"
+                               "  <object class='GtkButton' id='button1'/>"
+                               "  <object class='GtkWindow' id='window1' deferred='yes'>"
+                               "    <child>"
+                               "      <object class='GtkButton' id='button1'/>"
+                               "    </child>"
+                               "  </object>"
+                               "</interface>", -1, &error);
+  g_assert_error (error, GTK_BUILDER_ERROR, GTK_BUILDER_ERROR_DUPLICATE_ID);
+  g_error_free (error);
+  g_object_unref (builder);
+}
+
 int
 main (int argc, char **argv)
 {
@@ -2984,6 +3064,7 @@ main (int argc, char **argv)
   g_test_add_func ("/Builder/Property Bindings", test_property_bindings);
   g_test_add_func ("/Builder/anaconda-signal", test_anaconda_signal);
   g_test_add_func ("/Builder/FileFilter", test_file_filter);
+  g_test_add_func ("/Builder/Deferred", test_deferred);
 
   return g_test_run();
 }
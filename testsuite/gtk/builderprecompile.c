@@ -0,0 +1,392 @@
+/*
+ * builderprecompile.c: Test precompiled GtkBuilder data
+ *
+ * This library is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Library General Public
+ * License as published by the Free Software Foundation; either
+ * version 2 of the License, or (at your option) any later version.
+ *
+ * This library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Library General Public License for more details.
+ *
+ * You should have received a copy of the GNU Library General Public
+ * License along with this library. If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include <string.h>
+#include <gtk/gtk.h>
+#include "gtk/gtkbuilderprivate.h"
+
+/* Builds each file once from XML and once from its precompiled form,
+ * and checks that both give the same objects, with the same property
+ * values, style classes, children and child properties.
+ */
+
+static const gchar rich_ui[] =
+  "<interface>"
+  "  <object class='GtkAdjustment' id='adjustment'>"
+  "    <property name='upper'>100</property>"
+  "    <property name='value'>42</property>"
+  "    <property name='step-increment'>1</property>"
+  "  </object>"
+  "  <object class='GtkWindow' id='window'>"
+  "    <property name='title' translatable='yes'>A &amp; B &lt;window&gt;</property>"
+  "    <property name='default-width'>300</property>"
+  "    <child>"
+  "      <object class='GtkGrid' id='grid'>"
+  "        <property name='row-spacing'>6</property>"
+  "        <property name='column-homogeneous'>True</property>"
+  "        <child>"
+  "          <object class='GtkLabel' id='label'>"
+  "            <property name='label'>Name:</property>"
+  "            <property name='xalign'>1</property>"
+  "            <property name='ellipsize'>end</property>"
+  "            <style>"
+  "              <class name='dim-label'/>"
+  "            </style>"
+  "          </object>"
+  "          <packing>"
+  "            <property name='left-attach'>0</property>"
+  "            <property name='top-attach'>1</property>"
+  "          </packing>"
+  "        </child>"
+  "        <child>"
+  "          <object class='GtkSpinButton' id='spin'>"
+  "            <property name='adjustment'>adjustment</property>"
+  "            <property name='digits'>2</property>"
+  "          </object>"
+  "          <packing>"
+  "            <property name='left-attach'>1</property>"
+  "            <property name='top-attach'>1</property>"
+  "            <property name='width'>2</property>"
+  "          </packing>"
+  "        </child>"
+  "        <child>"
+  "          <object class='GtkBox' id='box'>"
+  "            <property name='orientation'>vertical</property>"
+  "            <child>"
+  "              <object class='GtkCheckButton' id='check'>"
+  "                <property name='label'>Check</property>"
+  "                <property name='active'>True</property>"
+  "              </object>"
+  "              <packing>"
+  "                <property name='pack-type'>end</property>"
+  "                <property name='padding'>3</property>"
+  "              </packing>"
+  "            </child>"
+  "            <child>"
+  "              <object class='GtkComboBoxText' id='combo'>"
+  "                <items>"
+  "                  <item id='a'>First</item>"
+  "                  <item id='b' translatable='yes'>Second</item>"
+  "                </items>"
+  "              </object>"
+  "            </child>"
+  "          </object>"
+  "          <packing>"
+  "            <property name='left-attach'>0</property>"
+  "            <property name='top-attach'>0</property>"
+  "          </packing>"
+  "        </child>"
+  "      </object>"
+  "    </child>"
+  "  </object>"
+  "</interface>";
+
+static gboolean
+value_is_comparable (GType type)
+{
+  GType fundamental = G_TYPE_FUNDAMENTAL (type);
+
+  return fundamental != G_TYPE_POINTER &&
+         fundamental != G_TYPE_BOXED &&
+         fundamental != G_TYPE_OBJECT &&
+         fundamental != G_TYPE_INTERFACE &&
+         fundamental != G_TYPE_PARAM &&
+         fundamental != G_TYPE_VARIANT;
+}
+
+static void
+compare_values (const gchar *what,
+                GParamSpec  *pspec,
+                GValue      *a,
+                GValue      *b)
+{
+  GObject *obj_a, *obj_b;
+
+  if (value_is_comparable (pspec->value_type))
+    {
+      if (g_param_values_cmp (pspec, a, b) != 0)
+        {
+          gchar *str_a = g_strdup_value_contents (a);
+          gchar *str_b = g_strdup_value_contents (b);
+
+          g_test_message ("%s::%s: %s != %s", what, pspec->name, str_a, str_b);
+          g_free (str_a);
+          g_free (str_b);
+          g_test_fail ();
+        }
+    }
+  else if (G_VALUE_HOLDS_OBJECT (a))
+    {
+      /* Only the shape, following object properties could loop */
+      obj_a = g_value_get_object (a);
+      obj_b = g_value_get_object (b);
+      g_assert ((obj_a == NULL) == (obj_b == NULL));
+      if (obj_a)
+        g_assert_cmpstr (G_OBJECT_TYPE_NAME (obj_a), ==, G_OBJECT_TYPE_NAME (obj_b));
+    }
+}
+
+static void
+compare_properties (GObject *a,
+                    GObject *b)
+{
+  GParamSpec **pspecs;
+  guint n_pspecs, i;
+
+  pspecs = g_object_class_list_properties (G_OBJECT_GET_CLASS (a), &n_pspecs);
+  for (i = 0; i < n_pspecs; i++)
+    {
+      GValue value_a = G_VALUE_INIT;
+      GValue value_b = G_VALUE_INIT;
+
+      if (!(pspecs[i]->flags & G_PARAM_READABLE) ||
+          (pspecs[i]->flags & G_PARAM_DEPRECATED))
+        continue;
+
+      g_value_init (&value_a, pspecs[i]->value_type);
+      g_value_init (&value_b, pspecs[i]->value_type);
+      g_object_get_property (a, pspecs[i]->name, &value_a);
+      g_object_get_property (b, pspecs[i]->name, &value_b);
+
+      compare_values (G_OBJECT_TYPE_NAME (a), pspecs[i], &value_a, &value_b);
+
+      g_value_unset (&value_a);
+      g_value_unset (&value_b);
+    }
+  g_free (pspecs);
+}
+
+static void
+compare_child_properties (GtkContainer *container_a,
+                          GtkWidget    *a,
+                          GtkContainer *container_b,
+                          GtkWidget    *b)
+{
+  GParamSpec **pspecs;
+  guint n_pspecs, i;
+
+  pspecs = gtk_container_class_list_child_properties (G_OBJECT_GET_CLASS (container_a), &n_pspecs);
+  for (i = 0; i < n_pspecs; i++)
+    {
+      GValue value_a = G_VALUE_INIT;
+      GValue value_b = G_VALUE_INIT;
+
+      if (!(pspecs[i]->flags & G_PARAM_READABLE))
+        continue;
+
+      g_value_init (&value_a, pspecs[i]->value_type);
+      g_value_init (&value_b, pspecs[i]->value_type);
+      gtk_container_child_get_property (container_a, a, pspecs[i]->name, &value_a);
+      gtk_container_child_get_property (container_b, b, pspecs[i]->name, &value_b);
+
+      compare_values (G_OBJECT_TYPE_NAME (container_a), pspecs[i], &value_a, &value_b);
+
+      g_value_unset (&value_a);
+      g_value_unset (&value_b);
+    }
+  g_free (pspecs);
+}
+
+static void
+compare_style_classes (GtkWidget *a,
+                       GtkWidget *b)
+{
+  GList *classes_a, *classes_b, *l;
+
+  classes_a = gtk_style_context_list_classes (gtk_widget_get_style_context (a));
+  classes_b = gtk_style_context_list_classes (gtk_widget_get_style_context (b));
+
+  g_assert_cmpuint (g_list_length (classes_a), ==, g_list_length (classes_b));
+  for (l = classes_a; l; l = l->next)
+    g_assert (gtk_style_context_has_class (gtk_widget_get_style_context (b), l->data));
+
+  g_list_free (classes_a);
+  g_list_free (classes_b);
+}
+
+static void
+compare_objects (GObject *a,
+                 GObject *b)
+{
+  GList *children_a, *children_b, *la, *lb;
+
+  g_assert_cmpstr (G_OBJECT_TYPE_NAME (a), ==, G_OBJECT_TYPE_NAME (b));
+
+  compare_properties (a, b);
+
+  if (!GTK_IS_WIDGET (a))
+    return;
+
+  compare_style_classes (GTK_WIDGET (a), GTK_WIDGET (b));
+
+  if (!GTK_IS_CONTAINER (a))
+    return;
+
+  children_a = gtk_container_get_children (GTK_CONTAINER (a));
+  children_b = gtk_container_get_children (GTK_CONTAINER (b));
+  g_assert_cmpuint (g_list_length (children_a), ==, g_list_length (children_b));
+
+  for (la = children_a, lb = children_b; la; la = la->next, lb = lb->next)
+    {
+      compare_child_properties (GTK_CONTAINER (a), la->data,
+                                GTK_CONTAINER (b), lb->data);
+      compare_objects (la->data, lb->data);
+    }
+
+  g_list_free (children_a);
+  g_list_free (children_b);
+}
+
+static void
+compare_builders (GtkBuilder *a,
+                  GtkBuilder *b)
+{
+  GSList *objects, *other_objects, *l;
+  const gchar *name;
+  GObject *other;
+
+  objects = gtk_builder_get_objects (a);
+  other_objects = gtk_builder_get_objects (b);
+  g_assert_cmpuint (g_slist_length (objects), ==, g_slist_length (other_objects));
+  g_slist_free (other_objects);
+
+  for (l = objects; l; l = l->next)
+    {
+      name = gtk_buildable_get_name (GTK_BUILDABLE (l->data));
+      other = gtk_builder_get_object (b, name);
+      g_assert (other != NULL);
+
+      compare_objects (l->data, other);
+    }
+
+  g_slist_free (objects);
+}
+
+static void
+check_precompiled (const gchar *contents,
+                   gsize        length)
+{
+  GtkBuilder *builder, *precompiled_builder;
+  GError *error = NULL;
+  GBytes *bytes;
+  gconstpointer data;
+  gsize size;
+
+  builder = gtk_builder_new ();
+  gtk_builder_add_from_string (builder, contents, length, &error);
+  g_assert_no_error (error);
+
+  bytes = _gtk_builder_precompile (contents, length, &error);
+  g_assert_no_error (error);
+
+  data = g_bytes_get_data (bytes, &size);
+  g_assert (_gtk_builder_is_precompiled (data, size));
+
+  precompiled_builder = gtk_builder_new ();
+  gtk_builder_add_from_string (precompiled_builder, data, size, &error);
+  g_assert_no_error (error);
+
+  compare_builders (builder, precompiled_builder);
+  compare_builders (precompiled_builder, builder);
+
+  g_bytes_unref (bytes);
+  g_object_unref (builder);
+  g_object_unref (precompiled_builder);
+}
+
+static void
+test_rich (void)
+{
+  check_precompiled (rich_ui, strlen (rich_ui));
+}
+
+static void
+test_file (gconstpointer d)
+{
+  const gchar *filename = d;
+  gchar *contents;
+  gsize length;
+  GError *error = NULL;
+
+  g_file_get_contents (filename, &contents, &length, &error);
+  g_assert_no_error (error);
+
+  check_precompiled (contents, length);
+
+  g_free (contents);
+}
+
+static gboolean
+file_builds (const gchar *filename)
+{
+  gchar *expected_file, *expected, *p;
+  gboolean builds;
+
+  expected_file = g_strdup (filename);
+  p = strstr (expected_file, ".ui");
+  strcpy (p, ".expected");
+
+  builds = FALSE;
+  if (g_file_get_contents (expected_file, &expected, NULL, NULL))
+    {
+      builds = g_str_has_prefix (expected, "SUCCESS");
+      g_free (expected);
+    }
+  g_free (expected_file);
+
+  return builds;
+}
+
+int
+main (int argc, char *argv[])
+{
+  GDir *dir;
+  GError *error = NULL;
+  const gchar *name;
+  gchar *path;
+
+  gtk_test_init (&argc, &argv, NULL);
+
+  g_test_add_func ("/builder/precompile/rich", test_rich);
+
+  /* The parser tests that are expected to build */
+  path = g_test_build_filename (G_TEST_DIST, "ui", NULL);
+  dir = g_dir_open (path, 0, &error);
+  g_free (path);
+  g_assert_no_error (error);
+  while ((name = g_dir_read_name (dir)) != NULL)
+    {
+      gchar *filename;
+
+      if (!g_str_has_suffix (name, ".ui"))
+        continue;
+
+      filename = g_test_build_filename (G_TEST_DIST, "ui", name, NULL);
+      if (!file_builds (filename))
+        {
+          g_free (filename);
+          continue;
+        }
+
+      path = g_strdup_printf ("/builder/precompile/%s", name);
+      g_test_add_data_func_full (path, filename, test_file, g_free);
+      g_free (path);
+    }
+  g_dir_close (dir);
+
+  return g_test_run ();
+}
@@ -17,10 +17,18 @@
 
 #include <gtk/gtk.h>
 
+#ifdef GDK_WINDOWING_X11
+#include <gdk/gdkx.h>
+#endif
+
 #include <string.h>
 
 #define SOME_TEXT "Hello World"
 #define TARGET_TEXT "UTF8_STRING"
+#define TARGET_STREAM "application/x-gtk-test-stream"
+#define STREAM_SIZE (16 * 1024 * 1024)
+
+static const char *test_program;
 
 static void
 test_text (void)
@@ -75,14 +83,223 @@ test_with_data (void)
     gtk_clipboard_request_contents (clipboard, gdk_atom_intern (TARGET_TEXT, FALSE), test_with_data_got, NULL);
 }
 
+static GBytes *
+make_payload (void)
+{
+  guchar *data;
+  gsize i;
+
+  data = g_malloc (STREAM_SIZE);
+  for (i = 0; i < STREAM_SIZE; i++)
+    data[i] = (i * 7 + i / 4096) & 0xff;
+
+  return g_bytes_new_take (data, STREAM_SIZE);
+}
+
+static void
+stream_get (GtkClipboard     *clipboard,
+            GtkSelectionData *selection_data,
+            guint             info,
+            gpointer          payload)
+{
+  GInputStream *stream;
+
+  stream = g_memory_input_stream_new_from_bytes (payload);
+  gtk_selection_data_set_stream (selection_data,
+                                 gdk_atom_intern_static_string (TARGET_STREAM),
+                                 8, stream);
+  g_object_unref (stream);
+}
+
+static void
+stream_clear (GtkClipboard *clipboard,
+              gpointer      payload)
+{
+  g_bytes_unref (payload);
+}
+
+static void
+set_stream_contents (GtkClipboard *clipboard)
+{
+  GtkTargetEntry entries[] = { { .target = TARGET_STREAM } };
+
+  gtk_clipboard_set_with_data (clipboard, entries, G_N_ELEMENTS (entries),
+                               stream_get, stream_clear, make_payload ());
+}
+
+typedef struct {
+  GMainLoop *loop;
+  GBytes *payload;
+  gsize offset;
+  guint n_chunks;
+  GError *error;
+} StreamResult;
+
+static void
+read_chunk_ready (GObject      *source,
+                  GAsyncResult *result,
+                  gpointer      data)
+{
+  StreamResult *res = data;
+  GBytes *bytes;
+  gsize size;
+
+  bytes = g_input_stream_read_bytes_finish (G_INPUT_STREAM (source), result, &res->error);
+  if (bytes == NULL || g_bytes_get_size (bytes) == 0)
+    {
+      g_clear_pointer (&bytes, g_bytes_unref);
+      g_main_loop_quit (res->loop);
+      return;
+    }
+
+  size = g_bytes_get_size (bytes);
+  g_assert_cmpuint (res->offset + size, <=, STREAM_SIZE);
+  g_assert (memcmp ((const guchar *) g_bytes_get_data (res->payload, NULL) + res->offset,
+                    g_bytes_get_data (bytes, NULL), size) == 0);
+  res->offset += size;
+  res->n_chunks++;
+  g_bytes_unref (bytes);
+
+  g_input_stream_read_bytes_async (G_INPUT_STREAM (source), 65536,
+                                   G_PRIORITY_DEFAULT, NULL,
+                                   read_chunk_ready, res);
+}
+
+static void
+stream_ready (GObject      *source,
+              GAsyncResult *result,
+              gpointer      data)
+{
+  StreamResult *res = data;
+  GInputStream *stream;
+  GdkAtom type;
+
+  stream = gtk_clipboard_read_stream_finish (GTK_CLIPBOARD (source), result, &type, &res->error);
+  if (stream == NULL)
+    {
+      g_main_loop_quit (res->loop);
+      return;
+    }
+
+  g_assert (type == gdk_atom_intern_static_string (TARGET_STREAM));
+
+  g_input_stream_read_bytes_async (stream, 65536,
+                                   G_PRIORITY_DEFAULT, NULL,
+                                   read_chunk_ready, res);
+  g_object_unref (stream);
+}
+
+static void
+check_stream_contents (GtkClipboard *clipboard)
+{
+  StreamResult res = { NULL, };
+
+  res.loop = g_main_loop_new (NULL, FALSE);
+  res.payload = make_payload ();
+
+  gtk_clipboard_read_stream_async (clipboard,
+                                   gdk_atom_intern_static_string (TARGET_STREAM),
+                                   NULL, stream_ready, &res);
+  g_main_loop_run (res.loop);
+
+  g_assert_no_error (res.error);
+  g_assert_cmpuint (res.offset, ==, STREAM_SIZE);
+  g_assert_cmpuint (res.n_chunks, >, 1);
+
+  g_bytes_unref (res.payload);
+  g_main_loop_unref (res.loop);
+}
+
+static void
+test_stream (void)
+{
+  GtkClipboard *clipboard = gtk_clipboard_get_for_display (gdk_display_get_default (), GDK_SELECTION_CLIPBOARD);
+  GtkSelectionData *data;
+
+  set_stream_contents (clipboard);
+  check_stream_contents (clipboard);
+
+  /* Requests that need a buffer still get all of the data */
+  data = gtk_clipboard_wait_for_contents (clipboard, gdk_atom_intern_static_string (TARGET_STREAM));
+  g_assert (data != NULL);
+  g_assert_cmpint (gtk_selection_data_get_length (data), ==, STREAM_SIZE);
+  gtk_selection_data_free (data);
+
+  gtk_clipboard_clear (clipboard);
+}
+
+/* Owns the clipboard in a separate process, so that the data has to
+ * go through the X server, in INCR chunks.
+ */
+static int
+run_stream_owner (void)
+{
+  GtkClipboard *clipboard;
+
+  gtk_init (NULL, NULL);
+
+  clipboard = gtk_clipboard_get_for_display (gdk_display_get_default (), GDK_SELECTION_CLIPBOARD);
+  set_stream_contents (clipboard);
+  gdk_display_sync (gdk_display_get_default ());
+
+  g_print ("ready\n");
+  fflush (stdout);
+
+  gtk_main ();
+
+  return 0;
+}
+
+static void
+test_stream_incr (void)
+{
+  GtkClipboard *clipboard = gtk_clipboard_get_for_display (gdk_display_get_default (), GDK_SELECTION_CLIPBOARD);
+  GSubprocess *owner;
+  GDataInputStream *output;
+  GError *error = NULL;
+  char *line;
+
+#ifdef GDK_WINDOWING_X11
+  if (!GDK_IS_X11_DISPLAY (gdk_display_get_default ()))
+#endif
+    {
+      g_test_skip ("INCR transfers only happen on X11");
+      return;
+    }
+
+  owner = g_subprocess_new (G_SUBPROCESS_FLAGS_STDOUT_PIPE, &error,
+                            test_program, "--stream-owner", NULL);
+  g_assert_no_error (error);
+
+  output = g_data_input_stream_new (g_subprocess_get_stdout_pipe (owner));
+  line = g_data_input_stream_read_line (output, NULL, NULL, &error);
+  g_assert_no_error (error);
+  g_assert_cmpstr (line, ==, "ready");
+  g_free (line);
+
+  check_stream_contents (clipboard);
+
+  g_subprocess_force_exit (owner);
+  g_subprocess_wait (owner, NULL, NULL);
+  g_object_unref (output);
+  g_object_unref (owner);
+}
+
 int
 main (int   argc,
       char *argv[])
 {
+  test_program = argv[0];
+
+  if (argc == 2 && strcmp (argv[1], "--stream-owner") == 0)
+    return run_stream_owner ();
+
   gtk_test_init (&argc, &argv);
 
   g_test_add_func ("/clipboard/test_text", test_text);
   g_test_add_func ("/clipboard/test_with_data", test_with_data);
+  g_test_add_func ("/clipboard/stream", test_stream);
+  g_test_add_func ("/clipboard/stream-incr", test_stream_incr);
 
   return g_test_run();
 }
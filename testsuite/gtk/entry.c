@@ -306,6 +306,85 @@ test_delete (void)
   g_object_unref (entry);
 }
 
+static void
+no_matches (GtkEntryCompletion *completion,
+            gint               *count)
+{
+  (*count)++;
+}
+
+static gchar *
+complete (GtkEntryCompletion *completion,
+          const gchar        *text)
+{
+  gtk_entry_set_text (GTK_ENTRY (gtk_entry_completion_get_entry (completion)), text);
+  gtk_entry_completion_complete (completion);
+
+  return gtk_entry_completion_compute_prefix (completion, "");
+}
+
+static void
+test_completion (void)
+{
+  GtkWidget *entry;
+  GtkEntryCompletion *completion;
+  GtkListStore *store;
+  GtkTreeIter iter, apple;
+  gint count = 0;
+  gchar *prefix;
+
+  store = gtk_list_store_new (1, G_TYPE_STRING);
+  gtk_list_store_insert_with_values (store, &apple, -1, 0, "apple", -1);
+  gtk_list_store_insert_with_values (store, NULL, -1, 0, "Apricot", -1);
+  gtk_list_store_insert_with_values (store, NULL, -1, 0, "banana", -1);
+  gtk_list_store_insert_with_values (store, NULL, -1, 0, "apartment", -1);
+
+  entry = gtk_entry_new ();
+  g_object_ref_sink (entry);
+  completion = gtk_entry_completion_new ();
+  gtk_entry_completion_set_model (completion, GTK_TREE_MODEL (store));
+  gtk_entry_completion_set_text_column (completion, 0);
+  gtk_entry_set_completion (GTK_ENTRY (entry), completion);
+  g_signal_connect (completion, "no-matches", G_CALLBACK (no_matches), &count);
+
+  /* narrowing the key, case-insensitively */
+  prefix = complete (completion, "A");
+  g_assert_cmpstr (prefix, ==, "");
+  g_free (prefix);
+  prefix = complete (completion, "ApA");
+  g_assert_cmpstr (prefix, ==, "apartment");
+  g_free (prefix);
+  prefix = complete (completion, "app");
+  g_assert_cmpstr (prefix, ==, "apple");
+  g_free (prefix);
+
+  /* the index follows changes to the model */
+  gtk_list_store_insert_with_values (store, NULL, 0, 0, "application", -1);
+  prefix = complete (completion, "app");
+  g_assert_cmpstr (prefix, ==, "appl");
+  g_free (prefix);
+
+  gtk_list_store_set (store, &apple, 0, "cherry", -1);
+  prefix = complete (completion, "app");
+  g_assert_cmpstr (prefix, ==, "application");
+  g_free (prefix);
+
+  gtk_tree_model_get_iter_first (GTK_TREE_MODEL (store), &iter);
+  gtk_list_store_remove (store, &iter);
+  g_assert_cmpint (count, ==, 0);
+  prefix = complete (completion, "app");
+  g_assert_null (prefix);
+  g_assert_cmpint (count, ==, 1);
+
+  prefix = complete (completion, "ch");
+  g_assert_cmpstr (prefix, ==, "cherry");
+  g_free (prefix);
+
+  g_object_unref (completion);
+  g_object_unref (entry);
+  g_object_unref (store);
+}
+
 int
 main (int   argc,
       char *argv[])
@@ -314,6 +393,7 @@ main (int   argc,
 
   g_test_add_func ("/entry/delete", test_delete);
   g_test_add_func ("/entry/insert", test_insert);
+  g_test_add_func ("/entry/completion", test_completion);
 
   return g_test_run();
 }
@@ -0,0 +1,356 @@
+/* GtkFileIndex tests.
+ *
+ * Copyright (C) 2016, Red Hat, Inc.
+ *
+ * This library is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public
+ * License as published by the Free Software Foundation; either
+ * version 2 of the License, or (at your option) any later version.
+ *
+ * This library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with this library. If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include <locale.h>
+#include <string.h>
+#include <utime.h>
+#include <glib/gstdio.h>
+
+#include "../../gtk/gtkfileindexprivate.h"
+
+static void
+create_file (const gchar *root,
+             const gchar *relative)
+{
+  gchar *path, *dir;
+
+  path = g_build_filename (root, relative, NULL);
+  dir = g_path_get_dirname (path);
+  g_assert_cmpint (g_mkdir_with_parents (dir, 0700), ==, 0);
+  g_assert (g_file_set_contents (path, "", 0, NULL));
+  g_free (dir);
+  g_free (path);
+}
+
+static void
+remove_file (const gchar *root,
+             const gchar *relative)
+{
+  gchar *path;
+
+  path = g_build_filename (root, relative, NULL);
+  g_assert_cmpint (g_remove (path), ==, 0);
+  g_free (path);
+}
+
+/* Directories are only rescanned when their mtime changed, and
+ * that only has a resolution of seconds, so the tests set it
+ */
+#define OLD_MTIME 1000000000
+#define NEW_MTIME (OLD_MTIME + 10)
+
+static void
+set_dir_mtime (const gchar *root,
+               const gchar *relative,
+               time_t       mtime)
+{
+  struct utimbuf times;
+  gchar *path;
+
+  path = g_build_filename (root, relative, NULL);
+  times.actime = mtime;
+  times.modtime = mtime;
+  g_assert_cmpint (g_utime (path, &times), ==, 0);
+  g_free (path);
+}
+
+static void
+remove_tree (const gchar *path)
+{
+  const gchar *name;
+  gchar *child;
+  GDir *dir;
+
+  dir = g_dir_open (path, 0, NULL);
+  if (dir)
+    {
+      while ((name = g_dir_read_name (dir)) != NULL)
+        {
+          child = g_build_filename (path, name, NULL);
+          remove_tree (child);
+          g_free (child);
+        }
+      g_dir_close (dir);
+    }
+
+  g_remove (path);
+}
+
+static gint
+compare_strings (gconstpointer a,
+                 gconstpointer b)
+{
+  return strcmp (*(const gchar **) a, *(const gchar **) b);
+}
+
+/* Returns the matches below @root, relative to it, sorted and
+ * separated by spaces
+ */
+static gchar *
+lookup (GtkFileIndex *index,
+        const gchar  *root,
+        const gchar  *text,
+        const gchar  *location,
+        gboolean      recursive)
+{
+  GFile *root_file;
+  GPtrArray *names;
+  GList *files, *l;
+  gchar *path, *result;
+
+  path = g_build_filename (root, location, NULL);
+  files = _gtk_file_index_lookup (index, text, path, recursive, NULL);
+  g_free (path);
+
+  root_file = g_file_new_for_path (root);
+  names = g_ptr_array_new_with_free_func (g_free);
+  for (l = files; l; l = l->next)
+    g_ptr_array_add (names, g_file_get_relative_path (root_file, l->data));
+  g_ptr_array_sort (names, compare_strings);
+  g_ptr_array_add (names, NULL);
+
+  result = g_strjoinv (" ", (gchar **) names->pdata);
+
+  g_ptr_array_unref (names);
+  g_list_free_full (files, g_object_unref);
+  g_object_unref (root_file);
+
+  return result;
+}
+
+static void
+assert_lookup (GtkFileIndex *index,
+               const gchar  *root,
+               const gchar  *text,
+               const gchar  *location,
+               gboolean      recursive,
+               const gchar  *expected)
+{
+  gchar *result;
+
+  result = lookup (index, root, text, location, recursive);
+  g_assert_cmpstr (result, ==, expected);
+  g_free (result);
+}
+
+typedef struct
+{
+  gchar *dir;
+  gchar *root;
+  gchar *cache_file;
+} Fixture;
+
+static void
+fixture_setup (Fixture       *fixture,
+               gconstpointer  data)
+{
+  fixture->dir = g_dir_make_tmp ("gtk-file-index-XXXXXX", NULL);
+  g_assert (fixture->dir != NULL);
+
+  fixture->root = g_build_filename (fixture->dir, "root", NULL);
+  fixture->cache_file = g_build_filename (fixture->dir, "cache", NULL);
+  g_assert_cmpint (g_mkdir (fixture->root, 0700), ==, 0);
+}
+
+static void
+fixture_teardown (Fixture       *fixture,
+                  gconstpointer  data)
+{
+  remove_tree (fixture->dir);
+
+  g_free (fixture->dir);
+  g_free (fixture->root);
+  g_free (fixture->cache_file);
+}
+
+static void
+test_lookup (Fixture       *fixture,
+             gconstpointer  data)
+{
+  const gchar *root = fixture->root;
+  GtkFileIndex *index;
+
+  create_file (root, "alpha.txt");
+  create_file (root, "beta.txt");
+  create_file (root, "Gamma Ray.png");
+  create_file (root, "sub/alphabet.c");
+  create_file (root, "sub/deeper/alpine.h");
+  create_file (root, ".alpha");
+  create_file (root, ".hidden/alpha.txt");
+
+  index = _gtk_file_index_new (root, fixture->cache_file);
+  _gtk_file_index_refresh (index, NULL);
+
+  /* Trigrams of one word */
+  assert_lookup (index, root, "alpha", "", TRUE, "alpha.txt sub/alphabet.c");
+  assert_lookup (index, root, "txt", "", TRUE, "alpha.txt beta.txt");
+
+  /* Every word has to match, in any order and case */
+  assert_lookup (index, root, "ray GAM", "", TRUE, "Gamma Ray.png");
+  assert_lookup (index, root, "alp bet", "", TRUE, "sub/alphabet.c");
+
+  /* A trigram nothing has */
+  assert_lookup (index, root, "xyz", "", TRUE, "");
+
+  /* Words shorter than a trigram look at everything */
+  assert_lookup (index, root, "al", "", TRUE, "alpha.txt sub/alphabet.c sub/deeper/alpine.h");
+
+  /* Locations */
+  assert_lookup (index, root, "alp", "", FALSE, "alpha.txt");
+  assert_lookup (index, root, "alp", "sub", FALSE, "sub/alphabet.c");
+  assert_lookup (index, root, "alp", "sub", TRUE, "sub/alphabet.c sub/deeper/alpine.h");
+
+  /* Directories are found too */
+  assert_lookup (index, root, "deep", "", TRUE, "sub/deeper");
+
+  _gtk_file_index_free (index);
+}
+
+static void
+test_save_load (Fixture       *fixture,
+                gconstpointer  data)
+{
+  const gchar *root = fixture->root;
+  GtkFileIndex *index;
+
+  create_file (root, "one.txt");
+  create_file (root, "two.txt");
+  create_file (root, "sub/three.txt");
+  set_dir_mtime (root, "", OLD_MTIME);
+  set_dir_mtime (root, "sub", OLD_MTIME);
+
+  index = _gtk_file_index_new (root, fixture->cache_file);
+  _gtk_file_index_refresh (index, NULL);
+  _gtk_file_index_free (index);
+
+  g_assert (g_file_test (fixture->cache_file, G_FILE_TEST_EXISTS));
+
+  /* As long as the directories look unchanged, a new index is
+   * filled from the saved one, without scanning them
+   */
+  remove_file (root, "two.txt");
+  create_file (root, "sub/four.txt");
+  set_dir_mtime (root, "", OLD_MTIME);
+  set_dir_mtime (root, "sub", OLD_MTIME);
+
+  index = _gtk_file_index_new (root, fixture->cache_file);
+  assert_lookup (index, root, "txt", "", TRUE, "one.txt sub/three.txt two.txt");
+  assert_lookup (index, root, "thr", "sub", FALSE, "sub/three.txt");
+  _gtk_file_index_free (index);
+
+  /* Once they changed, they are scanned again */
+  set_dir_mtime (root, "", NEW_MTIME);
+  set_dir_mtime (root, "sub", NEW_MTIME);
+
+  index = _gtk_file_index_new (root, fixture->cache_file);
+  assert_lookup (index, root, "txt", "", TRUE, "one.txt sub/four.txt sub/three.txt");
+  _gtk_file_index_free (index);
+
+  /* and the result of that was saved */
+  remove_file (root, "sub/four.txt");
+  set_dir_mtime (root, "sub", NEW_MTIME);
+
+  index = _gtk_file_index_new (root, fixture->cache_file);
+  assert_lookup (index, root, "txt", "", TRUE, "one.txt sub/four.txt sub/three.txt");
+  _gtk_file_index_free (index);
+}
+
+static void
+test_compact (Fixture       *fixture,
+              gconstpointer  data)
+{
+  const gchar *root = fixture->root;
+  GtkFileIndex *index;
+  gchar *name;
+  guint i;
+
+  /* A directory that goes away, ahead of one that stays */
+  create_file (root, "aaa-gone/inner-gone.txt");
+  create_file (root, "zzz-kept/inner-kept.txt");
+  create_file (root, "zzz-kept/deeper/innermost.txt");
+  for (i = 0; i < 10; i++)
+    {
+      name = g_strdup_printf ("file%u.txt", i);
+      create_file (root, name);
+      g_free (name);
+    }
+  set_dir_mtime (root, "", OLD_MTIME);
+  set_dir_mtime (root, "zzz-kept", OLD_MTIME);
+  set_dir_mtime (root, "zzz-kept/deeper", OLD_MTIME);
+
+  index = _gtk_file_index_new (root, fixture->cache_file);
+  _gtk_file_index_refresh (index, NULL);
+  assert_lookup (index, root, "inner", "", TRUE,
+                 "aaa-gone/inner-gone.txt zzz-kept/deeper/innermost.txt zzz-kept/inner-kept.txt");
+  _gtk_file_index_free (index);
+
+  /* Remove well over half of the entries */
+  remove_file (root, "aaa-gone/inner-gone.txt");
+  remove_file (root, "aaa-gone");
+  for (i = 0; i < 9; i++)
+    {
+      name = g_strdup_printf ("file%u.txt", i);
+      remove_file (root, name);
+      g_free (name);
+    }
+  create_file (root, "fresh.txt");
+  set_dir_mtime (root, "", NEW_MTIME);
+
+  /* Loading and rescanning tombstones all of them, so the refresh
+   * compacts the index, renumbering the directories and entries
+   * that are left
+   */
+  index = _gtk_file_index_new (root, fixture->cache_file);
+  assert_lookup (index, root, "inner", "", TRUE,
+                 "zzz-kept/deeper/innermost.txt zzz-kept/inner-kept.txt");
+  assert_lookup (index, root, "inner", "zzz-kept", FALSE, "zzz-kept/inner-kept.txt");
+  assert_lookup (index, root, "inner", "zzz-kept/deeper", FALSE, "zzz-kept/deeper/innermost.txt");
+  assert_lookup (index, root, "file", "", TRUE, "file9.txt");
+  assert_lookup (index, root, "txt", "", FALSE, "file9.txt fresh.txt");
+  assert_lookup (index, root, "gone", "", TRUE, "");
+
+  _gtk_file_index_free (index);
+
+  /* The compacted index is saved, and its directories keep being
+   * updated
+   */
+  create_file (root, "zzz-kept/deeper/newest.txt");
+  set_dir_mtime (root, "zzz-kept/deeper", NEW_MTIME);
+
+  index = _gtk_file_index_new (root, fixture->cache_file);
+  assert_lookup (index, root, "txt", "zzz-kept/deeper", FALSE,
+                 "zzz-kept/deeper/innermost.txt zzz-kept/deeper/newest.txt");
+  assert_lookup (index, root, "txt", "", FALSE, "file9.txt fresh.txt");
+  _gtk_file_index_free (index);
+}
+
+int
+main (int argc, char *argv[])
+{
+  g_test_init (&argc, &argv, NULL);
+  setlocale (LC_ALL, "C");
+
+  g_test_add ("/file-index/lookup", Fixture, NULL,
+              fixture_setup, test_lookup, fixture_teardown);
+  g_test_add ("/file-index/save-load", Fixture, NULL,
+              fixture_setup, test_save_load, fixture_teardown);
+  g_test_add ("/file-index/compact", Fixture, NULL,
+              fixture_setup, test_compact, fixture_teardown);
+
+  return g_test_run ();
+}
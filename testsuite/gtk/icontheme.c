@@ -754,6 +754,93 @@ test_nonsquare_symbolic (void)
   g_object_unref (info);
 }
 
+static gboolean
+count_draw (GtkWidget *widget,
+            cairo_t   *cr,
+            gpointer   data)
+{
+  guint *n_draws = data;
+
+  (*n_draws)++;
+
+  return FALSE;
+}
+
+static gboolean
+stop_waiting (gpointer data)
+{
+  gboolean *timed_out = data;
+
+  *timed_out = TRUE;
+
+  return G_SOURCE_REMOVE;
+}
+
+static GtkWidget *
+create_async_icon_window (guint *n_draws)
+{
+  GtkWidget *window, *view;
+  GtkCellRenderer *renderer;
+
+  window = gtk_offscreen_window_new ();
+  view = gtk_cell_view_new ();
+  renderer = gtk_cell_renderer_pixbuf_new ();
+  g_object_set (renderer,
+                "load-async", TRUE,
+                "icon-name", "simple",
+                "stock-size", GTK_ICON_SIZE_MENU,
+                NULL);
+  gtk_cell_layout_pack_start (GTK_CELL_LAYOUT (view), renderer, TRUE);
+  g_signal_connect (view, "draw", G_CALLBACK (count_draw), n_draws);
+  gtk_container_add (GTK_CONTAINER (window), view);
+  gtk_widget_show_all (window);
+
+  return window;
+}
+
+static void
+wait_for_draws (guint *n_draws,
+                guint  count)
+{
+  gboolean timed_out = FALSE;
+  guint id;
+
+  id = g_timeout_add_seconds (5, stop_waiting, &timed_out);
+  while (*n_draws < count && !timed_out)
+    g_main_context_iteration (NULL, TRUE);
+  if (!timed_out)
+    g_source_remove (id);
+}
+
+static void
+test_async_reload (void)
+{
+  GtkWidget *window;
+  guint n_draws;
+
+  g_object_set (gtk_settings_get_default (), "gtk-icon-theme-name", "icons", NULL);
+  gtk_icon_theme_prepend_search_path (gtk_icon_theme_get_default (),
+                                      g_test_get_dir (G_TEST_DIST));
+
+  /* The first draw starts loading the icon, and the window goes
+   * away before it arrives.
+   */
+  n_draws = 0;
+  window = create_async_icon_window (&n_draws);
+  wait_for_draws (&n_draws, 1);
+  g_assert_cmpuint (n_draws, ==, 1);
+  gtk_widget_destroy (window);
+
+  /* A new widget asking for the same icon must be redrawn
+   * once the icon is loaded.
+   */
+  n_draws = 0;
+  window = create_async_icon_window (&n_draws);
+  wait_for_draws (&n_draws, 2);
+  g_assert_cmpuint (n_draws, >=, 2);
+  gtk_widget_destroy (window);
+}
+
 int
 main (int argc, char *argv[])
 {
@@ -773,6 +860,7 @@ main (int argc, char *argv[])
   g_test_add_func ("/icontheme/async", test_async);
   g_test_add_func ("/icontheme/inherit", test_inherit);
   g_test_add_func ("/icontheme/nonsquare-symbolic", test_nonsquare_symbolic);
+  g_test_add_func ("/icontheme/async-reload", test_async_reload);
 
   return g_test_run();
 }
@@ -33,13 +33,12 @@ static void
 test_basic (void)
 {
   GtkKeyHash *hash;
-  GSList *keys;
+  gpointer keys[4];
 
   count = 0;
   hash = _gtk_key_hash_new (gdk_keymap_get_default (), counting_destroy);
 
-  keys = _gtk_key_hash_lookup (hash, 0, 0, 0, 0);
-  g_assert (keys == NULL);
+  g_assert_cmpuint (_gtk_key_hash_lookup (hash, 0, 0, 0, 0, keys, G_N_ELEMENTS (keys)), ==, 0);
 
   _gtk_key_hash_add_entry (hash, 1, 0, NULL);
   _gtk_key_hash_add_entry (hash, 1, 1, NULL);
@@ -70,7 +69,8 @@ test_lookup (GtkKeyHash      *hash,
 {
   va_list ap;
   gint d;
-  GSList *res, *l;
+  gpointer res[16];
+  guint n_res;
   gint i;
   GdkKeymapKey *keys;
   gint n_keys;
@@ -79,20 +79,19 @@ test_lookup (GtkKeyHash      *hash,
   if (n_keys == 0)
     return;
 
-  res = _gtk_key_hash_lookup (hash, keys[0].keycode, modifiers, mask, keys[0].group);
+  n_res = _gtk_key_hash_lookup (hash, keys[0].keycode, modifiers, mask, keys[0].group,
+                                res, G_N_ELEMENTS (res));
   g_free (keys);
 
-  g_assert_cmpint (g_slist_length (res), ==, n_results);
+  g_assert_cmpint (n_res, ==, n_results);
 
   va_start (ap, n_results);
-  for (i = 0, l = res; i < n_results; i++, l = l->next)
+  for (i = 0; i < n_results; i++)
     {
       d = va_arg (ap, int);
-      g_assert_cmpint (d, ==, GPOINTER_TO_INT (l->data));
+      g_assert_cmpint (d, ==, GPOINTER_TO_INT (res[i]));
     }
   va_end (ap);
-
-  g_slist_free (res);
 }
 
 static void
@@ -22,6 +22,7 @@
 
 const gchar *uri = "file:///tmp/testrecentchooser.txt";
 const gchar *uri2 = "file:///tmp/testrecentchooser2.txt";
+const gchar *uri3 = "file:///tmp/testrecentchooser3.txt";
 
 static void
 recent_manager_get_default (void)
@@ -159,6 +160,158 @@ recent_manager_add_many (void)
   g_object_unref (manager);
 
   g_assert_cmpint (g_unlink ("recently-used.xbel"), ==, 0);
+  g_unlink ("recently-used.xbel.journal");
+}
+
+static void
+quit_loop (GtkRecentManager *manager,
+           gpointer          data)
+{
+  g_main_loop_quit (data);
+}
+
+static void
+add_and_wait (GtkRecentManager *manager,
+              const gchar      *item_uri)
+{
+  GtkRecentData data = { NULL, };
+  GMainLoop *loop;
+  gulong id;
+
+  data.mime_type = "text/plain";
+  data.app_name = "testrecentchooser";
+  data.app_exec = "testrecentchooser %u";
+
+  loop = g_main_loop_new (NULL, FALSE);
+  id = g_signal_connect (manager, "changed", G_CALLBACK (quit_loop), loop);
+  gtk_recent_manager_add_full (manager, item_uri, &data);
+  g_main_loop_run (loop);
+  g_signal_handler_disconnect (manager, id);
+  g_main_loop_unref (loop);
+}
+
+static gboolean
+stop_waiting (gpointer data)
+{
+  g_main_loop_quit (data);
+
+  return G_SOURCE_REMOVE;
+}
+
+/* gives the manager time to fold the journal into the file */
+static void
+wait_for_compaction (void)
+{
+  GMainLoop *loop;
+
+  loop = g_main_loop_new (NULL, FALSE);
+  g_timeout_add_seconds (3, stop_waiting, loop);
+  g_main_loop_run (loop);
+  g_main_loop_unref (loop);
+}
+
+static gboolean
+file_has_item (const gchar *filename,
+               const gchar *item_uri)
+{
+  GBookmarkFile *bookmarks;
+  gboolean res;
+
+  bookmarks = g_bookmark_file_new ();
+  g_assert (g_bookmark_file_load_from_file (bookmarks, filename, NULL));
+  res = g_bookmark_file_has_item (bookmarks, item_uri);
+  g_bookmark_file_free (bookmarks);
+
+  return res;
+}
+
+static void
+recent_manager_journal (void)
+{
+  GtkRecentManager *manager, *manager2;
+  GtkRecentInfo *info;
+
+  manager = g_object_new (GTK_TYPE_RECENT_MANAGER,
+                          "filename", "recently-used-journal.xbel",
+                          NULL);
+
+  /* the first write creates the file */
+  add_and_wait (manager, uri);
+  g_assert (g_file_test ("recently-used-journal.xbel", G_FILE_TEST_EXISTS));
+
+  /* later ones only go to the journal at first */
+  add_and_wait (manager, uri2);
+  g_assert (file_has_item ("recently-used-journal.xbel", uri));
+  g_assert (!file_has_item ("recently-used-journal.xbel", uri2));
+
+  /* but other managers see them */
+  manager2 = g_object_new (GTK_TYPE_RECENT_MANAGER,
+                           "filename", "recently-used-journal.xbel",
+                           NULL);
+  g_assert (gtk_recent_manager_has_item (manager2, uri));
+  g_assert (gtk_recent_manager_has_item (manager2, uri2));
+
+  info = gtk_recent_manager_lookup_item (manager2, uri2, NULL);
+  g_assert (info != NULL);
+  g_assert (gtk_recent_info_has_application (info, "testrecentchooser"));
+  g_assert_cmpstr (gtk_recent_info_get_mime_type (info), ==, "text/plain");
+  gtk_recent_info_unref (info);
+
+  /* and the file catches up shortly after */
+  wait_for_compaction ();
+  g_assert (file_has_item ("recently-used-journal.xbel", uri2));
+
+  g_object_unref (manager2);
+  g_object_unref (manager);
+
+  g_assert_cmpint (g_unlink ("recently-used-journal.xbel"), ==, 0);
+  g_assert_cmpint (g_unlink ("recently-used-journal.xbel.journal"), ==, 0);
+}
+
+static void
+recent_manager_journal_replaced (void)
+{
+  GtkRecentManager *manager, *manager2;
+  GBookmarkFile *bookmarks;
+  GError *error = NULL;
+
+  manager = g_object_new (GTK_TYPE_RECENT_MANAGER,
+                          "filename", "recently-used-replaced.xbel",
+                          NULL);
+
+  add_and_wait (manager, uri);
+  add_and_wait (manager, uri2);
+  g_assert (!file_has_item ("recently-used-replaced.xbel", uri2));
+
+  /* someone who doesn't know about the journal rewrites the file */
+  bookmarks = g_bookmark_file_new ();
+  g_bookmark_file_load_from_file (bookmarks, "recently-used-replaced.xbel", &error);
+  g_assert_no_error (error);
+  g_bookmark_file_set_mime_type (bookmarks, uri3, "text/plain");
+  g_bookmark_file_add_application (bookmarks, uri3, "otherapp", "otherapp %u");
+  g_bookmark_file_to_file (bookmarks, "recently-used-replaced.xbel", &error);
+  g_assert_no_error (error);
+  g_bookmark_file_free (bookmarks);
+
+  /* the journal records still apply on top of the new file */
+  manager2 = g_object_new (GTK_TYPE_RECENT_MANAGER,
+                           "filename", "recently-used-replaced.xbel",
+                           NULL);
+  g_assert (gtk_recent_manager_has_item (manager2, uri));
+  g_assert (gtk_recent_manager_has_item (manager2, uri2));
+  g_assert (gtk_recent_manager_has_item (manager2, uri3));
+
+  /* and get folded into it */
+  wait_for_compaction ();
+  g_assert (file_has_item ("recently-used-replaced.xbel", uri));
+  g_assert (file_has_item ("recently-used-replaced.xbel", uri2));
+  g_assert (file_has_item ("recently-used-replaced.xbel", uri3));
+
+  g_object_unref (manager2);
+  g_object_unref (manager);
+
+  g_assert_cmpint (g_unlink ("recently-used-replaced.xbel"), ==, 0);
+  g_assert_cmpint (g_unlink ("recently-used-replaced.xbel.journal"), ==, 0);
 }
 
 static void
@@ -303,6 +456,10 @@ main (int    argc,
   g_test_add_func ("/recent-manager/get-default", recent_manager_get_default);
   g_test_add_func ("/recent-manager/add", recent_manager_add);
   g_test_add_func ("/recent-manager/add-many", recent_manager_add_many);
+#ifdef G_OS_UNIX
+  g_test_add_func ("/recent-manager/journal", recent_manager_journal);
+  g_test_add_func ("/recent-manager/journal-replaced", recent_manager_journal_replaced);
+#endif
   g_test_add_func ("/recent-manager/has-item", recent_manager_has_item);
   g_test_add_func ("/recent-manager/move-item", recent_manager_move_item);
   g_test_add_func ("/recent-manager/lookup-item", recent_manager_lookup_item);
@@ -0,0 +1,111 @@
+/*
+ * Copyright (C) 2016 Red Hat Inc.
+ *
+ * This library is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Library General Public
+ * License as published by the Free Software Foundation; either
+ * version 2 of the License, or (at your option) any later version.
+ *
+ * This library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Library General Public License for more details.
+ *
+ * You should have received a copy of the GNU Library General Public
+ * License along with this library. If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include <gtk/gtk.h>
+
+#define SIZE 10
+
+#define RED  0xffff0000
+#define BLUE 0xff0000ff
+
+typedef struct {
+  guint32 color;
+  guint n_draws;
+} DrawData;
+
+static gboolean
+draw_color (GtkWidget *widget,
+            cairo_t   *cr,
+            DrawData  *data)
+{
+  cairo_set_source_rgb (cr,
+                        ((data->color >> 16) & 0xff) / 255.,
+                        ((data->color >> 8) & 0xff) / 255.,
+                        (data->color & 0xff) / 255.);
+  cairo_paint (cr);
+  data->n_draws++;
+
+  return TRUE;
+}
+
+static guint32
+draw_pixel (GtkWidget *widget)
+{
+  cairo_surface_t *surface;
+  cairo_t *cr;
+  guint32 pixel;
+
+  surface = cairo_image_surface_create (CAIRO_FORMAT_ARGB32, SIZE, SIZE);
+  cr = cairo_create (surface);
+  gtk_widget_draw (widget, cr);
+  cairo_destroy (cr);
+
+  cairo_surface_flush (surface);
+  pixel = *(guint32 *) (cairo_image_surface_get_data (surface) +
+                        cairo_image_surface_get_stride (surface) + 4);
+  cairo_surface_destroy (surface);
+
+  return pixel;
+}
+
+static void
+test_queue_draw_parent (void)
+{
+  GtkWidget *window, *box, *area;
+  DrawData data = { RED, 0 };
+
+  window = gtk_offscreen_window_new ();
+  box = gtk_box_new (GTK_ORIENTATION_HORIZONTAL, 0);
+  gtk_container_add (GTK_CONTAINER (window), box);
+
+  area = gtk_drawing_area_new ();
+  gtk_widget_set_has_window (area, FALSE);
+  gtk_widget_set_size_request (area, SIZE, SIZE);
+  g_signal_connect (area, "draw", G_CALLBACK (draw_color), &data);
+  gtk_container_add (GTK_CONTAINER (box), area);
+
+  gtk_widget_show_all (window);
+  gtk_test_widget_wait_for_draw (window);
+
+  g_assert_cmphex (draw_pixel (box), ==, RED);
+
+  /* Without a queued draw, the recording is replayed */
+  data.color = BLUE;
+  data.n_draws = 0;
+  g_assert_cmphex (draw_pixel (box), ==, RED);
+  g_assert_cmpuint (data.n_draws, ==, 0);
+
+  /* Queueing a draw on the parent forces the child to be redrawn too */
+  gtk_widget_queue_draw (box);
+  g_assert_cmphex (draw_pixel (box), ==, BLUE);
+  g_assert_cmpuint (data.n_draws, ==, 1);
+
+  gtk_widget_destroy (window);
+}
+
+int
+main (int argc, char *argv[])
+{
+  /* Read once, when the first widget is drawn */
+  g_setenv ("GTK_RENDER_CACHE", "1", TRUE);
+
+  gtk_test_init (&argc, &argv, NULL);
+
+  g_test_add_func ("/rendercache/queue-draw-parent", test_queue_draw_parent);
+
+  return g_test_run ();
+}